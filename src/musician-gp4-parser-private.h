@@ -0,0 +1,109 @@
+/* musician-gp4-parser-private.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GP4_PARSER_PRIVATE_H
+#define MUSICIAN_GP4_PARSER_PRIVATE_H
+
+#include "musician-gp4-parser.h"
+#include "musician-gpt-arena.h"
+#include "musician-gpt-events.h"
+#include "musician-gpt-input-stream.h"
+#include "musician-gpt-parse-stats.h"
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+  MUSICIAN_GP4_SECTION_ATTRIBUTES,
+  MUSICIAN_GP4_SECTION_LYRICS,
+  MUSICIAN_GP4_SECTION_MIDI_PORTS,
+  MUSICIAN_GP4_SECTION_MEASURES,
+  MUSICIAN_GP4_SECTION_TRACKS,
+  MUSICIAN_GP4_SECTION_MEASURE_PAIRS,
+  MUSICIAN_GP4_SECTION_DONE,
+} MusicianGp4Section;
+
+/*
+ * Everything needed to pick up decoding where the last record left off,
+ * so that a file can be decoded in pieces as it arrives.
+ */
+typedef struct
+{
+  /* Where records go, and the song they build if no events were given */
+  const MusicianGptEvents *events;
+  gpointer                 user_data;
+  MusicianGptSong         *song;
+  MusicianGptArena        *arena;
+
+  MusicianGp4Section       section;
+
+  /* Filled in by the sections before the header is emitted */
+  MusicianGptHeaderEvent   header;
+  MusicianGptMidiPort      ports[4];
+
+  guint32                  n_measures;
+  guint32                  n_tracks;
+
+  /* The measure header, track or measure/track pair being decoded */
+  guint64                  index;
+
+  /* The beat being decoded within the current measure/track pair */
+  guint32                  n_beats;
+  guint32                  beat;
+  guint                    have_n_beats : 1;
+
+  /* The time signature carries over from one measure header to the next */
+  guint8                   numerator;
+  guint8                   denominator;
+
+  /* Points of the bends in the current beat */
+  GArray                  *points;
+
+  /*
+   * When loading lazily, the offset of each measure/track pair in the
+   * file. Beats are only checked, not emitted, while this is set.
+   */
+  GArray                  *offsets;
+
+  /* Counters for MusicianGptParser:stats, and the time spent per section */
+  MusicianGptParseStats    stats;
+  gint64                   section_usec[MUSICIAN_GP4_SECTION_DONE];
+  gint64                   section_begin;
+
+  /* When tracing, where and when the current section started */
+  guint                    trace : 1;
+  gint64                   trace_begin;
+  gsize                    trace_offset;
+  guint64                  trace_n_records;
+} MusicianGp4Decoder;
+
+void     _musician_gp4_decoder_init  (MusicianGp4Decoder       *decoder,
+                                      const gchar              *version,
+                                      MusicianGptArena         *arena,
+                                      const MusicianGptEvents  *events,
+                                      gpointer                  user_data);
+void     _musician_gp4_decoder_clear (MusicianGp4Decoder       *decoder);
+gboolean _musician_gp4_parser_step   (MusicianGp4Parser        *self,
+                                      MusicianGp4Decoder       *decoder,
+                                      MusicianGptInputStream   *stream,
+                                      GCancellable             *cancellable,
+                                      GError                  **error);
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GP4_PARSER_PRIVATE_H */
@@ -18,672 +18,1689 @@
 
 #define G_LOG_DOMAIN "musician-gp4-parser"
 
-#include "musician-gpt-beat.h"
+#include <string.h>
+
+#include "musician-gpt-beat-store-private.h"
 #include "musician-gpt-bend.h"
 #include "musician-gpt-chord.h"
+#include "musician-gpt-input-stream-private.h"
 #include "musician-gpt-measure.h"
+#include "musician-gpt-measure-private.h"
+#include "musician-gpt-metadata-private.h"
 #include "musician-gp4-parser.h"
+#include "musician-gp4-parser-private.h"
 #include "musician-gpt-song.h"
 #include "musician-gpt-song-private.h"
 #include "musician-gpt-track.h"
+#include "musician-gpt-track-private.h"
+#include "musician-gpt-trace-private.h"
 
 struct _MusicianGp4Parser
 {
   MusicianGptParser parent_instance;
 };
 
+/*
+ * What a lazily loaded song needs to decode the beats of a measure/track
+ * pair when they are requested. @offsets are positions within @bytes.
+ */
+typedef struct
+{
+  MusicianGp4Parser *parser;
+  GBytes            *bytes;
+  GArray            *offsets;
+  guint32            n_measures;
+  guint32            n_tracks;
+} MusicianGp4BlockIndex;
+
 G_DEFINE_TYPE (MusicianGp4Parser, musician_gp4_parser, MUSICIAN_TYPE_GPT_PARSER)
 
+/*
+ * The loaders below use the "pull" readers of MusicianGptInputStream. Those
+ * record the first failure in the stream and return zeroed values from then
+ * on, so we decode a whole record (a track, a measure header, a beat, ...)
+ * without testing every field, and then check the stream once before the
+ * record is handed to the consumer as a MusicianGptEvents callback.
+ *
+ * Anything that drives a loop from decoded data must stop as soon as the
+ * stream has failed, since the counts are no longer meaningful.
+ */
+
+/*
+ * The least a measure header, a track and a measure/track pair take in a
+ * file: the flags of the measure, every fixed field of the track, and the
+ * beat count of the pair.
+ */
+#define MIN_MEASURE_HEADER_SIZE 1
+#define MIN_TRACK_SIZE          98
+#define MIN_MEASURE_PAIR_SIZE   4
+
+/*
+ * Calls the @name callback of @decoder with @event, if there is one, and
+ * returns %FALSE from the calling function if the callback failed.
+ */
+#define DECODER_EMIT(decoder, name, event, error)                         \
+  G_STMT_START {                                                          \
+    if ((decoder)->events->name != NULL)                                  \
+      {                                                                   \
+        GError *emit_error = NULL;                                        \
+        (decoder)->events->name ((event), (decoder)->user_data, &emit_error); \
+        if (emit_error != NULL)                                           \
+          {                                                               \
+            g_propagate_error ((error), emit_error);                      \
+            return FALSE;                                                 \
+          }                                                               \
+      }                                                                   \
+  } G_STMT_END
+
 static gboolean
 musician_gp4_parser_load_attributes (MusicianGp4Parser       *self,
+                                     MusicianGp4Decoder      *decoder,
                                      MusicianGptInputStream  *stream,
-                                     MusicianGptSong         *song,
                                      GCancellable            *cancellable,
                                      GError                 **error)
 {
-  g_autofree gchar *album = NULL;
-  g_autofree gchar *artist = NULL;
-  g_autofree gchar *copyright = NULL;
-  g_autofree gchar *interpret = NULL;
-  g_autofree gchar *instructions = NULL;
-  g_autofree gchar *subtitle = NULL;
-  g_autofree gchar *writer = NULL;
-  g_autofree gchar *title = NULL;
-  g_auto(GStrv) comments = NULL;
-  gint32 n_comments;
+  MusicianGptHeaderEvent *header = &decoder->header;
+  const gchar *strings[8];
+  guint32 n_comments;
+  guint8 triplet_feel;
 
   g_assert (MUSICIAN_IS_GP4_PARSER (self));
   g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
-  g_assert (MUSICIAN_IS_GPT_SONG (song));
   g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
 
-  /* Read the title of the piece */
-  if (NULL == (title = musician_gpt_input_stream_read_string (stream, cancellable, error)))
-    return FALSE;
-
-  /* Read the subtitle of the piece */
-  if (NULL == (subtitle = musician_gpt_input_stream_read_string (stream, cancellable, error)))
-    return FALSE;
-
-  /* Read the interpret of the piece */
-  if (NULL == (interpret = musician_gpt_input_stream_read_string (stream, cancellable, error)))
-    return FALSE;
-
-  /* Read the album of the piece */
-  if (NULL == (album = musician_gpt_input_stream_read_string (stream, cancellable, error)))
-    return FALSE;
-
-  /* Read the artist of the piece */
-  if (NULL == (artist = musician_gpt_input_stream_read_string (stream, cancellable, error)))
-    return FALSE;
+  /* Title, subtitle, interpretation, album, artist, copyright, writer and instructions */
+  for (guint i = 0; i < G_N_ELEMENTS (strings); i++)
+    strings[i] = _musician_gpt_input_stream_pull_string (stream, cancellable);
 
-  /* Read the copyright of the piece */
-  if (NULL == (copyright = musician_gpt_input_stream_read_string (stream, cancellable, error)))
-    return FALSE;
+  /* We don't keep the comments (notice) around, just skip past them */
+  n_comments = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
+  for (guint32 i = 0; i < n_comments && !_musician_gpt_input_stream_failed (stream); i++)
+    _musician_gpt_input_stream_pull_string (stream, cancellable);
 
-  /* Read the tab_author of the piece */
-  if (NULL == (writer = musician_gpt_input_stream_read_string (stream, cancellable, error)))
-    return FALSE;
+  triplet_feel = _musician_gpt_input_stream_pull_byte (stream, cancellable);
 
-  /* Read the instructions of the piece */
-  if (NULL == (instructions = musician_gpt_input_stream_read_string (stream, cancellable, error)))
+  if (!_musician_gpt_input_stream_check (stream, cancellable, error))
     return FALSE;
 
-  comments = musician_gpt_input_stream_read_string_array (stream, cancellable, error);
+  decoder->stats.n_unsupported += n_comments;
 
-  musician_gpt_song_set_title (song, title);
-  musician_gpt_song_set_subtitle (song, subtitle);
-  musician_gpt_song_set_interpretation (song, interpret);
-  musician_gpt_song_set_album (song, album);
-  musician_gpt_song_set_artist (song, artist);
-  musician_gpt_song_set_copyright (song, copyright);
-  musician_gpt_song_set_writer (song, writer);
-  musician_gpt_song_set_instructions (song, instructions);
+  /* The header is emitted once the MIDI ports and counts are known */
+  header->title = strings[0];
+  header->subtitle = strings[1];
+  header->interpretation = strings[2];
+  header->album = strings[3];
+  header->artist = strings[4];
+  header->copyright = strings[5];
+  header->writer = strings[6];
+  header->instructions = strings[7];
+  header->triplet_feel = triplet_feel ? MUSICIAN_GPT_TRIPLET_FEEL_EIGHTH
+                                      : MUSICIAN_GPT_TRIPLET_FEEL_NONE;
 
   return TRUE;
 }
 
+/*
+ * Loads the lyrics along with the tempo, key and octave of the song that
+ * follow them.
+ */
 static gboolean
 musician_gp4_parser_load_lyrics (MusicianGp4Parser       *self,
+                                 MusicianGp4Decoder      *decoder,
                                  MusicianGptInputStream  *stream,
-                                 MusicianGptSong         *song,
                                  GCancellable            *cancellable,
                                  GError                 **error)
 {
-  guint32 track_num = 0;
+  MusicianGptHeaderEvent *header = &decoder->header;
+  const gchar *lyrics[G_N_ELEMENTS (header->lyrics)];
+  guint32 positions[G_N_ELEMENTS (header->lyrics)];
+  guint32 tempo;
+  gint32 key;
+  guint8 octave;
 
   g_assert (MUSICIAN_IS_GP4_PARSER (self));
   g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
-  g_assert (MUSICIAN_IS_GPT_SONG (song));
   g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
 
-  if (!musician_gpt_input_stream_read_uint32 (stream, cancellable, &track_num, error))
-    return FALSE;
+  /* The track the lyrics belong to */
+  _musician_gpt_input_stream_pull_skip (stream, 4, cancellable);
 
-  for (guint i = 0; i < 5; i++)
-    {
-      g_autofree gchar *lyrics = NULL;
-      guint32 position = 0;
+  for (guint i = 0; i < G_N_ELEMENTS (lyrics); i++)
+    lyrics[i] = _musician_gpt_input_stream_pull_lyric (stream, cancellable, &positions[i]);
 
-      if (NULL == (lyrics = musician_gpt_input_stream_read_lyric (stream, cancellable, &position, error)))
-        return FALSE;
+  tempo = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
+  key = _musician_gpt_input_stream_pull_int32 (stream, cancellable);
+  octave = _musician_gpt_input_stream_pull_byte (stream, cancellable);
+
+  if (!_musician_gpt_input_stream_check (stream, cancellable, error))
+    return FALSE;
 
-      _musician_gpt_song_add_lyrics (song, position, lyrics);
+  for (guint i = 0; i < G_N_ELEMENTS (lyrics); i++)
+    {
+      header->lyrics[i] = lyrics[i];
+      header->lyrics_positions[i] = positions[i];
     }
 
+  header->tempo = tempo;
+  header->key = key;
+  header->octave = octave;
+
   return TRUE;
 }
 
+/*
+ * Checks that @n_measures measures and @n_tracks tracks, as claimed by the
+ * header, could fit in what is left of @stream. Only streams over a whole
+ * file know how much is left; for others the song only grows its storage
+ * as measures and tracks are actually decoded.
+ */
+static gboolean
+musician_gp4_counts_fit (MusicianGptInputStream *stream,
+                         guint32                 n_measures,
+                         guint32                 n_tracks)
+{
+  guint64 n_remaining;
+
+  if (!_musician_gpt_input_stream_get_n_remaining (stream, &n_remaining))
+    return TRUE;
+
+  if (n_measures > n_remaining / MIN_MEASURE_HEADER_SIZE ||
+      n_tracks > n_remaining / MIN_TRACK_SIZE)
+    return FALSE;
+
+  n_remaining -= (guint64)n_measures * MIN_MEASURE_HEADER_SIZE;
+
+  if ((guint64)n_tracks * MIN_TRACK_SIZE > n_remaining)
+    return FALSE;
+
+  n_remaining -= (guint64)n_tracks * MIN_TRACK_SIZE;
+
+  return n_tracks == 0 || n_measures <= n_remaining / MIN_MEASURE_PAIR_SIZE / n_tracks;
+}
+
+/*
+ * Loads the MIDI port/channel mappings along with the number of measures
+ * and tracks that follow them, which completes the header.
+ */
 static gboolean
 musician_gp4_parser_load_midi_ports (MusicianGp4Parser       *self,
+                                     MusicianGp4Decoder      *decoder,
                                      MusicianGptInputStream  *stream,
-                                     MusicianGptSong         *song,
                                      GCancellable            *cancellable,
                                      GError                 **error)
 {
-  MusicianGptMidiPort ports[4];
+  MusicianGptHeaderEvent *header = &decoder->header;
+  MusicianGptMidiPort ports[G_N_ELEMENTS (decoder->ports)];
+  guint32 n_measures;
+  guint32 n_tracks;
 
   g_assert (MUSICIAN_IS_GP4_PARSER (self));
   g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
-  g_assert (MUSICIAN_IS_GPT_SONG (song));
   g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
 
-  for (guint i = 0; i < 4; i++)
+  for (guint i = 0; i < G_N_ELEMENTS (ports); i++)
+    _musician_gpt_input_stream_pull_midi_port (stream, i + 1, cancellable, &ports[i]);
+
+  n_measures = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
+  n_tracks = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
+
+  if (!_musician_gpt_input_stream_check (stream, cancellable, error))
+    return FALSE;
+
+  if (!musician_gp4_counts_fit (stream, n_measures, n_tracks))
     {
-      if (!musician_gpt_input_stream_read_midi_port (stream, i + 1, cancellable, &ports[i], error))
-        return FALSE;
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVALID_DATA,
+                   "%u measures and %u tracks do not fit in the file",
+                   n_measures, n_tracks);
+      return FALSE;
     }
 
-  _musician_gpt_song_set_midi_ports (song, ports, G_N_ELEMENTS (ports));
+  memcpy (decoder->ports, ports, sizeof ports);
+
+  header->ports = decoder->ports;
+  header->n_ports = G_N_ELEMENTS (decoder->ports);
+  header->n_measures = decoder->n_measures = n_measures;
+  header->n_tracks = decoder->n_tracks = n_tracks;
+
+  DECODER_EMIT (decoder, on_header, header, error);
 
   return TRUE;
 }
 
 static gboolean
-musician_gp4_parser_load_measures (MusicianGp4Parser       *self,
-                                   MusicianGptInputStream  *stream,
-                                   MusicianGptSong         *song,
-                                   guint                    n_measures,
-                                   GCancellable            *cancellable,
-                                   GError                 **error)
+musician_gp4_parser_load_measure (MusicianGp4Parser       *self,
+                                  MusicianGp4Decoder      *decoder,
+                                  MusicianGptInputStream  *stream,
+                                  GCancellable            *cancellable,
+                                  GError                 **error)
 {
+  MusicianGptMeasureHeaderEvent event = { 0 };
+
   g_assert (MUSICIAN_IS_GP4_PARSER (self));
   g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
-  g_assert (MUSICIAN_IS_GPT_SONG (song));
   g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
 
-  for (guint i = 0; i < n_measures; i++)
-    {
-      g_autoptr(MusicianGptMeasure) measure = NULL;
-      MusicianGptMeasureFlags flags;
-      guint8 header;
-      guint8 numerator = 0;
-      guint8 denominator = 0;
-      guint8 n_repeats = 0;
-      guint8 nth_ending = 0;
-      guint8 key = 0;
-
-      if (!musician_gpt_input_stream_read_byte (stream, cancellable, &header, error))
-        return FALSE;
-
-      flags = header;
-
-      measure = musician_gpt_measure_new ();
+  event.id = decoder->index + 1;
+  event.numerator = decoder->numerator;
+  event.denominator = decoder->denominator;
 
-      musician_gpt_measure_set_id (measure, i + 1);
-
-      if (flags & MUSICIAN_GPT_MEASURE_FLAGS_KEY_NUMERATOR)
-        {
-          if (!musician_gpt_input_stream_read_byte (stream, cancellable, &numerator, error))
-            return FALSE;
-          musician_gpt_measure_set_numerator (measure, numerator);
-        }
+  event.flags = _musician_gpt_input_stream_pull_byte (stream, cancellable);
 
-      if (flags & MUSICIAN_GPT_MEASURE_FLAGS_KEY_DENOMINATOR)
-        {
-          if (!musician_gpt_input_stream_read_byte (stream, cancellable, &denominator, error))
-            return FALSE;
-          musician_gpt_measure_set_denominator (measure, denominator);
-        }
+  /* The time signature carries over from the previous measure */
+  if (event.flags & MUSICIAN_GPT_MEASURE_FLAGS_KEY_NUMERATOR)
+    event.numerator = _musician_gpt_input_stream_pull_byte (stream, cancellable);
 
-      if (flags & MUSICIAN_GPT_MEASURE_FLAGS_REPEAT_END)
-        {
-          if (!musician_gpt_input_stream_read_byte (stream, cancellable, &n_repeats, error))
-            return FALSE;
-          musician_gpt_measure_set_nth_ending (measure, nth_ending);
-        }
+  if (event.flags & MUSICIAN_GPT_MEASURE_FLAGS_KEY_DENOMINATOR)
+    event.denominator = _musician_gpt_input_stream_pull_byte (stream, cancellable);
 
-      if (flags & MUSICIAN_GPT_MEASURE_FLAGS_ALTERNATE_ENDING)
-        {
-          if (!musician_gpt_input_stream_read_byte (stream, cancellable, &nth_ending, error))
-            return FALSE;
-          musician_gpt_measure_set_n_repeats (measure, n_repeats);
-        }
+  if (event.flags & MUSICIAN_GPT_MEASURE_FLAGS_REPEAT_END)
+    event.n_repeats = _musician_gpt_input_stream_pull_byte (stream, cancellable);
 
-      if (flags & MUSICIAN_GPT_MEASURE_FLAGS_MARKER)
-        {
-          g_autofree gchar *name = NULL;
-          GdkRGBA color;
+  if (event.flags & MUSICIAN_GPT_MEASURE_FLAGS_ALTERNATE_ENDING)
+    event.nth_ending = _musician_gpt_input_stream_pull_byte (stream, cancellable);
 
-          if (NULL == (name = musician_gpt_input_stream_read_string (stream, cancellable, error)))
-            return FALSE;
+  if (event.flags & MUSICIAN_GPT_MEASURE_FLAGS_MARKER)
+    {
+      event.marker_name = _musician_gpt_input_stream_pull_string (stream, cancellable);
+      _musician_gpt_input_stream_pull_color (stream, cancellable, &event.marker_color);
+    }
 
-          if (!musician_gpt_input_stream_read_color (stream, cancellable, &color, error))
-            return FALSE;
+  /* Tonality is the key followed by a major/minor byte we ignore */
+  if (event.flags & MUSICIAN_GPT_MEASURE_FLAGS_TONALITY)
+    {
+      event.key = _musician_gpt_input_stream_pull_byte (stream, cancellable);
+      _musician_gpt_input_stream_pull_skip (stream, 1, cancellable);
+    }
 
-          musician_gpt_measure_set_marker_name (measure, name);
-          musician_gpt_measure_set_marker_color (measure, &color);
-        }
+  if (!_musician_gpt_input_stream_check (stream, cancellable, error))
+    return FALSE;
 
-      if (flags & MUSICIAN_GPT_MEASURE_FLAGS_TONALITY)
-        {
-          if (!musician_gpt_input_stream_read_byte (stream, cancellable, &key, error) ||
-              !musician_gpt_input_stream_read_byte (stream, cancellable, NULL, error))
-            return FALSE;
-          musician_gpt_measure_set_key (measure, key);
-        }
+  decoder->numerator = event.numerator;
+  decoder->denominator = event.denominator;
 
-      musician_gpt_song_add_measure (song, measure);
-    }
+  DECODER_EMIT (decoder, on_measure_header, &event, error);
 
   return TRUE;
 }
 
 static gboolean
-musician_gp4_parser_load_tracks (MusicianGp4Parser       *self,
-                                 MusicianGptInputStream  *stream,
-                                 MusicianGptSong         *song,
-                                 guint                    n_tracks,
-                                 GCancellable            *cancellable,
-                                 GError                 **error)
+musician_gp4_parser_load_track (MusicianGp4Parser       *self,
+                                MusicianGp4Decoder      *decoder,
+                                MusicianGptInputStream  *stream,
+                                GCancellable            *cancellable,
+                                GError                 **error)
 {
+  MusicianGptTrackEvent event = { 0 };
+  MusicianGptTuning tunings[7];
+  guint32 n_strings;
+
   g_assert (MUSICIAN_IS_GP4_PARSER (self));
   g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
-  g_assert (MUSICIAN_IS_GPT_SONG (song));
   g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
 
-  for (guint i = 0; i < n_tracks; i++)
-    {
-      g_autofree gchar *title = NULL;
-      g_autoptr(MusicianGptTrack) track = NULL;
-      MusicianGptTrackFlags flags;
-      GdkRGBA color;
-      guint32 n_strings;
-      guint32 port;
-      guint32 channel;
-      guint32 effects_channel;
-      guint32 n_frets;
-      guint32 capo_at;
-      gint32 tunings[7];
-      guint8 header;
-
-      if (!musician_gpt_input_stream_read_byte (stream, cancellable, &header, error))
-        return FALSE;
-
-      flags = header;
+  event.id = decoder->index + 1;
+  event.flags = _musician_gpt_input_stream_pull_byte (stream, cancellable);
+  event.title = _musician_gpt_input_stream_pull_fixed_string (stream, 40, cancellable);
 
-      if (NULL == (title = musician_gpt_input_stream_read_fixed_string (stream, 40, cancellable, error)))
-        return FALSE;
+  n_strings = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
 
-      if (!musician_gpt_input_stream_read_uint32 (stream, cancellable, &n_strings, error))
-        return FALSE;
+  for (guint j = 0; j < G_N_ELEMENTS (tunings); j++)
+    tunings[j] = _musician_gpt_input_stream_pull_int32 (stream, cancellable);
 
-      for (guint j = 0; j < G_N_ELEMENTS (tunings); j++)
-        {
-          if (!musician_gpt_input_stream_read_int32 (stream, cancellable, &tunings[j], error))
-            return FALSE;
-        }
+  event.port = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
+  event.channel = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
+  event.effects_channel = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
+  event.n_frets = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
+  event.capo_at = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
+  _musician_gpt_input_stream_pull_color (stream, cancellable, &event.color);
 
-      if (!musician_gpt_input_stream_read_uint32 (stream, cancellable, &port, error) ||
-          !musician_gpt_input_stream_read_uint32 (stream, cancellable, &channel, error) ||
-          !musician_gpt_input_stream_read_uint32 (stream, cancellable, &effects_channel, error) ||
-          !musician_gpt_input_stream_read_uint32 (stream, cancellable, &n_frets, error) ||
-          !musician_gpt_input_stream_read_uint32 (stream, cancellable, &capo_at, error) ||
-          !musician_gpt_input_stream_read_color (stream, cancellable, &color, error))
-        return FALSE;
+  if (n_strings > G_N_ELEMENTS (tunings))
+    _musician_gpt_input_stream_set_error (stream,
+                                          G_IO_ERROR,
+                                          G_IO_ERROR_INVALID_DATA,
+                                          "Invalid number of strings: %u",
+                                          n_strings);
 
-      track = musician_gpt_track_new ();
+  if (!_musician_gpt_input_stream_check (stream, cancellable, error))
+    return FALSE;
 
-      musician_gpt_track_set_capo_at (track, capo_at);
-      musician_gpt_track_set_channel (track, channel);
-      musician_gpt_track_set_color (track, &color);
-      musician_gpt_track_set_effects_channel (track, effects_channel);
-      musician_gpt_track_set_id (track, i + 1);
-      musician_gpt_track_set_n_frets (track, n_frets);
-      musician_gpt_track_set_port (track, port);
-      musician_gpt_track_set_title (track, title);
-      musician_gpt_track_set_tunings (track, tunings, G_N_ELEMENTS (tunings));
+  event.tunings = tunings;
+  event.n_strings = n_strings;
 
-      musician_gpt_song_add_track (song, track);
-    }
+  DECODER_EMIT (decoder, on_track, &event, error);
 
   return TRUE;
 }
 
-static gboolean
-musician_gp4_parser_load_chord (MusicianGp4Parser       *self,
-                                MusicianGptInputStream  *stream,
-                                GCancellable            *cancellable,
-                                MusicianGptChord       **chord_out,
-                                GError                 **error)
+/*
+ * Skips a length-prefixed string without allocating it. The 32-bit length
+ * covers both the 1-byte length and the string that follow it.
+ */
+static void
+musician_gp4_parser_skip_string (MusicianGptInputStream *stream,
+                                 GCancellable           *cancellable)
 {
-  g_autofree gchar *name = NULL;
-  g_autoptr(MusicianGptChord) chord = NULL;
-  guint8 header;
-  guint8 sharp;
-  guint8 root;
-  guint8 chord_type;
-  guint8 breadth;
-  guint8 has_add;
-  guint8 fifth;
-  guint8 ninth;
-  guint8 eleventh;
-  guint8 omission1;
-  guint8 omission3;
-  guint8 omission5;
-  guint8 omission7;
-  guint8 omission9;
-  guint8 omission11;
-  guint8 omission13;
-  guint8 n_barres;
-  guint8 barre_frets[5];
-  guint8 barre_start[5];
-  guint8 barre_end[5];
-  guint8 fingering[7];
-  guint8 display;
-  gint32 lowest;
-  gint32 tonality;
-  guint32 bass_fret;
-  guint32 frets[7];
-
-  g_assert (MUSICIAN_IS_GP4_PARSER (self));
-  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
-  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
+  guint32 len;
 
-  chord = musician_gpt_chord_new ();
+  len = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
+  _musician_gpt_input_stream_pull_skip (stream, len, cancellable);
+}
 
-  if (!musician_gpt_input_stream_read_byte (stream, cancellable, &header, error))
-    return FALSE;
+/*
+ * Reads a string of a beat, or skips it while building the index of a lazy
+ * load since nothing would hold on to it. A @max_length of 0 is for strings
+ * with a 32-bit length, anything else is for fixed length strings.
+ */
+static const gchar *
+musician_gp4_parser_pull_beat_string (MusicianGp4Decoder     *decoder,
+                                      MusicianGptInputStream *stream,
+                                      guint8                  max_length,
+                                      GCancellable           *cancellable)
+{
+  guint8 len;
 
-  if (header != 1)
+  if (decoder->offsets == NULL)
     {
-      g_set_error (error,
-                   G_IO_ERROR,
-                   G_IO_ERROR_NOT_SUPPORTED,
-                   "Unsupported chord format: %d",
-                   header);
-      return FALSE;
+      if (max_length == 0)
+        return _musician_gpt_input_stream_pull_string (stream, cancellable);
+      else
+        return _musician_gpt_input_stream_pull_fixed_string (stream, max_length, cancellable);
     }
 
-  if (!musician_gpt_input_stream_read_byte (stream, cancellable, &sharp, error))
-    return FALSE;
-
-  g_print ("%d sharp or flat\n", sharp);
+  if (max_length == 0)
+    {
+      musician_gp4_parser_skip_string (stream, cancellable);
+      return NULL;
+    }
 
-  if (!g_input_stream_skip (G_INPUT_STREAM (stream), 3, cancellable, error))
-    return FALSE;
+  len = _musician_gpt_input_stream_pull_byte (stream, cancellable);
 
-  if (!musician_gpt_input_stream_read_byte (stream, cancellable, &root, error))
-    return FALSE;
+  if (len > max_length)
+    _musician_gpt_input_stream_set_error (stream,
+                                          G_IO_ERROR,
+                                          G_IO_ERROR_INVALID_DATA,
+                                          "The underlying string is larger than max_length");
+  else
+    _musician_gpt_input_stream_pull_skip (stream, max_length, cancellable);
 
-  if (!musician_gpt_input_stream_read_byte (stream, cancellable, &chord_type, error))
-    return FALSE;
+  return NULL;
+}
 
-  if (!musician_gpt_input_stream_read_byte (stream, cancellable, &breadth, error))
-    return FALSE;
+static void
+musician_gp4_parser_load_chord (MusicianGp4Parser      *self,
+                                MusicianGp4Decoder     *decoder,
+                                MusicianGptInputStream *stream,
+                                GCancellable           *cancellable,
+                                MusicianGptChordEvent  *event)
+{
+  guint8 format;
 
-  if (!musician_gpt_input_stream_read_int32 (stream, cancellable, &lowest, error))
-    return FALSE;
+  g_assert (MUSICIAN_IS_GP4_PARSER (self));
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
+  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
+  g_assert (event != NULL);
 
-  if (!musician_gpt_input_stream_read_int32 (stream, cancellable, &tonality, error))
-    return FALSE;
+  format = _musician_gpt_input_stream_pull_byte (stream, cancellable);
 
-  if (!musician_gpt_input_stream_read_byte (stream, cancellable, &has_add, error))
-    return FALSE;
+  if (format == 0)
+    {
+      /* The old (Guitar Pro 3) diagram: name, base fret, and 6 frets if set */
+      event->name = musician_gp4_parser_pull_beat_string (decoder, stream, 0, cancellable);
+      if (_musician_gpt_input_stream_pull_int32 (stream, cancellable) != 0)
+        _musician_gpt_input_stream_pull_skip (stream, 6 * 4, cancellable);
+    }
+  else
+    {
+      /*
+       * sharp, 3 bytes padding, root, chord type, extension, bass (int32),
+       * tonality (int32) and whether there is an added note.
+       */
+      _musician_gpt_input_stream_pull_skip (stream, 1 + 3 + 3 + 4 + 4 + 1, cancellable);
+
+      event->name = musician_gp4_parser_pull_beat_string (decoder, stream, 22, cancellable);
+
+      /*
+       * fifth, ninth, eleventh, base fret (int32), fret of each of the 7
+       * strings (int32), number of barres followed by 5 barre frets, starts
+       * and ends (the count only says how many are used), 7 omissions,
+       * 1 byte padding, 7 fingerings and whether to show the fingering.
+       */
+      _musician_gpt_input_stream_pull_skip (stream, 3 + 4 + (7 * 4) + 1 + (3 * 5) + 7 + 1 + 7 + 1, cancellable);
+    }
+}
 
-  if (NULL != (name = musician_gpt_input_stream_read_fixed_string (stream, 20, cancellable, error)))
-    return FALSE;
+/*
+ * The points of every bend in a beat are collected in @decoder->points
+ * until the beat is complete, so @event->points is not set here.
+ */
+static void
+musician_gp4_parser_load_bend (MusicianGp4Parser      *self,
+                               MusicianGp4Decoder     *decoder,
+                               MusicianGptInputStream *stream,
+                               GCancellable           *cancellable,
+                               MusicianGptBendEvent   *event)
+{
+  guint32 n_points;
+  guint8 type;
 
-  if (!g_input_stream_skip (G_INPUT_STREAM (stream), 2, cancellable, error))
-    return FALSE;
+  g_assert (MUSICIAN_IS_GP4_PARSER (self));
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
+  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
+  g_assert (event != NULL);
 
-  if (!musician_gpt_input_stream_read_byte (stream, cancellable, &fifth, error))
-    return FALSE;
+  type = _musician_gpt_input_stream_pull_byte (stream, cancellable);
 
-  if (!musician_gpt_input_stream_read_byte (stream, cancellable, &ninth, error))
-    return FALSE;
+  if (type > MUSICIAN_GPT_BEND_TREMELO_RELEASE_DOWN)
+    _musician_gpt_input_stream_set_error (stream,
+                                          G_IO_ERROR,
+                                          G_IO_ERROR_INVALID_DATA,
+                                          "Unknown bend type of %d",
+                                          type);
+  else
+    event->bend_type = type;
 
-  if (!musician_gpt_input_stream_read_byte (stream, cancellable, &eleventh, error))
-    return FALSE;
+  /* Bend value (int32), which is implied by the points */
+  _musician_gpt_input_stream_pull_skip (stream, 4, cancellable);
 
-  if (!musician_gpt_input_stream_read_uint32 (stream, cancellable, &bass_fret, error))
-    return FALSE;
+  n_points = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
 
-  for (guint i = 0; i < G_N_ELEMENTS (frets); i++)
+  for (guint32 i = 0; i < n_points && !_musician_gpt_input_stream_failed (stream); i++)
     {
-      if (!musician_gpt_input_stream_read_uint32 (stream, cancellable, &frets[i], error))
-        return FALSE;
-    }
+      MusicianGptBendPoint point;
 
-  if (!musician_gpt_input_stream_read_byte (stream, cancellable, &n_barres, error))
-    return FALSE;
+      point.absolute_position = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
+      point.vertical_position = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
+      point.vibrato = _musician_gpt_input_stream_pull_byte (stream, cancellable);
 
-  if (n_barres > 5)
-    {
-      g_set_error (error,
-                   G_IO_ERROR,
-                   G_IO_ERROR_INVALID_DATA,
-                   "Invalid value for number of barres: %d", n_barres);
-      return FALSE;
+      g_array_append_val (decoder->points, point);
+      event->n_points++;
     }
+}
 
-  for (guint i = 0; i < n_barres; i++)
-    {
-      if (!musician_gpt_input_stream_read_byte (stream, cancellable, &barre_frets[i], error))
-        return FALSE;
-    }
+static void
+musician_gp4_parser_load_mix_table (MusicianGp4Parser      *self,
+                                    MusicianGptInputStream *stream,
+                                    GCancellable           *cancellable)
+{
+  gint8 values[6];
+  gint32 tempo;
 
-  for (guint i = 0; i < n_barres; i++)
-    {
-      if (!musician_gpt_input_stream_read_byte (stream, cancellable, &barre_start[i], error))
-        return FALSE;
-    }
+  g_assert (MUSICIAN_IS_GP4_PARSER (self));
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
+  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
 
-  for (guint i = 0; i < n_barres; i++)
-    {
-      if (!musician_gpt_input_stream_read_byte (stream, cancellable, &barre_end[i], error))
-        return FALSE;
-    }
+  /* Instrument */
+  _musician_gpt_input_stream_pull_skip (stream, 1, cancellable);
 
-  if (!musician_gpt_input_stream_read_byte (stream, cancellable, &omission1, error) ||
-      !musician_gpt_input_stream_read_byte (stream, cancellable, &omission3, error) ||
-      !musician_gpt_input_stream_read_byte (stream, cancellable, &omission5, error) ||
-      !musician_gpt_input_stream_read_byte (stream, cancellable, &omission7, error) ||
-      !musician_gpt_input_stream_read_byte (stream, cancellable, &omission9, error) ||
-      !musician_gpt_input_stream_read_byte (stream, cancellable, &omission11, error) ||
-      !musician_gpt_input_stream_read_byte (stream, cancellable, &omission13, error))
-    return FALSE;
+  /* Volume, balance, chorus, reverb, phaser and tremolo; -1 if unchanged */
+  for (guint i = 0; i < G_N_ELEMENTS (values); i++)
+    values[i] = _musician_gpt_input_stream_pull_byte (stream, cancellable);
 
-  if (!g_input_stream_skip (G_INPUT_STREAM (stream), 1, cancellable, error))
-    return FALSE;
+  tempo = _musician_gpt_input_stream_pull_int32 (stream, cancellable);
 
-  for (guint i = 0; i < G_N_ELEMENTS (fingering); i++)
+  /* Each changed value is followed by the number of beats to reach it */
+  for (guint i = 0; i < G_N_ELEMENTS (values); i++)
     {
-      if (!musician_gpt_input_stream_read_byte (stream, cancellable, &fingering[i], error))
-        return FALSE;
+      if (values[i] >= 0)
+        _musician_gpt_input_stream_pull_skip (stream, 1, cancellable);
     }
 
-  if (!musician_gpt_input_stream_read_byte (stream, cancellable, &display, error))
-    return FALSE;
-
-  *chord_out = g_steal_pointer (&chord);
+  if (tempo >= 0)
+    _musician_gpt_input_stream_pull_skip (stream, 1, cancellable);
 
-  return TRUE;
+  /* Which of the changes apply to all tracks */
+  _musician_gpt_input_stream_pull_skip (stream, 1, cancellable);
 }
 
+/* Returns %TRUE if the note has a bend, which is stored in @bend */
 static gboolean
-musician_gp4_parser_load_bend (MusicianGp4Parser       *self,
-                               MusicianGptInputStream  *stream,
-                               GCancellable            *cancellable,
-                               MusicianGptBend        **out_bend,
-                               GError                 **error)
+musician_gp4_parser_load_note (MusicianGp4Parser      *self,
+                               MusicianGp4Decoder     *decoder,
+                               MusicianGptInputStream *stream,
+                               GCancellable           *cancellable,
+                               MusicianGptBendEvent   *bend)
 {
-  g_autoptr(MusicianGptBend) bend = NULL;
-  guint32 n_points;
-  guint8 type;
+  gboolean has_bend = FALSE;
+  guint8 flags;
 
   g_assert (MUSICIAN_IS_GP4_PARSER (self));
   g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
   g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
 
-  bend = musician_gpt_bend_new ();
+  flags = _musician_gpt_input_stream_pull_byte (stream, cancellable);
 
-  if (!musician_gpt_input_stream_read_byte (stream, cancellable, &type, error))
-    return FALSE;
+  /* Note type (normal, tie, dead) */
+  if (flags & (1 << 5))
+    _musician_gpt_input_stream_pull_skip (stream, 1, cancellable);
 
-  musician_gpt_bend_set_bend_type (bend, type);
+  /* Time independent duration and tuplet */
+  if (flags & (1 << 0))
+    _musician_gpt_input_stream_pull_skip (stream, 2, cancellable);
 
-  if (!musician_gpt_input_stream_read_uint32 (stream, cancellable, &n_points, error))
-    return FALSE;
+  /* Dynamics */
+  if (flags & (1 << 4))
+    _musician_gpt_input_stream_pull_skip (stream, 1, cancellable);
 
-  for (guint i = 0; i < n_points; i++)
-    {
-      MusicianGptBendPoint point;
-      guint32 abspos;
-      guint32 vertpos;
-      guint8 vibrato;
+  /* Fret */
+  if (flags & (1 << 5))
+    _musician_gpt_input_stream_pull_skip (stream, 1, cancellable);
 
-      if (!musician_gpt_input_stream_read_uint32 (stream, cancellable, &abspos, error))
-        return FALSE;
+  /* Left and right hand fingering */
+  if (flags & (1 << 7))
+    _musician_gpt_input_stream_pull_skip (stream, 2, cancellable);
 
-      if (!musician_gpt_input_stream_read_uint32 (stream, cancellable, &vertpos, error))
-        return FALSE;
+  if (flags & (1 << 3))
+    {
+      guint8 effects1;
+      guint8 effects2;
 
-      if (!musician_gpt_input_stream_read_byte (stream, cancellable, &vibrato, error))
-        return FALSE;
+      effects1 = _musician_gpt_input_stream_pull_byte (stream, cancellable);
+      effects2 = _musician_gpt_input_stream_pull_byte (stream, cancellable);
+
+      if (effects1 & (1 << 0))
+        {
+          musician_gp4_parser_load_bend (self, decoder, stream, cancellable, bend);
+          has_bend = TRUE;
+        }
 
-      point.absolute_position = abspos;
-      point.vertical_position = vertpos;
-      point.vibrato = vibrato;
+      /* Grace note: fret, dynamics, transition and duration */
+      if (effects1 & (1 << 4))
+        {
+          _musician_gpt_input_stream_pull_skip (stream, 4, cancellable);
+          decoder->stats.n_unsupported++;
+        }
 
-      musician_gpt_bend_add_point (bend, &point);
+      /* Tremolo picking, slide and harmonic */
+      if (effects2 & (1 << 2))
+        _musician_gpt_input_stream_pull_skip (stream, 1, cancellable);
+      if (effects2 & (1 << 3))
+        _musician_gpt_input_stream_pull_skip (stream, 1, cancellable);
+      if (effects2 & (1 << 4))
+        _musician_gpt_input_stream_pull_skip (stream, 1, cancellable);
+
+      /* Trill fret and period */
+      if (effects2 & (1 << 5))
+        _musician_gpt_input_stream_pull_skip (stream, 2, cancellable);
     }
 
-  *out_bend = g_steal_pointer (&bend);
-
-  return TRUE;
+  return has_bend;
 }
 
 static gboolean
 musician_gp4_parser_load_beat (MusicianGp4Parser       *self,
+                               MusicianGp4Decoder      *decoder,
                                MusicianGptInputStream  *stream,
-                               MusicianGptSong         *song,
-                               guint                    n_measures,
-                               guint                    n_tracks,
-                               guint                    n_beats,
                                GCancellable            *cancellable,
                                GError                 **error)
 {
-  g_autoptr(MusicianGptBeat) beat = NULL;
-  MusicianGptBeatFlags flags;
-  guint8 header;
-  guint8 duration;
+  MusicianGptBeatEvent event = { 0 };
+  MusicianGptChordEvent chord = { 0 };
+  MusicianGptBendEvent bends[8];
+  guint n_bends = 0;
+  gint8 duration;
 
   g_assert (MUSICIAN_IS_GP4_PARSER (self));
   g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
-  g_assert (MUSICIAN_IS_GPT_SONG (song));
   g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
 
-  beat = musician_gpt_beat_new ();
+  /* The measure/track pair index runs track by track within a measure */
+  event.measure = decoder->index / decoder->n_tracks + 1;
+  event.track = decoder->index % decoder->n_tracks + 1;
+  event.index = decoder->beat;
+  event.mode = MUSICIAN_GPT_BEAT_MODE_NORMAL;
 
-  if (!musician_gpt_input_stream_read_byte (stream, cancellable, &header, error))
-    return FALSE;
+  g_array_set_size (decoder->points, 0);
 
-  flags = header;
+  event.flags = _musician_gpt_input_stream_pull_byte (stream, cancellable);
 
-  if (flags & MUSICIAN_GPT_BEAT_FLAGS_STATUS)
+  if (event.flags & MUSICIAN_GPT_BEAT_FLAGS_STATUS)
     {
-      guint8 status;
+      guint8 status = _musician_gpt_input_stream_pull_byte (stream, cancellable);
+
+      if (status == 0)
+        event.mode = MUSICIAN_GPT_BEAT_MODE_EMPTY;
+      else if (status == 2)
+        event.mode = MUSICIAN_GPT_BEAT_MODE_REST;
+      else if (status != 1)
+        _musician_gpt_input_stream_set_error (stream,
+                                              G_IO_ERROR,
+                                              G_IO_ERROR_INVALID_DATA,
+                                              "Unknown beat mode of %d",
+                                              status);
+    }
 
-      if (!musician_gpt_input_stream_read_byte (stream, cancellable, &status, error))
-        return FALSE;
+  /*
+   * The duration is stored as -2 (whole note) through 4 (sixty-fourth note),
+   * we keep the note value instead (1, 2, 4, ... 64).
+   */
+  duration = _musician_gpt_input_stream_pull_byte (stream, cancellable);
+
+  if (duration < -2 || duration > 4)
+    _musician_gpt_input_stream_set_error (stream,
+                                          G_IO_ERROR,
+                                          G_IO_ERROR_INVALID_DATA,
+                                          "Invalid beat duration of %d",
+                                          duration);
+  else
+    event.duration = 1 << (duration + 2);
 
-      if (status == 2)
-        musician_gpt_beat_set_mode (beat, MUSICIAN_GPT_BEAT_MODE_REST);
-      else if (status == 0)
-        musician_gpt_beat_set_mode (beat, MUSICIAN_GPT_BEAT_MODE_EMPTY);
-      else
+  if (event.flags & MUSICIAN_GPT_BEAT_FLAGS_N_TUPLET)
+    {
+      guint32 n_tuplet = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
+
+      switch (n_tuplet)
         {
-          g_set_error (error,
-                       G_IO_ERROR,
-                       G_IO_ERROR_INVALID_DATA,
-                       "Unknown beat mode of %d",
-                       status);
-          return FALSE;
+        case 3: case 5: case 6: case 7: case 9: case 10: case 11: case 12: case 13:
+          event.n_tuplet = n_tuplet;
+          break;
+
+        default:
+          _musician_gpt_input_stream_set_error (stream,
+                                                G_IO_ERROR,
+                                                G_IO_ERROR_INVALID_DATA,
+                                                "Invalid n_tuplet value of %u",
+                                                n_tuplet);
+          break;
         }
     }
 
-  if (!musician_gpt_input_stream_read_byte (stream, cancellable, &duration, error))
-    return FALSE;
+  if (event.flags & MUSICIAN_GPT_BEAT_FLAGS_CHORD_DIAGRAM)
+    musician_gp4_parser_load_chord (self, decoder, stream, cancellable, &chord);
 
-  musician_gpt_beat_set_duration (beat, duration);
+  if (event.flags & MUSICIAN_GPT_BEAT_FLAGS_TEXT)
+    event.text = musician_gp4_parser_pull_beat_string (decoder, stream, 0, cancellable);
 
-  if (flags & MUSICIAN_GPT_BEAT_FLAGS_N_TUPLET)
+  if (event.flags & MUSICIAN_GPT_BEAT_FLAGS_EFFECTS)
     {
-      guint32 n_tuplet;
+      guint8 effects1;
+      guint8 effects2;
 
-      if (!musician_gpt_input_stream_read_uint32 (stream, cancellable, &n_tuplet, error))
-        return FALSE;
+      effects1 = _musician_gpt_input_stream_pull_byte (stream, cancellable);
+      effects2 = _musician_gpt_input_stream_pull_byte (stream, cancellable);
 
-      musician_gpt_beat_set_n_tuplet (beat, n_tuplet);
-    }
+      if (effects1 & (1 << 5))
+        {
+          guint8 dynamics = _musician_gpt_input_stream_pull_byte (stream, cancellable);
+
+          if (dynamics > MUSICIAN_GPT_DYNAMICS_POPPING)
+            _musician_gpt_input_stream_set_error (stream,
+                                                  G_IO_ERROR,
+                                                  G_IO_ERROR_INVALID_DATA,
+                                                  "Unknown beat dynamics of %d",
+                                                  dynamics);
+          else
+            event.dynamics = dynamics;
+        }
 
-  if (flags & MUSICIAN_GPT_BEAT_FLAGS_CHORD_DIAGRAM)
-    {
-      g_autoptr(MusicianGptChord) chord = NULL;
+      /* Tremolo bar, which we report as string 0 */
+      if (effects2 & (1 << 2))
+        {
+          bends[n_bends] = (MusicianGptBendEvent) { 0 };
+          musician_gp4_parser_load_bend (self, decoder, stream, cancellable, &bends[n_bends]);
+          n_bends++;
+        }
 
-      if (!musician_gp4_parser_load_chord (self, stream, cancellable, &chord, error))
-        return FALSE;
+      /* Upstroke and downstroke durations */
+      if (effects1 & (1 << 6))
+        _musician_gpt_input_stream_pull_skip (stream, 2, cancellable);
 
-      musician_gpt_beat_set_chord (beat, chord);
+      /* Pick stroke */
+      if (effects2 & (1 << 1))
+        _musician_gpt_input_stream_pull_skip (stream, 1, cancellable);
     }
 
-  if (flags & MUSICIAN_GPT_BEAT_FLAGS_TEXT)
-    {
-      g_autofree gchar *text = NULL;
+  if (event.flags & MUSICIAN_GPT_BEAT_FLAGS_MIX_TABLE)
+    musician_gp4_parser_load_mix_table (self, stream, cancellable);
 
-      if (NULL == (text = musician_gpt_input_stream_read_string (stream, cancellable, error)))
-        return FALSE;
+  /* One bit per string, from the highest bit (string 1) down */
+  event.strings_played = _musician_gpt_input_stream_pull_byte (stream, cancellable);
 
-      musician_gpt_beat_set_text (beat, text);
+  for (guint i = 0; i < 7; i++)
+    {
+      if (event.strings_played & (1 << (6 - i)))
+        {
+          bends[n_bends] = (MusicianGptBendEvent) { 0 };
+          bends[n_bends].string = i + 1;
+          if (musician_gp4_parser_load_note (self, decoder, stream, cancellable, &bends[n_bends]))
+            n_bends++;
+        }
     }
 
-  if (flags & MUSICIAN_GPT_BEAT_FLAGS_EFFECTS)
-    {
-      guint8 effects1;
-      guint8 effects2;
+  if (!_musician_gpt_input_stream_check (stream, cancellable, error))
+    return FALSE;
 
-      if (!musician_gpt_input_stream_read_byte (stream, cancellable, &effects1, error) ||
-          !musician_gpt_input_stream_read_byte (stream, cancellable, &effects2, error))
-        return FALSE;
+  decoder->stats.n_beats++;
+  decoder->stats.n_bends += n_bends;
 
-      if (effects1 & (1 << 5))
-        {
-          guint8 dynamics;
+  if (event.flags & MUSICIAN_GPT_BEAT_FLAGS_CHORD_DIAGRAM)
+    decoder->stats.n_chords++;
 
-          if (!musician_gpt_input_stream_read_byte (stream, cancellable, &dynamics, error))
-            return FALSE;
+  if (event.flags & MUSICIAN_GPT_BEAT_FLAGS_MIX_TABLE)
+    decoder->stats.n_unsupported++;
 
-          musician_gpt_beat_set_dynamics (beat, dynamics);
-        }
+  /* The beats are decoded again when they are requested */
+  if (decoder->offsets != NULL)
+    return TRUE;
 
-      if (effects2 & (1 << 2))
-        {
-          g_autoptr(MusicianGptBend) bend = NULL;
+  DECODER_EMIT (decoder, on_beat, &event, error);
 
-          if (!musician_gp4_parser_load_bend (self, stream, cancellable, &bend, error))
-            return FALSE;
-        }
+  if (event.flags & MUSICIAN_GPT_BEAT_FLAGS_CHORD_DIAGRAM)
+    {
+      chord.measure = event.measure;
+      chord.track = event.track;
+      chord.beat = event.index;
+
+      DECODER_EMIT (decoder, on_chord, &chord, error);
     }
 
-  if (flags & MUSICIAN_GPT_BEAT_FLAGS_MIX_TABLE)
+  for (guint i = 0, offset = 0; i < n_bends; i++)
     {
+      bends[i].measure = event.measure;
+      bends[i].track = event.track;
+      bends[i].beat = event.index;
+      bends[i].points = &g_array_index (decoder->points, MusicianGptBendPoint, offset);
+
+      offset += bends[i].n_points;
+
+      DECODER_EMIT (decoder, on_bend, &bends[i], error);
     }
 
   return TRUE;
 }
 
+/*
+ * Each measure/track pair is the number of beats followed by the beats, and
+ * we decode one of those per step.
+ */
 static gboolean
-musician_gp4_parser_load_measure_pairs (MusicianGp4Parser       *self,
-                                        MusicianGptInputStream  *stream,
-                                        MusicianGptSong         *song,
-                                        guint                    n_measures,
-                                        guint                    n_tracks,
-                                        GCancellable            *cancellable,
-                                        GError                 **error)
+musician_gp4_parser_load_measure_pair (MusicianGp4Parser       *self,
+                                       MusicianGp4Decoder      *decoder,
+                                       MusicianGptInputStream  *stream,
+                                       GCancellable            *cancellable,
+                                       GError                 **error)
 {
   g_assert (MUSICIAN_IS_GP4_PARSER (self));
   g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
-  g_assert (MUSICIAN_IS_GPT_SONG (song));
   g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
 
-  for (guint measure = 0; measure < n_measures; measure++)
+  if (!decoder->have_n_beats)
+    {
+      guint32 offset = 0;
+      guint32 n_beats;
+
+      if (decoder->offsets != NULL)
+        offset = _musician_gpt_input_stream_tell (stream);
+
+      n_beats = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
+
+      if (!_musician_gpt_input_stream_check (stream, cancellable, error))
+        return FALSE;
+
+      decoder->n_beats = n_beats;
+
+      if (decoder->offsets != NULL)
+        g_array_append_val (decoder->offsets, offset);
+
+      decoder->have_n_beats = TRUE;
+      decoder->beat = 0;
+    }
+  else
+    {
+      if (!musician_gp4_parser_load_beat (self, decoder, stream, cancellable, error))
+        return FALSE;
+
+      decoder->beat++;
+    }
+
+  if (decoder->beat == decoder->n_beats)
+    {
+      decoder->have_n_beats = FALSE;
+      decoder->index++;
+    }
+
+  return TRUE;
+}
+
+/*
+ * When loading a song, the song is just another consumer of the events.
+ * The user data for these is the decoder.
+ */
+
+static void
+musician_gp4_decoder_song_header (const MusicianGptHeaderEvent  *event,
+                                  gpointer                       user_data,
+                                  GError                       **error)
+{
+  MusicianGp4Decoder *decoder = user_data;
+  MusicianGptSong *song = decoder->song;
+  MusicianGptSongInfo info;
+
+  info.title = event->title;
+  info.subtitle = event->subtitle;
+  info.interpretation = event->interpretation;
+  info.album = event->album;
+  info.artist = event->artist;
+  info.copyright = event->copyright;
+  info.writer = event->writer;
+  info.instructions = event->instructions;
+  info.triplet_feel = event->triplet_feel;
+  info.tempo = event->tempo;
+  info.key = event->key;
+  info.octave = event->octave;
+
+  /* Nobody can see the song yet, so there is no one to notify */
+  _musician_gpt_song_set_info (song, &info);
+
+  for (guint i = 0; i < G_N_ELEMENTS (event->lyrics); i++)
+    _musician_gpt_song_add_lyrics (song, event->lyrics_positions[i], event->lyrics[i]);
+
+  _musician_gpt_song_set_midi_ports (song, event->ports, event->n_ports);
+
+  /*
+   * The beats are stored once every track has been decoded, so that the
+   * counts of a broken header never get to allocate anything.
+   */
+  if (event->n_tracks == 0)
+    _musician_gpt_song_set_block_layout (song, event->n_measures, 0);
+}
+
+static void
+musician_gp4_decoder_song_measure_header (const MusicianGptMeasureHeaderEvent  *event,
+                                          gpointer                              user_data,
+                                          GError                              **error)
+{
+  MusicianGp4Decoder *decoder = user_data;
+  g_autoptr(MusicianGptMeasure) measure = NULL;
+  MusicianGptMeasureInfo info = { 0 };
+
+  info.id = event->id;
+  info.numerator = event->numerator;
+  info.denominator = event->denominator;
+  info.key = MUSICIAN_GPT_KEY_C;
+
+  if (event->flags & MUSICIAN_GPT_MEASURE_FLAGS_REPEAT_END)
+    info.n_repeats = event->n_repeats;
+
+  if (event->flags & MUSICIAN_GPT_MEASURE_FLAGS_ALTERNATE_ENDING)
+    info.nth_ending = event->nth_ending;
+
+  if (event->flags & MUSICIAN_GPT_MEASURE_FLAGS_MARKER)
     {
-      for (guint track = 0; track < n_tracks; track++)
+      info.marker_name = event->marker_name;
+      info.marker_color = event->marker_color;
+    }
+
+  if (event->flags & MUSICIAN_GPT_MEASURE_FLAGS_TONALITY)
+    info.key = event->key;
+
+  measure = _musician_gpt_measure_new_from_info (&info, decoder->arena);
+
+  musician_gpt_song_add_measure (decoder->song, measure);
+}
+
+static void
+musician_gp4_decoder_song_track (const MusicianGptTrackEvent  *event,
+                                 gpointer                      user_data,
+                                 GError                      **error)
+{
+  MusicianGp4Decoder *decoder = user_data;
+  g_autoptr(MusicianGptTrack) track = NULL;
+  MusicianGptTrackInfo info;
+
+  info.id = event->id;
+  info.title = event->title;
+  info.tunings = event->tunings;
+  info.n_tunings = event->n_strings;
+  info.port = event->port;
+  info.channel = event->channel;
+  info.effects_channel = event->effects_channel;
+  info.n_frets = event->n_frets;
+  info.capo_at = event->capo_at;
+  info.color = event->color;
+
+  track = _musician_gpt_track_new_from_info (&info, decoder->arena);
+
+  musician_gpt_song_add_track (decoder->song, track);
+
+  if (event->id == decoder->n_tracks)
+    _musician_gpt_song_set_block_layout (decoder->song, decoder->n_measures, decoder->n_tracks);
+}
+
+static void
+musician_gp4_add_bend (MusicianGptBeatStore       *store,
+                       const MusicianGptBendEvent *event)
+{
+  g_autoptr(MusicianGptBend) bend = NULL;
+
+  g_assert (store != NULL);
+  g_assert (event != NULL);
+
+  bend = musician_gpt_intern_table_get_bend (_musician_gpt_beat_store_get_intern_table (store),
+                                             event->bend_type,
+                                             event->points,
+                                             event->n_points);
+  _musician_gpt_beat_store_add_bend (store, event->string, bend);
+}
+
+/* Chords are emitted right after the beat they belong to */
+static void
+musician_gp4_set_chord (MusicianGptBeatStore        *store,
+                        const MusicianGptChordEvent *event)
+{
+  g_autoptr(MusicianGptChord) chord = NULL;
+
+  g_assert (store != NULL);
+  g_assert (event != NULL);
+
+  chord = musician_gpt_intern_table_get_chord (_musician_gpt_beat_store_get_intern_table (store), event->name);
+  _musician_gpt_beat_store_set_chord (store, chord);
+}
+
+static void
+musician_gp4_decoder_song_beat (const MusicianGptBeatEvent  *event,
+                                gpointer                     user_data,
+                                GError                     **error)
+{
+  MusicianGp4Decoder *decoder = user_data;
+  MusicianGptBeatStore *store;
+
+  store = _musician_gpt_song_get_store (decoder->song, event->track);
+
+  if (event->index == 0)
+    _musician_gpt_beat_store_begin_measure (store, event->measure);
+
+  _musician_gpt_beat_store_append (store, event);
+}
+
+static void
+musician_gp4_decoder_song_bend (const MusicianGptBendEvent  *event,
+                                gpointer                     user_data,
+                                GError                     **error)
+{
+  MusicianGp4Decoder *decoder = user_data;
+
+  musician_gp4_add_bend (_musician_gpt_song_get_store (decoder->song, event->track), event);
+}
+
+static void
+musician_gp4_decoder_song_chord (const MusicianGptChordEvent  *event,
+                                 gpointer                      user_data,
+                                 GError                      **error)
+{
+  MusicianGp4Decoder *decoder = user_data;
+
+  musician_gp4_set_chord (_musician_gpt_song_get_store (decoder->song, event->track), event);
+}
+
+static const MusicianGptEvents song_events = {
+  musician_gp4_decoder_song_header,
+  musician_gp4_decoder_song_measure_header,
+  musician_gp4_decoder_song_track,
+  musician_gp4_decoder_song_beat,
+  musician_gp4_decoder_song_bend,
+  musician_gp4_decoder_song_chord,
+};
+
+/*
+ * When decoding a single measure/track pair, the user data for these is
+ * the #MusicianGptBeatStore being filled in, which has already begun the
+ * measure.
+ */
+
+static void
+musician_gp4_block_beat (const MusicianGptBeatEvent  *event,
+                         gpointer                     user_data,
+                         GError                     **error)
+{
+  _musician_gpt_beat_store_append (user_data, event);
+}
+
+static void
+musician_gp4_block_bend (const MusicianGptBendEvent  *event,
+                         gpointer                     user_data,
+                         GError                     **error)
+{
+  musician_gp4_add_bend (user_data, event);
+}
+
+static void
+musician_gp4_block_chord (const MusicianGptChordEvent  *event,
+                          gpointer                      user_data,
+                          GError                      **error)
+{
+  musician_gp4_set_chord (user_data, event);
+}
+
+static const MusicianGptEvents block_events = {
+  NULL,
+  NULL,
+  NULL,
+  musician_gp4_block_beat,
+  musician_gp4_block_bend,
+  musician_gp4_block_chord,
+};
+
+static void
+musician_gp4_block_index_free (gpointer data)
+{
+  MusicianGp4BlockIndex *index = data;
+
+  g_clear_object (&index->parser);
+  g_clear_pointer (&index->bytes, g_bytes_unref);
+  g_clear_pointer (&index->offsets, g_array_unref);
+  g_slice_free (MusicianGp4BlockIndex, index);
+}
+
+/*
+ * Decodes the beats of measure/track @pair with @stream, which must have
+ * been created for the bytes of @index, and appends them to @store.
+ */
+static gboolean
+musician_gp4_block_index_decode (MusicianGp4BlockIndex   *index,
+                                 MusicianGptInputStream  *stream,
+                                 guint                    pair,
+                                 MusicianGptBeatStore    *store,
+                                 GCancellable            *cancellable,
+                                 GError                 **error)
+{
+  MusicianGp4Decoder decoder;
+  gboolean ret = TRUE;
+
+  g_assert (index != NULL);
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
+  g_assert (pair < index->offsets->len);
+  g_assert (store != NULL);
+
+  _musician_gpt_input_stream_seek (stream, g_array_index (index->offsets, guint32, pair));
+
+  _musician_gp4_decoder_init (&decoder, NULL, _musician_gpt_input_stream_get_arena (stream), &block_events, store);
+
+  decoder.section = MUSICIAN_GP4_SECTION_MEASURE_PAIRS;
+  decoder.n_measures = index->n_measures;
+  decoder.n_tracks = index->n_tracks;
+  decoder.index = pair;
+
+  /* Our callers mark the blocks, rather than a section per block */
+  decoder.trace = FALSE;
+
+  while (ret && decoder.index == pair)
+    ret = _musician_gp4_parser_step (index->parser, &decoder, stream, cancellable, error);
+
+  _musician_gp4_decoder_clear (&decoder);
+
+  return ret;
+}
+
+static gboolean
+musician_gp4_block_index_load (guint                  measure,
+                               guint                  track,
+                               MusicianGptBeatStore  *store,
+                               gpointer               user_data,
+                               GCancellable          *cancellable,
+                               GError               **error)
+{
+  MusicianGp4BlockIndex *index = user_data;
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+  guint pair = (measure - 1) * index->n_tracks + (track - 1);
+  gint64 begin = 0;
+  gboolean ret;
+
+  g_assert (index != NULL);
+  g_assert (measure > 0 && measure <= index->n_measures);
+  g_assert (track > 0 && track <= index->n_tracks);
+
+  if (_musician_gpt_trace_is_enabled ())
+    begin = _musician_gpt_trace_get_time ();
+
+  stream = musician_gpt_input_stream_new_for_bytes (index->bytes);
+
+  ret = musician_gp4_block_index_decode (index, stream, pair, store, cancellable, error);
+
+  if (_musician_gpt_trace_is_enabled ())
+    _musician_gpt_trace_mark (begin,
+                              "gp4:block",
+                              "measure %u, track %u, bytes %u-%"G_GSIZE_FORMAT,
+                              measure,
+                              track,
+                              g_array_index (index->offsets, guint32, pair),
+                              _musician_gpt_input_stream_tell (stream));
+
+  return ret;
+}
+
+/* The number of beats of measure/track @pair, as found when indexing */
+static guint32
+musician_gp4_block_index_get_n_beats (MusicianGp4BlockIndex *index,
+                                      guint                  pair)
+{
+  const guint8 *data = g_bytes_get_data (index->bytes, NULL);
+  guint32 n_beats;
+
+  g_assert (pair < index->offsets->len);
+
+  memcpy (&n_beats, data + g_array_index (index->offsets, guint32, pair), sizeof n_beats);
+
+  return GUINT32_FROM_LE (n_beats);
+}
+
+/*
+ * Each track is split into blocks of this many measures, which are handed
+ * out to the workers one at a time. That keeps the shared counter out of
+ * the way without leaving anyone idle for long.
+ */
+#define PARALLEL_BATCH_SIZE 32
+
+/*
+ * Shared by the caller and the items it pushed to the decode pool. Items
+ * can sit in the pool queue behind other loads for longer than the caller
+ * waits, so this is reference counted and only @mutex, @closed and
+ * @n_running may be touched once @closed is set.
+ */
+typedef struct
+{
+  volatile gint           ref_count;
+
+  MusicianGp4BlockIndex  *index;
+  MusicianGptSong        *song;
+  MusicianGptInputStream *stream;
+  GCancellable           *cancellable;
+
+  /*
+   * One slice of a track store per unit of work. Unit u covers track
+   * u % n_tracks + 1 from measure (u / n_tracks) * PARALLEL_BATCH_SIZE + 1,
+   * so committing them in order keeps each track in measure order.
+   */
+  MusicianGptBeatStore  **slices;
+  guint                   n_units;
+
+  /* The next unit to be decoded, and whether anyone has failed */
+  volatile gint           next;
+  volatile gint           failed;
+
+  GMutex                  mutex;
+  GCond                   cond;
+
+  /* Set once the caller has run out of units to decode itself */
+  gboolean                closed;
+  guint                   n_running;
+  GError                 *error;
+} ParallelDecode;
+
+static void
+musician_gp4_parallel_decode_unref (ParallelDecode *state)
+{
+  if (g_atomic_int_dec_and_test (&state->ref_count))
+    {
+      g_assert (state->n_running == 0);
+      g_assert (state->error == NULL);
+
+      g_mutex_clear (&state->mutex);
+      g_cond_clear (&state->cond);
+      g_slice_free (ParallelDecode, state);
+    }
+}
+
+static void
+musician_gp4_parallel_decode_run (ParallelDecode *state)
+{
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+  guint n_tracks = state->index->n_tracks;
+  guint n_measures = state->index->n_measures;
+
+  /*
+   * Each worker gets its own cursor and arena over the shared bytes, but
+   * allocates from the budget of the stream being loaded. That stream is
+   * only touched under @mutex, as others may be folding theirs into it.
+   */
+  g_mutex_lock (&state->mutex);
+  stream = _musician_gpt_input_stream_new_sibling (state->stream);
+  g_mutex_unlock (&state->mutex);
+
+  while (!g_atomic_int_get (&state->failed))
+    {
+      guint unit = g_atomic_int_add (&state->next, 1);
+      MusicianGptBeatStore *store;
+      MusicianGptBeatStore *slice;
+      guint first;
+      guint last;
+      guint track;
+
+      if (unit >= state->n_units)
+        break;
+
+      track = unit % n_tracks;
+      first = (unit / n_tracks) * PARALLEL_BATCH_SIZE;
+      last = MIN (first + PARALLEL_BATCH_SIZE, n_measures);
+
+      /* The beats go straight into the range reserved for them */
+      store = _musician_gpt_song_get_store (state->song, track + 1);
+      slice = state->slices[unit] = _musician_gpt_beat_store_new_slice (store, first + 1, last - first);
+
+      for (guint measure = first; measure < last; measure++)
         {
-          guint32 n_beats;
+          guint pair = measure * n_tracks + track;
+          GError *error = NULL;
 
-          if (!musician_gpt_input_stream_read_uint32 (stream, cancellable, &n_beats, error))
-            return FALSE;
+          _musician_gpt_beat_store_begin_measure (slice, measure - first + 1);
 
-          if (!musician_gp4_parser_load_beat (self, stream, song, measure + 1, track + 1, n_beats, cancellable, error))
-            return FALSE;
+          if (!musician_gp4_block_index_decode (state->index, stream, pair, slice, state->cancellable, &error))
+            {
+              g_mutex_lock (&state->mutex);
+              if (state->error == NULL)
+                state->error = error;
+              else
+                g_error_free (error);
+              g_mutex_unlock (&state->mutex);
+
+              g_atomic_int_set (&state->failed, TRUE);
+
+              goto done;
+            }
+
+          /* Beat stores copy the strings they keep */
+          _musician_gpt_input_stream_reset_arena (stream);
         }
     }
 
+done:
+  g_mutex_lock (&state->mutex);
+  _musician_gpt_input_stream_absorb (state->stream, stream);
+  g_mutex_unlock (&state->mutex);
+}
+
+static void
+musician_gp4_parallel_decode_worker (gpointer data,
+                                     gpointer user_data)
+{
+  ParallelDecode *state = data;
+  gboolean closed;
+
+  /*
+   * If the caller already got through every unit while we were queued,
+   * it is not waiting for us and @state is only kept alive for our sake.
+   */
+  g_mutex_lock (&state->mutex);
+  if (!(closed = state->closed))
+    state->n_running++;
+  g_mutex_unlock (&state->mutex);
+
+  if (!closed)
+    {
+      musician_gp4_parallel_decode_run (state);
+
+      g_mutex_lock (&state->mutex);
+      if (--state->n_running == 0)
+        g_cond_signal (&state->cond);
+      g_mutex_unlock (&state->mutex);
+    }
+
+  musician_gp4_parallel_decode_unref (state);
+}
+
+static GThreadPool *
+get_decode_pool (void)
+{
+  static GThreadPool *pool;
+
+  if (g_once_init_enter (&pool))
+    {
+      GThreadPool *instance;
+
+      instance = g_thread_pool_new (musician_gp4_parallel_decode_worker,
+                                    NULL,
+                                    g_get_num_processors (),
+                                    FALSE,
+                                    NULL);
+
+      g_once_init_leave (&pool, instance);
+    }
+
+  return pool;
+}
+
+/*
+ * Decodes every measure/track pair of @index, which was built from
+ * @stream, on the decode pool. Each track store of @song is laid out up
+ * front from the beat counts in the index, and the workers decode into
+ * disjoint slices of it, so the result does not depend on how the work
+ * was split up.
+ */
+static gboolean
+musician_gp4_parallel_decode (MusicianGp4BlockIndex   *index,
+                              MusicianGptSong         *song,
+                              MusicianGptInputStream  *stream,
+                              GCancellable            *cancellable,
+                              GError                 **error)
+{
+  GThreadPool *pool = get_decode_pool ();
+  ParallelDecode *state;
+  guint32 *n_beats;
+  guint n_blocks;
+  guint n_workers;
+  gint64 begin = 0;
+  gboolean ret = TRUE;
+
+  g_assert (index != NULL);
+  g_assert (MUSICIAN_IS_GPT_SONG (song));
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
+
+  if (_musician_gpt_trace_is_enabled ())
+    begin = _musician_gpt_trace_get_time ();
+
+  n_beats = g_new (guint32, index->n_measures);
+
+  for (guint track = 0; track < index->n_tracks; track++)
+    {
+      for (guint measure = 0; measure < index->n_measures; measure++)
+        n_beats[measure] = musician_gp4_block_index_get_n_beats (index, measure * index->n_tracks + track);
+
+      _musician_gpt_beat_store_reserve (_musician_gpt_song_get_store (song, track + 1), n_beats);
+    }
+
+  g_free (n_beats);
+
+  /*
+   * Each pair takes at least 4 bytes of a file no larger than 4 GiB, so
+   * the shared counter cannot overflow even as workers run past the end.
+   */
+  n_blocks = (index->n_measures + PARALLEL_BATCH_SIZE - 1) / PARALLEL_BATCH_SIZE;
+  g_assert ((guint64)n_blocks * index->n_tracks <= G_MAXINT / 2);
+
+  state = g_slice_new0 (ParallelDecode);
+  state->ref_count = 1;
+  state->index = index;
+  state->song = song;
+  state->stream = stream;
+  state->cancellable = cancellable;
+  state->n_units = n_blocks * index->n_tracks;
+  state->slices = g_new0 (MusicianGptBeatStore *, state->n_units);
+  g_mutex_init (&state->mutex);
+  g_cond_init (&state->cond);
+
+  /*
+   * The calling thread decodes too, so this makes progress even when the
+   * pool is busy with other loads. No point in waking more workers than
+   * there are units.
+   */
+  n_workers = MIN ((guint)g_thread_pool_get_max_threads (pool), state->n_units);
+  if (n_workers > 0)
+    n_workers--;
+
+  for (guint i = 0; i < n_workers; i++)
+    {
+      g_atomic_int_inc (&state->ref_count);
+      g_thread_pool_push (pool, state, NULL);
+    }
+
+  musician_gp4_parallel_decode_run (state);
+
+  /*
+   * Every unit has been handed out by now. Only wait for the workers that
+   * are decoding one, not for items still queued behind other loads.
+   */
+  g_mutex_lock (&state->mutex);
+  state->closed = TRUE;
+  while (state->n_running > 0)
+    g_cond_wait (&state->cond, &state->mutex);
+  g_mutex_unlock (&state->mutex);
+
+  if (state->error != NULL)
+    {
+      g_propagate_error (error, g_steal_pointer (&state->error));
+      ret = FALSE;
+    }
+
+  for (guint unit = 0; unit < state->n_units; unit++)
+    {
+      g_autoptr(MusicianGptBeatStore) slice = g_steal_pointer (&state->slices[unit]);
+
+      if (ret && slice != NULL)
+        _musician_gpt_beat_store_commit_slice (_musician_gpt_song_get_store (song, unit % index->n_tracks + 1), slice);
+    }
+
+  if (_musician_gpt_trace_is_enabled ())
+    _musician_gpt_trace_mark (begin,
+                              "gp4:parallel-decode",
+                              "%u measure/track pairs in %u blocks, %u workers and the caller",
+                              index->offsets->len,
+                              state->n_units,
+                              n_workers);
+
+  g_clear_pointer (&state->slices, g_free);
+  state->index = NULL;
+  state->song = NULL;
+  state->stream = NULL;
+  state->cancellable = NULL;
+
+  musician_gp4_parallel_decode_unref (state);
+
+  return ret;
+}
+
+static const gchar *section_names[] = {
+  "gp4:attributes",
+  "gp4:lyrics",
+  "gp4:midi-ports",
+  "gp4:measures",
+  "gp4:tracks",
+  "gp4:measure-pairs",
+};
+
+G_STATIC_ASSERT (G_N_ELEMENTS (section_names) == MUSICIAN_GP4_SECTION_DONE);
+
+/*
+ * Charges the time since the previous section ended to @section, which the
+ * decoder has just moved past, and marks it when tracing. Waiting for more
+ * data in a push parser is charged to the section that was waiting.
+ */
+static void
+musician_gp4_decoder_end_section (MusicianGp4Decoder     *decoder,
+                                  MusicianGp4Section      section,
+                                  MusicianGptInputStream *stream)
+{
+  gint64 now = g_get_monotonic_time ();
+  gsize offset;
+
+  decoder->section_usec[section] += now - decoder->section_begin;
+  decoder->section_begin = now;
+
+  if (G_LIKELY (!decoder->trace))
+    return;
+
+  offset = _musician_gpt_input_stream_get_offset (stream);
+
+  _musician_gpt_trace_mark (decoder->trace_begin,
+                            section_names[section],
+                            "bytes %"G_GSIZE_FORMAT"-%"G_GSIZE_FORMAT", %"G_GUINT64_FORMAT" records, %u measures, %u tracks",
+                            decoder->trace_offset,
+                            offset,
+                            decoder->trace_n_records,
+                            decoder->n_measures,
+                            decoder->n_tracks);
+
+  decoder->trace_begin = _musician_gpt_trace_get_time ();
+  decoder->trace_offset = offset;
+  decoder->trace_n_records = 0;
+}
+
+/*
+ * Prepares @decoder to call @events for every record, starting right after
+ * @version. Strings are allocated from @arena.
+ *
+ * If @events is %NULL, the records build a #MusicianGptSong instead, which
+ * shares @arena and is found in @decoder->song once decoding is complete.
+ */
+void
+_musician_gp4_decoder_init (MusicianGp4Decoder      *decoder,
+                            const gchar             *version,
+                            MusicianGptArena        *arena,
+                            const MusicianGptEvents *events,
+                            gpointer                 user_data)
+{
+  g_return_if_fail (decoder != NULL);
+  g_return_if_fail (arena != NULL);
+
+  memset (decoder, 0, sizeof *decoder);
+
+  decoder->section = MUSICIAN_GP4_SECTION_ATTRIBUTES;
+  decoder->arena = musician_gpt_arena_ref (arena);
+  decoder->points = g_array_new (FALSE, FALSE, sizeof (MusicianGptBendPoint));
+  decoder->numerator = 4;
+  decoder->denominator = 4;
+  decoder->header.version = version;
+  decoder->section_begin = g_get_monotonic_time ();
+  decoder->trace = _musician_gpt_trace_is_enabled ();
+
+  if (events != NULL)
+    {
+      decoder->events = events;
+      decoder->user_data = user_data;
+    }
+  else
+    {
+      decoder->events = &song_events;
+      decoder->user_data = decoder;
+
+      /* Let the song (and everything in it) share the strings we decode */
+      decoder->song = musician_gpt_song_new ();
+      _musician_gpt_song_set_arena (decoder->song, arena);
+      _musician_gpt_song_set_version (decoder->song, version);
+    }
+}
+
+void
+_musician_gp4_decoder_clear (MusicianGp4Decoder *decoder)
+{
+  g_return_if_fail (decoder != NULL);
+
+  g_clear_object (&decoder->song);
+  g_clear_pointer (&decoder->points, g_array_unref);
+  g_clear_pointer (&decoder->offsets, g_array_unref);
+  g_clear_pointer (&decoder->arena, musician_gpt_arena_unref);
+}
+
+/*
+ * Decodes the next record of the file and hands it to the events of
+ * @decoder, moving on to the next section once the current one is complete.
+ *
+ * A record is either emitted in full or not at all, so when this fails
+ * because @stream ran out of data, the caller may rewind to where the record
+ * started and try again once there is more.
+ */
+gboolean
+_musician_gp4_parser_step (MusicianGp4Parser       *self,
+                           MusicianGp4Decoder      *decoder,
+                           MusicianGptInputStream  *stream,
+                           GCancellable            *cancellable,
+                           GError                 **error)
+{
+  MusicianGp4Section section;
+
+  g_return_val_if_fail (MUSICIAN_IS_GP4_PARSER (self), FALSE);
+  g_return_val_if_fail (decoder != NULL, FALSE);
+  g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (stream), FALSE);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), FALSE);
+
+  if (G_UNLIKELY (decoder->trace) && decoder->trace_begin == 0)
+    {
+      decoder->trace_begin = _musician_gpt_trace_get_time ();
+      decoder->trace_offset = _musician_gpt_input_stream_get_offset (stream);
+    }
+
+  section = decoder->section;
+
+  switch (decoder->section)
+    {
+    case MUSICIAN_GP4_SECTION_ATTRIBUTES:
+      if (!musician_gp4_parser_load_attributes (self, decoder, stream, cancellable, error))
+        return FALSE;
+      decoder->section = MUSICIAN_GP4_SECTION_LYRICS;
+      break;
+
+    case MUSICIAN_GP4_SECTION_LYRICS:
+      if (!musician_gp4_parser_load_lyrics (self, decoder, stream, cancellable, error))
+        return FALSE;
+      decoder->section = MUSICIAN_GP4_SECTION_MIDI_PORTS;
+      break;
+
+    case MUSICIAN_GP4_SECTION_MIDI_PORTS:
+      if (!musician_gp4_parser_load_midi_ports (self, decoder, stream, cancellable, error))
+        return FALSE;
+      decoder->section = MUSICIAN_GP4_SECTION_MEASURES;
+      break;
+
+    case MUSICIAN_GP4_SECTION_MEASURES:
+      if (!musician_gp4_parser_load_measure (self, decoder, stream, cancellable, error))
+        return FALSE;
+      decoder->index++;
+      break;
+
+    case MUSICIAN_GP4_SECTION_TRACKS:
+      if (!musician_gp4_parser_load_track (self, decoder, stream, cancellable, error))
+        return FALSE;
+      decoder->index++;
+      break;
+
+    case MUSICIAN_GP4_SECTION_MEASURE_PAIRS:
+      if (!musician_gp4_parser_load_measure_pair (self, decoder, stream, cancellable, error))
+        return FALSE;
+      break;
+
+    case MUSICIAN_GP4_SECTION_DONE:
+    default:
+      g_return_val_if_reached (FALSE);
+    }
+
+  /* Move past sections that are complete, including empty ones */
+  if (decoder->section == MUSICIAN_GP4_SECTION_MEASURES && decoder->index >= decoder->n_measures)
+    {
+      decoder->section = MUSICIAN_GP4_SECTION_TRACKS;
+      decoder->index = 0;
+    }
+
+  if (decoder->section == MUSICIAN_GP4_SECTION_TRACKS && decoder->index >= decoder->n_tracks)
+    {
+      decoder->section = MUSICIAN_GP4_SECTION_MEASURE_PAIRS;
+      decoder->index = 0;
+    }
+
+  if (decoder->section == MUSICIAN_GP4_SECTION_MEASURE_PAIRS &&
+      decoder->index >= (guint64)decoder->n_measures * decoder->n_tracks)
+    decoder->section = MUSICIAN_GP4_SECTION_DONE;
+
+  if (G_UNLIKELY (decoder->trace))
+    decoder->trace_n_records++;
+
+  if (decoder->section != section)
+    musician_gp4_decoder_end_section (decoder, section, stream);
+
   return TRUE;
 }
 
+/*
+ * Folds the per-section timings into the stats and hands them to @stream,
+ * where MusicianGptParser picks them up once the load has finished.
+ */
+static void
+musician_gp4_decoder_save_stats (MusicianGp4Decoder     *decoder,
+                                 MusicianGptInputStream *stream)
+{
+  MusicianGptParseStats *stats = &decoder->stats;
+
+  stats->header_usec = decoder->section_usec[MUSICIAN_GP4_SECTION_ATTRIBUTES] +
+                       decoder->section_usec[MUSICIAN_GP4_SECTION_LYRICS] +
+                       decoder->section_usec[MUSICIAN_GP4_SECTION_MIDI_PORTS];
+  stats->measures_usec = decoder->section_usec[MUSICIAN_GP4_SECTION_MEASURES];
+  stats->tracks_usec = decoder->section_usec[MUSICIAN_GP4_SECTION_TRACKS];
+  stats->beats_usec = decoder->section_usec[MUSICIAN_GP4_SECTION_MEASURE_PAIRS];
+  stats->n_measures = decoder->n_measures;
+  stats->n_tracks = decoder->n_tracks;
+
+  _musician_gpt_input_stream_set_stats (stream, stats);
+}
+
 static MusicianGptSong *
 musician_gp4_parser_load (MusicianGptParser       *parser,
                           MusicianGptInputStream  *stream,
@@ -692,79 +1709,188 @@ musician_gp4_parser_load (MusicianGptParser       *parser,
                           GError                 **error)
 {
   MusicianGp4Parser *self = (MusicianGp4Parser *)parser;
-  g_autoptr(MusicianGptSong) song = NULL;
-  MusicianGptTripletFeel triplet_feel = 0;
-  MusicianGptKey key = 0;
-  MusicianGptOctave octave = 0;
-  guint32 tempo = 0;
-  guint32 n_measures = 0;
-  guint32 n_tracks = 0;
+  MusicianGp4Decoder decoder;
+  MusicianGp4BlockIndex *index = NULL;
+  MusicianGptSong *song = NULL;
+  MusicianGptLoadFlags load_flags;
+  GBytes *bytes;
+  gboolean indexed;
+  gboolean parallel;
+  gboolean lazy;
 
   g_assert (MUSICIAN_IS_GP4_PARSER (self));
   g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
   g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
 
-  song = musician_gpt_song_new ();
+  /*
+   * Lazy and parallel loads both come back to measure/track pairs after
+   * the first pass, which we can only do when decoding from memory.
+   * Offsets are kept as 32-bit to keep the index small, which is plenty
+   * for any Guitar Pro file.
+   */
+  bytes = _musician_gpt_input_stream_get_bytes (stream);
+  indexed = bytes != NULL && g_bytes_get_size (bytes) <= G_MAXUINT32;
+  load_flags = _musician_gpt_input_stream_get_load_flags (stream);
+  lazy = indexed && (load_flags & MUSICIAN_GPT_LOAD_LAZY) != 0;
+  parallel = indexed && !lazy && (load_flags & MUSICIAN_GPT_LOAD_PARALLEL) != 0;
+
+  _musician_gp4_decoder_init (&decoder, version, _musician_gpt_input_stream_get_arena (stream), NULL, NULL);
+
+  /*
+   * Both lazy and parallel loads start by finding where each measure/track
+   * pair starts, which is a lot cheaper than decoding the beats.
+   */
+  if (lazy || parallel)
+    decoder.offsets = g_array_new (FALSE, FALSE, sizeof (guint32));
+
+  while (decoder.section != MUSICIAN_GP4_SECTION_DONE)
+    {
+      if (!_musician_gp4_parser_step (self, &decoder, stream, cancellable, error))
+        goto cleanup;
+    }
 
-  _musician_gpt_song_set_version (song, version);
+  if (lazy || parallel)
+    {
+      index = g_slice_new0 (MusicianGp4BlockIndex);
+      index->parser = g_object_ref (self);
+      index->bytes = g_bytes_ref (bytes);
+      index->offsets = g_steal_pointer (&decoder.offsets);
+      index->n_measures = decoder.n_measures;
+      index->n_tracks = decoder.n_tracks;
+    }
 
-  /* Load basic stuff like title, subtitle, artist, etc */
-  if (!musician_gp4_parser_load_attributes (self, stream, song, cancellable, error))
-    return NULL;
+  /* Every measure/track pair is left for musician_gpt_song_get_beats() */
+  if (lazy)
+    decoder.stats.n_deferred = index->offsets->len;
 
-  /* Load the triplet feel field */
-  if (musician_gpt_input_stream_read_triplet_feel (stream, cancellable, &triplet_feel, error))
-    musician_gpt_song_set_triplet_feel (song, triplet_feel);
-  else
-    return NULL;
+  if (parallel)
+    {
+      gint64 begin = g_get_monotonic_time ();
 
-  /* Load the track lyrics */
-  if (!musician_gp4_parser_load_lyrics (self, stream, song, cancellable, error))
-    return NULL;
+      if (!musician_gp4_parallel_decode (index, decoder.song, stream, cancellable, error))
+        goto cleanup;
 
-  /* Load the document tempo */
-  if (musician_gpt_input_stream_read_tempo (stream, cancellable, &tempo, error))
-    musician_gpt_song_set_tempo (song, tempo);
-  else
-    return NULL;
+      decoder.section_usec[MUSICIAN_GP4_SECTION_MEASURE_PAIRS] += g_get_monotonic_time () - begin;
+    }
 
-  /* Load the document key */
-  if (musician_gpt_input_stream_read_key (stream, cancellable, &key, error))
-    musician_gpt_song_set_key (song, key);
-  else
-    return NULL;
+  musician_gp4_decoder_save_stats (&decoder, stream);
 
-  /* Read the document octave */
-  if (musician_gpt_input_stream_read_octave (stream, cancellable, &octave, error))
-    musician_gpt_song_set_octave (song, octave);
-  else
-    return NULL;
+  song = g_steal_pointer (&decoder.song);
 
-  /* Load midi port/channel mappings */
-  if (!musician_gp4_parser_load_midi_ports (self, stream, song, cancellable, error))
-    return NULL;
+  if (lazy)
+    _musician_gpt_song_set_block_func (song, musician_gp4_block_index_load, g_steal_pointer (&index), musician_gp4_block_index_free);
 
-  /* Load the number of measures in the song */
-  if (!musician_gpt_input_stream_read_uint32 (stream, cancellable, &n_measures, error))
-    return NULL;
+cleanup:
+  g_clear_pointer (&index, musician_gp4_block_index_free);
+  _musician_gp4_decoder_clear (&decoder);
 
-  /* Load the number of tracks in the song */
-  if (!musician_gpt_input_stream_read_uint32 (stream, cancellable, &n_tracks, error))
-    return NULL;
+  return song;
+}
 
-  /* Load information about our mesaures */
-  if (!musician_gp4_parser_load_measures (self, stream, song, n_measures, cancellable, error))
-    return NULL;
+static gboolean
+musician_gp4_parser_parse (MusicianGptParser        *parser,
+                           MusicianGptInputStream   *stream,
+                           const gchar              *version,
+                           const MusicianGptEvents  *events,
+                           gpointer                  user_data,
+                           GCancellable             *cancellable,
+                           GError                  **error)
+{
+  MusicianGp4Parser *self = (MusicianGp4Parser *)parser;
+  MusicianGp4Decoder decoder;
+  gboolean ret = FALSE;
 
-  /* Load information about the tracks */
-  if (!musician_gp4_parser_load_tracks (self, stream, song, n_tracks, cancellable, error))
-    return NULL;
+  g_assert (MUSICIAN_IS_GP4_PARSER (self));
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
+  g_assert (events != NULL);
+  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  _musician_gp4_decoder_init (&decoder, version, _musician_gpt_input_stream_get_arena (stream), events, user_data);
+
+  while (decoder.section != MUSICIAN_GP4_SECTION_DONE)
+    {
+      if (!_musician_gp4_parser_step (self, &decoder, stream, cancellable, error))
+        goto cleanup;
+
+      /*
+       * Nothing holds on to decoded strings once their event has been
+       * emitted, so reuse the memory rather than growing with the song.
+       * The header keeps pointing into the arena until it is emitted.
+       */
+      if (decoder.section > MUSICIAN_GP4_SECTION_MIDI_PORTS)
+        _musician_gpt_input_stream_reset_arena (stream);
+    }
+
+  ret = TRUE;
+
+cleanup:
+  _musician_gp4_decoder_clear (&decoder);
+
+  return ret;
+}
+
+static MusicianGptMetadata *
+musician_gp4_parser_scan (MusicianGptParser       *parser,
+                          MusicianGptInputStream  *stream,
+                          const gchar             *version,
+                          GCancellable            *cancellable,
+                          GError                 **error)
+{
+  MusicianGp4Parser *self = (MusicianGp4Parser *)parser;
+  g_autoptr(MusicianGptMetadata) metadata = NULL;
+  guint32 n_comments;
+
+  g_assert (MUSICIAN_IS_GP4_PARSER (self));
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
+  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  /*
+   * This follows musician_gp4_parser_load() up to the number of tracks, but
+   * skips over everything that is not part of MusicianGptMetadata instead
+   * of decoding it. The strings we keep live in the stream's arena, which
+   * the metadata holds on to.
+   */
+
+  metadata = _musician_gpt_metadata_new (_musician_gpt_input_stream_get_arena (stream));
+  metadata->version = version;
+
+  metadata->title = _musician_gpt_input_stream_pull_string (stream, cancellable);
+  metadata->subtitle = _musician_gpt_input_stream_pull_string (stream, cancellable);
+  musician_gp4_parser_skip_string (stream, cancellable);
+  metadata->album = _musician_gpt_input_stream_pull_string (stream, cancellable);
+  metadata->artist = _musician_gpt_input_stream_pull_string (stream, cancellable);
+
+  /* Copyright, tab author and instructions */
+  for (guint i = 0; i < 3; i++)
+    musician_gp4_parser_skip_string (stream, cancellable);
+
+  n_comments = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
+  for (guint32 i = 0; i < n_comments && !_musician_gpt_input_stream_failed (stream); i++)
+    musician_gp4_parser_skip_string (stream, cancellable);
+
+  /* Triplet feel and the lyrics track */
+  _musician_gpt_input_stream_pull_skip (stream, 1 + 4, cancellable);
+
+  /* Each of the 5 lyrics is a position followed by a 32-bit length string */
+  for (guint i = 0; i < 5; i++)
+    {
+      _musician_gpt_input_stream_pull_skip (stream, 4, cancellable);
+      _musician_gpt_input_stream_pull_skip (stream, _musician_gpt_input_stream_pull_uint32 (stream, cancellable), cancellable);
+    }
+
+  metadata->tempo = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
+  metadata->key = _musician_gpt_input_stream_pull_int32 (stream, cancellable);
+
+  /* Octave, then 4 MIDI ports of 16 channels, each channel being 12 bytes */
+  _musician_gpt_input_stream_pull_skip (stream, 1 + (4 * 16 * 12), cancellable);
+
+  metadata->n_measures = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
+  metadata->n_tracks = _musician_gpt_input_stream_pull_uint32 (stream, cancellable);
 
-  /* Load measure/track pairs */
-  if (!musician_gp4_parser_load_measure_pairs (self, stream, song, n_measures, n_tracks, cancellable, error))
+  if (!_musician_gpt_input_stream_check (stream, cancellable, error))
     return NULL;
 
-  return g_steal_pointer (&song);
+  return g_steal_pointer (&metadata);
 }
 
 static void
@@ -782,6 +1908,8 @@ musician_gp4_parser_class_init (MusicianGp4ParserClass *klass)
   object_class->finalize = musician_gp4_parser_finalize;
 
   parser_class->load = musician_gp4_parser_load;
+  parser_class->scan = musician_gp4_parser_scan;
+  parser_class->parse = musician_gp4_parser_parse;
 }
 
 static void
@@ -0,0 +1,449 @@
+/* musician-gpt-arena.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "musician-gpt-arena"
+
+#include <gio/gio.h>
+#include <string.h>
+
+#include "musician-gpt-arena.h"
+
+/*
+ * MusicianGptArena is a simple bump allocator used while decoding a file.
+ *
+ * Everything allocated from the arena is released at once when the last
+ * reference is dropped. The parser hands the arena to the resulting song
+ * (and the tracks and measures within it), so that strings decoded from
+ * the file can be stored without being copied again or freed one by one.
+ *
+ * An arena may also be backed by a #GBytes, such as a mapped snapshot
+ * file. Strings within those bytes are then owned by the arena too, so
+ * objects can point straight into the mapping.
+ *
+ * Allocation is not thread-safe, but reference counting is.
+ */
+
+#define ARENA_ALIGN          (2 * sizeof (gpointer))
+#define ARENA_MIN_CHUNK_SIZE 4096
+#define ARENA_MAX_CHUNK_SIZE (256 * 1024)
+
+typedef struct _MusicianGptArenaChunk MusicianGptArenaChunk;
+
+struct _MusicianGptArenaChunk
+{
+  MusicianGptArenaChunk *next;
+  gsize                  len;
+  gsize                  pos;
+  gsize                  _padding;
+  guint8                 data[];
+};
+
+struct _MusicianGptArena
+{
+  volatile gint          ref_count;
+
+  /* The chunk we are currently allocating from is always first */
+  MusicianGptArenaChunk *chunks;
+
+  /* Number of bytes handed out, including alignment padding */
+  gsize                  size;
+
+  /* The largest @size has been, as musician_gpt_arena_reset() lowers it */
+  gsize                  peak_size;
+
+  /* Chunks double in size up to ARENA_MAX_CHUNK_SIZE */
+  gsize                  next_chunk_size;
+
+  /* Read-only memory we own in addition to our chunks, or %NULL */
+  GBytes                *bytes;
+};
+
+G_STATIC_ASSERT (sizeof (MusicianGptArenaChunk) % ARENA_ALIGN == 0);
+
+MusicianGptArena *
+musician_gpt_arena_new (void)
+{
+  MusicianGptArena *self;
+
+  self = g_slice_new0 (MusicianGptArena);
+  self->ref_count = 1;
+  self->next_chunk_size = ARENA_MIN_CHUNK_SIZE;
+
+  return self;
+}
+
+/**
+ * musician_gpt_arena_new_for_bytes:
+ * @bytes: A #GBytes
+ *
+ * Creates a new arena that holds a reference to @bytes. Pointers into
+ * @bytes are treated as owned by the arena, so musician_gpt_arena_dup_string()
+ * will not copy strings found there.
+ *
+ * The arena can still be allocated from like one made with
+ * musician_gpt_arena_new().
+ *
+ * Returns: (transfer full): A #MusicianGptArena.
+ */
+MusicianGptArena *
+musician_gpt_arena_new_for_bytes (GBytes *bytes)
+{
+  MusicianGptArena *self;
+
+  g_return_val_if_fail (bytes != NULL, NULL);
+
+  self = musician_gpt_arena_new ();
+  self->bytes = g_bytes_ref (bytes);
+
+  return self;
+}
+
+MusicianGptArena *
+musician_gpt_arena_ref (MusicianGptArena *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+  g_return_val_if_fail (self->ref_count > 0, NULL);
+
+  g_atomic_int_inc (&self->ref_count);
+
+  return self;
+}
+
+void
+musician_gpt_arena_unref (MusicianGptArena *self)
+{
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (self->ref_count > 0);
+
+  if (g_atomic_int_dec_and_test (&self->ref_count))
+    {
+      while (self->chunks != NULL)
+        {
+          MusicianGptArenaChunk *chunk = self->chunks;
+
+          self->chunks = chunk->next;
+          g_free (chunk);
+        }
+
+      g_clear_pointer (&self->bytes, g_bytes_unref);
+      g_slice_free (MusicianGptArena, self);
+    }
+}
+
+static MusicianGptArenaChunk *
+musician_gpt_arena_chunk_new (gsize    len,
+                              GError **error)
+{
+  MusicianGptArenaChunk *chunk;
+
+  if (len > G_MAXSIZE - sizeof *chunk ||
+      NULL == (chunk = g_try_malloc (sizeof *chunk + len)))
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_INVALID_DATA,
+                           "Failed to allocate memory while decoding.");
+      return NULL;
+    }
+
+  chunk->next = NULL;
+  chunk->len = len;
+  chunk->pos = 0;
+
+  return chunk;
+}
+
+/**
+ * musician_gpt_arena_alloc:
+ * @self: A #MusicianGptArena
+ * @n_bytes: the number of bytes to allocate
+ * @error: A location for a #GError or %NULL
+ *
+ * Allocates @n_bytes from the arena. The memory is not zeroed and is
+ * suitably aligned for pointers and doubles. It is released when the
+ * last reference to @self is dropped.
+ *
+ * Returns: (transfer none): the allocated memory, or %NULL and @error is set.
+ */
+gpointer
+musician_gpt_arena_alloc (MusicianGptArena  *self,
+                          gsize              n_bytes,
+                          GError           **error)
+{
+  MusicianGptArenaChunk *chunk;
+  gpointer ret;
+
+  g_return_val_if_fail (self != NULL, NULL);
+
+  if (n_bytes > G_MAXSIZE - ARENA_ALIGN)
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_INVALID_DATA,
+                           "Failed to allocate memory while decoding.");
+      return NULL;
+    }
+
+  n_bytes = (n_bytes + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+  chunk = self->chunks;
+
+  if (chunk == NULL || n_bytes > chunk->len - chunk->pos)
+    {
+      if (n_bytes > self->next_chunk_size / 4)
+        {
+          /*
+           * Large allocations get a chunk of their own. We put it behind
+           * the current chunk so that we can keep filling the free space
+           * remaining in the current chunk.
+           */
+          if (NULL == (chunk = musician_gpt_arena_chunk_new (n_bytes, error)))
+            return NULL;
+
+          if (self->chunks != NULL)
+            {
+              chunk->next = self->chunks->next;
+              self->chunks->next = chunk;
+            }
+          else
+            self->chunks = chunk;
+        }
+      else
+        {
+          if (NULL == (chunk = musician_gpt_arena_chunk_new (self->next_chunk_size, error)))
+            return NULL;
+
+          chunk->next = self->chunks;
+          self->chunks = chunk;
+
+          self->next_chunk_size = MIN (self->next_chunk_size * 2, ARENA_MAX_CHUNK_SIZE);
+        }
+    }
+
+  ret = &chunk->data[chunk->pos];
+  chunk->pos += n_bytes;
+  self->size += n_bytes;
+
+  if (self->size > self->peak_size)
+    self->peak_size = self->size;
+
+  return ret;
+}
+
+/**
+ * musician_gpt_arena_reset:
+ * @self: A #MusicianGptArena
+ *
+ * Releases everything that was allocated from @self, so that the memory
+ * can be used again. The most recent chunk is kept around for that.
+ *
+ * This is for decoders that do not hand their strings to a song, and it
+ * must only be called once nothing points into @self anymore.
+ */
+void
+musician_gpt_arena_reset (MusicianGptArena *self)
+{
+  MusicianGptArenaChunk *chunk;
+
+  g_return_if_fail (self != NULL);
+
+  if (self->chunks == NULL)
+    return;
+
+  while (NULL != (chunk = self->chunks->next))
+    {
+      self->chunks->next = chunk->next;
+      g_free (chunk);
+    }
+
+  self->chunks->pos = 0;
+  self->size = 0;
+}
+
+/**
+ * musician_gpt_arena_mark:
+ * @self: A #MusicianGptArena
+ * @mark: (out caller-allocates): A location for the mark
+ *
+ * Remembers how much has been allocated from @self, so that
+ * musician_gpt_arena_rewind() can release whatever is allocated after it.
+ */
+void
+musician_gpt_arena_mark (MusicianGptArena     *self,
+                         MusicianGptArenaMark *mark)
+{
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (mark != NULL);
+
+  mark->chunk = self->chunks;
+  mark->next = self->chunks ? self->chunks->next : NULL;
+  mark->pos = self->chunks ? self->chunks->pos : 0;
+  mark->size = self->size;
+}
+
+/**
+ * musician_gpt_arena_rewind:
+ * @self: A #MusicianGptArena
+ * @mark: A mark from musician_gpt_arena_mark()
+ *
+ * Releases everything that was allocated from @self since @mark was taken.
+ * This is for decoders that give up on a record half way through, and it
+ * must only be called once nothing points into those allocations.
+ *
+ * @mark is no longer valid once @self has been reset or rewound past it.
+ */
+void
+musician_gpt_arena_rewind (MusicianGptArena           *self,
+                           const MusicianGptArenaMark *mark)
+{
+  MusicianGptArenaChunk *chunk;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (mark != NULL);
+  g_return_if_fail (mark->size <= self->size);
+
+  /*
+   * Chunks are only ever added in front of the marked chunk, or right
+   * behind it for large allocations, so those are all we need to drop.
+   */
+  while (self->chunks != mark->chunk)
+    {
+      chunk = self->chunks;
+      self->chunks = chunk->next;
+      g_free (chunk);
+    }
+
+  if (self->chunks != NULL)
+    {
+      while (self->chunks->next != mark->next)
+        {
+          chunk = self->chunks->next;
+          self->chunks->next = chunk->next;
+          g_free (chunk);
+        }
+
+      self->chunks->pos = mark->pos;
+    }
+
+  self->size = mark->size;
+}
+
+/**
+ * musician_gpt_arena_contains:
+ * @self: (nullable): A #MusicianGptArena or %NULL
+ * @ptr: (nullable): a pointer
+ *
+ * Checks if @ptr was allocated from @self, or points into the bytes
+ * given to musician_gpt_arena_new_for_bytes().
+ *
+ * Returns: %TRUE if @ptr points into memory owned by @self.
+ */
+gboolean
+musician_gpt_arena_contains (MusicianGptArena *self,
+                             gconstpointer     ptr)
+{
+  const guint8 *p = ptr;
+
+  if (self == NULL || ptr == NULL)
+    return FALSE;
+
+  if (self->bytes != NULL)
+    {
+      gsize len;
+      const guint8 *data = g_bytes_get_data (self->bytes, &len);
+
+      if (data != NULL && p >= data && p < data + len)
+        return TRUE;
+    }
+
+  for (const MusicianGptArenaChunk *chunk = self->chunks; chunk != NULL; chunk = chunk->next)
+    {
+      if (p >= chunk->data && p < chunk->data + chunk->pos)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/**
+ * musician_gpt_arena_get_size:
+ * @self: A #MusicianGptArena
+ *
+ * Returns: the number of bytes that have been allocated from @self.
+ */
+gsize
+musician_gpt_arena_get_size (MusicianGptArena *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->size;
+}
+
+/**
+ * musician_gpt_arena_get_peak_size:
+ * @self: A #MusicianGptArena
+ *
+ * Returns: the most bytes that have been allocated from @self at once,
+ *   which is more than musician_gpt_arena_get_size() once @self has been
+ *   reset.
+ */
+gsize
+musician_gpt_arena_get_peak_size (MusicianGptArena *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->peak_size;
+}
+
+/**
+ * musician_gpt_arena_dup_string:
+ * @self: (nullable): A #MusicianGptArena or %NULL
+ * @str: (nullable): A string or %NULL
+ *
+ * This is a replacement for g_strdup() for objects that may hold strings
+ * owned by @self. If @str is already owned by @self it is returned as is,
+ * otherwise a copy is made with g_strdup().
+ *
+ * Release the result with musician_gpt_arena_free_string().
+ *
+ * Returns: @str or a newly allocated copy of @str.
+ */
+gchar *
+musician_gpt_arena_dup_string (MusicianGptArena *self,
+                               const gchar      *str)
+{
+  if (musician_gpt_arena_contains (self, str))
+    return (gchar *)str;
+
+  return g_strdup (str);
+}
+
+/**
+ * musician_gpt_arena_free_string:
+ * @self: (nullable): A #MusicianGptArena or %NULL
+ * @str: (nullable): A string from musician_gpt_arena_dup_string()
+ *
+ * Frees @str unless it is owned by @self.
+ */
+void
+musician_gpt_arena_free_string (MusicianGptArena *self,
+                                gchar            *str)
+{
+  if (!musician_gpt_arena_contains (self, str))
+    g_free (str);
+}
@@ -0,0 +1,68 @@
+/* musician-gpt-arena.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_ARENA_H
+#define MUSICIAN_GPT_ARENA_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _MusicianGptArena MusicianGptArena;
+
+/**
+ * MusicianGptArenaMark:
+ *
+ * A position in a #MusicianGptArena to go back to with
+ * musician_gpt_arena_rewind().
+ */
+typedef struct
+{
+  /*< private >*/
+  gpointer chunk;
+  gpointer next;
+  gsize    pos;
+  gsize    size;
+} MusicianGptArenaMark;
+
+MusicianGptArena *musician_gpt_arena_new           (void);
+MusicianGptArena *musician_gpt_arena_new_for_bytes (GBytes                     *bytes);
+MusicianGptArena *musician_gpt_arena_ref           (MusicianGptArena           *self);
+void              musician_gpt_arena_unref         (MusicianGptArena           *self);
+gpointer          musician_gpt_arena_alloc         (MusicianGptArena           *self,
+                                                    gsize                       n_bytes,
+                                                    GError                    **error);
+void              musician_gpt_arena_reset         (MusicianGptArena           *self);
+void              musician_gpt_arena_mark          (MusicianGptArena           *self,
+                                                    MusicianGptArenaMark       *mark);
+void              musician_gpt_arena_rewind        (MusicianGptArena           *self,
+                                                    const MusicianGptArenaMark *mark);
+gboolean          musician_gpt_arena_contains      (MusicianGptArena           *self,
+                                                    gconstpointer               ptr);
+gsize             musician_gpt_arena_get_size      (MusicianGptArena           *self);
+gsize             musician_gpt_arena_get_peak_size (MusicianGptArena           *self);
+gchar            *musician_gpt_arena_dup_string    (MusicianGptArena           *self,
+                                                    const gchar                *str);
+void              musician_gpt_arena_free_string   (MusicianGptArena           *self,
+                                                    gchar                      *str);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MusicianGptArena, musician_gpt_arena_unref)
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_ARENA_H */
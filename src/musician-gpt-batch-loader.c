@@ -0,0 +1,549 @@
+/* musician-gpt-batch-loader.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "musician-gpt-batch-loader"
+
+#include "musician-gpt-batch-loader.h"
+#include "musician-gpt-input-stream-private.h"
+#include "musician-gpt-parser.h"
+#include "musician-gpt-parser-private.h"
+
+/**
+ * SECTION:musician-gpt-batch-loader:
+ * @title: #MusicianGptBatchLoader
+ * @short_description: Load many Guitar Pro™ files at once
+ *
+ * #MusicianGptBatchLoader loads a list of files, or every .gp4 file in a
+ * directory tree, on a pool of threads shared by all batch loaders and
+ * sized to the number of processors. Each worker takes the next file
+ * that nobody has started yet, so a few large files do not hold up the
+ * rest of the batch.
+ *
+ * Songs are handed to a #MusicianGptBatchFunc on the thread that called
+ * musician_gpt_batch_loader_run(), in the order they complete.
+ *
+ * #MusicianGptBatchLoader:max-memory puts a ceiling on what all of the
+ * files being decoded, and those waiting to be handed over, allocate
+ * while decoding. Workers hold off on starting new files while more than
+ * half of it is in use.
+ */
+
+struct _MusicianGptBatchLoader
+{
+  GObject    parent_instance;
+
+  /* The files to load on the next run */
+  GPtrArray *files;
+
+  /* 0 if there is no limit beyond that of each stream */
+  guint64    max_memory;
+
+  guint      running : 1;
+};
+
+typedef struct
+{
+  GFile                  *file;
+  MusicianGptSong        *song;
+  GError                 *error;
+
+  /* Kept until the result is handed over, so its memory stays charged */
+  MusicianGptInputStream *stream;
+} BatchResult;
+
+typedef struct
+{
+  GPtrArray         *files;
+  GCancellable      *cancellable;
+  MusicianGptBudget  budget;
+
+  /* Where workers push a BatchResult for each file */
+  GAsyncQueue       *results;
+
+  /* The next file to be loaded */
+  volatile gint      next;
+
+  /*
+   * @released is signalled whenever a result has been freed, and
+   * @finished once the last worker is done with the run.
+   */
+  GMutex             mutex;
+  GCond              released;
+  GCond              finished;
+  guint              n_workers;
+} BatchRun;
+
+enum {
+  PROP_0,
+  PROP_MAX_MEMORY,
+  PROP_N_FILES,
+  N_PROPS
+};
+
+G_DEFINE_TYPE (MusicianGptBatchLoader, musician_gpt_batch_loader, G_TYPE_OBJECT)
+
+static GParamSpec *properties [N_PROPS];
+
+MusicianGptBatchLoader *
+musician_gpt_batch_loader_new (void)
+{
+  return g_object_new (MUSICIAN_TYPE_GPT_BATCH_LOADER, NULL);
+}
+
+static void
+batch_result_free (BatchResult *result)
+{
+  g_clear_object (&result->file);
+  g_clear_object (&result->song);
+  g_clear_error (&result->error);
+  g_clear_object (&result->stream);
+  g_slice_free (BatchResult, result);
+}
+
+static BatchResult *
+musician_gpt_batch_loader_load_one (BatchRun *run,
+                                    GFile    *file)
+{
+  g_autoptr(MusicianGptParser) parser = NULL;
+  BatchResult *result;
+
+  g_assert (run != NULL);
+  g_assert (G_IS_FILE (file));
+
+  result = g_slice_new0 (BatchResult);
+  result->file = g_object_ref (file);
+
+  parser = musician_gpt_parser_new ();
+
+  if (NULL != (result->stream = _musician_gpt_parser_open_file (file, run->cancellable, &result->error)))
+    {
+      _musician_gpt_input_stream_set_budget (result->stream, &run->budget);
+
+      if (_musician_gpt_parser_load_stream (parser, result->stream, run->cancellable, &result->error))
+        result->song = g_object_ref (musician_gpt_parser_get_song (parser));
+    }
+
+  return result;
+}
+
+static gboolean
+batch_run_under_pressure (BatchRun *run)
+{
+  gboolean ret;
+
+  g_mutex_lock (&run->budget.mutex);
+  ret = run->budget.used > run->budget.limit / 2;
+  g_mutex_unlock (&run->budget.mutex);
+
+  return ret;
+}
+
+static void
+musician_gpt_batch_loader_worker (gpointer data,
+                                  gpointer user_data)
+{
+  BatchRun *run = data;
+
+  for (;;)
+    {
+      guint i = g_atomic_int_add (&run->next, 1);
+
+      if (i >= run->files->len)
+        break;
+
+      /*
+       * Whatever is using the budget is either being decoded or waiting
+       * to be handed over, and is released soon either way.
+       */
+      g_mutex_lock (&run->mutex);
+      while (batch_run_under_pressure (run))
+        g_cond_wait (&run->released, &run->mutex);
+      g_mutex_unlock (&run->mutex);
+
+      g_async_queue_push (run->results,
+                          musician_gpt_batch_loader_load_one (run, g_ptr_array_index (run->files, i)));
+    }
+
+  g_mutex_lock (&run->mutex);
+  if (--run->n_workers == 0)
+    g_cond_signal (&run->finished);
+  g_mutex_unlock (&run->mutex);
+}
+
+static GThreadPool *
+get_batch_pool (void)
+{
+  static GThreadPool *pool;
+
+  if (g_once_init_enter (&pool))
+    {
+      GThreadPool *instance;
+
+      instance = g_thread_pool_new (musician_gpt_batch_loader_worker,
+                                    NULL,
+                                    g_get_num_processors (),
+                                    FALSE,
+                                    NULL);
+
+      g_once_init_leave (&pool, instance);
+    }
+
+  return pool;
+}
+
+static void
+musician_gpt_batch_loader_finalize (GObject *object)
+{
+  MusicianGptBatchLoader *self = (MusicianGptBatchLoader *)object;
+
+  g_clear_pointer (&self->files, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (musician_gpt_batch_loader_parent_class)->finalize (object);
+}
+
+static void
+musician_gpt_batch_loader_get_property (GObject    *object,
+                                        guint       prop_id,
+                                        GValue     *value,
+                                        GParamSpec *pspec)
+{
+  MusicianGptBatchLoader *self = MUSICIAN_GPT_BATCH_LOADER (object);
+
+  switch (prop_id)
+    {
+    case PROP_MAX_MEMORY:
+      g_value_set_uint64 (value, musician_gpt_batch_loader_get_max_memory (self));
+      break;
+
+    case PROP_N_FILES:
+      g_value_set_uint (value, musician_gpt_batch_loader_get_n_files (self));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+musician_gpt_batch_loader_set_property (GObject      *object,
+                                        guint         prop_id,
+                                        const GValue *value,
+                                        GParamSpec   *pspec)
+{
+  MusicianGptBatchLoader *self = MUSICIAN_GPT_BATCH_LOADER (object);
+
+  switch (prop_id)
+    {
+    case PROP_MAX_MEMORY:
+      musician_gpt_batch_loader_set_max_memory (self, g_value_get_uint64 (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+musician_gpt_batch_loader_class_init (MusicianGptBatchLoaderClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = musician_gpt_batch_loader_finalize;
+  object_class->get_property = musician_gpt_batch_loader_get_property;
+  object_class->set_property = musician_gpt_batch_loader_set_property;
+
+  properties [PROP_MAX_MEMORY] =
+    g_param_spec_uint64 ("max-memory",
+                         "Max Memory",
+                         "The most memory all files of a run may allocate while decoding, or 0",
+                         0,
+                         G_MAXUINT64,
+                         0,
+                         (G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS));
+
+  properties [PROP_N_FILES] =
+    g_param_spec_uint ("n-files",
+                       "N Files",
+                       "The number of files to load on the next run",
+                       0,
+                       G_MAXUINT,
+                       0,
+                       (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_properties (object_class, N_PROPS, properties);
+}
+
+static void
+musician_gpt_batch_loader_init (MusicianGptBatchLoader *self)
+{
+  self->files = g_ptr_array_new_with_free_func (g_object_unref);
+}
+
+guint64
+musician_gpt_batch_loader_get_max_memory (MusicianGptBatchLoader *self)
+{
+  g_return_val_if_fail (MUSICIAN_IS_GPT_BATCH_LOADER (self), 0);
+
+  return self->max_memory;
+}
+
+/**
+ * musician_gpt_batch_loader_set_max_memory:
+ * @self: A #MusicianGptBatchLoader
+ * @max_memory: A number of bytes, or 0
+ *
+ * Sets the most memory that the files of a run may allocate while they are
+ * decoded, in total. Songs stop counting against this once they have been
+ * handed to the #MusicianGptBatchFunc.
+ *
+ * A file that goes over the limit fails with %G_IO_ERROR_NO_SPACE. Since
+ * that may be due to the files it was decoded alongside, such files are
+ * tried again on their own at the end of the run.
+ *
+ * If @max_memory is 0, only the per-file limit of #MusicianGptInputStream
+ * applies.
+ */
+void
+musician_gpt_batch_loader_set_max_memory (MusicianGptBatchLoader *self,
+                                          guint64                 max_memory)
+{
+  g_return_if_fail (MUSICIAN_IS_GPT_BATCH_LOADER (self));
+
+  if (self->max_memory != max_memory)
+    {
+      self->max_memory = max_memory;
+      g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_MAX_MEMORY]);
+    }
+}
+
+guint
+musician_gpt_batch_loader_get_n_files (MusicianGptBatchLoader *self)
+{
+  g_return_val_if_fail (MUSICIAN_IS_GPT_BATCH_LOADER (self), 0);
+
+  return self->files->len;
+}
+
+/**
+ * musician_gpt_batch_loader_add_file:
+ * @self: A #MusicianGptBatchLoader
+ * @file: A #GFile
+ *
+ * Adds @file to the files loaded by the next musician_gpt_batch_loader_run().
+ */
+void
+musician_gpt_batch_loader_add_file (MusicianGptBatchLoader *self,
+                                    GFile                  *file)
+{
+  g_return_if_fail (MUSICIAN_IS_GPT_BATCH_LOADER (self));
+  g_return_if_fail (G_IS_FILE (file));
+
+  g_ptr_array_add (self->files, g_object_ref (file));
+  g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_N_FILES]);
+}
+
+/**
+ * musician_gpt_batch_loader_add_directory:
+ * @self: A #MusicianGptBatchLoader
+ * @directory: A #GFile for a directory
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @error: A location for a #GError or %NULL
+ *
+ * Adds every file ending in ".gp4" found in @directory, or in any of the
+ * directories below it, to the files loaded by the next
+ * musician_gpt_batch_loader_run(). Symbolic links are not followed.
+ *
+ * Nothing is added if the directory tree could not be read.
+ *
+ * Returns: %TRUE if successful; otherwise %FALSE and @error is set.
+ */
+gboolean
+musician_gpt_batch_loader_add_directory (MusicianGptBatchLoader  *self,
+                                         GFile                   *directory,
+                                         GCancellable            *cancellable,
+                                         GError                 **error)
+{
+  g_autoptr(GPtrArray) directories = NULL;
+  g_autoptr(GPtrArray) found = NULL;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_BATCH_LOADER (self), FALSE);
+  g_return_val_if_fail (G_IS_FILE (directory), FALSE);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), FALSE);
+
+  directories = g_ptr_array_new_with_free_func (g_object_unref);
+  found = g_ptr_array_new_with_free_func (g_object_unref);
+
+  g_ptr_array_add (directories, g_object_ref (directory));
+
+  while (directories->len > 0)
+    {
+      g_autoptr(GFileEnumerator) enumerator = NULL;
+      g_autoptr(GFile) current = NULL;
+
+      current = g_object_ref (g_ptr_array_index (directories, directories->len - 1));
+      g_ptr_array_remove_index (directories, directories->len - 1);
+
+      enumerator = g_file_enumerate_children (current,
+                                              G_FILE_ATTRIBUTE_STANDARD_NAME","
+                                              G_FILE_ATTRIBUTE_STANDARD_TYPE,
+                                              G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                              cancellable,
+                                              error);
+      if (enumerator == NULL)
+        return FALSE;
+
+      for (;;)
+        {
+          g_autofree gchar *name = NULL;
+          GFileInfo *info;
+          GFile *child;
+
+          if (!g_file_enumerator_iterate (enumerator, &info, &child, cancellable, error))
+            return FALSE;
+
+          if (info == NULL)
+            break;
+
+          switch (g_file_info_get_file_type (info))
+            {
+            case G_FILE_TYPE_DIRECTORY:
+              g_ptr_array_add (directories, g_object_ref (child));
+              break;
+
+            case G_FILE_TYPE_REGULAR:
+              name = g_ascii_strdown (g_file_info_get_name (info), -1);
+              if (g_str_has_suffix (name, ".gp4"))
+                g_ptr_array_add (found, g_object_ref (child));
+              break;
+
+            default:
+              break;
+            }
+        }
+    }
+
+  for (guint i = 0; i < found->len; i++)
+    g_ptr_array_add (self->files, g_object_ref (g_ptr_array_index (found, i)));
+
+  if (found->len > 0)
+    g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_N_FILES]);
+
+  return TRUE;
+}
+
+/**
+ * musician_gpt_batch_loader_run:
+ * @self: A #MusicianGptBatchLoader
+ * @func: (scope call): A #MusicianGptBatchFunc
+ * @user_data: Closure data for @func
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @error: A location for a #GError or %NULL
+ *
+ * Loads every file that has been added to @self, calling @func once for
+ * each of them on the calling thread, and blocks until all of them have
+ * been handed to @func. The list of files is empty again afterwards.
+ *
+ * Failing to load a file is not an error of the run; @func gets the error
+ * for that file instead. If @cancellable is cancelled, the remaining files
+ * fail with %G_IO_ERROR_CANCELLED.
+ *
+ * Returns: %TRUE if the run was not cancelled; otherwise %FALSE and @error
+ *   is set.
+ */
+gboolean
+musician_gpt_batch_loader_run (MusicianGptBatchLoader  *self,
+                               MusicianGptBatchFunc     func,
+                               gpointer                 user_data,
+                               GCancellable            *cancellable,
+                               GError                 **error)
+{
+  g_autoptr(GPtrArray) retry = NULL;
+  GThreadPool *pool = get_batch_pool ();
+  BatchRun run = { 0 };
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_BATCH_LOADER (self), FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), FALSE);
+  g_return_val_if_fail (!self->running, FALSE);
+
+  self->running = TRUE;
+
+  run.files = g_steal_pointer (&self->files);
+  run.cancellable = cancellable;
+  run.results = g_async_queue_new ();
+  g_mutex_init (&run.mutex);
+  g_cond_init (&run.released);
+  g_cond_init (&run.finished);
+
+  _musician_gpt_budget_init (&run.budget, self->max_memory ? MIN (self->max_memory, G_MAXSIZE) : G_MAXSIZE);
+
+  self->files = g_ptr_array_new_with_free_func (g_object_unref);
+  if (run.files->len > 0)
+    g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_N_FILES]);
+
+  run.n_workers = MIN ((guint)g_thread_pool_get_max_threads (pool), run.files->len);
+
+  for (guint i = 0; i < run.n_workers; i++)
+    g_thread_pool_push (pool, &run, NULL);
+
+  retry = g_ptr_array_new_with_free_func (g_object_unref);
+
+  for (guint i = 0; i < run.files->len; i++)
+    {
+      BatchResult *result = g_async_queue_pop (run.results);
+
+      /*
+       * The file may only have gone over the limit because of what was
+       * decoded alongside it, so give it another chance on its own.
+       */
+      if (self->max_memory > 0 && g_error_matches (result->error, G_IO_ERROR, G_IO_ERROR_NO_SPACE))
+        g_ptr_array_add (retry, g_object_ref (result->file));
+      else
+        func (result->file, result->song, result->error, user_data);
+
+      batch_result_free (result);
+
+      g_mutex_lock (&run.mutex);
+      g_cond_broadcast (&run.released);
+      g_mutex_unlock (&run.mutex);
+    }
+
+  g_mutex_lock (&run.mutex);
+  while (run.n_workers > 0)
+    g_cond_wait (&run.finished, &run.mutex);
+  g_mutex_unlock (&run.mutex);
+
+  for (guint i = 0; i < retry->len; i++)
+    {
+      BatchResult *result = musician_gpt_batch_loader_load_one (&run, g_ptr_array_index (retry, i));
+
+      func (result->file, result->song, result->error, user_data);
+      batch_result_free (result);
+    }
+
+  _musician_gpt_budget_clear (&run.budget);
+  g_async_queue_unref (run.results);
+  g_mutex_clear (&run.mutex);
+  g_cond_clear (&run.released);
+  g_cond_clear (&run.finished);
+  g_ptr_array_unref (run.files);
+
+  self->running = FALSE;
+
+  return !g_cancellable_set_error_if_cancelled (cancellable, error);
+}
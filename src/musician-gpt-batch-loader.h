@@ -0,0 +1,66 @@
+/* musician-gpt-batch-loader.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_BATCH_LOADER_H
+#define MUSICIAN_GPT_BATCH_LOADER_H
+
+#include <gio/gio.h>
+
+#include "musician-gpt-song.h"
+#include "musician-gpt-types.h"
+
+G_BEGIN_DECLS
+
+#define MUSICIAN_TYPE_GPT_BATCH_LOADER (musician_gpt_batch_loader_get_type())
+
+G_DECLARE_FINAL_TYPE (MusicianGptBatchLoader, musician_gpt_batch_loader, MUSICIAN, GPT_BATCH_LOADER, GObject)
+
+/**
+ * MusicianGptBatchFunc:
+ * @file: The file that was loaded
+ * @song: (nullable): The song, or %NULL if loading failed
+ * @error: (nullable): Why loading failed, or %NULL
+ * @user_data: The closure passed to musician_gpt_batch_loader_run()
+ *
+ * Called once for every file of a batch, as soon as it has been loaded.
+ */
+typedef void (*MusicianGptBatchFunc) (GFile           *file,
+                                      MusicianGptSong *song,
+                                      const GError    *error,
+                                      gpointer         user_data);
+
+MusicianGptBatchLoader *musician_gpt_batch_loader_new            (void);
+guint64                 musician_gpt_batch_loader_get_max_memory (MusicianGptBatchLoader  *self);
+void                    musician_gpt_batch_loader_set_max_memory (MusicianGptBatchLoader  *self,
+                                                                  guint64                  max_memory);
+guint                   musician_gpt_batch_loader_get_n_files    (MusicianGptBatchLoader  *self);
+void                    musician_gpt_batch_loader_add_file       (MusicianGptBatchLoader  *self,
+                                                                  GFile                   *file);
+gboolean                musician_gpt_batch_loader_add_directory  (MusicianGptBatchLoader  *self,
+                                                                  GFile                   *directory,
+                                                                  GCancellable            *cancellable,
+                                                                  GError                 **error);
+gboolean                musician_gpt_batch_loader_run            (MusicianGptBatchLoader  *self,
+                                                                  MusicianGptBatchFunc     func,
+                                                                  gpointer                 user_data,
+                                                                  GCancellable            *cancellable,
+                                                                  GError                 **error);
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_BATCH_LOADER_H */
@@ -0,0 +1,53 @@
+/* musician-gpt-beat-store-private.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_BEAT_STORE_PRIVATE_H
+#define MUSICIAN_GPT_BEAT_STORE_PRIVATE_H
+
+#include "musician-gpt-beat-store.h"
+#include "musician-gpt-events.h"
+#include "musician-gpt-intern-table.h"
+
+G_BEGIN_DECLS
+
+MusicianGptBeatStore   *_musician_gpt_beat_store_new              (guint                       n_measures,
+                                                                   MusicianGptInternTable     *intern_table);
+MusicianGptInternTable *_musician_gpt_beat_store_get_intern_table (MusicianGptBeatStore       *self);
+gboolean                _musician_gpt_beat_store_is_loaded        (MusicianGptBeatStore       *self,
+                                                                   guint                       measure);
+void                    _musician_gpt_beat_store_begin_measure    (MusicianGptBeatStore       *self,
+                                                                   guint                       measure);
+void                    _musician_gpt_beat_store_abort_measure    (MusicianGptBeatStore       *self);
+void                    _musician_gpt_beat_store_append           (MusicianGptBeatStore       *self,
+                                                                   const MusicianGptBeatEvent *event);
+void                    _musician_gpt_beat_store_set_chord        (MusicianGptBeatStore       *self,
+                                                                   MusicianGptChord           *chord);
+void                    _musician_gpt_beat_store_add_bend         (MusicianGptBeatStore       *self,
+                                                                   guint                       string,
+                                                                   MusicianGptBend            *bend);
+void                    _musician_gpt_beat_store_reserve          (MusicianGptBeatStore       *self,
+                                                                   const guint32              *n_beats);
+MusicianGptBeatStore   *_musician_gpt_beat_store_new_slice        (MusicianGptBeatStore       *self,
+                                                                   guint                       first_measure,
+                                                                   guint                       n_measures);
+void                    _musician_gpt_beat_store_commit_slice     (MusicianGptBeatStore       *self,
+                                                                   MusicianGptBeatStore       *slice);
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_BEAT_STORE_PRIVATE_H */
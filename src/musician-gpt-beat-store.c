@@ -0,0 +1,803 @@
+/* musician-gpt-beat-store.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "musician-gpt-beat-store"
+
+#include "musician-gpt-beat-store.h"
+#include "musician-gpt-beat-store-private.h"
+#include "musician-gpt-bend.h"
+#include "musician-gpt-chord.h"
+
+/**
+ * SECTION:musician-gpt-beat-store
+ * @title: MusicianGptBeatStore
+ * @short_description: The beats of a track
+ *
+ * A #MusicianGptBeatStore keeps every beat of a track in a set of parallel
+ * columns, one byte per beat for each of mode, duration, tuplet, dynamics
+ * and flags. Chords, texts and bends are rare, so they are kept in side
+ * tables instead and found with musician_gpt_beat_store_get_view().
+ *
+ * The beats of a measure are always next to each other. For a song that
+ * was loaded up front the measures are in order as well, so the columns
+ * can be scanned from start to end to look at the whole track.
+ */
+
+#define N_MIN_BEATS 16
+
+typedef struct
+{
+  /* G_MAXUINT when the measure has not been loaded */
+  guint first;
+  guint n_beats;
+} MeasureRange;
+
+/*
+ * Side table entries. Beats are only ever appended, so each table is
+ * sorted by beat and can be searched with side_table_find().
+ */
+typedef struct
+{
+  guint             beat;
+  MusicianGptChord *chord;
+} ChordEntry;
+
+typedef struct
+{
+  guint  beat;
+  gchar *text;
+} TextEntry;
+
+typedef struct
+{
+  guint            beat;
+  guint            string;
+  MusicianGptBend *bend;
+} BendEntry;
+
+struct _MusicianGptBeatStore
+{
+  volatile gint           ref_count;
+
+  /* Chords and bends of this track are interned here */
+  MusicianGptInternTable *intern_table;
+
+  guint                   n_beats;
+  guint                   n_allocated;
+
+  guint8                 *modes;
+  guint8                 *durations;
+  guint8                 *n_tuplets;
+  guint8                 *dynamics;
+  guint8                 *flags;
+
+  /*
+   * The ranges of the first @n_ranges measures. These grow as measures are
+   * begun rather than with @n_measures, which comes straight from the file
+   * and cannot be trusted until the measures have actually been decoded.
+   */
+  MeasureRange           *measures;
+  guint                   n_ranges;
+  guint                   n_measures;
+
+  /* The measure beats are being appended to, or 0 */
+  guint                   current;
+
+  GArray                 *chords;
+  GArray                 *texts;
+  GArray                 *bends;
+
+  /*
+   * Set for a slice, whose columns are part of those of @parent, starting
+   * at beat @offset, rather than our own. See
+   * _musician_gpt_beat_store_new_slice().
+   */
+  MusicianGptBeatStore   *parent;
+  guint                   offset;
+};
+
+G_DEFINE_BOXED_TYPE (MusicianGptBeatStore,
+                     musician_gpt_beat_store,
+                     musician_gpt_beat_store_ref,
+                     musician_gpt_beat_store_unref)
+
+static void
+chord_entry_clear (gpointer data)
+{
+  ChordEntry *entry = data;
+
+  g_clear_pointer (&entry->chord, musician_gpt_chord_unref);
+}
+
+static void
+text_entry_clear (gpointer data)
+{
+  TextEntry *entry = data;
+
+  g_clear_pointer (&entry->text, g_free);
+}
+
+static void
+bend_entry_clear (gpointer data)
+{
+  BendEntry *entry = data;
+
+  g_clear_pointer (&entry->bend, musician_gpt_bend_unref);
+}
+
+/* Finds the first entry of @table that is not before @beat */
+static guint
+side_table_find (GArray *table,
+                 guint   beat)
+{
+  guint element_size = g_array_get_element_size (table);
+  guint lo = 0;
+  guint hi = table->len;
+
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (*(guint *)(gpointer)(table->data + mid * element_size) < beat)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+/* Gets the entry of @table for @beat, or %NULL */
+static gpointer
+side_table_lookup (GArray *table,
+                   guint   beat)
+{
+  guint element_size = g_array_get_element_size (table);
+  guint index = side_table_find (table, beat);
+  gpointer entry;
+
+  if (index == table->len)
+    return NULL;
+
+  entry = table->data + index * element_size;
+
+  return *(guint *)entry == beat ? entry : NULL;
+}
+
+/* Drops every entry of @table from @beat onwards */
+static void
+side_table_truncate (GArray *table,
+                     guint   beat)
+{
+  guint index = side_table_find (table, beat);
+
+  if (index < table->len)
+    g_array_remove_range (table, index, table->len - index);
+}
+
+static void
+musician_gpt_beat_store_destroy (MusicianGptBeatStore *self)
+{
+  if (self->parent == NULL)
+    {
+      g_clear_pointer (&self->modes, g_free);
+      g_clear_pointer (&self->durations, g_free);
+      g_clear_pointer (&self->n_tuplets, g_free);
+      g_clear_pointer (&self->dynamics, g_free);
+      g_clear_pointer (&self->flags, g_free);
+    }
+
+  g_clear_pointer (&self->measures, g_free);
+  g_clear_pointer (&self->chords, g_array_unref);
+  g_clear_pointer (&self->texts, g_array_unref);
+  g_clear_pointer (&self->bends, g_array_unref);
+  g_clear_pointer (&self->intern_table, musician_gpt_intern_table_unref);
+  g_clear_pointer (&self->parent, musician_gpt_beat_store_unref);
+
+  g_slice_free (MusicianGptBeatStore, self);
+}
+
+/*
+ * Creates an empty store for a track with @n_measures measures, none of
+ * which are loaded yet. Chords and bends added to it should come from
+ * @intern_table, see _musician_gpt_beat_store_get_intern_table().
+ */
+MusicianGptBeatStore *
+_musician_gpt_beat_store_new (guint                   n_measures,
+                              MusicianGptInternTable *intern_table)
+{
+  MusicianGptBeatStore *self;
+
+  g_return_val_if_fail (intern_table != NULL, NULL);
+
+  self = g_slice_new0 (MusicianGptBeatStore);
+  self->ref_count = 1;
+  self->intern_table = musician_gpt_intern_table_ref (intern_table);
+  self->n_measures = n_measures;
+
+  self->chords = g_array_new (FALSE, FALSE, sizeof (ChordEntry));
+  g_array_set_clear_func (self->chords, chord_entry_clear);
+
+  self->texts = g_array_new (FALSE, FALSE, sizeof (TextEntry));
+  g_array_set_clear_func (self->texts, text_entry_clear);
+
+  self->bends = g_array_new (FALSE, FALSE, sizeof (BendEntry));
+  g_array_set_clear_func (self->bends, bend_entry_clear);
+
+  return self;
+}
+
+MusicianGptInternTable *
+_musician_gpt_beat_store_get_intern_table (MusicianGptBeatStore *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  return self->intern_table;
+}
+
+MusicianGptBeatStore *
+musician_gpt_beat_store_ref (MusicianGptBeatStore *self)
+{
+  g_return_val_if_fail (self, NULL);
+  g_return_val_if_fail (self->ref_count, NULL);
+
+  g_atomic_int_inc (&self->ref_count);
+
+  return self;
+}
+
+void
+musician_gpt_beat_store_unref (MusicianGptBeatStore *self)
+{
+  g_return_if_fail (self);
+  g_return_if_fail (self->ref_count);
+
+  if (g_atomic_int_dec_and_test (&self->ref_count))
+    musician_gpt_beat_store_destroy (self);
+}
+
+static void
+musician_gpt_beat_store_grow (MusicianGptBeatStore *self,
+                              guint                 n_beats)
+{
+  guint n_allocated;
+
+  g_assert (self != NULL);
+
+  if (self->n_beats + n_beats <= self->n_allocated)
+    return;
+
+  /* A slice only ever gets the beats its measures were reserved for */
+  g_assert (self->parent == NULL);
+
+  n_allocated = MAX (N_MIN_BEATS, self->n_allocated);
+  while (n_allocated < self->n_beats + n_beats)
+    n_allocated *= 2;
+
+  self->modes = g_renew (guint8, self->modes, n_allocated);
+  self->durations = g_renew (guint8, self->durations, n_allocated);
+  self->n_tuplets = g_renew (guint8, self->n_tuplets, n_allocated);
+  self->dynamics = g_renew (guint8, self->dynamics, n_allocated);
+  self->flags = g_renew (guint8, self->flags, n_allocated);
+  self->n_allocated = n_allocated;
+}
+
+/* Makes room for the ranges of the first @n_ranges measures */
+static void
+musician_gpt_beat_store_grow_ranges (MusicianGptBeatStore *self,
+                                     guint                 n_ranges)
+{
+  gsize n_allocated;
+
+  g_assert (self != NULL);
+  g_assert (n_ranges <= self->n_measures);
+
+  if (n_ranges <= self->n_ranges)
+    return;
+
+  /* Measures are mostly begun in order, so leave room for the next ones */
+  n_allocated = MAX (N_MIN_BEATS, self->n_ranges);
+  while (n_allocated < n_ranges)
+    n_allocated *= 2;
+  n_allocated = MIN (n_allocated, self->n_measures);
+
+  self->measures = g_renew (MeasureRange, self->measures, n_allocated);
+
+  for (gsize i = self->n_ranges; i < n_allocated; i++)
+    {
+      self->measures[i].first = G_MAXUINT;
+      self->measures[i].n_beats = 0;
+    }
+
+  self->n_ranges = n_allocated;
+}
+
+gboolean
+_musician_gpt_beat_store_is_loaded (MusicianGptBeatStore *self,
+                                    guint                 measure)
+{
+  g_return_val_if_fail (self != NULL, FALSE);
+  g_return_val_if_fail (measure > 0 && measure <= self->n_measures, FALSE);
+
+  return measure <= self->n_ranges && self->measures[measure - 1].first != G_MAXUINT;
+}
+
+/*
+ * Starts the beats of @measure, which must not have been loaded yet. Beats
+ * appended from now on belong to @measure, even if there are none.
+ */
+void
+_musician_gpt_beat_store_begin_measure (MusicianGptBeatStore *self,
+                                        guint                 measure)
+{
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (measure > 0 && measure <= self->n_measures);
+  g_return_if_fail (!_musician_gpt_beat_store_is_loaded (self, measure));
+
+  musician_gpt_beat_store_grow_ranges (self, measure);
+
+  self->measures[measure - 1].first = self->n_beats;
+  self->measures[measure - 1].n_beats = 0;
+  self->current = measure;
+}
+
+/*
+ * Drops the beats of the measure that was begun last, so that it can be
+ * loaded again after a decoding error.
+ */
+void
+_musician_gpt_beat_store_abort_measure (MusicianGptBeatStore *self)
+{
+  MeasureRange *range;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (self->current > 0);
+
+  range = &self->measures[self->current - 1];
+
+  self->n_beats = range->first;
+  side_table_truncate (self->chords, range->first);
+  side_table_truncate (self->texts, range->first);
+  side_table_truncate (self->bends, range->first);
+
+  range->first = G_MAXUINT;
+  range->n_beats = 0;
+  self->current = 0;
+}
+
+void
+_musician_gpt_beat_store_append (MusicianGptBeatStore       *self,
+                                 const MusicianGptBeatEvent *event)
+{
+  guint beat;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (self->current > 0);
+  g_return_if_fail (event != NULL);
+
+  musician_gpt_beat_store_grow (self, 1);
+
+  beat = self->n_beats++;
+  self->measures[self->current - 1].n_beats++;
+
+  self->modes[beat] = event->mode;
+  self->durations[beat] = event->duration;
+  self->n_tuplets[beat] = event->n_tuplet;
+  self->dynamics[beat] = event->dynamics;
+  self->flags[beat] = event->flags;
+
+  if (event->text != NULL)
+    {
+      TextEntry entry = { beat, g_strdup (event->text) };
+
+      g_array_append_val (self->texts, entry);
+    }
+}
+
+/* Sets the chord diagram of the last beat that was appended */
+void
+_musician_gpt_beat_store_set_chord (MusicianGptBeatStore *self,
+                                    MusicianGptChord     *chord)
+{
+  ChordEntry *entry;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (self->n_beats > 0);
+  g_return_if_fail (chord != NULL);
+
+  if (NULL != (entry = side_table_lookup (self->chords, self->n_beats - 1)))
+    {
+      musician_gpt_chord_ref (chord);
+      musician_gpt_chord_unref (entry->chord);
+      entry->chord = chord;
+    }
+  else
+    {
+      ChordEntry new_entry = { self->n_beats - 1, musician_gpt_chord_ref (chord) };
+
+      g_array_append_val (self->chords, new_entry);
+    }
+}
+
+/* Adds a bend of @string (0 for the tremolo bar) to the last beat */
+void
+_musician_gpt_beat_store_add_bend (MusicianGptBeatStore *self,
+                                   guint                 string,
+                                   MusicianGptBend      *bend)
+{
+  BendEntry entry;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (self->n_beats > 0);
+  g_return_if_fail (bend != NULL);
+
+  entry.beat = self->n_beats - 1;
+  entry.string = string;
+  entry.bend = musician_gpt_bend_ref (bend);
+
+  g_array_append_val (self->bends, entry);
+}
+
+/*
+ * Lays out every measure of @self up front, measure i having n_beats[i]
+ * beats, so that slices of it can be filled in on several threads at
+ * once. @self must be empty. The beats are undefined until the slices
+ * have been committed with _musician_gpt_beat_store_commit_slice().
+ */
+void
+_musician_gpt_beat_store_reserve (MusicianGptBeatStore *self,
+                                  const guint32        *n_beats)
+{
+  guint64 total = 0;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (self->parent == NULL);
+  g_return_if_fail (self->n_beats == 0);
+  g_return_if_fail (self->n_ranges == 0);
+  g_return_if_fail (n_beats != NULL || self->n_measures == 0);
+
+  for (guint i = 0; i < self->n_measures; i++)
+    total += n_beats[i];
+
+  g_return_if_fail (total < G_MAXUINT);
+
+  musician_gpt_beat_store_grow_ranges (self, self->n_measures);
+
+  /* Exactly what is needed, as nothing is appended after the slices */
+  self->n_allocated = MAX (total, 1);
+  self->modes = g_renew (guint8, self->modes, self->n_allocated);
+  self->durations = g_renew (guint8, self->durations, self->n_allocated);
+  self->n_tuplets = g_renew (guint8, self->n_tuplets, self->n_allocated);
+  self->dynamics = g_renew (guint8, self->dynamics, self->n_allocated);
+  self->flags = g_renew (guint8, self->flags, self->n_allocated);
+
+  for (guint i = 0; i < self->n_measures; i++)
+    {
+      self->measures[i].first = self->n_beats;
+      self->measures[i].n_beats = n_beats[i];
+      self->n_beats += n_beats[i];
+    }
+}
+
+/*
+ * Creates a store for @n_measures measures of @self, starting at
+ * @first_measure, which must have been reserved with
+ * _musician_gpt_beat_store_reserve(). The slice writes its beats straight
+ * into the columns of @self and numbers its measures from 1, but keeps
+ * its own side tables until it is committed.
+ */
+MusicianGptBeatStore *
+_musician_gpt_beat_store_new_slice (MusicianGptBeatStore *self,
+                                    guint                 first_measure,
+                                    guint                 n_measures)
+{
+  MusicianGptBeatStore *slice;
+  guint first;
+  guint n_beats = 0;
+
+  g_return_val_if_fail (self != NULL, NULL);
+  g_return_val_if_fail (self->parent == NULL, NULL);
+  g_return_val_if_fail (first_measure > 0, NULL);
+  g_return_val_if_fail (n_measures > 0, NULL);
+  g_return_val_if_fail (first_measure - 1 + n_measures <= self->n_ranges, NULL);
+
+  first = self->measures[first_measure - 1].first;
+
+  for (guint i = 0; i < n_measures; i++)
+    n_beats += self->measures[first_measure - 1 + i].n_beats;
+
+  slice = _musician_gpt_beat_store_new (n_measures, self->intern_table);
+  slice->parent = musician_gpt_beat_store_ref (self);
+  slice->offset = first;
+  slice->n_allocated = n_beats;
+  slice->modes = self->modes + first;
+  slice->durations = self->durations + first;
+  slice->n_tuplets = self->n_tuplets + first;
+  slice->dynamics = self->dynamics + first;
+  slice->flags = self->flags + first;
+
+  return slice;
+}
+
+/*
+ * Moves the chords, texts and bends of @slice into @self. Slices must be
+ * committed in the order of their measures, which keeps the side tables
+ * of @self sorted, and only once every beat of theirs has been appended.
+ */
+void
+_musician_gpt_beat_store_commit_slice (MusicianGptBeatStore *self,
+                                       MusicianGptBeatStore *slice)
+{
+  guint offset;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (slice != NULL);
+  g_return_if_fail (slice->parent == self);
+  g_return_if_fail (slice->n_beats == slice->n_allocated);
+
+  offset = slice->offset;
+
+  for (guint i = 0; i < slice->chords->len; i++)
+    {
+      ChordEntry entry = g_array_index (slice->chords, ChordEntry, i);
+
+      entry.beat += offset;
+      g_array_append_val (self->chords, entry);
+    }
+
+  for (guint i = 0; i < slice->texts->len; i++)
+    {
+      TextEntry entry = g_array_index (slice->texts, TextEntry, i);
+
+      entry.beat += offset;
+      g_array_append_val (self->texts, entry);
+    }
+
+  for (guint i = 0; i < slice->bends->len; i++)
+    {
+      BendEntry entry = g_array_index (slice->bends, BendEntry, i);
+
+      entry.beat += offset;
+      g_array_append_val (self->bends, entry);
+    }
+
+  /* @self owns the entries now */
+  g_array_set_clear_func (slice->chords, NULL);
+  g_array_set_clear_func (slice->texts, NULL);
+  g_array_set_clear_func (slice->bends, NULL);
+  g_array_set_size (slice->chords, 0);
+  g_array_set_size (slice->texts, 0);
+  g_array_set_size (slice->bends, 0);
+}
+
+guint
+musician_gpt_beat_store_get_n_beats (MusicianGptBeatStore *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->n_beats;
+}
+
+guint
+musician_gpt_beat_store_get_n_measures (MusicianGptBeatStore *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->n_measures;
+}
+
+/**
+ * musician_gpt_beat_store_get_measure:
+ * @self: A #MusicianGptBeatStore
+ * @measure: The measure, starting from 1
+ * @first_beat: (out): A location for the index of the first beat
+ * @n_beats: (out): A location for the number of beats
+ *
+ * Gets the range of beats that make up @measure. A measure without beats
+ * has an empty range.
+ *
+ * Returns: %TRUE if @measure is part of the track.
+ */
+gboolean
+musician_gpt_beat_store_get_measure (MusicianGptBeatStore *self,
+                                     guint                 measure,
+                                     guint                *first_beat,
+                                     guint                *n_beats)
+{
+  const MeasureRange *range;
+
+  g_return_val_if_fail (self != NULL, FALSE);
+  g_return_val_if_fail (first_beat != NULL, FALSE);
+  g_return_val_if_fail (n_beats != NULL, FALSE);
+
+  if (measure == 0 || measure > self->n_measures)
+    return FALSE;
+
+  range = measure <= self->n_ranges ? &self->measures[measure - 1] : NULL;
+
+  if (range == NULL || range->first == G_MAXUINT)
+    {
+      *first_beat = 0;
+      *n_beats = 0;
+    }
+  else
+    {
+      *first_beat = range->first;
+      *n_beats = range->n_beats;
+    }
+
+  return TRUE;
+}
+
+/**
+ * musician_gpt_beat_store_get_modes:
+ * @self: A #MusicianGptBeatStore
+ *
+ * Gets the #MusicianGptBeatMode of every beat in @self. This and the other
+ * columns have musician_gpt_beat_store_get_n_beats() elements and are only
+ * valid until more beats are loaded into @self.
+ *
+ * Returns: (transfer none): The modes of the beats.
+ */
+const guint8 *
+musician_gpt_beat_store_get_modes (MusicianGptBeatStore *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  return self->modes;
+}
+
+/**
+ * musician_gpt_beat_store_get_durations:
+ * @self: A #MusicianGptBeatStore
+ *
+ * Returns: (transfer none): The durations of the beats.
+ */
+const guint8 *
+musician_gpt_beat_store_get_durations (MusicianGptBeatStore *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  return self->durations;
+}
+
+/**
+ * musician_gpt_beat_store_get_n_tuplets:
+ * @self: A #MusicianGptBeatStore
+ *
+ * Returns: (transfer none): The tuplets of the beats, 0 for none.
+ */
+const guint8 *
+musician_gpt_beat_store_get_n_tuplets (MusicianGptBeatStore *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  return self->n_tuplets;
+}
+
+/**
+ * musician_gpt_beat_store_get_dynamics:
+ * @self: A #MusicianGptBeatStore
+ *
+ * Returns: (transfer none): The #MusicianGptDynamics of the beats.
+ */
+const guint8 *
+musician_gpt_beat_store_get_dynamics (MusicianGptBeatStore *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  return self->dynamics;
+}
+
+/**
+ * musician_gpt_beat_store_get_flags:
+ * @self: A #MusicianGptBeatStore
+ *
+ * Returns: (transfer none): The #MusicianGptBeatFlags of the beats.
+ */
+const guint8 *
+musician_gpt_beat_store_get_flags (MusicianGptBeatStore *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  return self->flags;
+}
+
+/**
+ * musician_gpt_beat_store_get_view:
+ * @self: A #MusicianGptBeatStore
+ * @beat: The index of the beat
+ * @view: (out caller-allocates): A #MusicianGptBeatView to fill in
+ *
+ * Fills in @view with everything that is known about @beat, without
+ * allocating anything.
+ */
+void
+musician_gpt_beat_store_get_view (MusicianGptBeatStore *self,
+                                  guint                 beat,
+                                  MusicianGptBeatView  *view)
+{
+  const ChordEntry *chord;
+  const TextEntry *text;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (beat < self->n_beats);
+  g_return_if_fail (view != NULL);
+
+  view->mode = self->modes[beat];
+  view->duration = self->durations[beat];
+  view->n_tuplet = self->n_tuplets[beat];
+  view->dynamics = self->dynamics[beat];
+  view->flags = self->flags[beat];
+
+  chord = side_table_lookup (self->chords, beat);
+  view->chord = chord ? chord->chord : NULL;
+
+  text = side_table_lookup (self->texts, beat);
+  view->text = text ? text->text : NULL;
+
+  view->n_bends = 0;
+  for (guint i = side_table_find (self->bends, beat);
+       i < self->bends->len && g_array_index (self->bends, BendEntry, i).beat == beat;
+       i++)
+    view->n_bends++;
+}
+
+/**
+ * musician_gpt_beat_store_get_bend:
+ * @self: A #MusicianGptBeatStore
+ * @beat: The index of the beat
+ * @nth: Which of the bends of @beat to get
+ * @string: (out) (optional): A location for the string that is bent, 0 for
+ *   the tremolo bar
+ *
+ * Gets one of the bends of @beat. There are #MusicianGptBeatView.n_bends
+ * of them.
+ *
+ * Returns: (transfer none) (nullable): A #MusicianGptBend or %NULL.
+ */
+MusicianGptBend *
+musician_gpt_beat_store_get_bend (MusicianGptBeatStore *self,
+                                  guint                 beat,
+                                  guint                 nth,
+                                  guint                *string)
+{
+  const BendEntry *entry;
+  guint index;
+
+  g_return_val_if_fail (self != NULL, NULL);
+  g_return_val_if_fail (beat < self->n_beats, NULL);
+
+  if (nth >= self->bends->len)
+    return NULL;
+
+  index = side_table_find (self->bends, beat) + nth;
+
+  if (index >= self->bends->len)
+    return NULL;
+
+  entry = &g_array_index (self->bends, BendEntry, index);
+
+  if (entry->beat != beat)
+    return NULL;
+
+  if (string != NULL)
+    *string = entry->string;
+
+  return entry->bend;
+}
@@ -0,0 +1,84 @@
+/* musician-gpt-beat-store.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_BEAT_STORE_H
+#define MUSICIAN_GPT_BEAT_STORE_H
+
+#include <gio/gio.h>
+
+#include "musician-gpt-types.h"
+
+G_BEGIN_DECLS
+
+#define MUSICIAN_TYPE_GPT_BEAT_STORE (musician_gpt_beat_store_get_type())
+
+/**
+ * MusicianGptBeatView:
+ * @mode: The #MusicianGptBeatMode of the beat.
+ * @duration: The duration of the beat.
+ * @n_tuplet: The tuplet the beat belongs to, or 0.
+ * @dynamics: The #MusicianGptDynamics of the beat.
+ * @flags: The #MusicianGptBeatFlags the beat was stored with.
+ * @chord: (nullable): The chord diagram of the beat, owned by the store.
+ * @text: (nullable): The text of the beat, owned by the store.
+ * @n_bends: The number of bends on the beat, see
+ *   musician_gpt_beat_store_get_bend().
+ *
+ * A beat as it is found in a #MusicianGptBeatStore. It is filled in on the
+ * stack and borrows from the store, so it is only valid for as long as the
+ * store is.
+ */
+typedef struct
+{
+  MusicianGptBeatMode   mode;
+  guint                 duration;
+  guint                 n_tuplet;
+  MusicianGptDynamics   dynamics;
+  MusicianGptBeatFlags  flags;
+  MusicianGptChord     *chord;
+  const gchar          *text;
+  guint                 n_bends;
+} MusicianGptBeatView;
+
+GType                 musician_gpt_beat_store_get_type       (void);
+MusicianGptBeatStore *musician_gpt_beat_store_ref            (MusicianGptBeatStore *self);
+void                  musician_gpt_beat_store_unref          (MusicianGptBeatStore *self);
+guint                 musician_gpt_beat_store_get_n_beats    (MusicianGptBeatStore *self);
+guint                 musician_gpt_beat_store_get_n_measures (MusicianGptBeatStore *self);
+gboolean              musician_gpt_beat_store_get_measure    (MusicianGptBeatStore *self,
+                                                              guint                 measure,
+                                                              guint                *first_beat,
+                                                              guint                *n_beats);
+const guint8         *musician_gpt_beat_store_get_modes      (MusicianGptBeatStore *self);
+const guint8         *musician_gpt_beat_store_get_durations  (MusicianGptBeatStore *self);
+const guint8         *musician_gpt_beat_store_get_n_tuplets  (MusicianGptBeatStore *self);
+const guint8         *musician_gpt_beat_store_get_dynamics   (MusicianGptBeatStore *self);
+const guint8         *musician_gpt_beat_store_get_flags      (MusicianGptBeatStore *self);
+void                  musician_gpt_beat_store_get_view       (MusicianGptBeatStore *self,
+                                                              guint                 beat,
+                                                              MusicianGptBeatView  *view);
+MusicianGptBend      *musician_gpt_beat_store_get_bend       (MusicianGptBeatStore *self,
+                                                              guint                 beat,
+                                                              guint                 nth,
+                                                              guint                *string);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MusicianGptBeatStore, musician_gpt_beat_store_unref)
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_BEAT_STORE_H */
@@ -18,13 +18,14 @@
 
 #define G_LOG_DOMAIN "musician-gpt-beat"
 
-#include "musician-gpt-beat.h"
+#include "musician-gpt-beat-private.h"
 #include "musician-gpt-chord.h"
 
 struct _MusicianGptBeat
 {
   volatile gint        ref_count;
 
+  MusicianGptPool     *pool;
   MusicianGptChord    *chord;
   gchar               *text;
 
@@ -46,7 +47,16 @@ musician_gpt_beat_destroy (MusicianGptBeat *self)
     {
       g_clear_pointer (&self->chord, musician_gpt_chord_unref);
       g_clear_pointer (&self->text, g_free);
-      g_slice_free (MusicianGptBeat, self);
+
+      if (self->pool != NULL)
+        {
+          MusicianGptPool *pool = self->pool;
+
+          musician_gpt_pool_free (pool, MUSICIAN_GPT_POOL_BEAT, self);
+          musician_gpt_pool_unref (pool);
+        }
+      else
+        g_slice_free (MusicianGptBeat, self);
     }
 }
 
@@ -62,6 +72,21 @@ musician_gpt_beat_new (void)
   return self;
 }
 
+MusicianGptBeat *
+_musician_gpt_beat_new_from_pool (MusicianGptPool *pool)
+{
+  MusicianGptBeat *self;
+
+  g_return_val_if_fail (pool != NULL, NULL);
+
+  self = musician_gpt_pool_alloc0 (pool, MUSICIAN_GPT_POOL_BEAT, sizeof *self);
+  self->ref_count = 1;
+  self->pool = musician_gpt_pool_ref (pool);
+  self->mode = MUSICIAN_GPT_BEAT_MODE_NORMAL;
+
+  return self;
+}
+
 MusicianGptBeat *
 musician_gpt_beat_ref (MusicianGptBeat *self)
 {
@@ -192,7 +217,7 @@ musician_gpt_beat_set_text (MusicianGptBeat *self,
 {
   g_return_if_fail (self != NULL);
 
-  if (g_strcmp0 (self->text, text) == 0)
+  if (g_strcmp0 (self->text, text) != 0)
     {
       g_free (self->text);
       self->text = g_strdup (text);
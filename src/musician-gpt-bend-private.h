@@ -0,0 +1,35 @@
+/* musician-gpt-bend-private.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_BEND_PRIVATE_H
+#define MUSICIAN_GPT_BEND_PRIVATE_H
+
+#include "musician-gpt-bend.h"
+#include "musician-gpt-pool.h"
+
+G_BEGIN_DECLS
+
+MusicianGptBend *_musician_gpt_bend_new_from_pool (MusicianGptPool *pool);
+void             _musician_gpt_bend_freeze        (MusicianGptBend *self);
+guint            _musician_gpt_bend_hash          (gconstpointer    data);
+gboolean         _musician_gpt_bend_equal         (gconstpointer    a,
+                                                   gconstpointer    b);
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_BEND_PRIVATE_H */
@@ -18,13 +18,26 @@
 
 #define G_LOG_DOMAIN "musician-gpt-bend"
 
-#include "musician-gpt-bend.h"
+#include "musician-gpt-bend-private.h"
+
+/*
+ * Nearly every bend in the wild has a dozen points or fewer, so they are
+ * kept inline and only spill into a GArray past that.
+ */
+#define N_INLINE_POINTS 12
 
 struct _MusicianGptBend
 {
-  volatile gint ref_count;
-  GArray *points;
-  MusicianGptBendType bend_type;
+  volatile gint         ref_count;
+  MusicianGptPool      *pool;
+  GArray               *points;
+  MusicianGptBendType   bend_type;
+  guint                 n_points;
+
+  /* Interned bends are shared, so they can no longer be changed */
+  gboolean              frozen;
+
+  MusicianGptBendPoint  inline_points[N_INLINE_POINTS];
 };
 
 G_DEFINE_BOXED_TYPE (MusicianGptBend,
@@ -39,7 +52,20 @@ musician_gpt_bend_new (void)
 
   self = g_slice_new0 (MusicianGptBend);
   self->ref_count = 1;
-  self->points = g_array_new (FALSE, FALSE, sizeof (MusicianGptBendPoint));
+
+  return self;
+}
+
+MusicianGptBend *
+_musician_gpt_bend_new_from_pool (MusicianGptPool *pool)
+{
+  MusicianGptBend *self;
+
+  g_return_val_if_fail (pool != NULL, NULL);
+
+  self = musician_gpt_pool_alloc0 (pool, MUSICIAN_GPT_POOL_BEND, sizeof *self);
+  self->ref_count = 1;
+  self->pool = musician_gpt_pool_ref (pool);
 
   return self;
 }
@@ -52,7 +78,15 @@ musician_gpt_bend_free (MusicianGptBend *self)
 
   g_clear_pointer (&self->points, g_array_unref);
 
-  g_slice_free (MusicianGptBend, self);
+  if (self->pool != NULL)
+    {
+      MusicianGptPool *pool = self->pool;
+
+      musician_gpt_pool_free (pool, MUSICIAN_GPT_POOL_BEND, self);
+      musician_gpt_pool_unref (pool);
+    }
+  else
+    g_slice_free (MusicianGptBend, self);
 }
 
 MusicianGptBend *
@@ -81,15 +115,125 @@ musician_gpt_bend_set_bend_type (MusicianGptBend     *self,
                                  MusicianGptBendType  bend_type)
 {
   g_return_if_fail (self != NULL);
+  g_return_if_fail (!self->frozen);
 
   self->bend_type = bend_type;
 }
 
+MusicianGptBendType
+musician_gpt_bend_get_bend_type (MusicianGptBend *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->bend_type;
+}
+
 void
 musician_gpt_bend_add_point (MusicianGptBend            *self,
                              const MusicianGptBendPoint *point)
 {
   g_return_if_fail (self != NULL);
+  g_return_if_fail (!self->frozen);
+  g_return_if_fail (point != NULL);
+
+  if (self->points != NULL)
+    {
+      g_array_append_vals (self->points, point, 1);
+    }
+  else if (self->n_points < N_INLINE_POINTS)
+    {
+      self->inline_points[self->n_points] = *point;
+    }
+  else
+    {
+      self->points = g_array_sized_new (FALSE, FALSE, sizeof (MusicianGptBendPoint),
+                                        N_INLINE_POINTS * 2);
+      g_array_append_vals (self->points, self->inline_points, N_INLINE_POINTS);
+      g_array_append_vals (self->points, point, 1);
+    }
+
+  self->n_points++;
+}
+
+/**
+ * musician_gpt_bend_get_points:
+ * @self: A #MusicianGptBend
+ * @n_points: (out): A location for the number of points
+ *
+ * Returns: (transfer none) (array length=n_points): The points of @self.
+ */
+const MusicianGptBendPoint *
+musician_gpt_bend_get_points (MusicianGptBend *self,
+                              guint           *n_points)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+  g_return_val_if_fail (n_points != NULL, NULL);
 
-  g_array_append_vals (self->points, point, 1);
+  *n_points = self->n_points;
+
+  if (self->points != NULL)
+    return (const MusicianGptBendPoint *)(gpointer)self->points->data;
+
+  return self->inline_points;
+}
+
+/* Bends are frozen once they have been interned and may be shared */
+void
+_musician_gpt_bend_freeze (MusicianGptBend *self)
+{
+  g_return_if_fail (self != NULL);
+
+  self->frozen = TRUE;
+}
+
+guint
+_musician_gpt_bend_hash (gconstpointer data)
+{
+  MusicianGptBend *self = (MusicianGptBend *)data;
+  const MusicianGptBendPoint *points;
+  guint n_points;
+  guint hash;
+
+  points = musician_gpt_bend_get_points (self, &n_points);
+  hash = self->bend_type * 31 + n_points;
+
+  for (guint i = 0; i < n_points; i++)
+    {
+      hash = hash * 31 + points[i].absolute_position;
+      hash = hash * 31 + points[i].vertical_position;
+      hash = hash * 31 + points[i].vibrato;
+    }
+
+  return hash;
+}
+
+gboolean
+_musician_gpt_bend_equal (gconstpointer a,
+                          gconstpointer b)
+{
+  MusicianGptBend *bend_a = (MusicianGptBend *)a;
+  MusicianGptBend *bend_b = (MusicianGptBend *)b;
+  const MusicianGptBendPoint *points_a;
+  const MusicianGptBendPoint *points_b;
+  guint n_points_a;
+  guint n_points_b;
+
+  if (bend_a->bend_type != bend_b->bend_type)
+    return FALSE;
+
+  points_a = musician_gpt_bend_get_points (bend_a, &n_points_a);
+  points_b = musician_gpt_bend_get_points (bend_b, &n_points_b);
+
+  if (n_points_a != n_points_b)
+    return FALSE;
+
+  for (guint i = 0; i < n_points_a; i++)
+    {
+      if (points_a[i].absolute_position != points_b[i].absolute_position ||
+          points_a[i].vertical_position != points_b[i].vertical_position ||
+          points_a[i].vibrato != points_b[i].vibrato)
+        return FALSE;
+    }
+
+  return TRUE;
 }
@@ -27,14 +27,16 @@ G_BEGIN_DECLS
 
 #define MUSICIAN_TYPE_GPT_BEND (musician_gpt_bend_get_type())
 
-MusicianGptBend     *musician_gpt_bend_new           (void);
-MusicianGptBend     *musician_gpt_bend_ref           (MusicianGptBend            *self);
-void                 musician_gpt_bend_unref         (MusicianGptBend            *self);
-MusicianGptBendType  musician_gpt_bend_get_bend_type (MusicianGptBend            *self);
-void                 musician_gpt_bend_set_bend_type (MusicianGptBend            *self,
-                                                      MusicianGptBendType         bend_type);
-void                 musician_gpt_bend_add_point     (MusicianGptBend            *self,
-                                                      const MusicianGptBendPoint *point);
+MusicianGptBend            *musician_gpt_bend_new           (void);
+MusicianGptBend            *musician_gpt_bend_ref           (MusicianGptBend            *self);
+void                        musician_gpt_bend_unref         (MusicianGptBend            *self);
+MusicianGptBendType         musician_gpt_bend_get_bend_type (MusicianGptBend            *self);
+void                        musician_gpt_bend_set_bend_type (MusicianGptBend            *self,
+                                                             MusicianGptBendType         bend_type);
+void                        musician_gpt_bend_add_point     (MusicianGptBend            *self,
+                                                             const MusicianGptBendPoint *point);
+const MusicianGptBendPoint *musician_gpt_bend_get_points    (MusicianGptBend            *self,
+                                                             guint                      *n_points);
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (MusicianGptBend, musician_gpt_bend_unref)
 
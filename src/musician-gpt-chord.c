@@ -18,11 +18,13 @@
 
 #define G_LOG_DOMAIN "musician-gpt-chord"
 
-#include "musician-gpt-chord.h"
+#include "musician-gpt-chord-private.h"
 
 struct _MusicianGptChord
 {
-  volatile gint ref_count;
+  volatile gint    ref_count;
+  MusicianGptPool *pool;
+  gchar           *name;
 };
 
 G_DEFINE_BOXED_TYPE (MusicianGptChord,
@@ -41,13 +43,39 @@ musician_gpt_chord_new (void)
   return self;
 }
 
+MusicianGptChord *
+_musician_gpt_chord_new_from_pool (MusicianGptPool *pool,
+                                   const gchar     *name)
+{
+  MusicianGptChord *self;
+
+  g_return_val_if_fail (pool != NULL, NULL);
+
+  self = musician_gpt_pool_alloc0 (pool, MUSICIAN_GPT_POOL_CHORD, sizeof *self);
+  self->ref_count = 1;
+  self->pool = musician_gpt_pool_ref (pool);
+  self->name = g_strdup (name);
+
+  return self;
+}
+
 static void
 musician_gpt_chord_free (MusicianGptChord *self)
 {
   g_assert (self);
   g_assert_cmpint (self->ref_count, ==, 0);
 
-  g_slice_free (MusicianGptChord, self);
+  g_clear_pointer (&self->name, g_free);
+
+  if (self->pool != NULL)
+    {
+      MusicianGptPool *pool = self->pool;
+
+      musician_gpt_pool_free (pool, MUSICIAN_GPT_POOL_CHORD, self);
+      musician_gpt_pool_unref (pool);
+    }
+  else
+    g_slice_free (MusicianGptChord, self);
 }
 
 MusicianGptChord *
@@ -70,3 +98,35 @@ musician_gpt_chord_unref (MusicianGptChord *self)
   if (g_atomic_int_dec_and_test (&self->ref_count))
     musician_gpt_chord_free (self);
 }
+
+/**
+ * musician_gpt_chord_get_name:
+ * @self: A #MusicianGptChord
+ *
+ * Returns: (nullable): the name of the chord diagram, such as "Am7".
+ */
+const gchar *
+musician_gpt_chord_get_name (MusicianGptChord *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  return self->name;
+}
+
+guint
+_musician_gpt_chord_hash (gconstpointer data)
+{
+  const MusicianGptChord *self = data;
+
+  return self->name ? g_str_hash (self->name) : 0;
+}
+
+gboolean
+_musician_gpt_chord_equal (gconstpointer a,
+                           gconstpointer b)
+{
+  const MusicianGptChord *chord_a = a;
+  const MusicianGptChord *chord_b = b;
+
+  return g_strcmp0 (chord_a->name, chord_b->name) == 0;
+}
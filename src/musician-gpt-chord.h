@@ -31,6 +31,7 @@ GType             musician_gpt_chord_get_type (void);
 MusicianGptChord *musician_gpt_chord_new      (void);
 MusicianGptChord *musician_gpt_chord_ref      (MusicianGptChord *self);
 void              musician_gpt_chord_unref    (MusicianGptChord *self);
+const gchar      *musician_gpt_chord_get_name (MusicianGptChord *self);
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (MusicianGptChord, musician_gpt_chord_unref)
 
@@ -0,0 +1,158 @@
+/* musician-gpt-events.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_EVENTS_H
+#define MUSICIAN_GPT_EVENTS_H
+
+#include <gdk/gdk.h>
+
+#include "musician-gpt-types.h"
+
+G_BEGIN_DECLS
+
+/*
+ * These are handed to the callbacks of #MusicianGptEvents, one for each
+ * record as it is decoded. The events live on the stack of the decoder and
+ * the strings and arrays they point to are only valid until the callback
+ * returns, so copy anything that is needed after that.
+ */
+
+typedef struct
+{
+  const gchar               *version;
+  const gchar               *title;
+  const gchar               *subtitle;
+  const gchar               *interpretation;
+  const gchar               *album;
+  const gchar               *artist;
+  const gchar               *copyright;
+  const gchar               *writer;
+  const gchar               *instructions;
+  MusicianGptTripletFeel     triplet_feel;
+  const gchar               *lyrics[5];
+  guint32                    lyrics_positions[5];
+  guint32                    tempo;
+  MusicianGptKey             key;
+  MusicianGptOctave          octave;
+  const MusicianGptMidiPort *ports;
+  guint                      n_ports;
+  guint32                    n_measures;
+  guint32                    n_tracks;
+} MusicianGptHeaderEvent;
+
+typedef struct
+{
+  guint32                  id;
+  MusicianGptMeasureFlags  flags;
+  guint8                   numerator;
+  guint8                   denominator;
+  guint8                   n_repeats;
+  guint8                   nth_ending;
+  gint8                    key;
+  const gchar             *marker_name;
+  GdkRGBA                  marker_color;
+} MusicianGptMeasureHeaderEvent;
+
+typedef struct
+{
+  guint32                  id;
+  MusicianGptTrackFlags    flags;
+  const gchar             *title;
+  const MusicianGptTuning *tunings;
+  guint                    n_strings;
+  guint32                  port;
+  guint32                  channel;
+  guint32                  effects_channel;
+  guint32                  n_frets;
+  guint32                  capo_at;
+  GdkRGBA                  color;
+} MusicianGptTrackEvent;
+
+typedef struct
+{
+  guint32               measure;
+  guint32               track;
+  guint32               index;
+  MusicianGptBeatFlags  flags;
+  MusicianGptBeatMode   mode;
+  guint                 duration;
+  guint                 n_tuplet;
+  MusicianGptDynamics   dynamics;
+  const gchar          *text;
+  guint8                strings_played;
+} MusicianGptBeatEvent;
+
+typedef struct
+{
+  guint32                     measure;
+  guint32                     track;
+  guint32                     beat;
+  guint                       string;
+  MusicianGptBendType         bend_type;
+  const MusicianGptBendPoint *points;
+  guint                       n_points;
+} MusicianGptBendEvent;
+
+typedef struct
+{
+  guint32      measure;
+  guint32      track;
+  guint32      beat;
+  const gchar *name;
+} MusicianGptChordEvent;
+
+/**
+ * MusicianGptEvents:
+ * @on_header: Called once, after everything up to the measure headers.
+ * @on_measure_header: Called for each measure header, in order.
+ * @on_track: Called for each track, after all of the measure headers.
+ * @on_beat: Called for each beat, measure by measure and track by track.
+ * @on_bend: Called after the #MusicianGptEvents.on_beat of the beat it belongs
+ *   to. The string is 0 for the tremolo bar, or 1-7 for a bent note.
+ * @on_chord: Called after the #MusicianGptEvents.on_beat of the beat it
+ *   belongs to.
+ *
+ * Callbacks for musician_gpt_parser_parse_from_stream() and friends. Any
+ * of them may be %NULL. Setting @error from a callback stops the parse and
+ * the error is returned to the caller.
+ */
+typedef struct
+{
+  void (*on_header)         (const MusicianGptHeaderEvent         *event,
+                             gpointer                              user_data,
+                             GError                              **error);
+  void (*on_measure_header) (const MusicianGptMeasureHeaderEvent  *event,
+                             gpointer                              user_data,
+                             GError                              **error);
+  void (*on_track)          (const MusicianGptTrackEvent          *event,
+                             gpointer                              user_data,
+                             GError                              **error);
+  void (*on_beat)           (const MusicianGptBeatEvent           *event,
+                             gpointer                              user_data,
+                             GError                              **error);
+  void (*on_bend)           (const MusicianGptBendEvent           *event,
+                             gpointer                              user_data,
+                             GError                              **error);
+  void (*on_chord)          (const MusicianGptChordEvent          *event,
+                             gpointer                              user_data,
+                             GError                              **error);
+} MusicianGptEvents;
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_EVENTS_H */
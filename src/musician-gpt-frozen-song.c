@@ -0,0 +1,539 @@
+/* musician-gpt-frozen-song.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "musician-gpt-frozen-song"
+
+#include <string.h>
+
+#include "musician-gpt-frozen-song.h"
+#include "musician-gpt-frozen-song-private.h"
+#include "musician-gpt-snapshot-private.h"
+
+/**
+ * SECTION:musician-gpt-frozen-song
+ * @title: MusicianGptFrozenSong
+ * @short_description: A read-only copy of a song for sharing between threads
+ *
+ * A #MusicianGptFrozenSong is created with musician_gpt_song_freeze() and
+ * can never change afterwards. The whole song, from its header down to
+ * the points of each bend, lives in a single allocation together with
+ * its reference count, so it is shared by taking one reference rather
+ * than one per track, measure and beat.
+ *
+ * None of the accessors take a lock or touch a reference count. They
+ * fill in structures on the stack, such as #MusicianGptFrozenBeat, that
+ * point into the frozen song and are valid for as long as it is alive.
+ * Any number of threads may read from the same frozen song at once.
+ *
+ * Measures, tracks and lyrics are looked up by their position in the
+ * song, starting at 0. Beats are looked up by the id of their measure
+ * and track, as with musician_gpt_song_get_beats().
+ */
+
+struct _MusicianGptFrozenSong
+{
+  volatile gint         ref_count;
+  const SnapshotHeader *header;
+
+  /* The snapshot itself, which SnapshotHeader starts */
+  guint64               data[];
+};
+
+G_DEFINE_BOXED_TYPE (MusicianGptFrozenSong,
+                     musician_gpt_frozen_song,
+                     musician_gpt_frozen_song_ref,
+                     musician_gpt_frozen_song_unref)
+
+#define frozen_song_records(self, section, Type) \
+  ((const Type *)(gconstpointer)((const guint8 *)(self)->data + (self)->header->section.offset))
+
+MusicianGptFrozenSong *
+_musician_gpt_frozen_song_new (GBytes *snapshot)
+{
+  MusicianGptFrozenSong *self;
+  gconstpointer data;
+  gsize len;
+
+  g_return_val_if_fail (snapshot != NULL, NULL);
+
+  data = g_bytes_get_data (snapshot, &len);
+
+  g_return_val_if_fail (len >= sizeof (SnapshotHeader), NULL);
+
+  self = g_malloc (sizeof *self + len);
+  self->ref_count = 1;
+  self->header = (const SnapshotHeader *)(gconstpointer)self->data;
+  memcpy (self->data, data, len);
+
+  g_assert (self->header->version == SNAPSHOT_VERSION);
+  g_assert (self->header->len == len);
+
+  return self;
+}
+
+MusicianGptFrozenSong *
+musician_gpt_frozen_song_ref (MusicianGptFrozenSong *self)
+{
+  g_return_val_if_fail (self, NULL);
+  g_return_val_if_fail (self->ref_count, NULL);
+
+  g_atomic_int_inc (&self->ref_count);
+
+  return self;
+}
+
+void
+musician_gpt_frozen_song_unref (MusicianGptFrozenSong *self)
+{
+  g_return_if_fail (self);
+  g_return_if_fail (self->ref_count);
+
+  if (g_atomic_int_dec_and_test (&self->ref_count))
+    g_free (self);
+}
+
+/*
+ * The snapshot was written by musician_gpt_snapshot_serialize() in this
+ * process, so its offsets are trusted and not checked again.
+ */
+static const gchar *
+frozen_song_string (MusicianGptFrozenSong *self,
+                    guint32                offset)
+{
+  if (offset == 0)
+    return NULL;
+
+  return &frozen_song_records (self, strings, gchar)[offset];
+}
+
+static const SnapshotBlock *
+frozen_song_get_block (MusicianGptFrozenSong *self,
+                       guint                  measure,
+                       guint                  track)
+{
+  const SnapshotHeader *header = self->header;
+
+  if (measure == 0 || measure > header->n_block_measures ||
+      track == 0 || track > header->n_block_tracks)
+    return NULL;
+
+  return &frozen_song_records (self, blocks, SnapshotBlock)[(measure - 1) * header->n_block_tracks + (track - 1)];
+}
+
+/*
+ * The bends of a block are sorted by beat, so the bends of @beat are the
+ * run that starts at the first bend not before it.
+ */
+static const SnapshotBend *
+frozen_song_find_bends (MusicianGptFrozenSong *self,
+                        const SnapshotBlock   *block,
+                        guint                  beat,
+                        guint                 *n_bends)
+{
+  const SnapshotBend *bends = &frozen_song_records (self, bends, SnapshotBend)[block->first_bend];
+  guint lo = 0;
+  guint hi = block->n_bends;
+  guint end;
+
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (bends[mid].beat < beat)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  for (end = lo; end < block->n_bends && bends[end].beat == beat; end++)
+    ;
+
+  *n_bends = end - lo;
+
+  return &bends[lo];
+}
+
+#define DEFINE_STRING_GETTER(name, field)                                   \
+const gchar *                                                               \
+musician_gpt_frozen_song_get_##name (MusicianGptFrozenSong *self)           \
+{                                                                           \
+  g_return_val_if_fail (self != NULL, NULL);                                \
+                                                                            \
+  return frozen_song_string (self, self->header->field);                    \
+}
+
+/**
+ * musician_gpt_frozen_song_get_album:
+ * @self: A #MusicianGptFrozenSong
+ *
+ * Returns: (nullable): The album of the song.
+ */
+DEFINE_STRING_GETTER (album, album)
+
+/**
+ * musician_gpt_frozen_song_get_artist:
+ * @self: A #MusicianGptFrozenSong
+ *
+ * Returns: (nullable): The artist of the song.
+ */
+DEFINE_STRING_GETTER (artist, artist)
+
+/**
+ * musician_gpt_frozen_song_get_copyright:
+ * @self: A #MusicianGptFrozenSong
+ *
+ * Returns: (nullable): The copyright of the song.
+ */
+DEFINE_STRING_GETTER (copyright, copyright)
+
+/**
+ * musician_gpt_frozen_song_get_instructions:
+ * @self: A #MusicianGptFrozenSong
+ *
+ * Returns: (nullable): The instructions of the song.
+ */
+DEFINE_STRING_GETTER (instructions, instructions)
+
+/**
+ * musician_gpt_frozen_song_get_interpretation:
+ * @self: A #MusicianGptFrozenSong
+ *
+ * Returns: (nullable): The interpretation of the song.
+ */
+DEFINE_STRING_GETTER (interpretation, interpretation)
+
+/**
+ * musician_gpt_frozen_song_get_subtitle:
+ * @self: A #MusicianGptFrozenSong
+ *
+ * Returns: (nullable): The subtitle of the song.
+ */
+DEFINE_STRING_GETTER (subtitle, subtitle)
+
+/**
+ * musician_gpt_frozen_song_get_title:
+ * @self: A #MusicianGptFrozenSong
+ *
+ * Returns: (nullable): The title of the song.
+ */
+DEFINE_STRING_GETTER (title, title)
+
+/**
+ * musician_gpt_frozen_song_get_version:
+ * @self: A #MusicianGptFrozenSong
+ *
+ * Returns: (nullable): The version of the file the song was parsed from.
+ */
+DEFINE_STRING_GETTER (version, song_version)
+
+/**
+ * musician_gpt_frozen_song_get_writer:
+ * @self: A #MusicianGptFrozenSong
+ *
+ * Returns: (nullable): The writer of the song.
+ */
+DEFINE_STRING_GETTER (writer, writer)
+
+#undef DEFINE_STRING_GETTER
+
+MusicianGptKey
+musician_gpt_frozen_song_get_key (MusicianGptFrozenSong *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->header->key;
+}
+
+MusicianGptOctave
+musician_gpt_frozen_song_get_octave (MusicianGptFrozenSong *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->header->octave;
+}
+
+guint
+musician_gpt_frozen_song_get_tempo (MusicianGptFrozenSong *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->header->tempo;
+}
+
+MusicianGptTripletFeel
+musician_gpt_frozen_song_get_triplet_feel (MusicianGptFrozenSong *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->header->triplet_feel;
+}
+
+guint
+musician_gpt_frozen_song_get_n_measures (MusicianGptFrozenSong *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->header->measures.n_items;
+}
+
+/**
+ * musician_gpt_frozen_song_get_measure:
+ * @self: A #MusicianGptFrozenSong
+ * @position: The position of the measure, starting at 0
+ * @measure: (out caller-allocates): A #MusicianGptFrozenMeasure
+ *
+ * Fills in @measure with the measure at @position.
+ *
+ * Returns: %TRUE if @position is within the song, otherwise %FALSE and
+ *   @measure is left untouched.
+ */
+gboolean
+musician_gpt_frozen_song_get_measure (MusicianGptFrozenSong    *self,
+                                      guint                     position,
+                                      MusicianGptFrozenMeasure *measure)
+{
+  const SnapshotMeasure *record;
+
+  g_return_val_if_fail (self != NULL, FALSE);
+  g_return_val_if_fail (measure != NULL, FALSE);
+
+  if (position >= self->header->measures.n_items)
+    return FALSE;
+
+  record = &frozen_song_records (self, measures, SnapshotMeasure)[position];
+
+  measure->id = record->id;
+  measure->numerator = record->numerator;
+  measure->denominator = record->denominator;
+  measure->n_repeats = record->n_repeats;
+  measure->nth_ending = record->nth_ending;
+  measure->key = record->key;
+  measure->marker_name = frozen_song_string (self, record->marker_name);
+  measure->marker_color = &record->marker_color;
+
+  return TRUE;
+}
+
+guint
+musician_gpt_frozen_song_get_n_tracks (MusicianGptFrozenSong *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->header->tracks.n_items;
+}
+
+/**
+ * musician_gpt_frozen_song_get_track:
+ * @self: A #MusicianGptFrozenSong
+ * @position: The position of the track, starting at 0
+ * @track: (out caller-allocates): A #MusicianGptFrozenTrack
+ *
+ * Fills in @track with the track at @position.
+ *
+ * Returns: %TRUE if @position is within the song, otherwise %FALSE and
+ *   @track is left untouched.
+ */
+gboolean
+musician_gpt_frozen_song_get_track (MusicianGptFrozenSong  *self,
+                                    guint                   position,
+                                    MusicianGptFrozenTrack *track)
+{
+  const SnapshotTrack *record;
+
+  g_return_val_if_fail (self != NULL, FALSE);
+  g_return_val_if_fail (track != NULL, FALSE);
+
+  if (position >= self->header->tracks.n_items)
+    return FALSE;
+
+  record = &frozen_song_records (self, tracks, SnapshotTrack)[position];
+
+  track->id = record->id;
+  track->title = frozen_song_string (self, record->title);
+  track->tunings = &frozen_song_records (self, tunings, MusicianGptTuning)[record->first_tuning];
+  track->n_tunings = record->n_tunings;
+  track->port = record->port;
+  track->channel = record->channel;
+  track->effects_channel = record->effects_channel;
+  track->n_frets = record->n_frets;
+  track->capo_at = record->capo_at;
+  track->color = &record->color;
+
+  return TRUE;
+}
+
+guint
+musician_gpt_frozen_song_get_n_lyrics (MusicianGptFrozenSong *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->header->lyrics.n_items;
+}
+
+/**
+ * musician_gpt_frozen_song_get_lyrics:
+ * @self: A #MusicianGptFrozenSong
+ * @position: The position of the lyrics, starting at 0
+ * @lyrics_position: (out) (optional): The measure the lyrics start at
+ *
+ * Returns: (nullable): The text of the lyrics at @position, or %NULL if
+ *   @position is not within the song.
+ */
+const gchar *
+musician_gpt_frozen_song_get_lyrics (MusicianGptFrozenSong *self,
+                                     guint                  position,
+                                     guint                 *lyrics_position)
+{
+  const SnapshotLyrics *record;
+
+  g_return_val_if_fail (self != NULL, NULL);
+
+  if (position >= self->header->lyrics.n_items)
+    return NULL;
+
+  record = &frozen_song_records (self, lyrics, SnapshotLyrics)[position];
+
+  if (lyrics_position != NULL)
+    *lyrics_position = record->position;
+
+  return frozen_song_string (self, record->text);
+}
+
+/**
+ * musician_gpt_frozen_song_get_n_beats:
+ * @self: A #MusicianGptFrozenSong
+ * @measure: The id of the measure
+ * @track: The id of the track
+ *
+ * Returns: The number of beats of @track within @measure.
+ */
+guint
+musician_gpt_frozen_song_get_n_beats (MusicianGptFrozenSong *self,
+                                      guint                  measure,
+                                      guint                  track)
+{
+  const SnapshotBlock *block;
+
+  g_return_val_if_fail (self != NULL, 0);
+
+  if (NULL == (block = frozen_song_get_block (self, measure, track)))
+    return 0;
+
+  return block->n_beats;
+}
+
+/**
+ * musician_gpt_frozen_song_get_beat:
+ * @self: A #MusicianGptFrozenSong
+ * @measure: The id of the measure
+ * @track: The id of the track
+ * @beat: The index of the beat within @measure
+ * @view: (out caller-allocates): A #MusicianGptFrozenBeat
+ *
+ * Fills in @view with a beat of @track within @measure.
+ *
+ * Returns: %TRUE if the beat exists, otherwise %FALSE and @view is left
+ *   untouched.
+ */
+gboolean
+musician_gpt_frozen_song_get_beat (MusicianGptFrozenSong *self,
+                                   guint                  measure,
+                                   guint                  track,
+                                   guint                  beat,
+                                   MusicianGptFrozenBeat *view)
+{
+  const SnapshotBlock *block;
+  const SnapshotBeat *record;
+
+  g_return_val_if_fail (self != NULL, FALSE);
+  g_return_val_if_fail (view != NULL, FALSE);
+
+  block = frozen_song_get_block (self, measure, track);
+
+  if (block == NULL || beat >= block->n_beats)
+    return FALSE;
+
+  record = &frozen_song_records (self, beats, SnapshotBeat)[block->first_beat + beat];
+
+  view->mode = record->mode;
+  view->duration = record->duration;
+  view->n_tuplet = record->n_tuplet;
+  view->dynamics = record->dynamics;
+  view->flags = record->flags;
+  view->has_chord = record->has_chord;
+  view->chord_name = frozen_song_string (self, record->chord_name);
+  view->text = frozen_song_string (self, record->text);
+
+  frozen_song_find_bends (self, block, beat, &view->n_bends);
+
+  return TRUE;
+}
+
+/**
+ * musician_gpt_frozen_song_get_bend:
+ * @self: A #MusicianGptFrozenSong
+ * @measure: The id of the measure
+ * @track: The id of the track
+ * @beat: The index of the beat within @measure
+ * @nth: The bend of the beat, below the @n_bends of its #MusicianGptFrozenBeat
+ * @string: (out) (optional): The string that is bent
+ * @bend_type: (out) (optional): The #MusicianGptBendType of the bend
+ * @n_points: (out): The number of points of the bend
+ *
+ * Returns: (array length=n_points) (nullable): The points of the bend,
+ *   or %NULL if the beat has no such bend.
+ */
+const MusicianGptBendPoint *
+musician_gpt_frozen_song_get_bend (MusicianGptFrozenSong *self,
+                                   guint                  measure,
+                                   guint                  track,
+                                   guint                  beat,
+                                   guint                  nth,
+                                   guint                 *string,
+                                   MusicianGptBendType   *bend_type,
+                                   guint                 *n_points)
+{
+  const SnapshotBlock *block;
+  const SnapshotBend *bends;
+  guint n_bends;
+
+  g_return_val_if_fail (self != NULL, NULL);
+  g_return_val_if_fail (n_points != NULL, NULL);
+
+  *n_points = 0;
+
+  block = frozen_song_get_block (self, measure, track);
+
+  if (block == NULL || beat >= block->n_beats)
+    return NULL;
+
+  bends = frozen_song_find_bends (self, block, beat, &n_bends);
+
+  if (nth >= n_bends)
+    return NULL;
+
+  if (string != NULL)
+    *string = bends[nth].string;
+
+  if (bend_type != NULL)
+    *bend_type = bends[nth].bend_type;
+
+  *n_points = bends[nth].n_points;
+
+  return &frozen_song_records (self, bend_points, MusicianGptBendPoint)[bends[nth].first_point];
+}
@@ -0,0 +1,165 @@
+/* musician-gpt-frozen-song.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_FROZEN_SONG_H
+#define MUSICIAN_GPT_FROZEN_SONG_H
+
+#include <gdk/gdk.h>
+
+#include "musician-gpt-types.h"
+
+G_BEGIN_DECLS
+
+#define MUSICIAN_TYPE_GPT_FROZEN_SONG (musician_gpt_frozen_song_get_type())
+
+/**
+ * MusicianGptFrozenMeasure:
+ * @id: The id of the measure.
+ * @numerator: The numerator of the time signature.
+ * @denominator: The denominator of the time signature.
+ * @n_repeats: The number of repeats.
+ * @nth_ending: The alternate ending of the measure.
+ * @key: The #MusicianGptKey of the measure.
+ * @marker_name: (nullable): The name of the marker, owned by the song.
+ * @marker_color: The color of the marker, owned by the song.
+ *
+ * A measure of a #MusicianGptFrozenSong, filled in on the stack by
+ * musician_gpt_frozen_song_get_measure().
+ */
+typedef struct
+{
+  guint          id;
+  guint          numerator;
+  guint          denominator;
+  guint          n_repeats;
+  guint          nth_ending;
+  MusicianGptKey key;
+  const gchar   *marker_name;
+  const GdkRGBA *marker_color;
+} MusicianGptFrozenMeasure;
+
+/**
+ * MusicianGptFrozenTrack:
+ * @id: The id of the track.
+ * @title: (nullable): The title of the track, owned by the song.
+ * @tunings: (array length=n_tunings): The tuning of each string, owned
+ *   by the song.
+ * @n_tunings: The number of strings.
+ * @port: The MIDI port of the track.
+ * @channel: The MIDI channel of the track.
+ * @effects_channel: The MIDI channel used for effects.
+ * @n_frets: The number of frets.
+ * @capo_at: The fret of the capo, or 0.
+ * @color: The color of the track, owned by the song.
+ *
+ * A track of a #MusicianGptFrozenSong, filled in on the stack by
+ * musician_gpt_frozen_song_get_track().
+ */
+typedef struct
+{
+  guint                    id;
+  const gchar             *title;
+  const MusicianGptTuning *tunings;
+  guint                    n_tunings;
+  guint                    port;
+  guint                    channel;
+  guint                    effects_channel;
+  guint                    n_frets;
+  guint                    capo_at;
+  const GdkRGBA           *color;
+} MusicianGptFrozenTrack;
+
+/**
+ * MusicianGptFrozenBeat:
+ * @mode: The #MusicianGptBeatMode of the beat.
+ * @duration: The duration of the beat.
+ * @n_tuplet: The tuplet the beat belongs to, or 0.
+ * @dynamics: The #MusicianGptDynamics of the beat.
+ * @flags: The #MusicianGptBeatFlags the beat was stored with.
+ * @has_chord: Whether the beat has a chord diagram.
+ * @chord_name: (nullable): The name of the chord diagram, owned by the song.
+ * @text: (nullable): The text of the beat, owned by the song.
+ * @n_bends: The number of bends on the beat, see
+ *   musician_gpt_frozen_song_get_bend().
+ *
+ * A beat of a #MusicianGptFrozenSong, filled in on the stack by
+ * musician_gpt_frozen_song_get_beat().
+ */
+typedef struct
+{
+  MusicianGptBeatMode   mode;
+  guint                 duration;
+  guint                 n_tuplet;
+  MusicianGptDynamics   dynamics;
+  MusicianGptBeatFlags  flags;
+  gboolean              has_chord;
+  const gchar          *chord_name;
+  const gchar          *text;
+  guint                 n_bends;
+} MusicianGptFrozenBeat;
+
+GType                       musician_gpt_frozen_song_get_type           (void);
+MusicianGptFrozenSong      *musician_gpt_frozen_song_ref                (MusicianGptFrozenSong    *self);
+void                        musician_gpt_frozen_song_unref              (MusicianGptFrozenSong    *self);
+const gchar                *musician_gpt_frozen_song_get_album          (MusicianGptFrozenSong    *self);
+const gchar                *musician_gpt_frozen_song_get_artist         (MusicianGptFrozenSong    *self);
+const gchar                *musician_gpt_frozen_song_get_copyright      (MusicianGptFrozenSong    *self);
+const gchar                *musician_gpt_frozen_song_get_instructions   (MusicianGptFrozenSong    *self);
+const gchar                *musician_gpt_frozen_song_get_interpretation (MusicianGptFrozenSong    *self);
+const gchar                *musician_gpt_frozen_song_get_subtitle       (MusicianGptFrozenSong    *self);
+const gchar                *musician_gpt_frozen_song_get_title          (MusicianGptFrozenSong    *self);
+const gchar                *musician_gpt_frozen_song_get_version        (MusicianGptFrozenSong    *self);
+const gchar                *musician_gpt_frozen_song_get_writer         (MusicianGptFrozenSong    *self);
+MusicianGptKey              musician_gpt_frozen_song_get_key            (MusicianGptFrozenSong    *self);
+MusicianGptOctave           musician_gpt_frozen_song_get_octave         (MusicianGptFrozenSong    *self);
+guint                       musician_gpt_frozen_song_get_tempo          (MusicianGptFrozenSong    *self);
+MusicianGptTripletFeel      musician_gpt_frozen_song_get_triplet_feel   (MusicianGptFrozenSong    *self);
+guint                       musician_gpt_frozen_song_get_n_measures     (MusicianGptFrozenSong    *self);
+gboolean                    musician_gpt_frozen_song_get_measure        (MusicianGptFrozenSong    *self,
+                                                                         guint                     position,
+                                                                         MusicianGptFrozenMeasure *measure);
+guint                       musician_gpt_frozen_song_get_n_tracks       (MusicianGptFrozenSong    *self);
+gboolean                    musician_gpt_frozen_song_get_track          (MusicianGptFrozenSong    *self,
+                                                                         guint                     position,
+                                                                         MusicianGptFrozenTrack   *track);
+guint                       musician_gpt_frozen_song_get_n_lyrics       (MusicianGptFrozenSong    *self);
+const gchar                *musician_gpt_frozen_song_get_lyrics         (MusicianGptFrozenSong    *self,
+                                                                         guint                     position,
+                                                                         guint                    *lyrics_position);
+guint                       musician_gpt_frozen_song_get_n_beats        (MusicianGptFrozenSong    *self,
+                                                                         guint                     measure,
+                                                                         guint                     track);
+gboolean                    musician_gpt_frozen_song_get_beat           (MusicianGptFrozenSong    *self,
+                                                                         guint                     measure,
+                                                                         guint                     track,
+                                                                         guint                     beat,
+                                                                         MusicianGptFrozenBeat    *view);
+const MusicianGptBendPoint *musician_gpt_frozen_song_get_bend           (MusicianGptFrozenSong    *self,
+                                                                         guint                     measure,
+                                                                         guint                     track,
+                                                                         guint                     beat,
+                                                                         guint                     nth,
+                                                                         guint                    *string,
+                                                                         MusicianGptBendType      *bend_type,
+                                                                         guint                    *n_points);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MusicianGptFrozenSong, musician_gpt_frozen_song_unref)
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_FROZEN_SONG_H */
@@ -0,0 +1,115 @@
+/* musician-gpt-input-stream-private.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_INPUT_STREAM_PRIVATE_H
+#define MUSICIAN_GPT_INPUT_STREAM_PRIVATE_H
+
+#include "musician-gpt-arena.h"
+#include "musician-gpt-input-stream.h"
+#include "musician-gpt-parse-stats.h"
+
+G_BEGIN_DECLS
+
+/*
+ * A memory ceiling shared by several streams, such as those of a batch
+ * load. What a stream allocates is charged to the budget until the stream
+ * is finalized, and allocations fail once @limit would be passed.
+ */
+typedef struct
+{
+  GMutex mutex;
+  gsize  limit;
+  gsize  used;
+} MusicianGptBudget;
+
+/*
+ * How a song is to be loaded, as set by the parser that started the load.
+ */
+typedef enum
+{
+  MUSICIAN_GPT_LOAD_LAZY     = 1 << 0,
+  MUSICIAN_GPT_LOAD_PARALLEL = 1 << 1,
+} MusicianGptLoadFlags;
+
+void                    _musician_gpt_budget_init                    (MusicianGptBudget       *budget,
+                                                                      gsize                    limit);
+void                    _musician_gpt_budget_clear                   (MusicianGptBudget       *budget);
+void                    _musician_gpt_input_stream_set_budget        (MusicianGptInputStream  *self,
+                                                                      MusicianGptBudget       *budget);
+MusicianGptInputStream *_musician_gpt_input_stream_new_sibling       (MusicianGptInputStream  *self);
+void                    _musician_gpt_input_stream_absorb            (MusicianGptInputStream  *self,
+                                                                      MusicianGptInputStream  *sibling);
+MusicianGptArena       *_musician_gpt_input_stream_get_arena         (MusicianGptInputStream  *self);
+void                    _musician_gpt_input_stream_set_arena         (MusicianGptInputStream  *self,
+                                                                      MusicianGptArena        *arena);
+void                    _musician_gpt_input_stream_reset_arena       (MusicianGptInputStream  *self);
+GBytes                 *_musician_gpt_input_stream_get_bytes         (MusicianGptInputStream  *self);
+gsize                   _musician_gpt_input_stream_tell              (MusicianGptInputStream  *self);
+gsize                   _musician_gpt_input_stream_get_offset        (MusicianGptInputStream  *self);
+gboolean                _musician_gpt_input_stream_get_n_remaining   (MusicianGptInputStream  *self,
+                                                                      guint64                 *n_remaining);
+void                    _musician_gpt_input_stream_set_partial       (MusicianGptInputStream  *self,
+                                                                      gboolean                 partial);
+void                    _musician_gpt_input_stream_set_load_flags    (MusicianGptInputStream  *self,
+                                                                      MusicianGptLoadFlags     load_flags);
+MusicianGptLoadFlags    _musician_gpt_input_stream_get_load_flags    (MusicianGptInputStream  *self);
+void                    _musician_gpt_input_stream_seek              (MusicianGptInputStream  *self,
+                                                                      gsize                    offset);
+gboolean                _musician_gpt_input_stream_truncated         (MusicianGptInputStream  *self);
+gsize                   _musician_gpt_input_stream_get_n_wanted      (MusicianGptInputStream  *self);
+void                    _musician_gpt_input_stream_set_stats         (MusicianGptInputStream  *self,
+                                                                      MusicianGptParseStats   *stats);
+void                    _musician_gpt_input_stream_get_stats         (MusicianGptInputStream  *self,
+                                                                      MusicianGptParseStats   *stats);
+gboolean                _musician_gpt_input_stream_check             (MusicianGptInputStream  *self,
+                                                                      GCancellable            *cancellable,
+                                                                      GError                 **error);
+gboolean                _musician_gpt_input_stream_failed            (MusicianGptInputStream  *self);
+void                    _musician_gpt_input_stream_set_error         (MusicianGptInputStream  *self,
+                                                                      GQuark                   domain,
+                                                                      gint                     code,
+                                                                      const gchar             *format,
+                                                                      ...) G_GNUC_PRINTF (4, 5);
+guint8                  _musician_gpt_input_stream_pull_byte         (MusicianGptInputStream  *self,
+                                                                      GCancellable            *cancellable);
+gint32                  _musician_gpt_input_stream_pull_int32        (MusicianGptInputStream  *self,
+                                                                      GCancellable            *cancellable);
+guint32                 _musician_gpt_input_stream_pull_uint32       (MusicianGptInputStream  *self,
+                                                                      GCancellable            *cancellable);
+void                    _musician_gpt_input_stream_pull_color        (MusicianGptInputStream  *self,
+                                                                      GCancellable            *cancellable,
+                                                                      GdkRGBA                 *color);
+void                    _musician_gpt_input_stream_pull_skip         (MusicianGptInputStream  *self,
+                                                                      gsize                    n_bytes,
+                                                                      GCancellable            *cancellable);
+const gchar            *_musician_gpt_input_stream_pull_string       (MusicianGptInputStream  *self,
+                                                                      GCancellable            *cancellable);
+const gchar            *_musician_gpt_input_stream_pull_fixed_string (MusicianGptInputStream  *self,
+                                                                      guint8                   max_length,
+                                                                      GCancellable            *cancellable);
+const gchar            *_musician_gpt_input_stream_pull_lyric        (MusicianGptInputStream  *self,
+                                                                      GCancellable            *cancellable,
+                                                                      guint32                 *position);
+void                    _musician_gpt_input_stream_pull_midi_port    (MusicianGptInputStream  *self,
+                                                                      guint                    portnum,
+                                                                      GCancellable            *cancellable,
+                                                                      MusicianGptMidiPort     *port);
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_INPUT_STREAM_PRIVATE_H */
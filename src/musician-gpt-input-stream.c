@@ -20,7 +20,9 @@
 
 #include <string.h>
 
+#include "musician-gpt-arena.h"
 #include "musician-gpt-input-stream.h"
+#include "musician-gpt-input-stream-private.h"
 
 /**
  * SECTION:musician-gpt-input-stream:
@@ -45,8 +47,11 @@ typedef struct
    * We track how much memory we've allocated creating items from
    * the input stream, so that we can prevent allocating big chunks
    * of memory when coming across a potentially mallicous file.
+   * What is released with _musician_gpt_input_stream_reset_arena() no
+   * longer counts, but is still part of @total_allocated.
    */
   gsize allocated;
+  gsize total_allocated;
 
   /*
    * This is the max number of bytes we'll allow ourselves to allocate
@@ -54,86 +59,982 @@ typedef struct
    * musician_gpt_input_stream_allocate() for where we enforce this.
    */
   gsize max_allocation;
+
+  /*
+   * If set, what we allocate is also charged to @budget, which is shared
+   * with other streams. @charged is returned to it when we are finalized.
+   */
+  MusicianGptBudget *budget;
+  gsize charged;
+
+  /*
+   * The largest each of the streams folded into us with
+   * _musician_gpt_input_stream_absorb() got, all added up as they may
+   * have been decoding at the same time.
+   */
+  gsize sibling_peak_size;
+
+  /*
+   * Everything we decode (strings, lyrics, string arrays) is allocated
+   * from this arena. The parser passes it on to the resulting song so
+   * that those allocations are released all at once, rather than being
+   * copied into the song and freed individually.
+   */
+  MusicianGptArena *arena;
+
+  /*
+   * When created with musician_gpt_input_stream_new_for_bytes(), we decode
+   * straight out of @bytes (which is usually a GMappedFile) using @pos as
+   * our cursor. That avoids a virtual call into GBufferedInputStream for
+   * every field we read. @data is never %NULL while @bytes is set.
+   */
+  GBytes       *bytes;
+  const guint8 *data;
+  gsize         len;
+  gsize         pos;
+
+  /*
+   * How many bytes have been read or skipped from a stream over a
+   * #GInputStream. We cannot ask the buffered stream for its position,
+   * since that includes whatever it read ahead.
+   */
+  gsize         n_consumed;
+
+  /*
+   * Set when a read ran past the end of @bytes. The push parser uses this
+   * to tell a record that is merely incomplete from one that is invalid,
+   * and @n_wanted to know how long @bytes must be for that read to work.
+   */
+  guint         truncated : 1;
+  gsize         n_wanted;
+
+  /*
+   * Set when @bytes is only the part of the file that has arrived so far,
+   * in which case we cannot tell how much of it is left.
+   */
+  guint         partial : 1;
+
+  /*
+   * How the parser was asked to load the song, captured from its
+   * properties on the thread that started the load.
+   */
+  MusicianGptLoadFlags load_flags;
+
+  /*
+   * The first failure seen by one of the _musician_gpt_input_stream_pull_*()
+   * readers. Once set, those readers stop touching the stream and return
+   * zeroed values until _musician_gpt_input_stream_check() hands the error
+   * to the caller. The public read_*() functions never look at this.
+   */
+  GError       *error;
+
+  /*
+   * What the parser found while decoding from us, completed with our own
+   * counters by _musician_gpt_input_stream_set_stats().
+   */
+  MusicianGptParseStats stats;
 } MusicianGptInputStreamPrivate;
 
-G_DEFINE_TYPE_WITH_PRIVATE (MusicianGptInputStream, musician_gpt_input_stream, G_TYPE_DATA_INPUT_STREAM)
+G_DEFINE_TYPE_WITH_PRIVATE (MusicianGptInputStream, musician_gpt_input_stream, G_TYPE_DATA_INPUT_STREAM)
+
+enum {
+  PROP_0,
+  N_PROPS
+};
+
+static GParamSpec *properties [N_PROPS];
+
+MusicianGptInputStream *
+musician_gpt_input_stream_new (GInputStream *base_stream)
+{
+  g_return_val_if_fail (G_IS_INPUT_STREAM (base_stream), NULL);
+
+  return g_object_new (MUSICIAN_TYPE_GPT_INPUT_STREAM,
+                       "base-stream", base_stream,
+                       NULL);
+}
+
+static GInputStream *
+get_placeholder_stream (void)
+{
+  static GInputStream *instance;
+
+  /*
+   * GFilterInputStream requires a base stream, but when we decode from
+   * a GBytes we never touch it. Share a single empty stream for all of
+   * those instances rather than creating one per parse.
+   */
+  if (g_once_init_enter (&instance))
+    g_once_init_leave (&instance, g_memory_input_stream_new ());
+
+  return instance;
+}
+
+/**
+ * musician_gpt_input_stream_new_for_bytes:
+ * @bytes: A #GBytes containing the file contents.
+ *
+ * Creates a new #MusicianGptInputStream that decodes directly from @bytes
+ * instead of going through a buffered #GInputStream. This is generally used
+ * along with a #GMappedFile so that no copy of the file is made.
+ *
+ * All of the musician_gpt_input_stream_read_*() functions, as well as
+ * g_input_stream_read() and g_input_stream_skip(), work as they would for
+ * a stream created with musician_gpt_input_stream_new().
+ *
+ * Returns: (transfer full): A #MusicianGptInputStream.
+ */
+MusicianGptInputStream *
+musician_gpt_input_stream_new_for_bytes (GBytes *bytes)
+{
+  MusicianGptInputStreamPrivate *priv;
+  MusicianGptInputStream *self;
+  gconstpointer data;
+  gsize len;
+
+  g_return_val_if_fail (bytes != NULL, NULL);
+
+  self = g_object_new (MUSICIAN_TYPE_GPT_INPUT_STREAM,
+                       "base-stream", get_placeholder_stream (),
+                       "close-base-stream", FALSE,
+                       NULL);
+  priv = musician_gpt_input_stream_get_instance_private (self);
+
+  data = g_bytes_get_data (bytes, &len);
+
+  priv->bytes = g_bytes_ref (bytes);
+  priv->data = len > 0 ? data : (const guint8 *)"";
+  priv->len = len;
+  priv->pos = 0;
+
+  return self;
+}
+
+/*
+ * Creates another stream over the bytes of @self, with a cursor and arena
+ * of its own, so that parts of the file can be decoded on other threads.
+ * What it allocates is charged to the budget of @self and counts against
+ * what is left of the allocation limit of @self. Fold it back in with
+ * _musician_gpt_input_stream_absorb() once done.
+ */
+MusicianGptInputStream *
+_musician_gpt_input_stream_new_sibling (MusicianGptInputStream *self)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+  MusicianGptInputStreamPrivate *sibling_priv;
+  MusicianGptInputStream *sibling;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), NULL);
+  g_return_val_if_fail (priv->bytes != NULL, NULL);
+
+  sibling = musician_gpt_input_stream_new_for_bytes (priv->bytes);
+  sibling_priv = musician_gpt_input_stream_get_instance_private (sibling);
+
+  sibling_priv->budget = priv->budget;
+  sibling_priv->max_allocation = priv->max_allocation - priv->allocated;
+
+  return sibling;
+}
+
+/*
+ * Adds what @sibling, which was created with
+ * _musician_gpt_input_stream_new_sibling(), allocated to the statistics of
+ * @self. @sibling keeps its budget charge until it is finalized.
+ */
+void
+_musician_gpt_input_stream_absorb (MusicianGptInputStream *self,
+                                   MusicianGptInputStream *sibling)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+  MusicianGptInputStreamPrivate *sibling_priv = musician_gpt_input_stream_get_instance_private (sibling);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self));
+  g_return_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (sibling));
+  g_return_if_fail (sibling_priv->bytes == priv->bytes);
+
+  priv->total_allocated += sibling_priv->total_allocated;
+  priv->sibling_peak_size += sibling_priv->sibling_peak_size;
+
+  if (sibling_priv->arena != NULL)
+    priv->sibling_peak_size += musician_gpt_arena_get_peak_size (sibling_priv->arena);
+}
+
+static gboolean
+musician_gpt_input_stream_short_read (GError **error)
+{
+  g_set_error_literal (error,
+                       G_IO_ERROR,
+                       G_IO_ERROR_INVALID_DATA,
+                       "Unexpected end of file");
+  return FALSE;
+}
+
+/* Notes that @n_bytes were wanted at the cursor, past the end of the data */
+static void
+musician_gpt_input_stream_set_truncated (MusicianGptInputStreamPrivate *priv,
+                                         gsize                          n_bytes)
+{
+  priv->truncated = TRUE;
+  priv->n_wanted = n_bytes > G_MAXSIZE - priv->pos ? G_MAXSIZE : priv->pos + n_bytes;
+}
+
+/*
+ * Advances the cursor of a bytes-backed stream by @n_bytes and returns
+ * a pointer to the data that was skipped over, or %NULL if there is not
+ * enough data left.
+ */
+static inline const guint8 *
+musician_gpt_input_stream_take (MusicianGptInputStreamPrivate  *priv,
+                                gsize                           n_bytes,
+                                GError                        **error)
+{
+  const guint8 *ret;
+
+  g_assert (priv->bytes != NULL);
+
+  if G_UNLIKELY (n_bytes > priv->len - priv->pos)
+    {
+      musician_gpt_input_stream_set_truncated (priv, n_bytes);
+      musician_gpt_input_stream_short_read (error);
+      return NULL;
+    }
+
+  ret = &priv->data[priv->pos];
+  priv->pos += n_bytes;
+
+  return ret;
+}
+
+static inline gboolean
+musician_gpt_input_stream_get_byte (MusicianGptInputStream  *self,
+                                    GCancellable            *cancellable,
+                                    guint8                  *value,
+                                    GError                 **error)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+  GError *local_error = NULL;
+
+  if (priv->bytes != NULL)
+    {
+      const guint8 *data;
+
+      if (NULL == (data = musician_gpt_input_stream_take (priv, 1, error)))
+        return FALSE;
+
+      *value = data[0];
+
+      return TRUE;
+    }
+
+  *value = g_data_input_stream_read_byte (G_DATA_INPUT_STREAM (self), cancellable, &local_error);
+
+  if (local_error != NULL)
+    {
+      g_propagate_error (error, local_error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static inline gboolean
+musician_gpt_input_stream_get_uint32 (MusicianGptInputStream  *self,
+                                      GCancellable            *cancellable,
+                                      guint32                 *value,
+                                      GError                 **error)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+  GError *local_error = NULL;
+
+  if (priv->bytes != NULL)
+    {
+      const guint8 *data;
+      guint32 le;
+
+      if (NULL == (data = musician_gpt_input_stream_take (priv, sizeof le, error)))
+        return FALSE;
+
+      memcpy (&le, data, sizeof le);
+      *value = GUINT32_FROM_LE (le);
+
+      return TRUE;
+    }
+
+  *value = g_data_input_stream_read_uint32 (G_DATA_INPUT_STREAM (self), cancellable, &local_error);
+
+  if (local_error != NULL)
+    {
+      g_propagate_error (error, local_error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static inline gboolean
+musician_gpt_input_stream_get_int32 (MusicianGptInputStream  *self,
+                                     GCancellable            *cancellable,
+                                     gint32                  *value,
+                                     GError                 **error)
+{
+  guint32 real_value;
+
+  if (!musician_gpt_input_stream_get_uint32 (self, cancellable, &real_value, error))
+    return FALSE;
+
+  *value = (gint32)real_value;
+
+  return TRUE;
+}
+
+static gboolean
+musician_gpt_input_stream_get_data (MusicianGptInputStream  *self,
+                                    GCancellable            *cancellable,
+                                    gpointer                 buffer,
+                                    gsize                    n_bytes,
+                                    GError                 **error)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+  gsize n_read;
+
+  if (priv->bytes != NULL)
+    {
+      const guint8 *data;
+
+      /*
+       * There is no I/O to cancel when decoding from memory, but bulk reads
+       * are a cheap place to honor @cancellable so large files stay
+       * cancellable without checking on every byte.
+       */
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+        return FALSE;
+
+      if (NULL == (data = musician_gpt_input_stream_take (priv, n_bytes, error)))
+        return FALSE;
+
+      memcpy (buffer, data, n_bytes);
+
+      return TRUE;
+    }
+
+  if (!g_input_stream_read_all (G_INPUT_STREAM (self), buffer, n_bytes, &n_read, cancellable, error))
+    return FALSE;
+
+  if (n_read != n_bytes)
+    return musician_gpt_input_stream_short_read (error);
+
+  return TRUE;
+}
+
+MusicianGptArena *
+_musician_gpt_input_stream_get_arena (MusicianGptInputStream *self)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), NULL);
+
+  if (priv->arena == NULL)
+    priv->arena = musician_gpt_arena_new ();
+
+  return priv->arena;
+}
+
+/*
+ * Makes @self allocate from @arena instead of creating its own. This lets
+ * several streams decode into one song, which is what the push parser does
+ * as more data arrives. What is already in @arena counts against our
+ * allocation limit, so splitting the input does not raise that limit.
+ */
+void
+_musician_gpt_input_stream_set_arena (MusicianGptInputStream *self,
+                                      MusicianGptArena       *arena)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self));
+  g_return_if_fail (arena != NULL);
+  g_return_if_fail (priv->arena == NULL);
+
+  priv->arena = musician_gpt_arena_ref (arena);
+  priv->allocated = musician_gpt_arena_get_size (arena);
+}
+
+/*
+ * Releases everything allocated from the arena of @self, once nothing
+ * points into it any more, such as after each record when decoding to
+ * events. That memory is credited back to our allocation limit and to the
+ * budget, so that a long stream decoded this way does not run into either.
+ */
+void
+_musician_gpt_input_stream_reset_arena (MusicianGptInputStream *self)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self));
+
+  if (priv->arena != NULL)
+    musician_gpt_arena_reset (priv->arena);
+
+  priv->allocated = 0;
+
+  if (priv->budget != NULL && priv->charged > 0)
+    {
+      g_mutex_lock (&priv->budget->mutex);
+      priv->budget->used -= priv->charged;
+      g_mutex_unlock (&priv->budget->mutex);
+      priv->charged = 0;
+    }
+}
+
+/*
+ * Where the arena of a stream and what it was charged for stood, so that
+ * the public readers can give back the arena copy of what they return.
+ */
+typedef struct
+{
+  MusicianGptArenaMark arena;
+  gsize                allocated;
+  gsize                charged;
+} MusicianGptInputStreamMark;
+
+static void
+musician_gpt_input_stream_mark (MusicianGptInputStream     *self,
+                                MusicianGptInputStreamMark *mark)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (self));
+  g_assert (mark != NULL);
+
+  musician_gpt_arena_mark (_musician_gpt_input_stream_get_arena (self), &mark->arena);
+  mark->allocated = priv->allocated;
+  mark->charged = priv->charged;
+}
+
+/*
+ * Releases what was allocated from the arena of @self since @mark, and
+ * credits it back to our allocation limit and to the budget.
+ */
+static void
+musician_gpt_input_stream_rewind (MusicianGptInputStream           *self,
+                                  const MusicianGptInputStreamMark *mark)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (self));
+  g_assert (mark != NULL);
+  g_assert (priv->arena != NULL);
+
+  musician_gpt_arena_rewind (priv->arena, &mark->arena);
+  priv->allocated = mark->allocated;
+
+  if (priv->budget != NULL && priv->charged > mark->charged)
+    {
+      g_mutex_lock (&priv->budget->mutex);
+      priv->budget->used -= priv->charged - mark->charged;
+      g_mutex_unlock (&priv->budget->mutex);
+      priv->charged = mark->charged;
+    }
+}
+
+void
+_musician_gpt_budget_init (MusicianGptBudget *budget,
+                           gsize              limit)
+{
+  g_return_if_fail (budget != NULL);
+
+  g_mutex_init (&budget->mutex);
+  budget->limit = limit;
+  budget->used = 0;
+}
+
+void
+_musician_gpt_budget_clear (MusicianGptBudget *budget)
+{
+  g_return_if_fail (budget != NULL);
+  g_return_if_fail (budget->used == 0);
+
+  g_mutex_clear (&budget->mutex);
+}
+
+/*
+ * Charges what @self allocates to @budget from now on, which must outlive
+ * @self. This is on top of the per-stream limit.
+ */
+void
+_musician_gpt_input_stream_set_budget (MusicianGptInputStream *self,
+                                       MusicianGptBudget      *budget)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self));
+  g_return_if_fail (priv->budget == NULL);
+
+  priv->budget = budget;
+}
+
+/* The #GBytes a stream decodes from, or %NULL if it wraps a #GInputStream */
+GBytes *
+_musician_gpt_input_stream_get_bytes (MusicianGptInputStream *self)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), NULL);
+
+  return priv->bytes;
+}
+
+/* The number of bytes consumed from a stream created for a #GBytes */
+gsize
+_musician_gpt_input_stream_tell (MusicianGptInputStream *self)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), 0);
+  g_return_val_if_fail (priv->bytes != NULL, 0);
+
+  return priv->pos;
+}
+
+/*
+ * Returns how far into the file @self is. Unlike _musician_gpt_input_stream_tell(),
+ * this works for streams over a #GInputStream too, where it is the number of
+ * bytes decoded so far, and is meant for statistics and tracing.
+ */
+gsize
+_musician_gpt_input_stream_get_offset (MusicianGptInputStream *self)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), 0);
+
+  if (priv->bytes != NULL)
+    return priv->pos;
+
+  return priv->n_consumed;
+}
+
+/*
+ * Gets how many bytes are left to decode, which is only known for streams
+ * created for a #GBytes holding the whole file. Parsers use this to reject
+ * counts that could not possibly fit in the file before allocating
+ * anything for them.
+ */
+gboolean
+_musician_gpt_input_stream_get_n_remaining (MusicianGptInputStream *self,
+                                            guint64                *n_remaining)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), FALSE);
+  g_return_val_if_fail (n_remaining != NULL, FALSE);
+
+  if (priv->bytes == NULL || priv->partial)
+    return FALSE;
+
+  *n_remaining = priv->len - priv->pos;
+
+  return TRUE;
+}
+
+/*
+ * Marks a stream created for a #GBytes as holding only the start of the
+ * file, such as what the push parser has been fed so far.
+ */
+void
+_musician_gpt_input_stream_set_partial (MusicianGptInputStream *self,
+                                        gboolean                partial)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self));
+
+  priv->partial = !!partial;
+}
+
+/*
+ * Sets how the song is to be loaded from @self. Parsers read these from
+ * the stream rather than from their own properties, which may change on
+ * another thread while a load is running in a worker.
+ */
+void
+_musician_gpt_input_stream_set_load_flags (MusicianGptInputStream *self,
+                                           MusicianGptLoadFlags    load_flags)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self));
+
+  priv->load_flags = load_flags;
+}
+
+MusicianGptLoadFlags
+_musician_gpt_input_stream_get_load_flags (MusicianGptInputStream *self)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), 0);
+
+  return priv->load_flags;
+}
+
+/*
+ * Moves the cursor of a stream created for a #GBytes to @offset, such as
+ * one found with _musician_gpt_input_stream_tell() earlier.
+ */
+void
+_musician_gpt_input_stream_seek (MusicianGptInputStream *self,
+                                 gsize                   offset)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self));
+  g_return_if_fail (priv->bytes != NULL);
+  g_return_if_fail (priv->error == NULL);
+  g_return_if_fail (offset <= priv->len);
+
+  priv->pos = offset;
+}
+
+/* Whether a read on a stream created for a #GBytes ran out of data */
+gboolean
+_musician_gpt_input_stream_truncated (MusicianGptInputStream *self)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), FALSE);
+
+  return priv->truncated;
+}
+
+/*
+ * Gets how many bytes a truncated stream must hold for the read that ran
+ * past its end to succeed. Decoding the same data again is pointless
+ * until at least that much is there.
+ */
+gsize
+_musician_gpt_input_stream_get_n_wanted (MusicianGptInputStream *self)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), 0);
+  g_return_val_if_fail (priv->truncated, 0);
+
+  return priv->n_wanted;
+}
+
+/*
+ * Keeps @stats, as found by a parser that decoded a song from @self, along
+ * with how much of @self was decoded and how much memory that took.
+ */
+void
+_musician_gpt_input_stream_set_stats (MusicianGptInputStream *self,
+                                      MusicianGptParseStats  *stats)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self));
+  g_return_if_fail (stats != NULL);
+
+  priv->stats = *stats;
+  priv->stats.n_bytes = _musician_gpt_input_stream_get_offset (self);
+  priv->stats.allocated = priv->total_allocated;
+  priv->stats.peak_arena_size = musician_gpt_arena_get_peak_size (_musician_gpt_input_stream_get_arena (self)) +
+                                 priv->sibling_peak_size;
+}
+
+/*
+ * Copies the statistics of the last song decoded from @self into @stats,
+ * which are all zero if none was.
+ */
+void
+_musician_gpt_input_stream_get_stats (MusicianGptInputStream *self,
+                                      MusicianGptParseStats  *stats)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self));
+  g_return_if_fail (stats != NULL);
+
+  *stats = priv->stats;
+}
+
+static gpointer
+musician_gpt_input_stream_allocate (MusicianGptInputStream  *self,
+                                    gsize                    n_bytes,
+                                    GError                 **error)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+  gpointer ret;
+
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (self));
+
+  if (n_bytes > (priv->max_allocation - priv->allocated))
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_INVALID_DATA,
+                           "Failed to allocate memory while decoding. The file may be corrupt.");
+      return NULL;
+    }
+
+  if (priv->budget != NULL)
+    {
+      gboolean exhausted;
+
+      g_mutex_lock (&priv->budget->mutex);
+      exhausted = n_bytes > (priv->budget->limit - priv->budget->used);
+      if (!exhausted)
+        priv->budget->used += n_bytes;
+      g_mutex_unlock (&priv->budget->mutex);
+
+      if (exhausted)
+        {
+          g_set_error_literal (error,
+                               G_IO_ERROR,
+                               G_IO_ERROR_NO_SPACE,
+                               "The memory limit for decoding has been reached.");
+          return NULL;
+        }
+
+      priv->charged += n_bytes;
+    }
+
+  if (NULL == (ret = musician_gpt_arena_alloc (_musician_gpt_input_stream_get_arena (self), n_bytes, error)))
+    return NULL;
+
+  priv->allocated += n_bytes;
+  priv->total_allocated += n_bytes;
+
+  return ret;
+}
+
+static gpointer
+musician_gpt_input_stream_allocate_n (MusicianGptInputStream  *self,
+                                      gsize                    element_size,
+                                      gsize                    n_elements,
+                                      GError                 **error)
+{
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (self));
+  g_assert (element_size > 0);
+
+  if (G_MAXSIZE / element_size < n_elements)
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_INVALID_DATA,
+                           "Failed to allocate memory while decoding");
+      return NULL;
+    }
+
+  return musician_gpt_input_stream_allocate (self, element_size * n_elements, error);
+}
+
+static gboolean
+musician_gpt_input_stream_discard (MusicianGptInputStream  *self,
+                                   GCancellable            *cancellable,
+                                   gsize                    n_bytes,
+                                   GError                 **error)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  if (priv->bytes != NULL)
+    return musician_gpt_input_stream_take (priv, n_bytes, error) != NULL;
+
+  while (n_bytes > 0)
+    {
+      gssize n_skipped;
+
+      n_skipped = g_input_stream_skip (G_INPUT_STREAM (self), n_bytes, cancellable, error);
+
+      if (n_skipped < 0)
+        return FALSE;
+      else if (n_skipped == 0)
+        return musician_gpt_input_stream_short_read (error);
+
+      n_bytes -= n_skipped;
+    }
+
+  return TRUE;
+}
+
+static const gchar *
+musician_gpt_input_stream_get_fixed_string (MusicianGptInputStream  *self,
+                                            guint8                   max_length,
+                                            GCancellable            *cancellable,
+                                            GError                 **error)
+{
+  gchar *ret;
+  guint8 len;
+
+  if (!musician_gpt_input_stream_get_byte (self, cancellable, &len, error))
+    return NULL;
+
+  if (len > max_length)
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_INVALID_DATA,
+                           "The underlying string is larger than max_length");
+      return NULL;
+    }
+
+  if (NULL == (ret = musician_gpt_input_stream_allocate (self, (gsize)len + 1, error)))
+    return NULL;
 
-enum {
-  PROP_0,
-  N_PROPS
-};
+  /* The string is always padded out to @max_length bytes */
+  if (!musician_gpt_input_stream_get_data (self, cancellable, ret, len, error) ||
+      !musician_gpt_input_stream_discard (self, cancellable, max_length - len, error))
+    return NULL;
 
-static GParamSpec *properties [N_PROPS];
+  ret[len] = '\0';
 
-MusicianGptInputStream *
-musician_gpt_input_stream_new (GInputStream *base_stream)
-{
-  g_return_val_if_fail (G_IS_INPUT_STREAM (base_stream), NULL);
+  if (!g_utf8_validate (ret, len, NULL))
+    {
+      /*
+       * TODO: Can we sanitize the UTF-8 string here so we can continue if
+       *       we come across a bad string? I mean, of course we can, but is
+       *       there an easy glib routine for it.
+       */
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_INVALID_DATA,
+                           "Invalid UTF-8 in underlying string");
+      return NULL;
+    }
 
-  return g_object_new (MUSICIAN_TYPE_GPT_INPUT_STREAM,
-                       "base-stream", base_stream,
-                       NULL);
+  return ret;
 }
 
-static gpointer
-musician_gpt_input_stream_allocate (MusicianGptInputStream  *self,
-                                    gsize                    n_bytes,
-                                    GError                 **error)
+static const gchar *
+musician_gpt_input_stream_get_string (MusicianGptInputStream  *self,
+                                     GCancellable            *cancellable,
+                                     GError                 **error)
 {
-  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
-  gpointer ret;
+  gchar *ret;
+  guint32 len;
+  guint8 plen;
 
-  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (self));
+  /*
+   * So as idiotic as this sounds, there are two string lengths for
+   * the string. A 32-bit string, (which is string length + 1), and
+   * then a pascal like string which is a 1-byte length followed by
+   * the string. So we waste 5 bytes of overhead for a 255-byte max
+   * string.
+   */
 
-  if (n_bytes > (priv->max_allocation - priv->allocated))
+  if (!musician_gpt_input_stream_get_uint32 (self, cancellable, &len, error))
+    return NULL;
+
+  if (len == G_MAXUINT32)
     {
       g_set_error_literal (error,
                            G_IO_ERROR,
                            G_IO_ERROR_INVALID_DATA,
-                           "Failed to allocate memory while decoding. The file may be corrupt.");
+                           "Invalid string length");
       return NULL;
     }
 
-  ret = g_try_malloc (n_bytes);
+  if (!musician_gpt_input_stream_get_byte (self, cancellable, &plen, error))
+    return NULL;
 
-  if (ret == NULL)
+  if ((guint32)plen + 1 != len)
     {
       g_set_error_literal (error,
                            G_IO_ERROR,
                            G_IO_ERROR_INVALID_DATA,
-                           "Failed to allocate memory while decoding.");
+                           "Corrupt or invalid data discovered");
       return NULL;
     }
 
-  priv->allocated += n_bytes;
+  if (NULL == (ret = musician_gpt_input_stream_allocate (self, (gsize)plen + 1, error)))
+    return NULL;
+
+  if (!musician_gpt_input_stream_get_data (self, cancellable, ret, plen, error))
+    return NULL;
+
+  ret[plen] = '\0';
 
   return ret;
 }
 
-static gpointer
-musician_gpt_input_stream_allocate_n (MusicianGptInputStream  *self,
-                                      gsize                    element_size,
-                                      gsize                    n_elements,
-                                      GError                 **error)
+static gssize
+musician_gpt_input_stream_read_fn (GInputStream  *stream,
+                                   void          *buffer,
+                                   gsize          count,
+                                   GCancellable  *cancellable,
+                                   GError       **error)
 {
+  MusicianGptInputStream *self = (MusicianGptInputStream *)stream;
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
   g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (self));
-  g_assert (element_size > 0);
 
-  if (G_MAXSIZE / element_size < n_elements)
+  if (priv->bytes == NULL)
     {
-      g_set_error_literal (error,
-                           G_IO_ERROR,
-                           G_IO_ERROR_INVALID_DATA,
-                           "Failed to allocate memory while decoding");
-      return NULL;
+      gssize n_read;
+
+      n_read = G_INPUT_STREAM_CLASS (musician_gpt_input_stream_parent_class)->read_fn (stream, buffer, count, cancellable, error);
+      if (n_read > 0)
+        priv->n_consumed += n_read;
+
+      return n_read;
     }
 
-  return musician_gpt_input_stream_allocate (self, element_size * n_elements, error);
+  count = MIN (count, priv->len - priv->pos);
+  memcpy (buffer, &priv->data[priv->pos], count);
+  priv->pos += count;
+
+  return count;
+}
+
+static gssize
+musician_gpt_input_stream_skip (GInputStream  *stream,
+                                gsize          count,
+                                GCancellable  *cancellable,
+                                GError       **error)
+{
+  MusicianGptInputStream *self = (MusicianGptInputStream *)stream;
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (self));
+
+  if (priv->bytes == NULL)
+    {
+      gssize n_skipped;
+
+      n_skipped = G_INPUT_STREAM_CLASS (musician_gpt_input_stream_parent_class)->skip (stream, count, cancellable, error);
+      if (n_skipped > 0)
+        priv->n_consumed += n_skipped;
+
+      return n_skipped;
+    }
+
+  count = MIN (count, priv->len - priv->pos);
+  priv->pos += count;
+
+  return count;
 }
 
 static void
 musician_gpt_input_stream_finalize (GObject *object)
 {
+  MusicianGptInputStream *self = (MusicianGptInputStream *)object;
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  if (priv->budget != NULL)
+    {
+      g_mutex_lock (&priv->budget->mutex);
+      priv->budget->used -= priv->charged;
+      g_mutex_unlock (&priv->budget->mutex);
+      priv->budget = NULL;
+    }
+
+  priv->data = NULL;
+  g_clear_pointer (&priv->bytes, g_bytes_unref);
+  g_clear_pointer (&priv->arena, musician_gpt_arena_unref);
+  g_clear_error (&priv->error);
+
   G_OBJECT_CLASS (musician_gpt_input_stream_parent_class)->finalize (object);
 }
 
@@ -171,10 +1072,14 @@ static void
 musician_gpt_input_stream_class_init (MusicianGptInputStreamClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GInputStreamClass *stream_class = G_INPUT_STREAM_CLASS (klass);
 
   object_class->finalize = musician_gpt_input_stream_finalize;
   object_class->get_property = musician_gpt_input_stream_get_property;
   object_class->set_property = musician_gpt_input_stream_set_property;
+
+  stream_class->read_fn = musician_gpt_input_stream_read_fn;
+  stream_class->skip = musician_gpt_input_stream_skip;
 }
 
 static void
@@ -214,25 +1119,15 @@ musician_gpt_input_stream_read_color (MusicianGptInputStream  *self,
                                       GdkRGBA                 *color,
                                       GError                 **error)
 {
-  gsize n_read;
   guint8 bytes[4];
 
   g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), FALSE);
   g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), FALSE);
   g_return_val_if_fail (color != NULL, FALSE);
 
-  if (!g_input_stream_read_all (G_INPUT_STREAM (self), bytes, G_N_ELEMENTS (bytes), &n_read, cancellable, error))
+  if (!musician_gpt_input_stream_get_data (self, cancellable, bytes, sizeof bytes, error))
     return FALSE;
 
-  if (n_read != G_N_ELEMENTS (bytes))
-    {
-      g_set_error_literal (error,
-                           G_IO_ERROR,
-                           G_IO_ERROR_INVALID_DATA,
-                           "Failed to read enough data for color");
-      return FALSE;
-    }
-
   color->red = bytes[0] / 255.0;
   color->green = bytes[1] / 255.0;
   color->blue = bytes[2] / 255.0;
@@ -256,7 +1151,7 @@ musician_gpt_input_stream_read_color (MusicianGptInputStream  *self,
  *
  * This method will ensure that the resulting string is valid UTF-8.
  *
- * Returns: A newly allocated string containing the string read from the
+ * Returns: (transfer full): A newly allocated string read from the
  *   underlying stream. The string is %NULL terminated.
  */
 gchar *
@@ -265,63 +1160,43 @@ musician_gpt_input_stream_read_fixed_string (MusicianGptInputStream  *self,
                                              GCancellable            *cancellable,
                                              GError                 **error)
 {
-  g_autofree gchar *ret = NULL;
-  GError *local_error = NULL;
-  gsize len;
-  gsize n_read;
+  MusicianGptInputStreamMark mark;
+  gchar *ret;
 
   g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), NULL);
   g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), NULL);
 
-  len = g_data_input_stream_read_byte (G_DATA_INPUT_STREAM (self), cancellable, &local_error);
-
-  if (local_error != NULL)
-    {
-      g_propagate_error (error, local_error);
-      return NULL;
-    }
-
-  if (len > max_length)
-    {
-      g_set_error_literal (error,
-                           G_IO_ERROR,
-                           G_IO_ERROR_INVALID_DATA,
-                           "The underlying string is larger than max_length");
-      return NULL;
-    }
-
-  if (NULL == (ret = musician_gpt_input_stream_allocate (self, (gsize)max_length + 1, error)))
-    return FALSE;
-
-  if (!g_input_stream_read_all (G_INPUT_STREAM (self), ret, max_length, &n_read, cancellable, error))
-    return FALSE;
-
-  if (max_length != n_read)
-    {
-      g_set_error_literal (error,
-                           G_IO_ERROR,
-                           G_IO_ERROR_INVALID_DATA,
-                           "Failed to read string from underlying stream");
-      return NULL;
-    }
+  /* The caller gets a copy, so the arena does not need to keep one */
+  musician_gpt_input_stream_mark (self, &mark);
+  ret = g_strdup (musician_gpt_input_stream_get_fixed_string (self, max_length, cancellable, error));
+  musician_gpt_input_stream_rewind (self, &mark);
 
-  ret[len] = '\0';
+  return ret;
+}
 
-  if (!g_utf8_validate (ret, -1, NULL))
-    {
-      /*
-       * TODO: Can we sanitize the UTF-8 string here so we can continue if
-       *       we come across a bad string? I mean, of course we can, but is
-       *       there an easy glib routine for it.
-       */
-      g_set_error_literal (error,
-                           G_IO_ERROR,
-                           G_IO_ERROR_INVALID_DATA,
-                           "Invalid UTF-8 in underlying string");
-      return NULL;
-    }
+/**
+ * musician_gpt_input_stream_read_fixed_string_borrowed:
+ * @self: A #MusicianGptInputStream
+ * @max_length: the max_length of the string
+ * @cancellable: (nullable): A #GCancellable or %NULL.
+ * @error: a location for a #GError or %NULL
+ *
+ * Like musician_gpt_input_stream_read_fixed_string(), but the string is
+ * allocated from the arena of @self rather than copied for the caller.
+ *
+ * Returns: (transfer none): The string read from the underlying stream,
+ *   owned by the arena of @self. The string is %NULL terminated.
+ */
+const gchar *
+musician_gpt_input_stream_read_fixed_string_borrowed (MusicianGptInputStream  *self,
+                                                      guint8                   max_length,
+                                                      GCancellable            *cancellable,
+                                                      GError                 **error)
+{
+  g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), NULL);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), NULL);
 
-  return g_steal_pointer (&ret);
+  return musician_gpt_input_stream_get_fixed_string (self, max_length, cancellable, error);
 }
 
 /**
@@ -343,17 +1218,13 @@ musician_gpt_input_stream_read_note (MusicianGptInputStream  *self,
                                      MusicianGptNote         *note,
                                      GError                 **error)
 {
-  GError *local_error = NULL;
   gint32 value;
 
   g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), 0);
   g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), FALSE);
 
-  value = g_data_input_stream_read_int32 (G_DATA_INPUT_STREAM (self), cancellable, &local_error);
-
-  if (local_error != NULL)
+  if (!musician_gpt_input_stream_get_int32 (self, cancellable, &value, error))
     {
-      g_propagate_error (error, local_error);
       if (note != NULL)
         *note = 0;
       return FALSE;
@@ -365,15 +1236,56 @@ musician_gpt_input_stream_read_note (MusicianGptInputStream  *self,
   return TRUE;
 }
 
+/**
+ * musician_gpt_input_stream_read_lyric:
+ * @self: A #MusicianGptInputStream
+ * @cancellable: (nullable): A #GCancellable or %NULL.
+ * @position: (out) (nullable): A location for the lyric position or %NULL.
+ * @error: a location for a #GError or %NULL
+ *
+ * Reads a lyric and the measure it begins at from the underlying stream.
+ *
+ * Returns: (transfer full): A newly allocated string containing the lyric.
+ */
 gchar *
 musician_gpt_input_stream_read_lyric (MusicianGptInputStream  *self,
                                       GCancellable            *cancellable,
                                       guint32                 *position,
                                       GError                 **error)
 {
-  g_autofree gchar *ret = NULL;
-  GError *local_error = NULL;
-  gsize n_read;
+  MusicianGptInputStreamMark mark;
+  gchar *ret;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), NULL);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), NULL);
+
+  musician_gpt_input_stream_mark (self, &mark);
+  ret = g_strdup (musician_gpt_input_stream_read_lyric_borrowed (self, cancellable, position, error));
+  musician_gpt_input_stream_rewind (self, &mark);
+
+  return ret;
+}
+
+/**
+ * musician_gpt_input_stream_read_lyric_borrowed:
+ * @self: A #MusicianGptInputStream
+ * @cancellable: (nullable): A #GCancellable or %NULL.
+ * @position: (out) (nullable): A location for the lyric position or %NULL.
+ * @error: a location for a #GError or %NULL
+ *
+ * Like musician_gpt_input_stream_read_lyric(), but the lyric is allocated
+ * from the arena of @self rather than copied for the caller.
+ *
+ * Returns: (transfer none): The lyric text, owned by the arena of @self.
+ */
+const gchar *
+musician_gpt_input_stream_read_lyric_borrowed (MusicianGptInputStream  *self,
+                                               GCancellable            *cancellable,
+                                               guint32                 *position,
+                                               GError                 **error)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+  gchar *ret;
   guint32 len;
   guint32 real_position;
 
@@ -385,13 +1297,8 @@ musician_gpt_input_stream_read_lyric (MusicianGptInputStream  *self,
    * This likely matches up to a given measure that we should
    * display the lyrics above the music.
    */
-  real_position = g_data_input_stream_read_uint32 (G_DATA_INPUT_STREAM (self), cancellable, &local_error);
-
-  if (local_error != NULL)
-    {
-      g_propagate_error (error, local_error);
-      return NULL;
-    }
+  if (!musician_gpt_input_stream_get_uint32 (self, cancellable, &real_position, error))
+    return NULL;
 
   if (position != NULL)
     *position = real_position;
@@ -400,72 +1307,8 @@ musician_gpt_input_stream_read_lyric (MusicianGptInputStream  *self,
    * Now decode the string, which is a 32-bit string length followed by
    * the string bytes themselves.
    */
-  len = g_data_input_stream_read_uint32 (G_DATA_INPUT_STREAM (self), cancellable, &local_error);
-
-  if (local_error != NULL)
-    {
-      g_propagate_error (error, local_error);
-      return NULL;
-    }
-
-  if (len == G_MAXUINT32)
-    {
-      g_set_error_literal (error,
-                           G_IO_ERROR,
-                           G_IO_ERROR_INVALID_DATA,
-                           "Invalid string length");
-      return NULL;
-    }
-
-  if (NULL == (ret = musician_gpt_input_stream_allocate (self, len + 1, error)))
-    return NULL;
-
-  if (!g_input_stream_read_all (G_INPUT_STREAM (self), ret, len, &n_read, cancellable, error))
-    return NULL;
-
-  if (n_read != len)
-    {
-      g_set_error_literal (error,
-                           G_IO_ERROR,
-                           G_IO_ERROR_INVALID_DATA,
-                           "Unexpected end of file");
-      return NULL;
-    }
-
-  ret[len] = '\0';
-
-  return g_steal_pointer (&ret);
-}
-
-gchar *
-musician_gpt_input_stream_read_string (MusicianGptInputStream  *self,
-                                       GCancellable            *cancellable,
-                                       GError                 **error)
-{
-  g_autofree gchar *ret = NULL;
-  GError *local_error = NULL;
-  gsize n_read;
-  guint32 len;
-  guint32 plen;
-
-  g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), NULL);
-  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), NULL);
-
-  /*
-   * So as idiotic as this sounds, there are two string lengths for
-   * the string. A 32-bit string, (which is string length + 1), and
-   * then a pascal like string which is a 1-byte length followed by
-   * the string. So we waste 5 bytes of overhead for a 255-byte max
-   * string.
-   */
-
-  len = g_data_input_stream_read_uint32 (G_DATA_INPUT_STREAM (self), cancellable, &local_error);
-
-  if (local_error != NULL)
-    {
-      g_propagate_error (error, local_error);
-      return NULL;
-    }
+  if (!musician_gpt_input_stream_get_uint32 (self, cancellable, &len, error))
+    return NULL;
 
   if (len == G_MAXUINT32)
     {
@@ -476,62 +1319,135 @@ musician_gpt_input_stream_read_string (MusicianGptInputStream  *self,
       return NULL;
     }
 
-  plen = g_data_input_stream_read_byte (G_DATA_INPUT_STREAM (self), cancellable, &local_error);
-
-  if (local_error != NULL)
-    {
-      g_propagate_error (error, local_error);
-      return NULL;
-    }
-
-  if (plen + 1 != len)
+  /*
+   * When decoding from memory, make sure the text is all there before
+   * allocating for it. Otherwise a truncated file (or a push parser still
+   * waiting on the rest of the lyric) would allocate up to 4 GiB for nothing.
+   */
+  if (priv->bytes != NULL && len > priv->len - priv->pos)
     {
-      g_set_error_literal (error,
-                           G_IO_ERROR,
-                           G_IO_ERROR_INVALID_DATA,
-                           "Corrupt or invalid data discovered");
+      musician_gpt_input_stream_set_truncated (priv, len);
+      musician_gpt_input_stream_short_read (error);
       return NULL;
     }
 
-  if (NULL == (ret = musician_gpt_input_stream_allocate (self, plen + 1, error)))
+  if (NULL == (ret = musician_gpt_input_stream_allocate (self, (gsize)len + 1, error)))
     return NULL;
 
-  if (!g_input_stream_read_all (G_INPUT_STREAM (self), ret, plen, &n_read, cancellable, error))
+  if (!musician_gpt_input_stream_get_data (self, cancellable, ret, len, error))
     return NULL;
 
-  if (n_read != plen)
-    {
-      g_set_error_literal (error,
-                           G_IO_ERROR,
-                           G_IO_ERROR_INVALID_DATA,
-                           "Unexpected end of file");
-      return NULL;
-    }
+  ret[len] = '\0';
 
-  ret[plen] = '\0';
+  return ret;
+}
+
+/**
+ * musician_gpt_input_stream_read_string:
+ * @self: A #MusicianGptInputStream
+ * @cancellable: (nullable): A #GCancellable or %NULL.
+ * @error: a location for a #GError or %NULL
+ *
+ * Reads a length-prefixed string from the underlying stream.
+ *
+ * Returns: (transfer full): A newly allocated string.
+ */
+gchar *
+musician_gpt_input_stream_read_string (MusicianGptInputStream  *self,
+                                       GCancellable            *cancellable,
+                                       GError                 **error)
+{
+  MusicianGptInputStreamMark mark;
+  gchar *ret;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), NULL);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), NULL);
+
+  musician_gpt_input_stream_mark (self, &mark);
+  ret = g_strdup (musician_gpt_input_stream_get_string (self, cancellable, error));
+  musician_gpt_input_stream_rewind (self, &mark);
 
-  return g_steal_pointer (&ret);
+  return ret;
+}
+
+/**
+ * musician_gpt_input_stream_read_string_borrowed:
+ * @self: A #MusicianGptInputStream
+ * @cancellable: (nullable): A #GCancellable or %NULL.
+ * @error: a location for a #GError or %NULL
+ *
+ * Like musician_gpt_input_stream_read_string(), without the copy.
+ *
+ * The string is allocated from the arena of @self and stays valid for as
+ * long as the arena is alive. Objects built by #MusicianGptParser keep a
+ * reference to it, so they can store the string without copying it.
+ *
+ * Returns: (transfer none): The string, owned by the arena of @self.
+ */
+const gchar *
+musician_gpt_input_stream_read_string_borrowed (MusicianGptInputStream  *self,
+                                                GCancellable            *cancellable,
+                                                GError                 **error)
+{
+  g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), NULL);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), NULL);
+
+  return musician_gpt_input_stream_get_string (self, cancellable, error);
 }
 
+/**
+ * musician_gpt_input_stream_read_string_array:
+ * @self: A #MusicianGptInputStream
+ * @cancellable: (nullable): A #GCancellable or %NULL.
+ * @error: a location for a #GError or %NULL
+ *
+ * Reads a 32-bit count followed by that many strings.
+ *
+ * Returns: (transfer full): A newly allocated %NULL terminated array of
+ *   strings. Free it with g_strfreev().
+ */
 gchar **
 musician_gpt_input_stream_read_string_array (MusicianGptInputStream  *self,
                                              GCancellable            *cancellable,
                                              GError                 **error)
 {
-  g_auto(GStrv) ret = NULL;
-  GError *local_error = NULL;
-  gint32 n_strings;
+  MusicianGptInputStreamMark mark;
+  gchar **ret;
 
   g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), NULL);
   g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), NULL);
 
-  n_strings = g_data_input_stream_read_int32 (G_DATA_INPUT_STREAM (self), cancellable, &local_error);
+  musician_gpt_input_stream_mark (self, &mark);
+  ret = g_strdupv ((gchar **)musician_gpt_input_stream_read_string_array_borrowed (self, cancellable, error));
+  musician_gpt_input_stream_rewind (self, &mark);
 
-  if (local_error != NULL)
-    {
-      g_propagate_error (error, local_error);
-      return NULL;
-    }
+  return ret;
+}
+
+/**
+ * musician_gpt_input_stream_read_string_array_borrowed:
+ * @self: A #MusicianGptInputStream
+ * @cancellable: (nullable): A #GCancellable or %NULL.
+ * @error: a location for a #GError or %NULL
+ *
+ * Like musician_gpt_input_stream_read_string_array(), without the copy.
+ *
+ * Returns: (transfer none): A %NULL terminated array of strings. Both the
+ *   array and the strings are owned by the arena of @self.
+ */
+const gchar * const *
+musician_gpt_input_stream_read_string_array_borrowed (MusicianGptInputStream  *self,
+                                                      GCancellable            *cancellable,
+                                                      GError                 **error)
+{
+  const gchar **ret;
+  gint32 n_strings;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), NULL);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), NULL);
+
+  if (!musician_gpt_input_stream_get_int32 (self, cancellable, &n_strings, error))
+    return NULL;
 
   if (n_strings < 0)
     {
@@ -542,22 +1458,18 @@ musician_gpt_input_stream_read_string_array (MusicianGptInputStream  *self,
       return NULL;
     }
 
-  if (NULL == (ret = musician_gpt_input_stream_allocate_n (self, sizeof (gchar *), n_strings + 1, error)))
+  if (NULL == (ret = musician_gpt_input_stream_allocate_n (self, sizeof (gchar *), (gsize)n_strings + 1, error)))
     return NULL;
 
   for (gint32 i = 0; i < n_strings; i++)
     {
-      g_autofree gchar *str = NULL;
-
-      if (NULL == (str = musician_gpt_input_stream_read_string (self, cancellable, error)))
+      if (NULL == (ret[i] = musician_gpt_input_stream_get_string (self, cancellable, error)))
         return NULL;
-
-      ret[i] = g_steal_pointer (&str);
     }
 
   ret[n_strings] = NULL;
 
-  return g_steal_pointer (&ret);
+  return ret;
 }
 
 gboolean
@@ -566,19 +1478,13 @@ musician_gpt_input_stream_read_triplet_feel  (MusicianGptInputStream  *self,
                                               MusicianGptTripletFeel  *triplet_feel,
                                               GError                 **error)
 {
-  GError *local_error = NULL;
   guint8 byte;
 
   g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), FALSE);
   g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), FALSE);
 
-  byte = g_data_input_stream_read_byte (G_DATA_INPUT_STREAM (self), cancellable, &local_error);
-
-  if (local_error != NULL)
-    {
-      g_propagate_error (error, local_error);
-      return FALSE;
-    }
+  if (!musician_gpt_input_stream_get_byte (self, cancellable, &byte, error))
+    return FALSE;
 
   if (triplet_feel != NULL)
     {
@@ -597,19 +1503,13 @@ musician_gpt_input_stream_read_tempo (MusicianGptInputStream  *self,
                                       guint32                 *tempo,
                                       GError                 **error)
 {
-  GError *local_error = NULL;
   guint32 real_tempo;
 
   g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), FALSE);
   g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), FALSE);
 
-  real_tempo = g_data_input_stream_read_uint32 (G_DATA_INPUT_STREAM (self), cancellable, &local_error);
-
-  if (local_error != NULL)
-    {
-      g_propagate_error (error, local_error);
-      return FALSE;
-    }
+  if (!musician_gpt_input_stream_get_uint32 (self, cancellable, &real_tempo, error))
+    return FALSE;
 
   if (tempo != NULL)
     *tempo = real_tempo;
@@ -623,19 +1523,13 @@ musician_gpt_input_stream_read_key (MusicianGptInputStream  *self,
                                     MusicianGptKey          *key,
                                     GError                 **error)
 {
-  GError *local_error = NULL;
   gint32 real_key;
 
   g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), FALSE);
   g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), FALSE);
 
-  real_key = g_data_input_stream_read_int32 (G_DATA_INPUT_STREAM (self), cancellable, &local_error);
-
-  if (local_error != NULL)
-    {
-      g_propagate_error (error, local_error);
-      return FALSE;
-    }
+  if (!musician_gpt_input_stream_get_int32 (self, cancellable, &real_key, error))
+    return FALSE;
 
   if (key != NULL)
     *key = real_key;
@@ -649,19 +1543,13 @@ musician_gpt_input_stream_read_octave (MusicianGptInputStream  *self,
                                        MusicianGptOctave       *octave,
                                        GError                 **error)
 {
-  GError *local_error = NULL;
   guint8 real_octave;
 
   g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), FALSE);
   g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), FALSE);
 
-  real_octave = g_data_input_stream_read_byte (G_DATA_INPUT_STREAM (self), cancellable, &local_error);
-
-  if (local_error != NULL)
-    {
-      g_propagate_error (error, local_error);
-      return FALSE;
-    }
+  if (!musician_gpt_input_stream_get_byte (self, cancellable, &real_octave, error))
+    return FALSE;
 
   if (octave != NULL)
     *octave = real_octave;
@@ -675,19 +1563,13 @@ musician_gpt_input_stream_read_int32 (MusicianGptInputStream  *self,
                                       gint32                  *value,
                                       GError                 **error)
 {
-  GError *local_error = NULL;
   gint32 real_value;
 
   g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (self));
   g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
 
-  real_value = g_data_input_stream_read_int32 (G_DATA_INPUT_STREAM (self), cancellable, &local_error);
-
-  if (local_error != NULL)
-    {
-      g_propagate_error (error, local_error);
-      return FALSE;
-    }
+  if (!musician_gpt_input_stream_get_int32 (self, cancellable, &real_value, error))
+    return FALSE;
 
   if (value != NULL)
     *value = real_value;
@@ -701,19 +1583,13 @@ musician_gpt_input_stream_read_uint32 (MusicianGptInputStream  *self,
                                        guint32                 *value,
                                        GError                 **error)
 {
-  GError *local_error = NULL;
   guint32 real_value;
 
   g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (self));
   g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
 
-  real_value = g_data_input_stream_read_uint32 (G_DATA_INPUT_STREAM (self), cancellable, &local_error);
-
-  if (local_error != NULL)
-    {
-      g_propagate_error (error, local_error);
-      return FALSE;
-    }
+  if (!musician_gpt_input_stream_get_uint32 (self, cancellable, &real_value, error))
+    return FALSE;
 
   if (value != NULL)
     *value = real_value;
@@ -727,19 +1603,13 @@ musician_gpt_input_stream_read_byte (MusicianGptInputStream  *self,
                                      guchar                  *value,
                                      GError                 **error)
 {
-  GError *local_error = NULL;
   guchar real_value;
 
   g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (self));
   g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
 
-  real_value = g_data_input_stream_read_byte (G_DATA_INPUT_STREAM (self), cancellable, &local_error);
-
-  if (local_error != NULL)
-    {
-      g_propagate_error (error, local_error);
-      return FALSE;
-    }
+  if (!musician_gpt_input_stream_get_byte (self, cancellable, &real_value, error))
+    return FALSE;
 
   if (value != NULL)
     *value = real_value;
@@ -755,7 +1625,6 @@ musician_gpt_input_stream_read_midi_port (MusicianGptInputStream  *self,
                                           GError                 **error)
 {
   MusicianGptMidiPort dummy_port;
-  GError *local_error = NULL;
 
   g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), FALSE);
   g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), FALSE);
@@ -770,16 +1639,14 @@ musician_gpt_input_stream_read_midi_port (MusicianGptInputStream  *self,
       port->channels[i].port_id = portnum;
       port->channels[i].channel_id = i + 1;
 
-      if (!musician_gpt_input_stream_read_uint32 (self, cancellable, &port->channels[i].instrument, error) ||
-          !musician_gpt_input_stream_read_byte (self, cancellable, &port->channels[i].volume, error) ||
-          !musician_gpt_input_stream_read_byte (self, cancellable, &port->channels[i].balance, error) ||
-          !musician_gpt_input_stream_read_byte (self, cancellable, &port->channels[i].chorus, error) ||
-          !musician_gpt_input_stream_read_byte (self, cancellable, &port->channels[i].reverb, error) ||
-          !musician_gpt_input_stream_read_byte (self, cancellable, &port->channels[i].phaser, error) ||
-          !musician_gpt_input_stream_read_byte (self, cancellable, &port->channels[i].tremelo, error))
-        return FALSE;
-
-      if (!g_input_stream_skip (G_INPUT_STREAM (self), 2, cancellable, error))
+      if (!musician_gpt_input_stream_get_uint32 (self, cancellable, &port->channels[i].instrument, error) ||
+          !musician_gpt_input_stream_get_byte (self, cancellable, &port->channels[i].volume, error) ||
+          !musician_gpt_input_stream_get_byte (self, cancellable, &port->channels[i].balance, error) ||
+          !musician_gpt_input_stream_get_byte (self, cancellable, &port->channels[i].chorus, error) ||
+          !musician_gpt_input_stream_get_byte (self, cancellable, &port->channels[i].reverb, error) ||
+          !musician_gpt_input_stream_get_byte (self, cancellable, &port->channels[i].phaser, error) ||
+          !musician_gpt_input_stream_get_byte (self, cancellable, &port->channels[i].tremelo, error) ||
+          !musician_gpt_input_stream_discard (self, cancellable, 2, error))
         return FALSE;
 
       port->channels[i]._blank1 = 0;
@@ -788,3 +1655,213 @@ musician_gpt_input_stream_read_midi_port (MusicianGptInputStream  *self,
 
   return TRUE;
 }
+
+/*
+ * The _musician_gpt_input_stream_pull_*() family is the "sticky error" side
+ * of the reader. Instead of every field producing a GError and a gboolean
+ * that must be tested, the first failure is recorded in the stream and all
+ * following pulls return zeroed values without touching the stream. The
+ * parser decodes a whole record (a measure header, a track, a beat) and then
+ * calls _musician_gpt_input_stream_check() once to find out whether any of
+ * it failed.
+ *
+ * Values returned after a failure are meaningless and must not be stored,
+ * which is why callers check before committing a record to the song.
+ */
+
+/*
+ * Checks whether any pull failed since the last check, and whether
+ * @cancellable has been cancelled. The recorded error is handed over to
+ * the caller, so the stream can be used again afterwards.
+ */
+gboolean
+_musician_gpt_input_stream_check (MusicianGptInputStream  *self,
+                                  GCancellable            *cancellable,
+                                  GError                 **error)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self), FALSE);
+
+  if G_UNLIKELY (priv->error != NULL)
+    {
+      g_propagate_error (error, g_steal_pointer (&priv->error));
+      return FALSE;
+    }
+
+  return !g_cancellable_set_error_if_cancelled (cancellable, error);
+}
+
+/*
+ * Records an error found by the caller (such as an out of range value) as
+ * if a pull had failed. Only the first error is kept.
+ */
+void
+_musician_gpt_input_stream_set_error (MusicianGptInputStream *self,
+                                      GQuark                  domain,
+                                      gint                    code,
+                                      const gchar            *format,
+                                      ...)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+  va_list args;
+
+  g_return_if_fail (MUSICIAN_IS_GPT_INPUT_STREAM (self));
+
+  if (priv->error != NULL)
+    return;
+
+  va_start (args, format);
+  priv->error = g_error_new_valist (domain, code, format, args);
+  va_end (args);
+}
+
+gboolean
+_musician_gpt_input_stream_failed (MusicianGptInputStream *self)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  return priv->error != NULL;
+}
+
+guint8
+_musician_gpt_input_stream_pull_byte (MusicianGptInputStream *self,
+                                      GCancellable           *cancellable)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+  guint8 value = 0;
+
+  if G_LIKELY (priv->error == NULL && priv->bytes != NULL && priv->pos < priv->len)
+    return priv->data[priv->pos++];
+
+  if (priv->error == NULL &&
+      !musician_gpt_input_stream_get_byte (self, cancellable, &value, &priv->error))
+    value = 0;
+
+  return value;
+}
+
+guint32
+_musician_gpt_input_stream_pull_uint32 (MusicianGptInputStream *self,
+                                        GCancellable           *cancellable)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+  guint32 value = 0;
+
+  if G_LIKELY (priv->error == NULL && priv->bytes != NULL && priv->len - priv->pos >= sizeof value)
+    {
+      memcpy (&value, &priv->data[priv->pos], sizeof value);
+      priv->pos += sizeof value;
+      return GUINT32_FROM_LE (value);
+    }
+
+  if (priv->error == NULL &&
+      !musician_gpt_input_stream_get_uint32 (self, cancellable, &value, &priv->error))
+    value = 0;
+
+  return value;
+}
+
+gint32
+_musician_gpt_input_stream_pull_int32 (MusicianGptInputStream *self,
+                                       GCancellable           *cancellable)
+{
+  return (gint32)_musician_gpt_input_stream_pull_uint32 (self, cancellable);
+}
+
+void
+_musician_gpt_input_stream_pull_color (MusicianGptInputStream *self,
+                                       GCancellable           *cancellable,
+                                       GdkRGBA                *color)
+{
+  guint8 bytes[4];
+
+  g_assert (color != NULL);
+
+  for (guint i = 0; i < G_N_ELEMENTS (bytes); i++)
+    bytes[i] = _musician_gpt_input_stream_pull_byte (self, cancellable);
+
+  color->red = bytes[0] / 255.0;
+  color->green = bytes[1] / 255.0;
+  color->blue = bytes[2] / 255.0;
+  color->alpha = 1.0;
+}
+
+void
+_musician_gpt_input_stream_pull_skip (MusicianGptInputStream *self,
+                                      gsize                   n_bytes,
+                                      GCancellable           *cancellable)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  if (priv->error == NULL)
+    musician_gpt_input_stream_discard (self, cancellable, n_bytes, &priv->error);
+}
+
+/* Returns %NULL if this or a previous pull failed */
+const gchar *
+_musician_gpt_input_stream_pull_string (MusicianGptInputStream *self,
+                                        GCancellable           *cancellable)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  if (priv->error != NULL)
+    return NULL;
+
+  return musician_gpt_input_stream_get_string (self, cancellable, &priv->error);
+}
+
+const gchar *
+_musician_gpt_input_stream_pull_fixed_string (MusicianGptInputStream *self,
+                                              guint8                  max_length,
+                                              GCancellable           *cancellable)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  if (priv->error != NULL)
+    return NULL;
+
+  return musician_gpt_input_stream_get_fixed_string (self, max_length, cancellable, &priv->error);
+}
+
+/* Like musician_gpt_input_stream_read_lyric_borrowed(), %NULL after a failure */
+const gchar *
+_musician_gpt_input_stream_pull_lyric (MusicianGptInputStream *self,
+                                       GCancellable           *cancellable,
+                                       guint32                *position)
+{
+  MusicianGptInputStreamPrivate *priv = musician_gpt_input_stream_get_instance_private (self);
+
+  if (priv->error != NULL)
+    return NULL;
+
+  return musician_gpt_input_stream_read_lyric_borrowed (self, cancellable, position, &priv->error);
+}
+
+void
+_musician_gpt_input_stream_pull_midi_port (MusicianGptInputStream *self,
+                                           guint                   portnum,
+                                           GCancellable           *cancellable,
+                                           MusicianGptMidiPort    *port)
+{
+  g_assert (port != NULL);
+
+  port->port_id = portnum;
+
+  for (guint i = 0; i < G_N_ELEMENTS (port->channels); i++)
+    {
+      port->channels[i].port_id = portnum;
+      port->channels[i].channel_id = i + 1;
+      port->channels[i].instrument = _musician_gpt_input_stream_pull_uint32 (self, cancellable);
+      port->channels[i].volume = _musician_gpt_input_stream_pull_byte (self, cancellable);
+      port->channels[i].balance = _musician_gpt_input_stream_pull_byte (self, cancellable);
+      port->channels[i].chorus = _musician_gpt_input_stream_pull_byte (self, cancellable);
+      port->channels[i].reverb = _musician_gpt_input_stream_pull_byte (self, cancellable);
+      port->channels[i].phaser = _musician_gpt_input_stream_pull_byte (self, cancellable);
+      port->channels[i].tremelo = _musician_gpt_input_stream_pull_byte (self, cancellable);
+      port->channels[i]._blank1 = 0;
+      port->channels[i]._blank2 = 0;
+
+      _musician_gpt_input_stream_pull_skip (self, 2, cancellable);
+    }
+}
@@ -47,62 +47,77 @@ struct _MusicianGptInputStreamClass
   gpointer _reserved12;
 };
 
-MusicianGptInputStream *musician_gpt_input_stream_new                (GInputStream            *base_stream);
-gboolean                musician_gpt_input_stream_read_color         (MusicianGptInputStream  *self,
-                                                                      GCancellable            *cancellable,
-                                                                      GdkRGBA                 *color,
-                                                                      GError                 **error);
-gchar                  *musician_gpt_input_stream_read_fixed_string  (MusicianGptInputStream  *self,
-                                                                      guint8                   max_length,
-                                                                      GCancellable            *cancellable,
-                                                                      GError                 **error);
-gchar                  *musician_gpt_input_stream_read_string        (MusicianGptInputStream  *self,
-                                                                      GCancellable            *cancellable,
-                                                                      GError                 **error);
-gchar                 **musician_gpt_input_stream_read_string_array  (MusicianGptInputStream  *self,
-                                                                      GCancellable            *cancellable,
-                                                                      GError                 **error);
-gchar                  *musician_gpt_input_stream_read_lyric         (MusicianGptInputStream  *self,
-                                                                      GCancellable            *cancellable,
-                                                                      guint32                 *position,
-                                                                      GError                 **error);
-gboolean                musician_gpt_input_stream_read_triplet_feel  (MusicianGptInputStream  *self,
-                                                                      GCancellable            *cancellable,
-                                                                      MusicianGptTripletFeel  *triplet_feel,
-                                                                      GError                 **error);
-gboolean                musician_gpt_input_stream_read_note          (MusicianGptInputStream  *self,
-                                                                      GCancellable            *cancellable,
-                                                                      MusicianGptNote         *note,
-                                                                      GError                 **error);
-gboolean                musician_gpt_input_stream_read_tempo         (MusicianGptInputStream  *self,
-                                                                      GCancellable            *cancellable,
-                                                                      guint32                 *tempo,
-                                                                      GError                 **error);
-gboolean                musician_gpt_input_stream_read_key           (MusicianGptInputStream  *self,
-                                                                      GCancellable            *cancellable,
-                                                                      MusicianGptKey          *key,
-                                                                      GError                 **error);
-gboolean                musician_gpt_input_stream_read_octave        (MusicianGptInputStream  *self,
-                                                                      GCancellable            *cancellable,
-                                                                      MusicianGptOctave       *octave,
-                                                                      GError                 **error);
-gboolean                musician_gpt_input_stream_read_midi_port     (MusicianGptInputStream  *self,
-                                                                      guint                    portnum,
-                                                                      GCancellable            *cancellable,
-                                                                      MusicianGptMidiPort     *port,
-                                                                      GError                 **error);
-gboolean                musician_gpt_input_stream_read_byte          (MusicianGptInputStream  *self,
-                                                                      GCancellable            *cancellable,
-                                                                      guchar                  *value,
-                                                                      GError                 **error);
-gboolean                musician_gpt_input_stream_read_int32         (MusicianGptInputStream  *self,
-                                                                      GCancellable            *cancellable,
-                                                                      gint32                  *value,
-                                                                      GError                 **error);
-gboolean                musician_gpt_input_stream_read_uint32        (MusicianGptInputStream  *self,
-                                                                      GCancellable            *cancellable,
-                                                                      guint32                 *value,
-                                                                      GError                 **error);
+MusicianGptInputStream *musician_gpt_input_stream_new                        (GInputStream            *base_stream);
+MusicianGptInputStream *musician_gpt_input_stream_new_for_bytes              (GBytes                  *bytes);
+gboolean                musician_gpt_input_stream_read_color                 (MusicianGptInputStream  *self,
+                                                                              GCancellable            *cancellable,
+                                                                              GdkRGBA                 *color,
+                                                                              GError                 **error);
+gchar                  *musician_gpt_input_stream_read_fixed_string          (MusicianGptInputStream  *self,
+                                                                              guint8                   max_length,
+                                                                              GCancellable            *cancellable,
+                                                                              GError                 **error);
+const gchar            *musician_gpt_input_stream_read_fixed_string_borrowed (MusicianGptInputStream  *self,
+                                                                              guint8                   max_length,
+                                                                              GCancellable            *cancellable,
+                                                                              GError                 **error);
+gchar                  *musician_gpt_input_stream_read_string                (MusicianGptInputStream  *self,
+                                                                              GCancellable            *cancellable,
+                                                                              GError                 **error);
+const gchar            *musician_gpt_input_stream_read_string_borrowed       (MusicianGptInputStream  *self,
+                                                                              GCancellable            *cancellable,
+                                                                              GError                 **error);
+gchar                 **musician_gpt_input_stream_read_string_array          (MusicianGptInputStream  *self,
+                                                                              GCancellable            *cancellable,
+                                                                              GError                 **error);
+const gchar * const    *musician_gpt_input_stream_read_string_array_borrowed (MusicianGptInputStream  *self,
+                                                                              GCancellable            *cancellable,
+                                                                              GError                 **error);
+gchar                  *musician_gpt_input_stream_read_lyric                 (MusicianGptInputStream  *self,
+                                                                              GCancellable            *cancellable,
+                                                                              guint32                 *position,
+                                                                              GError                 **error);
+const gchar            *musician_gpt_input_stream_read_lyric_borrowed        (MusicianGptInputStream  *self,
+                                                                              GCancellable            *cancellable,
+                                                                              guint32                 *position,
+                                                                              GError                 **error);
+gboolean                musician_gpt_input_stream_read_triplet_feel          (MusicianGptInputStream  *self,
+                                                                              GCancellable            *cancellable,
+                                                                              MusicianGptTripletFeel  *triplet_feel,
+                                                                              GError                 **error);
+gboolean                musician_gpt_input_stream_read_note                  (MusicianGptInputStream  *self,
+                                                                              GCancellable            *cancellable,
+                                                                              MusicianGptNote         *note,
+                                                                              GError                 **error);
+gboolean                musician_gpt_input_stream_read_tempo                 (MusicianGptInputStream  *self,
+                                                                              GCancellable            *cancellable,
+                                                                              guint32                 *tempo,
+                                                                              GError                 **error);
+gboolean                musician_gpt_input_stream_read_key                   (MusicianGptInputStream  *self,
+                                                                              GCancellable            *cancellable,
+                                                                              MusicianGptKey          *key,
+                                                                              GError                 **error);
+gboolean                musician_gpt_input_stream_read_octave                (MusicianGptInputStream  *self,
+                                                                              GCancellable            *cancellable,
+                                                                              MusicianGptOctave       *octave,
+                                                                              GError                 **error);
+gboolean                musician_gpt_input_stream_read_midi_port             (MusicianGptInputStream  *self,
+                                                                              guint                    portnum,
+                                                                              GCancellable            *cancellable,
+                                                                              MusicianGptMidiPort     *port,
+                                                                              GError                 **error);
+gboolean                musician_gpt_input_stream_read_byte                  (MusicianGptInputStream  *self,
+                                                                              GCancellable            *cancellable,
+                                                                              guchar                  *value,
+                                                                              GError                 **error);
+gboolean                musician_gpt_input_stream_read_int32                 (MusicianGptInputStream  *self,
+                                                                              GCancellable            *cancellable,
+                                                                              gint32                  *value,
+                                                                              GError                 **error);
+gboolean                musician_gpt_input_stream_read_uint32                (MusicianGptInputStream  *self,
+                                                                              GCancellable            *cancellable,
+                                                                              guint32                 *value,
+                                                                              GError                 **error);
 
 G_END_DECLS
 
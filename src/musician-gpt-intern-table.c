@@ -0,0 +1,228 @@
+/* musician-gpt-intern-table.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "musician-gpt-intern-table"
+
+#include "musician-gpt-bend.h"
+#include "musician-gpt-bend-private.h"
+#include "musician-gpt-chord.h"
+#include "musician-gpt-chord-private.h"
+#include "musician-gpt-intern-table.h"
+
+/*
+ * Tabs repeat the same chord diagrams and bend shapes over and over, so a
+ * song keeps one instance of each in a MusicianGptInternTable and shares
+ * it between every beat that uses it. Interned objects never change, so
+ * two of them are equal exactly when they are the same pointer.
+ *
+ * The table holds a reference to everything it has handed out, which is
+ * released along with the table once the song and its beat stores are
+ * gone. Lookups are thread-safe, as measures are decoded on several
+ * threads at once.
+ */
+
+struct _MusicianGptInternTable
+{
+  volatile gint    ref_count;
+
+  GMutex           mutex;
+  MusicianGptPool *pool;
+  GHashTable      *chords;
+  GHashTable      *bends;
+};
+
+MusicianGptInternTable *
+musician_gpt_intern_table_new (MusicianGptPool *pool)
+{
+  MusicianGptInternTable *self;
+
+  g_return_val_if_fail (pool != NULL, NULL);
+
+  self = g_slice_new0 (MusicianGptInternTable);
+  self->ref_count = 1;
+  self->pool = musician_gpt_pool_ref (pool);
+  self->chords = g_hash_table_new_full (_musician_gpt_chord_hash,
+                                        _musician_gpt_chord_equal,
+                                        (GDestroyNotify)musician_gpt_chord_unref,
+                                        NULL);
+  self->bends = g_hash_table_new_full (_musician_gpt_bend_hash,
+                                       _musician_gpt_bend_equal,
+                                       (GDestroyNotify)musician_gpt_bend_unref,
+                                       NULL);
+  g_mutex_init (&self->mutex);
+
+  return self;
+}
+
+MusicianGptInternTable *
+musician_gpt_intern_table_ref (MusicianGptInternTable *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+  g_return_val_if_fail (self->ref_count > 0, NULL);
+
+  g_atomic_int_inc (&self->ref_count);
+
+  return self;
+}
+
+void
+musician_gpt_intern_table_unref (MusicianGptInternTable *self)
+{
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (self->ref_count > 0);
+
+  if (g_atomic_int_dec_and_test (&self->ref_count))
+    {
+      g_clear_pointer (&self->chords, g_hash_table_unref);
+      g_clear_pointer (&self->bends, g_hash_table_unref);
+      g_clear_pointer (&self->pool, musician_gpt_pool_unref);
+      g_mutex_clear (&self->mutex);
+      g_slice_free (MusicianGptInternTable, self);
+    }
+}
+
+/**
+ * musician_gpt_intern_table_get_pool:
+ * @self: A #MusicianGptInternTable
+ *
+ * Returns: (transfer none): the pool interned objects are allocated from.
+ */
+MusicianGptPool *
+musician_gpt_intern_table_get_pool (MusicianGptInternTable *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  return self->pool;
+}
+
+/*
+ * Returns the interned copy of @candidate, adding @candidate itself if
+ * there is none yet. Consumes the reference to @candidate.
+ */
+static gpointer
+musician_gpt_intern_table_intern (MusicianGptInternTable *self,
+                                  GHashTable             *table,
+                                  gpointer                candidate,
+                                  GBoxedCopyFunc          ref,
+                                  GDestroyNotify          unref)
+{
+  gpointer ret;
+
+  g_mutex_lock (&self->mutex);
+
+  if (NULL == (ret = g_hash_table_lookup (table, candidate)))
+    {
+      g_hash_table_add (table, candidate);
+      ret = candidate;
+    }
+  else
+    {
+      /* Freeing goes straight back to the pool's free list */
+      unref (candidate);
+    }
+
+  ret = ref (ret);
+
+  g_mutex_unlock (&self->mutex);
+
+  return ret;
+}
+
+/**
+ * musician_gpt_intern_table_get_chord:
+ * @self: A #MusicianGptInternTable
+ * @name: (nullable): The name of the chord diagram
+ *
+ * Gets the chord named @name, creating it the first time it is asked for.
+ *
+ * Returns: (transfer full): A shared #MusicianGptChord.
+ */
+MusicianGptChord *
+musician_gpt_intern_table_get_chord (MusicianGptInternTable *self,
+                                     const gchar            *name)
+{
+  MusicianGptChord *chord;
+
+  g_return_val_if_fail (self != NULL, NULL);
+
+  chord = _musician_gpt_chord_new_from_pool (self->pool, name);
+
+  return musician_gpt_intern_table_intern (self,
+                                           self->chords,
+                                           chord,
+                                           (GBoxedCopyFunc)musician_gpt_chord_ref,
+                                           (GDestroyNotify)musician_gpt_chord_unref);
+}
+
+/**
+ * musician_gpt_intern_table_get_bend:
+ * @self: A #MusicianGptInternTable
+ * @bend_type: The #MusicianGptBendType of the bend
+ * @points: (array length=n_points): The points of the bend
+ * @n_points: The number of elements in @points
+ *
+ * Gets the bend of @bend_type through @points, creating it the first time
+ * it is asked for. The bend is frozen and must not be changed.
+ *
+ * Returns: (transfer full): A shared #MusicianGptBend.
+ */
+MusicianGptBend *
+musician_gpt_intern_table_get_bend (MusicianGptInternTable     *self,
+                                    MusicianGptBendType         bend_type,
+                                    const MusicianGptBendPoint *points,
+                                    guint                       n_points)
+{
+  MusicianGptBend *bend;
+
+  g_return_val_if_fail (self != NULL, NULL);
+  g_return_val_if_fail (points != NULL || n_points == 0, NULL);
+
+  bend = _musician_gpt_bend_new_from_pool (self->pool);
+  musician_gpt_bend_set_bend_type (bend, bend_type);
+
+  for (guint i = 0; i < n_points; i++)
+    musician_gpt_bend_add_point (bend, &points[i]);
+
+  _musician_gpt_bend_freeze (bend);
+
+  return musician_gpt_intern_table_intern (self,
+                                           self->bends,
+                                           bend,
+                                           (GBoxedCopyFunc)musician_gpt_bend_ref,
+                                           (GDestroyNotify)musician_gpt_bend_unref);
+}
+
+/**
+ * musician_gpt_intern_table_get_n_items:
+ * @self: A #MusicianGptInternTable
+ *
+ * Returns: the number of distinct chords and bends in @self.
+ */
+guint
+musician_gpt_intern_table_get_n_items (MusicianGptInternTable *self)
+{
+  guint ret;
+
+  g_return_val_if_fail (self != NULL, 0);
+
+  g_mutex_lock (&self->mutex);
+  ret = g_hash_table_size (self->chords) + g_hash_table_size (self->bends);
+  g_mutex_unlock (&self->mutex);
+
+  return ret;
+}
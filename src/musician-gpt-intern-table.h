@@ -0,0 +1,45 @@
+/* musician-gpt-intern-table.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_INTERN_TABLE_H
+#define MUSICIAN_GPT_INTERN_TABLE_H
+
+#include "musician-gpt-pool.h"
+#include "musician-gpt-types.h"
+
+G_BEGIN_DECLS
+
+typedef struct _MusicianGptInternTable MusicianGptInternTable;
+
+MusicianGptInternTable *musician_gpt_intern_table_new         (MusicianGptPool            *pool);
+MusicianGptInternTable *musician_gpt_intern_table_ref         (MusicianGptInternTable     *self);
+void                    musician_gpt_intern_table_unref       (MusicianGptInternTable     *self);
+MusicianGptPool        *musician_gpt_intern_table_get_pool    (MusicianGptInternTable     *self);
+MusicianGptChord       *musician_gpt_intern_table_get_chord   (MusicianGptInternTable     *self,
+                                                               const gchar                *name);
+MusicianGptBend        *musician_gpt_intern_table_get_bend    (MusicianGptInternTable     *self,
+                                                               MusicianGptBendType         bend_type,
+                                                               const MusicianGptBendPoint *points,
+                                                               guint                       n_points);
+guint                   musician_gpt_intern_table_get_n_items (MusicianGptInternTable     *self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MusicianGptInternTable, musician_gpt_intern_table_unref)
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_INTERN_TABLE_H */
@@ -19,9 +19,12 @@
 #define G_LOG_DOMAIN "musician-gpt-lyrics"
 
 #include "musician-gpt-lyrics.h"
+#include "musician-gpt-lyrics-private.h"
 
 typedef struct
 {
+  MusicianGptArena *arena;
+
   gchar *text;
   guint position;
 } MusicianGptLyricsPrivate;
@@ -49,7 +52,9 @@ musician_gpt_lyrics_finalize (GObject *object)
   MusicianGptLyrics *self = (MusicianGptLyrics *)object;
   MusicianGptLyricsPrivate *priv = musician_gpt_lyrics_get_instance_private (self);
 
-  g_clear_pointer (&priv->text, g_free);
+  musician_gpt_arena_free_string (priv->arena, priv->text);
+
+  g_clear_pointer (&priv->arena, musician_gpt_arena_unref);
 
   G_OBJECT_CLASS (musician_gpt_lyrics_parent_class)->finalize (object);
 }
@@ -153,8 +158,8 @@ musician_gpt_lyrics_set_text (MusicianGptLyrics *self,
 
   if (g_strcmp0 (priv->text, text) != 0)
     {
-      g_free (priv->text);
-      priv->text = g_strdup (text);
+      musician_gpt_arena_free_string (priv->arena, priv->text);
+      priv->text = musician_gpt_arena_dup_string (priv->arena, text);
       g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_TEXT]);
     }
 }
@@ -183,3 +188,20 @@ musician_gpt_lyrics_set_position (MusicianGptLyrics *self,
       g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_POSITION]);
     }
 }
+
+void
+_musician_gpt_lyrics_set_arena (MusicianGptLyrics *self,
+                                MusicianGptArena  *arena)
+{
+  MusicianGptLyricsPrivate *priv = musician_gpt_lyrics_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_LYRICS (self));
+  g_return_if_fail (priv->arena == NULL);
+
+  /*
+   * Strings that live in @arena are stored without a copy from now on, so
+   * the arena can only be set once, before the parser fills in the object.
+   */
+  if (arena != NULL)
+    priv->arena = musician_gpt_arena_ref (arena);
+}
@@ -0,0 +1,51 @@
+/* musician-gpt-measure-private.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_MEASURE_PRIVATE_H
+#define MUSICIAN_GPT_MEASURE_PRIVATE_H
+
+#include "musician-gpt-arena.h"
+#include "musician-gpt-measure.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Everything a measure is made of, so that parsers can create a measure in
+ * one go with _musician_gpt_measure_new_from_info() rather than setting
+ * (and notifying) each property in turn.
+ */
+typedef struct
+{
+  guint           id;
+  guint           numerator;
+  guint           denominator;
+  guint           n_repeats;
+  guint           nth_ending;
+  MusicianGptKey  key;
+  const gchar    *marker_name;
+  GdkRGBA         marker_color;
+} MusicianGptMeasureInfo;
+
+void                _musician_gpt_measure_set_arena     (MusicianGptMeasure           *self,
+                                                         MusicianGptArena             *arena);
+MusicianGptMeasure *_musician_gpt_measure_new_from_info (const MusicianGptMeasureInfo *info,
+                                                         MusicianGptArena             *arena);
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_MEASURE_PRIVATE_H */
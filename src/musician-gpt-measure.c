@@ -19,9 +19,12 @@
 #define G_LOG_DOMAIN "musician-gpt-measure"
 
 #include "musician-gpt-measure.h"
+#include "musician-gpt-measure-private.h"
 
 typedef struct
 {
+  MusicianGptArena *arena;
+
   gchar *marker_name;
   GdkRGBA marker_color;
   guint id;
@@ -55,7 +58,9 @@ musician_gpt_measure_finalize (GObject *object)
   MusicianGptMeasure *self = (MusicianGptMeasure *)object;
   MusicianGptMeasurePrivate *priv = musician_gpt_measure_get_instance_private (self);
 
-  g_clear_pointer (&priv->marker_name, g_free);
+  musician_gpt_arena_free_string (priv->arena, priv->marker_name);
+
+  g_clear_pointer (&priv->arena, musician_gpt_arena_unref);
 
   G_OBJECT_CLASS (musician_gpt_measure_parent_class)->finalize (object);
 }
@@ -344,8 +349,8 @@ musician_gpt_measure_set_marker_name (MusicianGptMeasure *self,
 
   if (g_strcmp0 (priv->marker_name, marker_name) != 0)
     {
-      g_free (priv->marker_name);
-      priv->marker_name = g_strdup (marker_name);
+      musician_gpt_arena_free_string (priv->arena, priv->marker_name);
+      priv->marker_name = musician_gpt_arena_dup_string (priv->arena, marker_name);
       g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_MARKER_NAME]);
     }
 }
@@ -463,3 +468,52 @@ musician_gpt_measure_compare (const MusicianGptMeasure *a,
 
   return (gint)priva->id - (gint)privb->id;
 }
+
+void
+_musician_gpt_measure_set_arena (MusicianGptMeasure *self,
+                                 MusicianGptArena   *arena)
+{
+  MusicianGptMeasurePrivate *priv = musician_gpt_measure_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_MEASURE (self));
+  g_return_if_fail (priv->arena == NULL);
+
+  /*
+   * Strings that live in @arena are stored without a copy from now on, so
+   * the arena can only be set once, before the parser fills in the object.
+   */
+  if (arena != NULL)
+    priv->arena = musician_gpt_arena_ref (arena);
+}
+
+/*
+ * Creates a measure from @info without emitting any notifications, which
+ * is how parsers create the thousands of measures of a song. Strings that
+ * live in @arena are kept without a copy.
+ */
+MusicianGptMeasure *
+_musician_gpt_measure_new_from_info (const MusicianGptMeasureInfo *info,
+                                     MusicianGptArena             *arena)
+{
+  MusicianGptMeasurePrivate *priv;
+  MusicianGptMeasure *self;
+
+  g_return_val_if_fail (info != NULL, NULL);
+
+  self = g_object_new (MUSICIAN_TYPE_GPT_MEASURE, NULL);
+  priv = musician_gpt_measure_get_instance_private (self);
+
+  if (arena != NULL)
+    priv->arena = musician_gpt_arena_ref (arena);
+
+  priv->id = info->id;
+  priv->numerator = info->numerator;
+  priv->denominator = info->denominator;
+  priv->n_repeats = info->n_repeats;
+  priv->nth_ending = info->nth_ending;
+  priv->key = info->key;
+  priv->marker_name = musician_gpt_arena_dup_string (priv->arena, info->marker_name);
+  priv->marker_color = info->marker_color;
+
+  return self;
+}
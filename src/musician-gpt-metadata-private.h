@@ -0,0 +1,53 @@
+/* musician-gpt-metadata-private.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_METADATA_PRIVATE_H
+#define MUSICIAN_GPT_METADATA_PRIVATE_H
+
+#include "musician-gpt-arena.h"
+#include "musician-gpt-metadata.h"
+
+G_BEGIN_DECLS
+
+/*
+ * The parser fills this in directly. The strings are owned by @arena, which
+ * is the arena of the stream the metadata was scanned from.
+ */
+struct _MusicianGptMetadata
+{
+  volatile gint     ref_count;
+
+  MusicianGptArena *arena;
+
+  const gchar      *version;
+  const gchar      *title;
+  const gchar      *subtitle;
+  const gchar      *artist;
+  const gchar      *album;
+
+  guint32           tempo;
+  MusicianGptKey    key;
+  guint32           n_measures;
+  guint32           n_tracks;
+};
+
+MusicianGptMetadata *_musician_gpt_metadata_new (MusicianGptArena *arena);
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_METADATA_PRIVATE_H */
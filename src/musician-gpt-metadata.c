@@ -0,0 +1,156 @@
+/* musician-gpt-metadata.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "musician-gpt-metadata"
+
+#include "musician-gpt-metadata.h"
+#include "musician-gpt-metadata-private.h"
+
+/**
+ * SECTION:musician-gpt-metadata:
+ * @title: #MusicianGptMetadata
+ * @short_description: Song information found by a metadata scan
+ *
+ * #MusicianGptMetadata contains the fields of a song that are useful for
+ * indexing a music library. It is created by musician_gpt_parser_scan_from_file()
+ * and friends, which only decode the header of the file and never build a
+ * #MusicianGptSong.
+ */
+
+G_DEFINE_BOXED_TYPE (MusicianGptMetadata,
+                     musician_gpt_metadata,
+                     musician_gpt_metadata_ref,
+                     musician_gpt_metadata_unref)
+
+MusicianGptMetadata *
+_musician_gpt_metadata_new (MusicianGptArena *arena)
+{
+  MusicianGptMetadata *self;
+
+  g_return_val_if_fail (arena != NULL, NULL);
+
+  self = g_slice_new0 (MusicianGptMetadata);
+  self->ref_count = 1;
+  self->arena = musician_gpt_arena_ref (arena);
+
+  return self;
+}
+
+static void
+musician_gpt_metadata_free (MusicianGptMetadata *self)
+{
+  g_assert (self);
+  g_assert_cmpint (self->ref_count, ==, 0);
+
+  g_clear_pointer (&self->arena, musician_gpt_arena_unref);
+
+  g_slice_free (MusicianGptMetadata, self);
+}
+
+MusicianGptMetadata *
+musician_gpt_metadata_ref (MusicianGptMetadata *self)
+{
+  g_return_val_if_fail (self, NULL);
+  g_return_val_if_fail (self->ref_count, NULL);
+
+  g_atomic_int_inc (&self->ref_count);
+
+  return self;
+}
+
+void
+musician_gpt_metadata_unref (MusicianGptMetadata *self)
+{
+  g_return_if_fail (self);
+  g_return_if_fail (self->ref_count);
+
+  if (g_atomic_int_dec_and_test (&self->ref_count))
+    musician_gpt_metadata_free (self);
+}
+
+const gchar *
+musician_gpt_metadata_get_version (MusicianGptMetadata *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  return self->version;
+}
+
+const gchar *
+musician_gpt_metadata_get_title (MusicianGptMetadata *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  return self->title;
+}
+
+const gchar *
+musician_gpt_metadata_get_subtitle (MusicianGptMetadata *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  return self->subtitle;
+}
+
+const gchar *
+musician_gpt_metadata_get_artist (MusicianGptMetadata *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  return self->artist;
+}
+
+const gchar *
+musician_gpt_metadata_get_album (MusicianGptMetadata *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  return self->album;
+}
+
+guint
+musician_gpt_metadata_get_tempo (MusicianGptMetadata *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->tempo;
+}
+
+MusicianGptKey
+musician_gpt_metadata_get_key (MusicianGptMetadata *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->key;
+}
+
+guint
+musician_gpt_metadata_get_n_measures (MusicianGptMetadata *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->n_measures;
+}
+
+guint
+musician_gpt_metadata_get_n_tracks (MusicianGptMetadata *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->n_tracks;
+}
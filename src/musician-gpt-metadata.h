@@ -0,0 +1,47 @@
+/* musician-gpt-metadata.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_METADATA_H
+#define MUSICIAN_GPT_METADATA_H
+
+#include <gio/gio.h>
+
+#include "musician-gpt-types.h"
+
+G_BEGIN_DECLS
+
+#define MUSICIAN_TYPE_GPT_METADATA (musician_gpt_metadata_get_type())
+
+GType                musician_gpt_metadata_get_type       (void);
+MusicianGptMetadata *musician_gpt_metadata_ref            (MusicianGptMetadata *self);
+void                 musician_gpt_metadata_unref          (MusicianGptMetadata *self);
+const gchar         *musician_gpt_metadata_get_version    (MusicianGptMetadata *self);
+const gchar         *musician_gpt_metadata_get_title      (MusicianGptMetadata *self);
+const gchar         *musician_gpt_metadata_get_subtitle   (MusicianGptMetadata *self);
+const gchar         *musician_gpt_metadata_get_artist     (MusicianGptMetadata *self);
+const gchar         *musician_gpt_metadata_get_album      (MusicianGptMetadata *self);
+guint                musician_gpt_metadata_get_tempo      (MusicianGptMetadata *self);
+MusicianGptKey       musician_gpt_metadata_get_key        (MusicianGptMetadata *self);
+guint                musician_gpt_metadata_get_n_measures (MusicianGptMetadata *self);
+guint                musician_gpt_metadata_get_n_tracks   (MusicianGptMetadata *self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MusicianGptMetadata, musician_gpt_metadata_unref)
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_METADATA_H */
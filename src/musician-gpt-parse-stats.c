@@ -0,0 +1,57 @@
+/* musician-gpt-parse-stats.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "musician-gpt-parse-stats"
+
+#include "musician-gpt-parse-stats.h"
+
+/**
+ * SECTION:musician-gpt-parse-stats:
+ * @title: #MusicianGptParseStats
+ * @short_description: Counters and timings of a load
+ *
+ * #MusicianGptParseStats is filled in by #MusicianGptParser for every
+ * song it loads. It is a plain structure, so that services loading many
+ * songs can add them up to find files that are unusually slow or large.
+ */
+
+G_DEFINE_BOXED_TYPE (MusicianGptParseStats,
+                     musician_gpt_parse_stats,
+                     musician_gpt_parse_stats_copy,
+                     musician_gpt_parse_stats_free)
+
+/**
+ * musician_gpt_parse_stats_copy:
+ * @self: A #MusicianGptParseStats
+ *
+ * Returns: (transfer full): A copy of @self.
+ */
+MusicianGptParseStats *
+musician_gpt_parse_stats_copy (const MusicianGptParseStats *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  return g_slice_dup (MusicianGptParseStats, self);
+}
+
+void
+musician_gpt_parse_stats_free (MusicianGptParseStats *self)
+{
+  if (self != NULL)
+    g_slice_free (MusicianGptParseStats, self);
+}
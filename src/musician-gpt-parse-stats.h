@@ -0,0 +1,77 @@
+/* musician-gpt-parse-stats.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_PARSE_STATS_H
+#define MUSICIAN_GPT_PARSE_STATS_H
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define MUSICIAN_TYPE_GPT_PARSE_STATS (musician_gpt_parse_stats_get_type())
+
+/**
+ * MusicianGptParseStats:
+ * @n_bytes: The number of bytes of the file that were decoded.
+ * @header_usec: Time spent on the song header, in microseconds.
+ * @measures_usec: Time spent on the measure headers, in microseconds.
+ * @tracks_usec: Time spent on the tracks, in microseconds.
+ * @beats_usec: Time spent on the beats, in microseconds. For a lazy load
+ *   this is only the time spent finding where they are.
+ * @n_measures: The number of measures.
+ * @n_tracks: The number of tracks.
+ * @n_beats: The number of beats, in all tracks.
+ * @n_chords: The number of chord diagrams.
+ * @n_bends: The number of bends, including tremolo bar bends.
+ * @n_unsupported: The number of blocks that were read past because they
+ *   are not supported, such as mix table changes, grace notes and comments.
+ * @n_deferred: The number of measure/track blocks whose beats were left
+ *   to be decoded on demand by a lazy load.
+ * @allocated: The number of bytes allocated for strings while decoding.
+ * @peak_arena_size: The most that was allocated from the arena of the
+ *   load at any one time.
+ *
+ * What went into loading a song, as found in #MusicianGptParser:stats.
+ */
+typedef struct
+{
+  guint64 n_bytes;
+  gint64  header_usec;
+  gint64  measures_usec;
+  gint64  tracks_usec;
+  gint64  beats_usec;
+  guint   n_measures;
+  guint   n_tracks;
+  guint64 n_beats;
+  guint64 n_chords;
+  guint64 n_bends;
+  guint64 n_unsupported;
+  guint64 n_deferred;
+  gsize   allocated;
+  gsize   peak_arena_size;
+} MusicianGptParseStats;
+
+GType                  musician_gpt_parse_stats_get_type (void);
+MusicianGptParseStats *musician_gpt_parse_stats_copy     (const MusicianGptParseStats *self);
+void                   musician_gpt_parse_stats_free     (MusicianGptParseStats       *self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MusicianGptParseStats, musician_gpt_parse_stats_free)
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_PARSE_STATS_H */
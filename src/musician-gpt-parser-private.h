@@ -0,0 +1,38 @@
+/* musician-gpt-parser-private.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_PARSER_PRIVATE_H
+#define MUSICIAN_GPT_PARSER_PRIVATE_H
+
+#include "musician-gpt-parser.h"
+
+G_BEGIN_DECLS
+
+MusicianGptParser      *_musician_gpt_parser_create_subparser (const gchar             *version,
+                                                               GError                 **error);
+MusicianGptInputStream *_musician_gpt_parser_open_file        (GFile                   *file,
+                                                               GCancellable            *cancellable,
+                                                               GError                 **error);
+gboolean                _musician_gpt_parser_load_stream      (MusicianGptParser       *self,
+                                                               MusicianGptInputStream  *stream,
+                                                               GCancellable            *cancellable,
+                                                               GError                 **error);
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_PARSER_PRIVATE_H */
@@ -22,16 +22,34 @@
 
 #include "musician-gp4-parser.h"
 #include "musician-gpt-parser.h"
+#include "musician-gpt-input-stream-private.h"
+#include "musician-gpt-parser-private.h"
 #include "musician-gpt-song.h"
+#include "musician-gpt-song-cache-private.h"
+#include "musician-gpt-trace-private.h"
 
 typedef struct
 {
   MusicianGptSong *song;
+  MusicianGptSongCache *cache;
+
+  /* What went into loading @song, valid once it has been loaded */
+  MusicianGptParseStats stats;
+
+  /* Set while an asynchronous load is in flight */
+  guint loading : 1;
+
+  guint lazy : 1;
+  guint parallel : 1;
 } MusicianGptParserPrivate;
 
 enum {
   PROP_0,
+  PROP_CACHE,
+  PROP_LAZY,
+  PROP_PARALLEL,
   PROP_SONG,
+  PROP_STATS,
   N_PROPS
 };
 
@@ -39,14 +57,17 @@ G_DEFINE_TYPE_WITH_PRIVATE (MusicianGptParser, musician_gpt_parser, G_TYPE_OBJEC
 
 static GParamSpec *properties [N_PROPS];
 
-static MusicianGptSong *
-musician_gpt_parser_real_load (MusicianGptParser       *self,
-                               MusicianGptInputStream  *stream,
-                               const gchar             *version,
-                               GCancellable            *cancellable,
-                               GError                 **error)
+/*
+ * Creates the parser subclass that handles files starting with @version.
+ * This is what lets the default ::load, ::scan and ::parse implementations sniff the
+ * proper subclass, so consumers of the parser don't need to know which exact
+ * parser to use, while we can still separate code into different subclasses
+ * for maintainability.
+ */
+MusicianGptParser *
+_musician_gpt_parser_create_subparser (const gchar  *version,
+                                       GError      **error)
 {
-  g_autoptr(MusicianGptParser) subparser = NULL;
   GType type_id = G_TYPE_NONE;
   struct {
     const gchar *version;
@@ -57,18 +78,7 @@ musician_gpt_parser_real_load (MusicianGptParser       *self,
     { "FICHIER GUITAR PRO L4.06", MUSICIAN_TYPE_GP4_PARSER },
   };
 
-  g_assert (MUSICIAN_IS_GPT_PARSER (self));
-  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
   g_assert (version != NULL);
-  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
-
-  /*
-   * This function serves as a default implementation of ::load that can
-   * sniff the proper subclass based on @version. This is helpful because
-   * it doesn't require consumers of the parser to know which exact parser
-   * to use, but allow us to separate code into different subclasses for
-   * maintainability.
-   */
 
   for (guint i = 0; i < G_N_ELEMENTS (mappings); i++)
     {
@@ -89,7 +99,49 @@ musician_gpt_parser_real_load (MusicianGptParser       *self,
       return NULL;
     }
 
-  subparser = g_object_new (type_id, NULL);
+  return g_object_new (type_id, NULL);
+}
+
+/*
+ * Marks the time @subparser spent on a file after we dispatched to it,
+ * from @offset to wherever it left @stream.
+ */
+static void
+musician_gpt_parser_trace_dispatch (gint64                  begin,
+                                    const gchar            *name,
+                                    MusicianGptParser      *subparser,
+                                    const gchar            *version,
+                                    MusicianGptInputStream *stream,
+                                    gsize                   offset,
+                                    gboolean                success)
+{
+  _musician_gpt_trace_mark (begin,
+                            name,
+                            "%s for \"%s\", bytes %"G_GSIZE_FORMAT"-%"G_GSIZE_FORMAT"%s",
+                            G_OBJECT_TYPE_NAME (subparser),
+                            version,
+                            offset,
+                            _musician_gpt_input_stream_get_offset (stream),
+                            success ? "" : ", failed");
+}
+
+static MusicianGptSong *
+musician_gpt_parser_real_load (MusicianGptParser       *self,
+                               MusicianGptInputStream  *stream,
+                               const gchar             *version,
+                               GCancellable            *cancellable,
+                               GError                 **error)
+{
+  g_autoptr(MusicianGptParser) subparser = NULL;
+  MusicianGptSong *song;
+
+  g_assert (MUSICIAN_IS_GPT_PARSER (self));
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
+  g_assert (version != NULL);
+  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  if (NULL == (subparser = _musician_gpt_parser_create_subparser (version, error)))
+    return NULL;
 
   /*
    * Double check that the subclass did in fact override this function
@@ -106,9 +158,107 @@ musician_gpt_parser_real_load (MusicianGptParser       *self,
       return NULL;
     }
 
+  if (_musician_gpt_trace_is_enabled ())
+    {
+      gint64 begin = _musician_gpt_trace_get_time ();
+      gsize offset = _musician_gpt_input_stream_get_offset (stream);
+
+      song = MUSICIAN_GPT_PARSER_GET_CLASS (subparser)->load (subparser, stream, version, cancellable, error);
+      musician_gpt_parser_trace_dispatch (begin, "parser:load", subparser, version, stream, offset, song != NULL);
+
+      return song;
+    }
+
   return MUSICIAN_GPT_PARSER_GET_CLASS (subparser)->load (subparser, stream, version, cancellable, error);
 }
 
+static MusicianGptMetadata *
+musician_gpt_parser_real_scan (MusicianGptParser       *self,
+                               MusicianGptInputStream  *stream,
+                               const gchar             *version,
+                               GCancellable            *cancellable,
+                               GError                 **error)
+{
+  g_autoptr(MusicianGptParser) subparser = NULL;
+  MusicianGptMetadata *metadata;
+
+  g_assert (MUSICIAN_IS_GPT_PARSER (self));
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
+  g_assert (version != NULL);
+  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  if (NULL == (subparser = _musician_gpt_parser_create_subparser (version, error)))
+    return NULL;
+
+  if (MUSICIAN_GPT_PARSER_GET_CLASS (subparser)->scan == musician_gpt_parser_real_scan)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVAL,
+                   "%s failed to override MusicianGptParserClass::scan",
+                   G_OBJECT_TYPE_NAME (subparser));
+      return NULL;
+    }
+
+  if (_musician_gpt_trace_is_enabled ())
+    {
+      gint64 begin = _musician_gpt_trace_get_time ();
+      gsize offset = _musician_gpt_input_stream_get_offset (stream);
+
+      metadata = MUSICIAN_GPT_PARSER_GET_CLASS (subparser)->scan (subparser, stream, version, cancellable, error);
+      musician_gpt_parser_trace_dispatch (begin, "parser:scan", subparser, version, stream, offset, metadata != NULL);
+
+      return metadata;
+    }
+
+  return MUSICIAN_GPT_PARSER_GET_CLASS (subparser)->scan (subparser, stream, version, cancellable, error);
+}
+
+static gboolean
+musician_gpt_parser_real_parse (MusicianGptParser        *self,
+                                MusicianGptInputStream   *stream,
+                                const gchar              *version,
+                                const MusicianGptEvents  *events,
+                                gpointer                  user_data,
+                                GCancellable             *cancellable,
+                                GError                  **error)
+{
+  g_autoptr(MusicianGptParser) subparser = NULL;
+
+  g_assert (MUSICIAN_IS_GPT_PARSER (self));
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
+  g_assert (version != NULL);
+  g_assert (events != NULL);
+  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  if (NULL == (subparser = _musician_gpt_parser_create_subparser (version, error)))
+    return FALSE;
+
+  if (MUSICIAN_GPT_PARSER_GET_CLASS (subparser)->parse == musician_gpt_parser_real_parse)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVAL,
+                   "%s failed to override MusicianGptParserClass::parse",
+                   G_OBJECT_TYPE_NAME (subparser));
+      return FALSE;
+    }
+
+  if (_musician_gpt_trace_is_enabled ())
+    {
+      gint64 begin = _musician_gpt_trace_get_time ();
+      gsize offset = _musician_gpt_input_stream_get_offset (stream);
+      gboolean ret;
+
+      ret = MUSICIAN_GPT_PARSER_GET_CLASS (subparser)->parse (subparser, stream, version, events, user_data, cancellable, error);
+      musician_gpt_parser_trace_dispatch (begin, "parser:parse", subparser, version, stream, offset, ret);
+
+      return ret;
+    }
+
+  return MUSICIAN_GPT_PARSER_GET_CLASS (subparser)->parse (subparser, stream, version, events, user_data, cancellable, error);
+}
+
 static void
 musician_gpt_parser_finalize (GObject *object)
 {
@@ -116,6 +266,7 @@ musician_gpt_parser_finalize (GObject *object)
   MusicianGptParserPrivate *priv = musician_gpt_parser_get_instance_private (self);
 
   g_clear_object (&priv->song);
+  g_clear_object (&priv->cache);
 
   G_OBJECT_CLASS (musician_gpt_parser_parent_class)->finalize (object);
 }
@@ -127,13 +278,58 @@ musician_gpt_parser_get_property (GObject    *object,
                                   GParamSpec *pspec)
 {
   MusicianGptParser *self = MUSICIAN_GPT_PARSER (object);
+  MusicianGptParserPrivate *priv = musician_gpt_parser_get_instance_private (self);
 
   switch (prop_id)
     {
+    case PROP_CACHE:
+      g_value_set_object (value, musician_gpt_parser_get_cache (self));
+      break;
+
+    case PROP_LAZY:
+      g_value_set_boolean (value, musician_gpt_parser_get_lazy (self));
+      break;
+
+    case PROP_PARALLEL:
+      g_value_set_boolean (value, musician_gpt_parser_get_parallel (self));
+      break;
+
     case PROP_SONG:
       g_value_set_object (value, musician_gpt_parser_get_song (self));
       break;
 
+    case PROP_STATS:
+      if (musician_gpt_parser_get_song (self) != NULL)
+        g_value_set_boxed (value, &priv->stats);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+musician_gpt_parser_set_property (GObject      *object,
+                                  guint         prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+  MusicianGptParser *self = MUSICIAN_GPT_PARSER (object);
+
+  switch (prop_id)
+    {
+    case PROP_CACHE:
+      musician_gpt_parser_set_cache (self, g_value_get_object (value));
+      break;
+
+    case PROP_LAZY:
+      musician_gpt_parser_set_lazy (self, g_value_get_boolean (value));
+      break;
+
+    case PROP_PARALLEL:
+      musician_gpt_parser_set_parallel (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -146,8 +342,35 @@ musician_gpt_parser_class_init (MusicianGptParserClass *klass)
 
   object_class->finalize = musician_gpt_parser_finalize;
   object_class->get_property = musician_gpt_parser_get_property;
+  object_class->set_property = musician_gpt_parser_set_property;
 
   klass->load = musician_gpt_parser_real_load;
+  klass->scan = musician_gpt_parser_real_scan;
+  klass->parse = musician_gpt_parser_real_parse;
+
+  /* Every decoder starts from a parser class, so look at MUSICIAN_TRACE here */
+  _musician_gpt_trace_init ();
+
+  properties [PROP_CACHE] =
+    g_param_spec_object ("cache",
+                         "Cache",
+                         "The cache that loaded songs are shared through",
+                         MUSICIAN_TYPE_GPT_SONG_CACHE,
+                         (G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS));
+
+  properties [PROP_LAZY] =
+    g_param_spec_boolean ("lazy",
+                          "Lazy",
+                          "If the beats of a song are decoded only when requested",
+                          FALSE,
+                          (G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS));
+
+  properties [PROP_PARALLEL] =
+    g_param_spec_boolean ("parallel",
+                          "Parallel",
+                          "If the beats of a song are decoded on multiple threads",
+                          FALSE,
+                          (G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS));
 
   properties [PROP_SONG] =
     g_param_spec_object ("song",
@@ -156,6 +379,21 @@ musician_gpt_parser_class_init (MusicianGptParserClass *klass)
                          MUSICIAN_TYPE_GPT_SONG,
                          (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * MusicianGptParser:stats:
+   *
+   * The #MusicianGptParseStats of the song that has been loaded, or %NULL
+   * if no song has been loaded yet. A song that was found in
+   * #MusicianGptParser:cache did not need decoding, so its counters are
+   * all zero.
+   */
+  properties [PROP_STATS] =
+    g_param_spec_boxed ("stats",
+                        "Stats",
+                        "What went into loading the song",
+                        MUSICIAN_TYPE_GPT_PARSE_STATS,
+                        (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   g_object_class_install_properties (object_class, N_PROPS, properties);
 }
 
@@ -185,41 +423,168 @@ musician_gpt_parser_get_song (MusicianGptParser *self)
   return priv->song;
 }
 
+/**
+ * musician_gpt_parser_get_stats:
+ * @self: A #MusicianGptParser
+ * @stats: (out caller-allocates): Location for the #MusicianGptParseStats
+ *
+ * Gets the #MusicianGptParser:stats of the song that has been loaded.
+ *
+ * Returns: %TRUE if a song has been loaded and @stats was set.
+ */
 gboolean
-musician_gpt_parser_load_from_file (MusicianGptParser  *self,
-                                    GFile              *file,
-                                    GCancellable       *cancellable,
-                                    GError            **error)
+musician_gpt_parser_get_stats (MusicianGptParser     *self,
+                               MusicianGptParseStats *stats)
 {
-  g_autoptr(GFileInputStream) stream = NULL;
+  MusicianGptParserPrivate *priv = musician_gpt_parser_get_instance_private (self);
 
   g_return_val_if_fail (MUSICIAN_IS_GPT_PARSER (self), FALSE);
-  g_return_val_if_fail (G_IS_FILE (file), FALSE);
-  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), FALSE);
+  g_return_val_if_fail (stats != NULL, FALSE);
 
-  if (NULL != (stream = g_file_read (file, cancellable, error)))
-    return musician_gpt_parser_load_from_stream (self, G_INPUT_STREAM (stream), cancellable, error);
+  if (priv->song == NULL)
+    return FALSE;
 
-  return FALSE;
+  *stats = priv->stats;
+
+  return TRUE;
+}
+
+/**
+ * musician_gpt_parser_get_cache:
+ *
+ * Returns: (nullable) (transfer none): A #MusicianGptSongCache or %NULL.
+ */
+MusicianGptSongCache *
+musician_gpt_parser_get_cache (MusicianGptParser *self)
+{
+  MusicianGptParserPrivate *priv = musician_gpt_parser_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_PARSER (self), NULL);
+
+  return priv->cache;
+}
+
+/**
+ * musician_gpt_parser_set_cache:
+ * @self: A #MusicianGptParser
+ * @cache: (nullable): A #MusicianGptSongCache or %NULL
+ *
+ * Makes the loads of @self go through @cache. A file whose contents are
+ * already in @cache is not decoded again, and musician_gpt_parser_get_song()
+ * returns the song that is in @cache. Such songs are shared, so they must
+ * not be modified.
+ *
+ * Streams are read into memory in full before they are decoded, so that
+ * they can be looked up. Songs are always loaded in full, as if
+ * #MusicianGptParser:lazy was %FALSE.
+ */
+void
+musician_gpt_parser_set_cache (MusicianGptParser    *self,
+                               MusicianGptSongCache *cache)
+{
+  MusicianGptParserPrivate *priv = musician_gpt_parser_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_PARSER (self));
+  g_return_if_fail (!cache || MUSICIAN_IS_GPT_SONG_CACHE (cache));
+
+  if (g_set_object (&priv->cache, cache))
+    g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_CACHE]);
 }
 
 gboolean
-musician_gpt_parser_load_from_stream (MusicianGptParser  *self,
-                                      GInputStream       *base_stream,
-                                      GCancellable       *cancellable,
-                                      GError            **error)
+musician_gpt_parser_get_lazy (MusicianGptParser *self)
 {
   MusicianGptParserPrivate *priv = musician_gpt_parser_get_instance_private (self);
-  g_autoptr(MusicianGptInputStream) stream = NULL;
-  g_autoptr(MusicianGptSong) song = NULL;
-  g_autofree gchar *version = NULL;
-  GType file_format;
 
   g_return_val_if_fail (MUSICIAN_IS_GPT_PARSER (self), FALSE);
-  g_return_val_if_fail (G_IS_INPUT_STREAM (base_stream), FALSE);
-  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), FALSE);
 
-  if (priv->song != NULL)
+  return priv->lazy;
+}
+
+/**
+ * musician_gpt_parser_set_lazy:
+ * @self: A #MusicianGptParser
+ * @lazy: If beats should be decoded on demand
+ *
+ * When @lazy is %TRUE, loading a song only records where the beats of each
+ * measure/track block are in the file, and musician_gpt_song_get_beats()
+ * decodes a block the first time it is requested. This makes opening large
+ * files much faster when only a few measures are looked at.
+ *
+ * Lazy loading needs random access to the file, so it only applies to
+ * musician_gpt_parser_load_from_bytes() and to local files loaded with
+ * musician_gpt_parser_load_from_file(). The song keeps a reference to the
+ * file contents for as long as it is alive. Other sources are loaded in
+ * full, as if @lazy was %FALSE.
+ *
+ * Asynchronous loads go by the value @lazy had when they were started.
+ */
+void
+musician_gpt_parser_set_lazy (MusicianGptParser *self,
+                              gboolean           lazy)
+{
+  MusicianGptParserPrivate *priv = musician_gpt_parser_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_PARSER (self));
+
+  lazy = !!lazy;
+
+  if (priv->lazy != lazy)
+    {
+      priv->lazy = lazy;
+      g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_LAZY]);
+    }
+}
+
+gboolean
+musician_gpt_parser_get_parallel (MusicianGptParser *self)
+{
+  MusicianGptParserPrivate *priv = musician_gpt_parser_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_PARSER (self), FALSE);
+
+  return priv->parallel;
+}
+
+/**
+ * musician_gpt_parser_set_parallel:
+ * @self: A #MusicianGptParser
+ * @parallel: If beats should be decoded on multiple threads
+ *
+ * When @parallel is %TRUE, loading a song first finds where the beats of
+ * each measure/track block are in the file, and then decodes the blocks
+ * on a pool of threads shared by all parsers, sized to the number of
+ * processors. The resulting song is the same as with a regular load.
+ *
+ * This helps with large files that have many tracks. It has the same
+ * requirements as #MusicianGptParser:lazy, and is ignored when that is set.
+ */
+void
+musician_gpt_parser_set_parallel (MusicianGptParser *self,
+                                  gboolean           parallel)
+{
+  MusicianGptParserPrivate *priv = musician_gpt_parser_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_PARSER (self));
+
+  parallel = !!parallel;
+
+  if (priv->parallel != parallel)
+    {
+      priv->parallel = parallel;
+      g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_PARALLEL]);
+    }
+}
+
+static gboolean
+musician_gpt_parser_check_unused (MusicianGptParser  *self,
+                                  GError            **error)
+{
+  MusicianGptParserPrivate *priv = musician_gpt_parser_get_instance_private (self);
+
+  g_assert (MUSICIAN_IS_GPT_PARSER (self));
+
+  if (priv->song != NULL || priv->loading)
     {
       g_set_error (error,
                    G_IO_ERROR,
@@ -228,25 +593,923 @@ musician_gpt_parser_load_from_stream (MusicianGptParser  *self,
       return FALSE;
     }
 
-  /* Create our wrapper stream to read Guitar Pro formats */
-  stream = musician_gpt_input_stream_new (base_stream);
+  return TRUE;
+}
+
+/*
+ * Keeps @song, and the @stats of loading it, as the result of @self.
+ */
+static void
+musician_gpt_parser_set_song (MusicianGptParser           *self,
+                              MusicianGptSong             *song,
+                              const MusicianGptParseStats *stats)
+{
+  MusicianGptParserPrivate *priv = musician_gpt_parser_get_instance_private (self);
+
+  g_assert (MUSICIAN_IS_GPT_PARSER (self));
+  g_assert (MUSICIAN_IS_GPT_SONG (song));
+  g_assert (stats != NULL);
+
+  g_set_object (&priv->song, song);
+  priv->stats = *stats;
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_SONG]);
+  g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_STATS]);
+}
+
+/*
+ * Gets how songs are to be loaded according to the properties of @self.
+ * This must be called on the thread that owns @self, before handing the
+ * load to a worker.
+ */
+static MusicianGptLoadFlags
+musician_gpt_parser_get_load_flags (MusicianGptParser *self)
+{
+  MusicianGptParserPrivate *priv = musician_gpt_parser_get_instance_private (self);
+  MusicianGptLoadFlags load_flags = 0;
+
+  g_assert (MUSICIAN_IS_GPT_PARSER (self));
+
+  /* Songs from a cache are shared, so they must not decode beats later on */
+  if (priv->lazy && priv->cache == NULL)
+    load_flags |= MUSICIAN_GPT_LOAD_LAZY;
+
+  if (priv->parallel)
+    load_flags |= MUSICIAN_GPT_LOAD_PARALLEL;
+
+  return load_flags;
+}
+
+/*
+ * Decodes a song from @stream without touching the state of @self, so that
+ * this may be called from a worker thread. @load_flags must have been taken
+ * from @self beforehand. @stats is set to what went into decoding the song.
+ */
+static MusicianGptSong *
+musician_gpt_parser_decode (MusicianGptParser       *self,
+                            MusicianGptInputStream  *stream,
+                            MusicianGptLoadFlags     load_flags,
+                            MusicianGptParseStats   *stats,
+                            GCancellable            *cancellable,
+                            GError                 **error)
+{
+  MusicianGptSong *song;
+  const gchar *version;
+
+  g_assert (MUSICIAN_IS_GPT_PARSER (self));
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
+  g_assert (stats != NULL);
+  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  _musician_gpt_input_stream_set_load_flags (stream, load_flags);
 
   /* Read the version string so we can dispatch to the proper loader.
    * Our default load implementation will lookup based on known subclasses
    * and dispatch to a subparser to perform the parse. To force a specific
    * version loader, just use that subclass (such as MusicianGp4Parser).
    */
-  version = musician_gpt_input_stream_read_fixed_string (stream, 30, cancellable, error);
+  if (NULL == (version = musician_gpt_input_stream_read_fixed_string_borrowed (stream, 30, cancellable, error)))
+    return NULL;
 
   /* Let our potential subclass override the parsing process */
-  song = MUSICIAN_GPT_PARSER_GET_CLASS (self)->load (self, stream, version, cancellable, error);
+  if (NULL == (song = MUSICIAN_GPT_PARSER_GET_CLASS (self)->load (self, stream, version, cancellable, error)))
+    return NULL;
 
-  if (song != NULL)
-    {
-      g_clear_object (&priv->song);
-      priv->song = g_steal_pointer (&song);
-      return TRUE;
-    }
+  _musician_gpt_input_stream_get_stats (stream, stats);
 
-  return FALSE;
+  return song;
+}
+
+/*
+ * Loads the song of @self from @stream, which is how every synchronous
+ * load ends up. The batch loader uses this to load from a stream it has
+ * set up itself.
+ */
+gboolean
+_musician_gpt_parser_load_stream (MusicianGptParser       *self,
+                                  MusicianGptInputStream  *stream,
+                                  GCancellable            *cancellable,
+                                  GError                 **error)
+{
+  g_autoptr(MusicianGptSong) song = NULL;
+  MusicianGptParseStats stats = { 0 };
+
+  g_assert (MUSICIAN_IS_GPT_PARSER (self));
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
+  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  if (!musician_gpt_parser_check_unused (self, error))
+    return FALSE;
+
+  if (NULL != (song = musician_gpt_parser_decode (self,
+                                                  stream,
+                                                  musician_gpt_parser_get_load_flags (self),
+                                                  &stats,
+                                                  cancellable,
+                                                  error)))
+    {
+      musician_gpt_parser_set_song (self, song, &stats);
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+/*
+ * Gets the song decoded from @bytes out of @cache, decoding and storing
+ * it there if it is not in @cache yet. Like musician_gpt_parser_decode(),
+ * this does not touch the state of @self. @stats is left alone when the
+ * song was found in @cache.
+ */
+static MusicianGptSong *
+musician_gpt_parser_decode_cached (MusicianGptParser      *self,
+                                   MusicianGptSongCache   *cache,
+                                   GBytes                 *bytes,
+                                   MusicianGptLoadFlags    load_flags,
+                                   MusicianGptParseStats  *stats,
+                                   GCancellable           *cancellable,
+                                   GError                **error)
+{
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+  g_autoptr(MusicianGptSong) song = NULL;
+  g_autofree gchar *key = NULL;
+  guint64 cost;
+
+  g_assert (MUSICIAN_IS_GPT_PARSER (self));
+  g_assert (MUSICIAN_IS_GPT_SONG_CACHE (cache));
+  g_assert (bytes != NULL);
+
+  key = _musician_gpt_song_cache_compute_key (bytes);
+
+  if (NULL != (song = _musician_gpt_song_cache_lookup (cache, key)))
+    return g_steal_pointer (&song);
+
+  stream = musician_gpt_input_stream_new_for_bytes (bytes);
+
+  if (NULL == (song = musician_gpt_parser_decode (self, stream, load_flags, stats, cancellable, error)))
+    return NULL;
+
+  /* The song holds on to the arena of the stream, and lazy songs to @bytes */
+  cost = g_bytes_get_size (bytes) +
+         musician_gpt_arena_get_size (_musician_gpt_input_stream_get_arena (stream));
+
+  return _musician_gpt_song_cache_insert (cache, key, song, cost);
+}
+
+static gboolean
+musician_gpt_parser_load_cached (MusicianGptParser  *self,
+                                 GBytes             *bytes,
+                                 GCancellable       *cancellable,
+                                 GError            **error)
+{
+  MusicianGptParserPrivate *priv = musician_gpt_parser_get_instance_private (self);
+  g_autoptr(MusicianGptSong) song = NULL;
+  MusicianGptParseStats stats = { 0 };
+
+  g_assert (MUSICIAN_IS_GPT_PARSER (self));
+  g_assert (priv->cache != NULL);
+
+  if (!musician_gpt_parser_check_unused (self, error))
+    return FALSE;
+
+  if (NULL != (song = musician_gpt_parser_decode_cached (self,
+                                                         priv->cache,
+                                                         bytes,
+                                                         musician_gpt_parser_get_load_flags (self),
+                                                         &stats,
+                                                         cancellable,
+                                                         error)))
+    {
+      musician_gpt_parser_set_song (self, song, &stats);
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+/*
+ * Tries to map @file into memory so that we can decode straight from the
+ * mapping. Returns %NULL if @file is not a local regular file (or could not
+ * be mapped for some other reason), in which case the caller should fall
+ * back to reading from a #GInputStream.
+ */
+static GBytes *
+musician_gpt_parser_map_file (GFile        *file,
+                              GCancellable *cancellable)
+{
+  g_autoptr(GMappedFile) mapped = NULL;
+  g_autofree gchar *path = NULL;
+
+  g_assert (G_IS_FILE (file));
+
+  if (!g_file_is_native (file) ||
+      g_file_query_file_type (file, G_FILE_QUERY_INFO_NONE, cancellable) != G_FILE_TYPE_REGULAR ||
+      NULL == (path = g_file_get_path (file)) ||
+      NULL == (mapped = g_mapped_file_new (path, FALSE, NULL)))
+    return NULL;
+
+  return g_mapped_file_get_bytes (mapped);
+}
+
+/*
+ * Opens @file for decoding, using a mapping when possible and a
+ * #GFileInputStream otherwise.
+ */
+MusicianGptInputStream *
+_musician_gpt_parser_open_file (GFile         *file,
+                                GCancellable  *cancellable,
+                                GError       **error)
+{
+  g_autoptr(GFileInputStream) stream = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+
+  g_assert (G_IS_FILE (file));
+
+  if (NULL != (bytes = musician_gpt_parser_map_file (file, cancellable)))
+    return musician_gpt_input_stream_new_for_bytes (bytes);
+
+  if (NULL != (stream = g_file_read (file, cancellable, error)))
+    return musician_gpt_input_stream_new (G_INPUT_STREAM (stream));
+
+  return NULL;
+}
+
+/*
+ * Gets the contents of @file, or of @base_stream if @file is %NULL, which
+ * is what songs are looked up by in a #MusicianGptSongCache.
+ */
+static GBytes *
+musician_gpt_parser_read_contents (GFile         *file,
+                                   GInputStream  *base_stream,
+                                   GCancellable  *cancellable,
+                                   GError       **error)
+{
+  g_autoptr(GOutputStream) memory = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+
+  g_assert (!file || G_IS_FILE (file));
+  g_assert (file || G_IS_INPUT_STREAM (base_stream));
+
+  if (file != NULL)
+    {
+      gchar *contents = NULL;
+      gsize len = 0;
+
+      if (NULL != (bytes = musician_gpt_parser_map_file (file, cancellable)))
+        return g_steal_pointer (&bytes);
+
+      if (!g_file_load_contents (file, cancellable, &contents, &len, NULL, error))
+        return NULL;
+
+      return g_bytes_new_take (contents, len);
+    }
+
+  memory = g_memory_output_stream_new_resizable ();
+
+  if (g_output_stream_splice (memory,
+                              base_stream,
+                              G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+                              cancellable,
+                              error) < 0)
+    return NULL;
+
+  return g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (memory));
+}
+
+/**
+ * musician_gpt_parser_load_from_file:
+ * @self: A #MusicianGptParser
+ * @file: A #GFile
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @error: A location for a #GError or %NULL
+ *
+ * Loads a song from @file. If @file is a local file, it will be mapped
+ * into memory and decoded directly from the mapping. Otherwise, this
+ * falls back to musician_gpt_parser_load_from_stream().
+ *
+ * Returns: %TRUE if successful; otherwise %FALSE and @error is set.
+ */
+gboolean
+musician_gpt_parser_load_from_file (MusicianGptParser  *self,
+                                    GFile              *file,
+                                    GCancellable       *cancellable,
+                                    GError            **error)
+{
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_PARSER (self), FALSE);
+  g_return_val_if_fail (G_IS_FILE (file), FALSE);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), FALSE);
+
+  if (musician_gpt_parser_get_cache (self) != NULL)
+    {
+      g_autoptr(GBytes) bytes = NULL;
+
+      if (NULL == (bytes = musician_gpt_parser_read_contents (file, NULL, cancellable, error)))
+        return FALSE;
+
+      return musician_gpt_parser_load_cached (self, bytes, cancellable, error);
+    }
+
+  if (NULL == (stream = _musician_gpt_parser_open_file (file, cancellable, error)))
+    return FALSE;
+
+  return _musician_gpt_parser_load_stream (self, stream, cancellable, error);
+}
+
+gboolean
+musician_gpt_parser_load_from_stream (MusicianGptParser  *self,
+                                      GInputStream       *base_stream,
+                                      GCancellable       *cancellable,
+                                      GError            **error)
+{
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_PARSER (self), FALSE);
+  g_return_val_if_fail (G_IS_INPUT_STREAM (base_stream), FALSE);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), FALSE);
+
+  if (musician_gpt_parser_get_cache (self) != NULL)
+    {
+      g_autoptr(GBytes) bytes = NULL;
+
+      if (NULL == (bytes = musician_gpt_parser_read_contents (NULL, base_stream, cancellable, error)))
+        return FALSE;
+
+      return musician_gpt_parser_load_cached (self, bytes, cancellable, error);
+    }
+
+  /* Create our wrapper stream to read Guitar Pro formats */
+  stream = musician_gpt_input_stream_new (base_stream);
+
+  return _musician_gpt_parser_load_stream (self, stream, cancellable, error);
+}
+
+/**
+ * musician_gpt_parser_load_from_bytes:
+ * @self: A #MusicianGptParser
+ * @bytes: A #GBytes containing the file contents
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @error: A location for a #GError or %NULL
+ *
+ * Loads a song from a buffer that is already in memory, such as a database
+ * blob, a #GResource or an entry from an archive.
+ *
+ * The buffer is decoded in place; it is not wrapped in a #GInputStream and
+ * no copy of it is made. Strings are copied directly out of @bytes into
+ * the resulting song. @bytes is not referenced once this function returns,
+ * unless #MusicianGptParser:lazy is set.
+ *
+ * Returns: %TRUE if successful; otherwise %FALSE and @error is set.
+ */
+gboolean
+musician_gpt_parser_load_from_bytes (MusicianGptParser  *self,
+                                     GBytes             *bytes,
+                                     GCancellable       *cancellable,
+                                     GError            **error)
+{
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_PARSER (self), FALSE);
+  g_return_val_if_fail (bytes != NULL, FALSE);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), FALSE);
+
+  if (musician_gpt_parser_get_cache (self) != NULL)
+    return musician_gpt_parser_load_cached (self, bytes, cancellable, error);
+
+  stream = musician_gpt_input_stream_new_for_bytes (bytes);
+
+  return _musician_gpt_parser_load_stream (self, stream, cancellable, error);
+}
+
+typedef struct
+{
+  GFile                *file;
+  GInputStream         *base_stream;
+
+  /*
+   * The cache and load flags of the parser when the load was started, as
+   * its properties may change while the worker is running.
+   */
+  MusicianGptSongCache *cache;
+  MusicianGptLoadFlags  load_flags;
+
+  /* Filled in by the worker, read once the task has completed */
+  MusicianGptParseStats stats;
+} LoadState;
+
+static void
+load_state_free (gpointer data)
+{
+  LoadState *state = data;
+
+  g_clear_object (&state->file);
+  g_clear_object (&state->base_stream);
+  g_clear_object (&state->cache);
+  g_slice_free (LoadState, state);
+}
+
+static void
+musician_gpt_parser_load_worker (gpointer data,
+                                 gpointer user_data)
+{
+  g_autoptr(GTask) task = data;
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+  MusicianGptParser *self = g_task_get_source_object (task);
+  LoadState *state = g_task_get_task_data (task);
+  GCancellable *cancellable = g_task_get_cancellable (task);
+  MusicianGptSong *song = NULL;
+  GError *error = NULL;
+
+  g_assert (MUSICIAN_IS_GPT_PARSER (self));
+  g_assert (state != NULL);
+
+  if (state->cache != NULL)
+    {
+      g_autoptr(GBytes) bytes = NULL;
+
+      if (NULL != (bytes = musician_gpt_parser_read_contents (state->file, state->base_stream, cancellable, &error)))
+        song = musician_gpt_parser_decode_cached (self, state->cache, bytes, state->load_flags, &state->stats, cancellable, &error);
+    }
+  else
+    {
+      if (state->file != NULL)
+        stream = _musician_gpt_parser_open_file (state->file, cancellable, &error);
+      else
+        stream = musician_gpt_input_stream_new (state->base_stream);
+
+      if (stream != NULL)
+        song = musician_gpt_parser_decode (self, stream, state->load_flags, &state->stats, cancellable, &error);
+    }
+
+  /* GTask delivers the result to the GMainContext of the caller */
+  if (song != NULL)
+    g_task_return_pointer (task, song, g_object_unref);
+  else
+    g_task_return_error (task, error);
+}
+
+static GThreadPool *
+get_load_pool (void)
+{
+  static GThreadPool *instance;
+
+  /*
+   * All parsers share a single pool with one thread per CPU, so opening
+   * many files at once queues them up rather than spawning a thread for
+   * each of them. Workers also block reading their file or stream, so we
+   * keep at least two of them; with one, a stream that stalls (a slow
+   * network mount, a pipe) would hold up every other load on a single
+   * processor machine.
+   */
+  if (g_once_init_enter (&instance))
+    g_once_init_leave (&instance,
+                       g_thread_pool_new (musician_gpt_parser_load_worker,
+                                          NULL,
+                                          MAX (2, g_get_num_processors ()),
+                                          FALSE,
+                                          NULL));
+
+  return instance;
+}
+
+static void
+musician_gpt_parser_load_completed (GTask             *task,
+                                    GParamSpec        *pspec,
+                                    MusicianGptParser *self)
+{
+  MusicianGptParserPrivate *priv = musician_gpt_parser_get_instance_private (self);
+
+  g_assert (G_IS_TASK (task));
+  g_assert (MUSICIAN_IS_GPT_PARSER (self));
+
+  priv->loading = FALSE;
+}
+
+static void
+musician_gpt_parser_load_async_internal (MusicianGptParser   *self,
+                                         LoadState           *state,
+                                         GCancellable        *cancellable,
+                                         GAsyncReadyCallback  callback,
+                                         gpointer             user_data,
+                                         gpointer             source_tag)
+{
+  MusicianGptParserPrivate *priv = musician_gpt_parser_get_instance_private (self);
+  g_autoptr(GTask) task = NULL;
+  GError *error = NULL;
+
+  g_assert (MUSICIAN_IS_GPT_PARSER (self));
+  g_assert (state != NULL);
+  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  if (priv->cache != NULL)
+    state->cache = g_object_ref (priv->cache);
+  state->load_flags = musician_gpt_parser_get_load_flags (self);
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, source_tag);
+  g_task_set_task_data (task, state, load_state_free);
+
+  if (!musician_gpt_parser_check_unused (self, &error))
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  /*
+   * Only one load may be in flight. The task holds a reference to @self,
+   * so the handler cannot outlive us.
+   */
+  priv->loading = TRUE;
+  g_signal_connect (task,
+                    "notify::completed",
+                    G_CALLBACK (musician_gpt_parser_load_completed),
+                    self);
+
+  g_thread_pool_push (get_load_pool (), g_steal_pointer (&task), NULL);
+}
+
+static gboolean
+musician_gpt_parser_load_finish_internal (MusicianGptParser  *self,
+                                          GTask              *task,
+                                          GError            **error)
+{
+  LoadState *state = g_task_get_task_data (task);
+  g_autoptr(MusicianGptSong) song = NULL;
+
+  g_assert (MUSICIAN_IS_GPT_PARSER (self));
+  g_assert (G_IS_TASK (task));
+
+  if (NULL == (song = g_task_propagate_pointer (task, error)))
+    return FALSE;
+
+  musician_gpt_parser_set_song (self, song, &state->stats);
+
+  return TRUE;
+}
+
+/**
+ * musician_gpt_parser_load_from_file_async:
+ * @self: A #MusicianGptParser
+ * @file: A #GFile
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @callback: (scope async): A callback to execute upon completion
+ * @user_data: user data for @callback
+ *
+ * Asynchronously loads a song from @file. The file is decoded on a worker
+ * thread so that the main loop is not blocked. Worker threads are shared by
+ * all parsers, one per processor but at least two, so many concurrent loads
+ * are queued rather than each getting their own thread.
+ *
+ * @callback is executed in the thread-default #GMainContext of the caller,
+ * where it should call musician_gpt_parser_load_from_file_finish().
+ */
+void
+musician_gpt_parser_load_from_file_async (MusicianGptParser   *self,
+                                          GFile               *file,
+                                          GCancellable        *cancellable,
+                                          GAsyncReadyCallback  callback,
+                                          gpointer             user_data)
+{
+  LoadState *state;
+
+  g_return_if_fail (MUSICIAN_IS_GPT_PARSER (self));
+  g_return_if_fail (G_IS_FILE (file));
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  state = g_slice_new0 (LoadState);
+  state->file = g_object_ref (file);
+
+  musician_gpt_parser_load_async_internal (self,
+                                           state,
+                                           cancellable,
+                                           callback,
+                                           user_data,
+                                           musician_gpt_parser_load_from_file_async);
+}
+
+/**
+ * musician_gpt_parser_load_from_file_finish:
+ * @self: A #MusicianGptParser
+ * @result: A #GAsyncResult provided to the callback
+ * @error: A location for a #GError or %NULL
+ *
+ * Completes an asynchronous request to musician_gpt_parser_load_from_file_async().
+ * Upon success, the song is available from musician_gpt_parser_get_song().
+ *
+ * Returns: %TRUE if successful; otherwise %FALSE and @error is set.
+ */
+gboolean
+musician_gpt_parser_load_from_file_finish (MusicianGptParser  *self,
+                                           GAsyncResult       *result,
+                                           GError            **error)
+{
+  g_return_val_if_fail (MUSICIAN_IS_GPT_PARSER (self), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, self), FALSE);
+
+  return musician_gpt_parser_load_finish_internal (self, G_TASK (result), error);
+}
+
+/**
+ * musician_gpt_parser_load_from_stream_async:
+ * @self: A #MusicianGptParser
+ * @base_stream: A #GInputStream
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @callback: (scope async): A callback to execute upon completion
+ * @user_data: user data for @callback
+ *
+ * Like musician_gpt_parser_load_from_file_async(), but reads from
+ * @base_stream. @base_stream is read with blocking calls from the worker
+ * thread, so it must not be used by anything else until @callback runs.
+ */
+void
+musician_gpt_parser_load_from_stream_async (MusicianGptParser   *self,
+                                            GInputStream        *base_stream,
+                                            GCancellable        *cancellable,
+                                            GAsyncReadyCallback  callback,
+                                            gpointer             user_data)
+{
+  LoadState *state;
+
+  g_return_if_fail (MUSICIAN_IS_GPT_PARSER (self));
+  g_return_if_fail (G_IS_INPUT_STREAM (base_stream));
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  state = g_slice_new0 (LoadState);
+  state->base_stream = g_object_ref (base_stream);
+
+  musician_gpt_parser_load_async_internal (self,
+                                           state,
+                                           cancellable,
+                                           callback,
+                                           user_data,
+                                           musician_gpt_parser_load_from_stream_async);
+}
+
+/**
+ * musician_gpt_parser_load_from_stream_finish:
+ * @self: A #MusicianGptParser
+ * @result: A #GAsyncResult provided to the callback
+ * @error: A location for a #GError or %NULL
+ *
+ * Completes an asynchronous request to musician_gpt_parser_load_from_stream_async().
+ * Upon success, the song is available from musician_gpt_parser_get_song().
+ *
+ * Returns: %TRUE if successful; otherwise %FALSE and @error is set.
+ */
+gboolean
+musician_gpt_parser_load_from_stream_finish (MusicianGptParser  *self,
+                                             GAsyncResult       *result,
+                                             GError            **error)
+{
+  g_return_val_if_fail (MUSICIAN_IS_GPT_PARSER (self), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, self), FALSE);
+
+  return musician_gpt_parser_load_finish_internal (self, G_TASK (result), error);
+}
+
+static MusicianGptMetadata *
+musician_gpt_parser_scan_internal (MusicianGptParser       *self,
+                                   MusicianGptInputStream  *stream,
+                                   GCancellable            *cancellable,
+                                   GError                 **error)
+{
+  const gchar *version;
+
+  g_assert (MUSICIAN_IS_GPT_PARSER (self));
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
+  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  if (NULL == (version = musician_gpt_input_stream_read_fixed_string_borrowed (stream, 30, cancellable, error)))
+    return NULL;
+
+  return MUSICIAN_GPT_PARSER_GET_CLASS (self)->scan (self, stream, version, cancellable, error);
+}
+
+/**
+ * musician_gpt_parser_scan_from_file:
+ * @self: A #MusicianGptParser
+ * @file: A #GFile
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @error: A location for a #GError or %NULL
+ *
+ * Reads the information needed to index @file in a music library, such as
+ * the title, artist, tempo and number of tracks.
+ *
+ * Only the header of the file is decoded. No #MusicianGptSong is created,
+ * and musician_gpt_parser_get_song() is not affected, so the same parser
+ * may be used to scan any number of files.
+ *
+ * Local files are mapped into memory, so only the pages containing the
+ * header are read from disk.
+ *
+ * Returns: (transfer full): A #MusicianGptMetadata or %NULL and @error is set.
+ */
+MusicianGptMetadata *
+musician_gpt_parser_scan_from_file (MusicianGptParser  *self,
+                                    GFile              *file,
+                                    GCancellable       *cancellable,
+                                    GError            **error)
+{
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_PARSER (self), NULL);
+  g_return_val_if_fail (G_IS_FILE (file), NULL);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), NULL);
+
+  if (NULL == (stream = _musician_gpt_parser_open_file (file, cancellable, error)))
+    return NULL;
+
+  return musician_gpt_parser_scan_internal (self, stream, cancellable, error);
+}
+
+/**
+ * musician_gpt_parser_scan_from_stream:
+ * @self: A #MusicianGptParser
+ * @base_stream: A #GInputStream
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @error: A location for a #GError or %NULL
+ *
+ * Like musician_gpt_parser_scan_from_file(), but reads from @base_stream.
+ * Reading stops right after the header, so @base_stream is left positioned
+ * somewhere in the middle of the file.
+ *
+ * Returns: (transfer full): A #MusicianGptMetadata or %NULL and @error is set.
+ */
+MusicianGptMetadata *
+musician_gpt_parser_scan_from_stream (MusicianGptParser  *self,
+                                      GInputStream       *base_stream,
+                                      GCancellable       *cancellable,
+                                      GError            **error)
+{
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_PARSER (self), NULL);
+  g_return_val_if_fail (G_IS_INPUT_STREAM (base_stream), NULL);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), NULL);
+
+  stream = musician_gpt_input_stream_new (base_stream);
+
+  return musician_gpt_parser_scan_internal (self, stream, cancellable, error);
+}
+
+/**
+ * musician_gpt_parser_scan_from_bytes:
+ * @self: A #MusicianGptParser
+ * @bytes: A #GBytes containing the file contents
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @error: A location for a #GError or %NULL
+ *
+ * Like musician_gpt_parser_scan_from_file(), but decodes a buffer that is
+ * already in memory.
+ *
+ * Returns: (transfer full): A #MusicianGptMetadata or %NULL and @error is set.
+ */
+MusicianGptMetadata *
+musician_gpt_parser_scan_from_bytes (MusicianGptParser  *self,
+                                     GBytes             *bytes,
+                                     GCancellable       *cancellable,
+                                     GError            **error)
+{
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_PARSER (self), NULL);
+  g_return_val_if_fail (bytes != NULL, NULL);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), NULL);
+
+  stream = musician_gpt_input_stream_new_for_bytes (bytes);
+
+  return musician_gpt_parser_scan_internal (self, stream, cancellable, error);
+}
+
+static gboolean
+musician_gpt_parser_parse_internal (MusicianGptParser        *self,
+                                    MusicianGptInputStream   *stream,
+                                    const MusicianGptEvents  *events,
+                                    gpointer                  user_data,
+                                    GCancellable             *cancellable,
+                                    GError                  **error)
+{
+  const gchar *version;
+
+  g_assert (MUSICIAN_IS_GPT_PARSER (self));
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
+  g_assert (events != NULL);
+  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  if (NULL == (version = musician_gpt_input_stream_read_fixed_string_borrowed (stream, 30, cancellable, error)))
+    return FALSE;
+
+  return MUSICIAN_GPT_PARSER_GET_CLASS (self)->parse (self, stream, version, events, user_data, cancellable, error);
+}
+
+/**
+ * musician_gpt_parser_parse_from_file:
+ * @self: A #MusicianGptParser
+ * @file: A #GFile
+ * @events: The callbacks to call as records are decoded
+ * @user_data: user data for @events
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @error: A location for a #GError or %NULL
+ *
+ * Decodes @file in a single pass, calling @events for the header, every
+ * measure header, track and beat, and the chords and bends of each beat.
+ *
+ * This is for consumers that only need to look at the data once, such as
+ * exporters and statistics. No #MusicianGptSong is created, and memory use
+ * does not depend on the size of the song, since nothing is kept once
+ * the callback for a record has returned. musician_gpt_parser_get_song()
+ * is not affected, so the same parser may be used for any number of files.
+ *
+ * Returns: %TRUE if the whole file was decoded; otherwise %FALSE and
+ *   @error is set.
+ */
+gboolean
+musician_gpt_parser_parse_from_file (MusicianGptParser        *self,
+                                     GFile                    *file,
+                                     const MusicianGptEvents  *events,
+                                     gpointer                  user_data,
+                                     GCancellable             *cancellable,
+                                     GError                  **error)
+{
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_PARSER (self), FALSE);
+  g_return_val_if_fail (G_IS_FILE (file), FALSE);
+  g_return_val_if_fail (events != NULL, FALSE);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), FALSE);
+
+  if (NULL == (stream = _musician_gpt_parser_open_file (file, cancellable, error)))
+    return FALSE;
+
+  return musician_gpt_parser_parse_internal (self, stream, events, user_data, cancellable, error);
+}
+
+/**
+ * musician_gpt_parser_parse_from_stream:
+ * @self: A #MusicianGptParser
+ * @base_stream: A #GInputStream
+ * @events: The callbacks to call as records are decoded
+ * @user_data: user data for @events
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @error: A location for a #GError or %NULL
+ *
+ * Like musician_gpt_parser_parse_from_file(), but reads from @base_stream.
+ *
+ * Returns: %TRUE if the whole file was decoded; otherwise %FALSE and
+ *   @error is set.
+ */
+gboolean
+musician_gpt_parser_parse_from_stream (MusicianGptParser        *self,
+                                       GInputStream             *base_stream,
+                                       const MusicianGptEvents  *events,
+                                       gpointer                  user_data,
+                                       GCancellable             *cancellable,
+                                       GError                  **error)
+{
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_PARSER (self), FALSE);
+  g_return_val_if_fail (G_IS_INPUT_STREAM (base_stream), FALSE);
+  g_return_val_if_fail (events != NULL, FALSE);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), FALSE);
+
+  stream = musician_gpt_input_stream_new (base_stream);
+
+  return musician_gpt_parser_parse_internal (self, stream, events, user_data, cancellable, error);
+}
+
+/**
+ * musician_gpt_parser_parse_from_bytes:
+ * @self: A #MusicianGptParser
+ * @bytes: A #GBytes containing the file contents
+ * @events: The callbacks to call as records are decoded
+ * @user_data: user data for @events
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @error: A location for a #GError or %NULL
+ *
+ * Like musician_gpt_parser_parse_from_file(), but decodes a buffer that is
+ * already in memory.
+ *
+ * Returns: %TRUE if the whole file was decoded; otherwise %FALSE and
+ *   @error is set.
+ */
+gboolean
+musician_gpt_parser_parse_from_bytes (MusicianGptParser        *self,
+                                      GBytes                   *bytes,
+                                      const MusicianGptEvents  *events,
+                                      gpointer                  user_data,
+                                      GCancellable             *cancellable,
+                                      GError                  **error)
+{
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_PARSER (self), FALSE);
+  g_return_val_if_fail (bytes != NULL, FALSE);
+  g_return_val_if_fail (events != NULL, FALSE);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), FALSE);
+
+  stream = musician_gpt_input_stream_new_for_bytes (bytes);
+
+  return musician_gpt_parser_parse_internal (self, stream, events, user_data, cancellable, error);
 }
@@ -21,7 +21,11 @@
 
 #include <gio/gio.h>
 
+#include "musician-gpt-events.h"
 #include "musician-gpt-input-stream.h"
+#include "musician-gpt-metadata.h"
+#include "musician-gpt-parse-stats.h"
+#include "musician-gpt-song-cache.h"
 #include "musician-gpt-types.h"
 
 G_BEGIN_DECLS
@@ -40,22 +44,95 @@ struct _MusicianGptParserClass
                             GCancellable            *cancellable,
                             GError                 **error);
 
-  gpointer _reserved1;
-  gpointer _reserved2;
+  MusicianGptMetadata *(*scan) (MusicianGptParser       *self,
+                                MusicianGptInputStream  *stream,
+                                const gchar             *version,
+                                GCancellable            *cancellable,
+                                GError                 **error);
+
+  gboolean (*parse) (MusicianGptParser        *self,
+                     MusicianGptInputStream   *stream,
+                     const gchar              *version,
+                     const MusicianGptEvents  *events,
+                     gpointer                  user_data,
+                     GCancellable             *cancellable,
+                     GError                  **error);
+
   gpointer _reserved3;
   gpointer _reserved4;
 };
 
-MusicianGptParser *musician_gpt_parser_new              (void);
-MusicianGptSong   *musician_gpt_parser_get_song         (MusicianGptParser   *self);
-gboolean           musician_gpt_parser_load_from_stream (MusicianGptParser   *self,
-                                                         GInputStream        *base_stream,
-                                                         GCancellable        *cancellable,
-                                                         GError             **error);
-gboolean           musician_gpt_parser_load_from_file   (MusicianGptParser   *self,
-                                                         GFile               *file,
-                                                         GCancellable        *cancellable,
-                                                         GError             **error);
+MusicianGptParser    *musician_gpt_parser_new                     (void);
+MusicianGptSong      *musician_gpt_parser_get_song                (MusicianGptParser        *self);
+gboolean              musician_gpt_parser_get_stats               (MusicianGptParser        *self,
+                                                                   MusicianGptParseStats    *stats);
+MusicianGptSongCache *musician_gpt_parser_get_cache               (MusicianGptParser        *self);
+void                  musician_gpt_parser_set_cache               (MusicianGptParser        *self,
+                                                                   MusicianGptSongCache     *cache);
+gboolean              musician_gpt_parser_get_lazy                (MusicianGptParser        *self);
+void                  musician_gpt_parser_set_lazy                (MusicianGptParser        *self,
+                                                                   gboolean                  lazy);
+gboolean              musician_gpt_parser_get_parallel            (MusicianGptParser        *self);
+void                  musician_gpt_parser_set_parallel            (MusicianGptParser        *self,
+                                                                   gboolean                  parallel);
+gboolean              musician_gpt_parser_load_from_stream        (MusicianGptParser        *self,
+                                                                   GInputStream             *base_stream,
+                                                                   GCancellable             *cancellable,
+                                                                   GError                  **error);
+gboolean              musician_gpt_parser_load_from_file          (MusicianGptParser        *self,
+                                                                   GFile                    *file,
+                                                                   GCancellable             *cancellable,
+                                                                   GError                  **error);
+gboolean              musician_gpt_parser_load_from_bytes         (MusicianGptParser        *self,
+                                                                   GBytes                   *bytes,
+                                                                   GCancellable             *cancellable,
+                                                                   GError                  **error);
+void                  musician_gpt_parser_load_from_file_async    (MusicianGptParser        *self,
+                                                                   GFile                    *file,
+                                                                   GCancellable             *cancellable,
+                                                                   GAsyncReadyCallback       callback,
+                                                                   gpointer                  user_data);
+gboolean              musician_gpt_parser_load_from_file_finish   (MusicianGptParser        *self,
+                                                                   GAsyncResult             *result,
+                                                                   GError                  **error);
+void                  musician_gpt_parser_load_from_stream_async  (MusicianGptParser        *self,
+                                                                   GInputStream             *base_stream,
+                                                                   GCancellable             *cancellable,
+                                                                   GAsyncReadyCallback       callback,
+                                                                   gpointer                  user_data);
+gboolean              musician_gpt_parser_load_from_stream_finish (MusicianGptParser        *self,
+                                                                   GAsyncResult             *result,
+                                                                   GError                  **error);
+MusicianGptMetadata  *musician_gpt_parser_scan_from_stream        (MusicianGptParser        *self,
+                                                                   GInputStream             *base_stream,
+                                                                   GCancellable             *cancellable,
+                                                                   GError                  **error);
+MusicianGptMetadata  *musician_gpt_parser_scan_from_file          (MusicianGptParser        *self,
+                                                                   GFile                    *file,
+                                                                   GCancellable             *cancellable,
+                                                                   GError                  **error);
+MusicianGptMetadata  *musician_gpt_parser_scan_from_bytes         (MusicianGptParser        *self,
+                                                                   GBytes                   *bytes,
+                                                                   GCancellable             *cancellable,
+                                                                   GError                  **error);
+gboolean              musician_gpt_parser_parse_from_stream       (MusicianGptParser        *self,
+                                                                   GInputStream             *base_stream,
+                                                                   const MusicianGptEvents  *events,
+                                                                   gpointer                  user_data,
+                                                                   GCancellable             *cancellable,
+                                                                   GError                  **error);
+gboolean              musician_gpt_parser_parse_from_file         (MusicianGptParser        *self,
+                                                                   GFile                    *file,
+                                                                   const MusicianGptEvents  *events,
+                                                                   gpointer                  user_data,
+                                                                   GCancellable             *cancellable,
+                                                                   GError                  **error);
+gboolean              musician_gpt_parser_parse_from_bytes        (MusicianGptParser        *self,
+                                                                   GBytes                   *bytes,
+                                                                   const MusicianGptEvents  *events,
+                                                                   gpointer                  user_data,
+                                                                   GCancellable             *cancellable,
+                                                                   GError                  **error);
 
 G_END_DECLS
 
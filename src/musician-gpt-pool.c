@@ -0,0 +1,262 @@
+/* musician-gpt-pool.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "musician-gpt-pool"
+
+#include <string.h>
+
+#include "musician-gpt-pool.h"
+
+/*
+ * MusicianGptPool hands out the small boxed types a song is made of
+ * (beats, bends and chords) from large chunks, so that a song with
+ * thousands of them makes a handful of calls to malloc() rather than
+ * thousands.
+ *
+ * Each type has its own slab of fixed-size slots. Freed slots go on a
+ * free list for that type and are used again. The chunks themselves are
+ * only released along with the pool, which happens once the song and
+ * every object allocated from the pool have let go of it.
+ *
+ * Unlike #MusicianGptArena, allocating and freeing are thread-safe, as
+ * measures are decoded on several threads at once and objects may be
+ * released from any thread.
+ */
+
+#define POOL_CHUNK_SIZE (64 * 1024)
+#define POOL_ALIGN      (2 * sizeof (gpointer))
+
+typedef struct _MusicianGptPoolChunk MusicianGptPoolChunk;
+
+struct _MusicianGptPoolChunk
+{
+  MusicianGptPoolChunk *next;
+  gsize                 _padding;
+  guint8                data[];
+};
+
+typedef struct
+{
+  /* Every slot of this slab has the same size, set by the first allocation */
+  gsize   slot_size;
+
+  /* Freed slots, linked through their first word */
+  gpointer free_list;
+
+  /* The unused tail of the chunk this slab is carving slots from */
+  guint8 *pos;
+  guint8 *end;
+} MusicianGptPoolSlab;
+
+struct _MusicianGptPool
+{
+  volatile gint          ref_count;
+
+  GMutex                 mutex;
+  MusicianGptPoolSlab    slabs[MUSICIAN_GPT_POOL_N_TYPES];
+  MusicianGptPoolChunk  *chunks;
+  guint                  n_chunks;
+  guint                  n_objects;
+};
+
+G_STATIC_ASSERT (sizeof (MusicianGptPoolChunk) % POOL_ALIGN == 0);
+
+MusicianGptPool *
+musician_gpt_pool_new (void)
+{
+  MusicianGptPool *self;
+
+  self = g_slice_new0 (MusicianGptPool);
+  self->ref_count = 1;
+  g_mutex_init (&self->mutex);
+
+  return self;
+}
+
+MusicianGptPool *
+musician_gpt_pool_ref (MusicianGptPool *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+  g_return_val_if_fail (self->ref_count > 0, NULL);
+
+  g_atomic_int_inc (&self->ref_count);
+
+  return self;
+}
+
+void
+musician_gpt_pool_unref (MusicianGptPool *self)
+{
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (self->ref_count > 0);
+
+  if (g_atomic_int_dec_and_test (&self->ref_count))
+    {
+      while (self->chunks != NULL)
+        {
+          MusicianGptPoolChunk *chunk = self->chunks;
+
+          self->chunks = chunk->next;
+          g_free (chunk);
+        }
+
+      g_mutex_clear (&self->mutex);
+      g_slice_free (MusicianGptPool, self);
+    }
+}
+
+/**
+ * musician_gpt_pool_alloc0:
+ * @self: A #MusicianGptPool
+ * @type: The type being allocated
+ * @size: The size of @type, which must be the same for every call
+ *
+ * Allocates a zeroed object of @type. Release it with
+ * musician_gpt_pool_free(). Objects should hold a reference to @self for
+ * as long as they are alive.
+ *
+ * Returns: (transfer full): the allocated memory.
+ */
+gpointer
+musician_gpt_pool_alloc0 (MusicianGptPool     *self,
+                          MusicianGptPoolType  type,
+                          gsize                size)
+{
+  MusicianGptPoolSlab *slab;
+  gpointer ret;
+
+  g_return_val_if_fail (self != NULL, NULL);
+  g_return_val_if_fail (type < MUSICIAN_GPT_POOL_N_TYPES, NULL);
+  g_return_val_if_fail (size > 0, NULL);
+
+  size = (size + POOL_ALIGN - 1) & ~(POOL_ALIGN - 1);
+
+  g_return_val_if_fail (size <= POOL_CHUNK_SIZE / 16, NULL);
+
+  g_mutex_lock (&self->mutex);
+
+  slab = &self->slabs[type];
+
+  if (slab->slot_size == 0)
+    slab->slot_size = size;
+
+  g_assert_cmpint (slab->slot_size, ==, size);
+
+  if (slab->free_list != NULL)
+    {
+      ret = slab->free_list;
+      slab->free_list = *(gpointer *)ret;
+    }
+  else
+    {
+      if (slab->pos == NULL || (gsize)(slab->end - slab->pos) < size)
+        {
+          MusicianGptPoolChunk *chunk;
+
+          /* Whatever is left of the previous chunk is not worth keeping */
+          chunk = g_malloc (sizeof *chunk + POOL_CHUNK_SIZE);
+          chunk->next = self->chunks;
+          self->chunks = chunk;
+          self->n_chunks++;
+
+          slab->pos = chunk->data;
+          slab->end = chunk->data + POOL_CHUNK_SIZE;
+        }
+
+      ret = slab->pos;
+      slab->pos += size;
+    }
+
+  self->n_objects++;
+
+  g_mutex_unlock (&self->mutex);
+
+  return memset (ret, 0, size);
+}
+
+/**
+ * musician_gpt_pool_free:
+ * @self: A #MusicianGptPool
+ * @type: The type @mem was allocated as
+ * @mem: Memory from musician_gpt_pool_alloc0()
+ *
+ * Returns @mem to @self, to be handed out again by a later allocation of
+ * @type.
+ */
+void
+musician_gpt_pool_free (MusicianGptPool     *self,
+                        MusicianGptPoolType  type,
+                        gpointer             mem)
+{
+  MusicianGptPoolSlab *slab;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (type < MUSICIAN_GPT_POOL_N_TYPES);
+
+  if (mem == NULL)
+    return;
+
+  g_mutex_lock (&self->mutex);
+
+  slab = &self->slabs[type];
+  *(gpointer *)mem = slab->free_list;
+  slab->free_list = mem;
+  self->n_objects--;
+
+  g_mutex_unlock (&self->mutex);
+}
+
+/**
+ * musician_gpt_pool_get_n_objects:
+ * @self: A #MusicianGptPool
+ *
+ * Returns: the number of objects allocated from @self that are alive.
+ */
+guint
+musician_gpt_pool_get_n_objects (MusicianGptPool *self)
+{
+  guint ret;
+
+  g_return_val_if_fail (self != NULL, 0);
+
+  g_mutex_lock (&self->mutex);
+  ret = self->n_objects;
+  g_mutex_unlock (&self->mutex);
+
+  return ret;
+}
+
+/**
+ * musician_gpt_pool_get_n_chunks:
+ * @self: A #MusicianGptPool
+ *
+ * Returns: the number of chunks @self has allocated with malloc().
+ */
+guint
+musician_gpt_pool_get_n_chunks (MusicianGptPool *self)
+{
+  guint ret;
+
+  g_return_val_if_fail (self != NULL, 0);
+
+  g_mutex_lock (&self->mutex);
+  ret = self->n_chunks;
+  g_mutex_unlock (&self->mutex);
+
+  return ret;
+}
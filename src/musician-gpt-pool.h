@@ -0,0 +1,52 @@
+/* musician-gpt-pool.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_POOL_H
+#define MUSICIAN_GPT_POOL_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _MusicianGptPool MusicianGptPool;
+
+typedef enum
+{
+  MUSICIAN_GPT_POOL_BEAT,
+  MUSICIAN_GPT_POOL_BEND,
+  MUSICIAN_GPT_POOL_CHORD,
+  MUSICIAN_GPT_POOL_N_TYPES
+} MusicianGptPoolType;
+
+MusicianGptPool *musician_gpt_pool_new           (void);
+MusicianGptPool *musician_gpt_pool_ref           (MusicianGptPool     *self);
+void             musician_gpt_pool_unref         (MusicianGptPool     *self);
+gpointer         musician_gpt_pool_alloc0        (MusicianGptPool     *self,
+                                                  MusicianGptPoolType  type,
+                                                  gsize                size);
+void             musician_gpt_pool_free          (MusicianGptPool     *self,
+                                                  MusicianGptPoolType  type,
+                                                  gpointer             mem);
+guint            musician_gpt_pool_get_n_objects (MusicianGptPool     *self);
+guint            musician_gpt_pool_get_n_chunks  (MusicianGptPool     *self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MusicianGptPool, musician_gpt_pool_unref)
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_POOL_H */
@@ -0,0 +1,374 @@
+/* musician-gpt-push-parser.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "musician-gpt-push-parser"
+
+#include "musician-gp4-parser-private.h"
+#include "musician-gpt-arena.h"
+#include "musician-gpt-input-stream-private.h"
+#include "musician-gpt-parser-private.h"
+#include "musician-gpt-push-parser.h"
+
+/**
+ * SECTION:musician-gpt-push-parser:
+ * @title: #MusicianGptPushParser
+ * @short_description: Decode a Guitar Pro™ file as it arrives
+ *
+ * #MusicianGptPushParser is the counterpart to #MusicianGptParser for data
+ * that arrives in pieces, such as from a pipe or a socket. Rather than
+ * blocking for more data, musician_gpt_push_parser_feed() decodes as much
+ * as it can and reports %MUSICIAN_GPT_PUSH_STATUS_NEED_MORE_DATA.
+ *
+ * Only the part of the input that does not yet make up a complete record
+ * (a measure header, a track, a beat, ...) is kept around between calls,
+ * so memory use does not grow with the size of the file beyond the song
+ * itself.
+ */
+
+struct _MusicianGptPushParser
+{
+  GObject             parent_instance;
+
+  /* Data that has been fed to us but not yet decoded */
+  GByteArray         *buffer;
+
+  /*
+   * How much of @buffer the record we are waiting on needs at the least.
+   * Decoding it again before then would only fail at the same spot.
+   */
+  gsize               n_wanted;
+
+  /* Shared by every stream we decode from, and by the resulting song */
+  MusicianGptArena   *arena;
+
+  /* %NULL until we have seen the version string */
+  MusicianGp4Parser  *subparser;
+  MusicianGp4Decoder  decoder;
+
+  /* The song, once it has been decoded completely */
+  MusicianGptSong    *song;
+
+  guint               failed : 1;
+};
+
+G_DEFINE_TYPE (MusicianGptPushParser, musician_gpt_push_parser, G_TYPE_OBJECT)
+
+MusicianGptPushParser *
+musician_gpt_push_parser_new (void)
+{
+  return g_object_new (MUSICIAN_TYPE_GPT_PUSH_PARSER, NULL);
+}
+
+static void
+musician_gpt_push_parser_finalize (GObject *object)
+{
+  MusicianGptPushParser *self = (MusicianGptPushParser *)object;
+
+  if (self->subparser != NULL)
+    _musician_gp4_decoder_clear (&self->decoder);
+
+  g_clear_object (&self->subparser);
+  g_clear_object (&self->song);
+  g_clear_pointer (&self->buffer, g_byte_array_unref);
+  g_clear_pointer (&self->arena, musician_gpt_arena_unref);
+
+  G_OBJECT_CLASS (musician_gpt_push_parser_parent_class)->finalize (object);
+}
+
+static void
+musician_gpt_push_parser_class_init (MusicianGptPushParserClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = musician_gpt_push_parser_finalize;
+}
+
+static void
+musician_gpt_push_parser_init (MusicianGptPushParser *self)
+{
+  self->buffer = g_byte_array_new ();
+  self->arena = musician_gpt_arena_new ();
+}
+
+/*
+ * Reads the version string and sets up the decoder for it. Returns %FALSE
+ * with @error unset if the version string is not complete yet.
+ */
+static gboolean
+musician_gpt_push_parser_begin (MusicianGptPushParser   *self,
+                                MusicianGptInputStream  *stream,
+                                GCancellable            *cancellable,
+                                GError                 **error)
+{
+  g_autoptr(MusicianGptParser) subparser = NULL;
+  g_autoptr(GError) local_error = NULL;
+  const gchar *version;
+
+  g_assert (MUSICIAN_IS_GPT_PUSH_PARSER (self));
+  g_assert (MUSICIAN_IS_GPT_INPUT_STREAM (stream));
+  g_assert (self->subparser == NULL);
+
+  version = musician_gpt_input_stream_read_fixed_string_borrowed (stream, 30, cancellable, &local_error);
+
+  if (version == NULL)
+    {
+      if (!_musician_gpt_input_stream_truncated (stream))
+        g_propagate_error (error, g_steal_pointer (&local_error));
+      return FALSE;
+    }
+
+  if (NULL == (subparser = _musician_gpt_parser_create_subparser (version, error)))
+    return FALSE;
+
+  /* Only the GP4 decoder can be resumed in the middle of a file */
+  if (!MUSICIAN_IS_GP4_PARSER (subparser))
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_NOT_SUPPORTED,
+                   "The file format \"%s\" cannot be decoded incrementally",
+                   version);
+      return FALSE;
+    }
+
+  self->subparser = MUSICIAN_GP4_PARSER (g_steal_pointer (&subparser));
+  _musician_gp4_decoder_init (&self->decoder, version, self->arena, NULL, NULL);
+
+  return TRUE;
+}
+
+/*
+ * Decodes as many complete records as there are in the buffer and drops
+ * them from it. Whatever is left is the start of a record we will try
+ * again once more data has arrived.
+ */
+static MusicianGptPushStatus
+musician_gpt_push_parser_process (MusicianGptPushParser  *self,
+                                  GCancellable           *cancellable,
+                                  GError                **error)
+{
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+  MusicianGptArenaMark mark;
+  GError *local_error = NULL;
+  gsize consumed = 0;
+
+  g_assert (MUSICIAN_IS_GPT_PUSH_PARSER (self));
+  g_assert (self->song == NULL);
+
+  musician_gpt_arena_mark (self->arena, &mark);
+
+  /* The stream does not outlive this function, nor does @buffer change */
+  bytes = g_bytes_new_static (self->buffer->data, self->buffer->len);
+  stream = musician_gpt_input_stream_new_for_bytes (bytes);
+  _musician_gpt_input_stream_set_arena (stream, self->arena);
+  _musician_gpt_input_stream_set_partial (stream, TRUE);
+
+  if (self->subparser == NULL)
+    {
+      if (!musician_gpt_push_parser_begin (self, stream, cancellable, &local_error))
+        goto finish;
+
+      consumed = _musician_gpt_input_stream_tell (stream);
+      musician_gpt_arena_mark (self->arena, &mark);
+    }
+
+  while (self->decoder.section != MUSICIAN_GP4_SECTION_DONE)
+    {
+      if (!_musician_gp4_parser_step (self->subparser, &self->decoder, stream, cancellable, &local_error))
+        {
+          /* Not an error, the rest of the record is still on its way */
+          if (_musician_gpt_input_stream_truncated (stream) &&
+              !g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_clear_error (&local_error);
+          goto finish;
+        }
+
+      consumed = _musician_gpt_input_stream_tell (stream);
+      musician_gpt_arena_mark (self->arena, &mark);
+    }
+
+  self->song = g_steal_pointer (&self->decoder.song);
+
+finish:
+  /*
+   * The strings of the record we gave up on are decoded again along with
+   * the rest of it, so drop them rather than letting them pile up.
+   */
+  if (self->song == NULL && local_error == NULL)
+    {
+      self->n_wanted = _musician_gpt_input_stream_get_n_wanted (stream) - consumed;
+      musician_gpt_arena_rewind (self->arena, &mark);
+    }
+
+  g_clear_object (&stream);
+  g_clear_pointer (&bytes, g_bytes_unref);
+
+  if (local_error != NULL)
+    {
+      self->failed = TRUE;
+      g_propagate_error (error, local_error);
+      return MUSICIAN_GPT_PUSH_STATUS_ERROR;
+    }
+
+  /* Anything after the song (GP4 files are padded) is of no interest */
+  if (self->song != NULL)
+    consumed = self->buffer->len;
+
+  g_byte_array_remove_range (self->buffer, 0, consumed);
+
+  return self->song != NULL ? MUSICIAN_GPT_PUSH_STATUS_DONE
+                            : MUSICIAN_GPT_PUSH_STATUS_NEED_MORE_DATA;
+}
+
+/**
+ * musician_gpt_push_parser_feed:
+ * @self: A #MusicianGptPushParser
+ * @data: (array length=len): The next chunk of the file
+ * @len: The length of @data in bytes
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @error: A location for a #GError or %NULL
+ *
+ * Decodes as much of the file as possible using @data along with whatever
+ * was left over from previous calls. @data may be split anywhere, and is
+ * copied if it is needed after this call returns.
+ *
+ * Once the song is complete, %MUSICIAN_GPT_PUSH_STATUS_DONE is returned
+ * and any further data is ignored. After %MUSICIAN_GPT_PUSH_STATUS_ERROR,
+ * the parser cannot be used again.
+ *
+ * Returns: %MUSICIAN_GPT_PUSH_STATUS_NEED_MORE_DATA if the song is not
+ *   complete yet, %MUSICIAN_GPT_PUSH_STATUS_DONE if it is, or
+ *   %MUSICIAN_GPT_PUSH_STATUS_ERROR and @error is set.
+ */
+MusicianGptPushStatus
+musician_gpt_push_parser_feed (MusicianGptPushParser  *self,
+                               const guint8           *data,
+                               gsize                   len,
+                               GCancellable           *cancellable,
+                               GError                **error)
+{
+  g_return_val_if_fail (MUSICIAN_IS_GPT_PUSH_PARSER (self), MUSICIAN_GPT_PUSH_STATUS_ERROR);
+  g_return_val_if_fail (data != NULL || len == 0, MUSICIAN_GPT_PUSH_STATUS_ERROR);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), MUSICIAN_GPT_PUSH_STATUS_ERROR);
+
+  if (self->failed)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_FAILED,
+                   "Cannot use parser after it has failed");
+      return MUSICIAN_GPT_PUSH_STATUS_ERROR;
+    }
+
+  if (self->song != NULL)
+    return MUSICIAN_GPT_PUSH_STATUS_DONE;
+
+  if (len == 0)
+    return MUSICIAN_GPT_PUSH_STATUS_NEED_MORE_DATA;
+
+  g_byte_array_append (self->buffer, data, len);
+
+  if (self->buffer->len < self->n_wanted)
+    return MUSICIAN_GPT_PUSH_STATUS_NEED_MORE_DATA;
+
+  return musician_gpt_push_parser_process (self, cancellable, error);
+}
+
+/**
+ * musician_gpt_push_parser_close:
+ * @self: A #MusicianGptPushParser
+ * @error: A location for a #GError or %NULL
+ *
+ * Tells @self that there is no more data. This fails if the song is not
+ * complete, such as when the connection was dropped half way through.
+ *
+ * Returns: %TRUE if the song was decoded completely; otherwise %FALSE
+ *   and @error is set.
+ */
+gboolean
+musician_gpt_push_parser_close (MusicianGptPushParser  *self,
+                                GError                **error)
+{
+  g_return_val_if_fail (MUSICIAN_IS_GPT_PUSH_PARSER (self), FALSE);
+
+  if (self->song == NULL)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVALID_DATA,
+                   "Unexpected end of file");
+      self->failed = TRUE;
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * musician_gpt_push_parser_get_n_buffered:
+ * @self: A #MusicianGptPushParser
+ *
+ * Gets the number of bytes that have been fed to @self but are held back
+ * until the record they belong to is complete. This is how much input
+ * memory a connection is using, which is usually a few hundred bytes.
+ *
+ * Returns: The number of bytes waiting to be decoded.
+ */
+gsize
+musician_gpt_push_parser_get_n_buffered (MusicianGptPushParser *self)
+{
+  g_return_val_if_fail (MUSICIAN_IS_GPT_PUSH_PARSER (self), 0);
+
+  return self->buffer->len;
+}
+
+/**
+ * musician_gpt_push_parser_get_n_allocated:
+ * @self: A #MusicianGptPushParser
+ *
+ * Gets the number of bytes allocated for the strings of the song so far.
+ * Records that are still incomplete do not count towards this, however
+ * many times they have been tried.
+ *
+ * Returns: The number of bytes allocated for the song.
+ */
+gsize
+musician_gpt_push_parser_get_n_allocated (MusicianGptPushParser *self)
+{
+  g_return_val_if_fail (MUSICIAN_IS_GPT_PUSH_PARSER (self), 0);
+
+  return musician_gpt_arena_get_size (self->arena);
+}
+
+/**
+ * musician_gpt_push_parser_get_song:
+ * @self: A #MusicianGptPushParser
+ *
+ * Gets the song, once musician_gpt_push_parser_feed() has returned
+ * %MUSICIAN_GPT_PUSH_STATUS_DONE.
+ *
+ * Returns: (transfer none) (nullable): A #MusicianGptSong or %NULL.
+ */
+MusicianGptSong *
+musician_gpt_push_parser_get_song (MusicianGptPushParser *self)
+{
+  g_return_val_if_fail (MUSICIAN_IS_GPT_PUSH_PARSER (self), NULL);
+
+  return self->song;
+}
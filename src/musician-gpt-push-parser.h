@@ -0,0 +1,47 @@
+/* musician-gpt-push-parser.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_PUSH_PARSER_H
+#define MUSICIAN_GPT_PUSH_PARSER_H
+
+#include <gio/gio.h>
+
+#include "musician-gpt-song.h"
+#include "musician-gpt-types.h"
+
+G_BEGIN_DECLS
+
+#define MUSICIAN_TYPE_GPT_PUSH_PARSER (musician_gpt_push_parser_get_type())
+
+G_DECLARE_FINAL_TYPE (MusicianGptPushParser, musician_gpt_push_parser, MUSICIAN, GPT_PUSH_PARSER, GObject)
+
+MusicianGptPushParser *musician_gpt_push_parser_new             (void);
+MusicianGptPushStatus  musician_gpt_push_parser_feed            (MusicianGptPushParser  *self,
+                                                                 const guint8           *data,
+                                                                 gsize                   len,
+                                                                 GCancellable           *cancellable,
+                                                                 GError                **error);
+gboolean               musician_gpt_push_parser_close           (MusicianGptPushParser  *self,
+                                                                 GError                **error);
+gsize                  musician_gpt_push_parser_get_n_buffered  (MusicianGptPushParser  *self);
+gsize                  musician_gpt_push_parser_get_n_allocated (MusicianGptPushParser  *self);
+MusicianGptSong       *musician_gpt_push_parser_get_song        (MusicianGptPushParser  *self);
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_PUSH_PARSER_H */
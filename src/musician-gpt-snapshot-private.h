@@ -0,0 +1,162 @@
+/* musician-gpt-snapshot-private.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_SNAPSHOT_PRIVATE_H
+#define MUSICIAN_GPT_SNAPSHOT_PRIVATE_H
+
+#include <gdk/gdk.h>
+
+#include "musician-gpt-types.h"
+
+G_BEGIN_DECLS
+
+/*
+ * The snapshot records are shared with #MusicianGptFrozenSong, which
+ * reads them in place rather than loading them back into a song.
+ */
+
+#define SNAPSHOT_MAGIC   "MGPTSNAP"
+#define SNAPSHOT_VERSION 3
+#define SNAPSHOT_ALIGN   8
+
+typedef struct
+{
+  guint32 offset;
+  guint32 n_items;
+} SnapshotSection;
+
+/*
+ * Strings are stored as offsets into the strings section, which starts
+ * with a nul byte so that 0 can stand for %NULL.
+ */
+typedef struct
+{
+  gchar           magic[8];
+  guint32         version;
+  guint32         byte_order;
+  guint32         len;
+
+  guint32         album;
+  guint32         artist;
+  guint32         copyright;
+  guint32         interpretation;
+  guint32         instructions;
+  guint32         subtitle;
+  guint32         title;
+  guint32         song_version;
+  guint32         writer;
+
+  gint32          key;
+  guint32         octave;
+  guint32         triplet_feel;
+  guint32         tempo;
+
+  guint32         n_block_measures;
+  guint32         n_block_tracks;
+
+  SnapshotSection strings;
+  SnapshotSection ports;
+  SnapshotSection lyrics;
+  SnapshotSection tracks;
+  SnapshotSection tunings;
+  SnapshotSection measures;
+  SnapshotSection blocks;
+  SnapshotSection beats;
+  SnapshotSection bends;
+  SnapshotSection bend_points;
+} SnapshotHeader;
+
+typedef struct
+{
+  guint32 position;
+  guint32 text;
+} SnapshotLyrics;
+
+typedef struct
+{
+  GdkRGBA color;
+  guint32 title;
+  guint32 id;
+  guint32 capo_at;
+  guint32 n_frets;
+  guint32 port;
+  guint32 channel;
+  guint32 effects_channel;
+  guint32 first_tuning;
+  guint32 n_tunings;
+  guint32 _padding;
+} SnapshotTrack;
+
+typedef struct
+{
+  GdkRGBA marker_color;
+  guint32 marker_name;
+  guint32 id;
+  guint32 numerator;
+  guint32 denominator;
+  guint32 n_repeats;
+  guint32 nth_ending;
+  gint32  key;
+  guint32 _padding;
+} SnapshotMeasure;
+
+/* One per measure/track pair, track by track within a measure */
+typedef struct
+{
+  guint32 first_beat;
+  guint32 n_beats;
+  guint32 first_bend;
+  guint32 n_bends;
+} SnapshotBlock;
+
+typedef struct
+{
+  guint32 text;
+  guint32 chord_name;
+  guint8  mode;
+  guint8  duration;
+  guint8  dynamics;
+  guint8  n_tuplet;
+  guint8  has_chord;
+  guint8  flags;
+  guint8  _padding[2];
+} SnapshotBeat;
+
+/* The bends of a block are sorted by the beat within the block */
+typedef struct
+{
+  guint32 beat;
+  guint32 string;
+  guint32 bend_type;
+  guint32 first_point;
+  guint32 n_points;
+  guint32 _padding;
+} SnapshotBend;
+
+G_STATIC_ASSERT (sizeof (SnapshotHeader) % SNAPSHOT_ALIGN == 0);
+G_STATIC_ASSERT (sizeof (SnapshotLyrics) == 8);
+G_STATIC_ASSERT (sizeof (SnapshotTrack) == 72);
+G_STATIC_ASSERT (sizeof (SnapshotMeasure) == 64);
+G_STATIC_ASSERT (sizeof (SnapshotBlock) == 16);
+G_STATIC_ASSERT (sizeof (SnapshotBeat) == 16);
+G_STATIC_ASSERT (sizeof (SnapshotBend) == 24);
+G_STATIC_ASSERT (sizeof (MusicianGptBendPoint) == 4);
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_SNAPSHOT_PRIVATE_H */
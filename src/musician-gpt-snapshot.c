@@ -0,0 +1,830 @@
+/* musician-gpt-snapshot.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "musician-gpt-snapshot"
+
+#include <string.h>
+
+#include "musician-gpt-arena.h"
+#include "musician-gpt-beat-store.h"
+#include "musician-gpt-beat-store-private.h"
+#include "musician-gpt-bend.h"
+#include "musician-gpt-chord.h"
+#include "musician-gpt-lyrics.h"
+#include "musician-gpt-measure.h"
+#include "musician-gpt-measure-private.h"
+#include "musician-gpt-snapshot.h"
+#include "musician-gpt-snapshot-private.h"
+#include "musician-gpt-song-private.h"
+#include "musician-gpt-track.h"
+#include "musician-gpt-track-private.h"
+
+/**
+ * SECTION:musician-gpt-snapshot
+ * @title: Snapshots
+ * @short_description: Save songs for fast reloading
+ *
+ * A snapshot is a binary copy of a #MusicianGptSong that loads much
+ * faster than the Guitar Pro™ file it came from. It is meant as a cache
+ * next to the original file, not as a format to exchange songs with.
+ *
+ * Every record in a snapshot has a fixed size and lives at an aligned
+ * offset, in the byte order of the machine that wrote it. Loading a
+ * snapshot only checks the bounds of each section and then reads the
+ * records in place. Strings are stored once, nul-terminated, and the
+ * song points straight into the snapshot rather than copying them.
+ * Beats are read the first time musician_gpt_song_get_beats() or
+ * musician_gpt_song_get_beat_store() asks for them.
+ *
+ * A song loaded with musician_gpt_snapshot_load_from_file() keeps the
+ * file mapped for as long as it is alive, so snapshots must be replaced
+ * rather than written to in place. musician_gpt_snapshot_save_to_file()
+ * does this.
+ */
+
+typedef struct
+{
+  GString    *strings;
+  GHashTable *string_offsets;
+  GArray     *ports;
+  GArray     *lyrics;
+  GArray     *tracks;
+  GArray     *tunings;
+  GArray     *measures;
+  GArray     *blocks;
+  GArray     *beats;
+  GArray     *bends;
+  GArray     *bend_points;
+} SnapshotWriter;
+
+/*
+ * A loaded snapshot. The song keeps one of these around as the user data
+ * of its block function, so that beats can be read on demand.
+ */
+typedef struct
+{
+  GBytes               *bytes;
+  const guint8         *data;
+  const SnapshotHeader *header;
+
+  /* Set when a string or record points outside of its section */
+  gboolean              failed;
+} Snapshot;
+
+static void
+snapshot_writer_init (SnapshotWriter *writer)
+{
+  writer->strings = g_string_new_len ("", 1);
+  writer->string_offsets = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  writer->ports = g_array_new (FALSE, FALSE, sizeof (MusicianGptMidiPort));
+  writer->lyrics = g_array_new (FALSE, FALSE, sizeof (SnapshotLyrics));
+  writer->tracks = g_array_new (FALSE, FALSE, sizeof (SnapshotTrack));
+  writer->tunings = g_array_new (FALSE, FALSE, sizeof (MusicianGptTuning));
+  writer->measures = g_array_new (FALSE, FALSE, sizeof (SnapshotMeasure));
+  writer->blocks = g_array_new (FALSE, FALSE, sizeof (SnapshotBlock));
+  writer->beats = g_array_new (FALSE, FALSE, sizeof (SnapshotBeat));
+  writer->bends = g_array_new (FALSE, FALSE, sizeof (SnapshotBend));
+  writer->bend_points = g_array_new (FALSE, FALSE, sizeof (MusicianGptBendPoint));
+}
+
+static void
+snapshot_writer_clear (SnapshotWriter *writer)
+{
+  g_string_free (writer->strings, TRUE);
+  g_clear_pointer (&writer->string_offsets, g_hash_table_unref);
+  g_clear_pointer (&writer->ports, g_array_unref);
+  g_clear_pointer (&writer->lyrics, g_array_unref);
+  g_clear_pointer (&writer->tracks, g_array_unref);
+  g_clear_pointer (&writer->tunings, g_array_unref);
+  g_clear_pointer (&writer->measures, g_array_unref);
+  g_clear_pointer (&writer->blocks, g_array_unref);
+  g_clear_pointer (&writer->beats, g_array_unref);
+  g_clear_pointer (&writer->bends, g_array_unref);
+  g_clear_pointer (&writer->bend_points, g_array_unref);
+}
+
+/* Strings that repeat, such as beat texts, are only stored once */
+static guint32
+snapshot_writer_add_string (SnapshotWriter *writer,
+                            const gchar    *str)
+{
+  gpointer offset;
+
+  if (str == NULL)
+    return 0;
+
+  if (!g_hash_table_lookup_extended (writer->string_offsets, str, NULL, &offset))
+    {
+      offset = GUINT_TO_POINTER (writer->strings->len);
+      g_string_append_len (writer->strings, str, strlen (str) + 1);
+      g_hash_table_insert (writer->string_offsets, g_strdup (str), offset);
+    }
+
+  return GPOINTER_TO_UINT (offset);
+}
+
+static gboolean
+snapshot_writer_add_block (SnapshotWriter  *writer,
+                           MusicianGptSong *song,
+                           guint            measure,
+                           guint            track,
+                           GCancellable    *cancellable,
+                           GError         **error)
+{
+  MusicianGptBeatStore *store;
+  SnapshotBlock block;
+  guint first_beat;
+  guint n_beats;
+
+  if (NULL == (store = musician_gpt_song_get_beat_store (song, track, cancellable, error)))
+    return FALSE;
+
+  musician_gpt_beat_store_get_measure (store, measure, &first_beat, &n_beats);
+
+  block.first_beat = writer->beats->len;
+  block.n_beats = n_beats;
+  block.first_bend = writer->bends->len;
+
+  for (guint i = 0; i < n_beats; i++)
+    {
+      MusicianGptBeatView view;
+      SnapshotBeat record = { 0 };
+
+      musician_gpt_beat_store_get_view (store, first_beat + i, &view);
+
+      record.text = snapshot_writer_add_string (writer, view.text);
+      record.mode = view.mode;
+      record.duration = view.duration;
+      record.dynamics = view.dynamics;
+      record.n_tuplet = view.n_tuplet;
+      record.has_chord = view.chord != NULL;
+      if (view.chord != NULL)
+        record.chord_name = snapshot_writer_add_string (writer, musician_gpt_chord_get_name (view.chord));
+      record.flags = view.flags;
+
+      g_array_append_val (writer->beats, record);
+
+      for (guint j = 0; j < view.n_bends; j++)
+        {
+          const MusicianGptBendPoint *points;
+          MusicianGptBend *bend;
+          SnapshotBend bend_record = { 0 };
+          guint n_points;
+          guint string;
+
+          bend = musician_gpt_beat_store_get_bend (store, first_beat + i, j, &string);
+          points = musician_gpt_bend_get_points (bend, &n_points);
+
+          bend_record.beat = i;
+          bend_record.string = string;
+          bend_record.bend_type = musician_gpt_bend_get_bend_type (bend);
+          bend_record.first_point = writer->bend_points->len;
+          bend_record.n_points = n_points;
+
+          g_array_append_val (writer->bends, bend_record);
+          g_array_append_vals (writer->bend_points, points, n_points);
+        }
+    }
+
+  block.n_bends = writer->bends->len - block.first_bend;
+  g_array_append_val (writer->blocks, block);
+
+  return TRUE;
+}
+
+static gboolean
+snapshot_writer_add_song (SnapshotWriter   *writer,
+                          SnapshotHeader   *header,
+                          MusicianGptSong  *song,
+                          GCancellable     *cancellable,
+                          GError          **error)
+{
+  const MusicianGptMidiPort *ports;
+  MusicianGptMeasure **measures;
+  guint n_measures;
+  GPtrArray *lyrics;
+  GPtrArray *tracks;
+  gsize n_ports;
+
+  header->album = snapshot_writer_add_string (writer, musician_gpt_song_get_album (song));
+  header->artist = snapshot_writer_add_string (writer, musician_gpt_song_get_artist (song));
+  header->copyright = snapshot_writer_add_string (writer, musician_gpt_song_get_copyright (song));
+  header->interpretation = snapshot_writer_add_string (writer, musician_gpt_song_get_interpretation (song));
+  header->instructions = snapshot_writer_add_string (writer, musician_gpt_song_get_instructions (song));
+  header->subtitle = snapshot_writer_add_string (writer, musician_gpt_song_get_subtitle (song));
+  header->title = snapshot_writer_add_string (writer, musician_gpt_song_get_title (song));
+  header->song_version = snapshot_writer_add_string (writer, musician_gpt_song_get_version (song));
+  header->writer = snapshot_writer_add_string (writer, musician_gpt_song_get_writer (song));
+
+  header->key = musician_gpt_song_get_key (song);
+  header->octave = musician_gpt_song_get_octave (song);
+  header->triplet_feel = musician_gpt_song_get_triplet_feel (song);
+  header->tempo = musician_gpt_song_get_tempo (song);
+
+  ports = _musician_gpt_song_get_midi_ports (song, &n_ports);
+  g_array_append_vals (writer->ports, ports, n_ports);
+
+  lyrics = _musician_gpt_song_get_lyrics (song);
+  for (guint i = 0; i < lyrics->len; i++)
+    {
+      MusicianGptLyrics *item = g_ptr_array_index (lyrics, i);
+      SnapshotLyrics record;
+
+      record.position = musician_gpt_lyrics_get_position (item);
+      record.text = snapshot_writer_add_string (writer, musician_gpt_lyrics_get_text (item));
+
+      g_array_append_val (writer->lyrics, record);
+    }
+
+  tracks = _musician_gpt_song_get_tracks (song);
+  for (guint i = 0; i < tracks->len; i++)
+    {
+      MusicianGptTrack *track = g_ptr_array_index (tracks, i);
+      const MusicianGptTuning *tunings;
+      SnapshotTrack record = { { 0 } };
+      gsize n_tunings;
+
+      tunings = musician_gpt_track_get_tunings (track, &n_tunings);
+
+      record.color = *musician_gpt_track_get_color (track);
+      record.title = snapshot_writer_add_string (writer, musician_gpt_track_get_title (track));
+      record.id = musician_gpt_track_get_id (track);
+      record.capo_at = musician_gpt_track_get_capo_at (track);
+      record.n_frets = musician_gpt_track_get_n_frets (track);
+      record.port = musician_gpt_track_get_port (track);
+      record.channel = musician_gpt_track_get_channel (track);
+      record.effects_channel = musician_gpt_track_get_effects_channel (track);
+      record.first_tuning = writer->tunings->len;
+      record.n_tunings = n_tunings;
+
+      g_array_append_vals (writer->tunings, tunings, n_tunings);
+      g_array_append_val (writer->tracks, record);
+    }
+
+  measures = musician_gpt_song_get_measures (song, &n_measures);
+  for (guint i = 0; i < n_measures; i++)
+    {
+      MusicianGptMeasure *measure = measures[i];
+      SnapshotMeasure record = { { 0 } };
+
+      record.marker_color = *musician_gpt_measure_get_marker_color (measure);
+      record.marker_name = snapshot_writer_add_string (writer, musician_gpt_measure_get_marker_name (measure));
+      record.id = musician_gpt_measure_get_id (measure);
+      record.numerator = musician_gpt_measure_get_numerator (measure);
+      record.denominator = musician_gpt_measure_get_denominator (measure);
+      record.n_repeats = musician_gpt_measure_get_n_repeats (measure);
+      record.nth_ending = musician_gpt_measure_get_nth_ending (measure);
+      record.key = musician_gpt_measure_get_key (measure);
+
+      g_array_append_val (writer->measures, record);
+    }
+
+  /* This decodes the beats of lazily loaded songs */
+  _musician_gpt_song_get_block_layout (song, &header->n_block_measures, &header->n_block_tracks);
+  for (guint measure = 1; measure <= header->n_block_measures; measure++)
+    {
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+        return FALSE;
+
+      for (guint track = 1; track <= header->n_block_tracks; track++)
+        {
+          if (!snapshot_writer_add_block (writer, song, measure, track, cancellable, error))
+            return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+static gboolean
+snapshot_append_section (GByteArray       *buffer,
+                         SnapshotSection  *section,
+                         gconstpointer     data,
+                         gsize             n_items,
+                         gsize             item_size,
+                         GError          **error)
+{
+  static const guint8 zeroes[SNAPSHOT_ALIGN] = { 0 };
+  gsize padding = (SNAPSHOT_ALIGN - buffer->len % SNAPSHOT_ALIGN) % SNAPSHOT_ALIGN;
+
+  if (n_items > G_MAXUINT32 ||
+      n_items > (G_MAXUINT32 - buffer->len - padding) / item_size)
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_NO_SPACE,
+                           "The song is too large for a snapshot");
+      return FALSE;
+    }
+
+  g_byte_array_append (buffer, zeroes, padding);
+
+  section->offset = buffer->len;
+  section->n_items = n_items;
+
+  g_byte_array_append (buffer, data, n_items * item_size);
+
+  return TRUE;
+}
+
+/**
+ * musician_gpt_snapshot_serialize:
+ * @song: A #MusicianGptSong
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @error: A location for a #GError or %NULL
+ *
+ * Creates a snapshot of @song, which can be loaded again with
+ * musician_gpt_snapshot_load_from_bytes().
+ *
+ * If @song was loaded lazily, all of its beats are decoded first.
+ *
+ * Returns: (transfer full): A #GBytes, or %NULL and @error is set.
+ */
+GBytes *
+musician_gpt_snapshot_serialize (MusicianGptSong  *song,
+                                 GCancellable     *cancellable,
+                                 GError          **error)
+{
+  g_autoptr(GByteArray) buffer = NULL;
+  SnapshotHeader header = { { 0 } };
+  SnapshotWriter writer;
+  gboolean ret;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (song), NULL);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), NULL);
+
+  memcpy (header.magic, SNAPSHOT_MAGIC, sizeof header.magic);
+  header.version = SNAPSHOT_VERSION;
+  header.byte_order = G_BYTE_ORDER;
+
+  snapshot_writer_init (&writer);
+
+  buffer = g_byte_array_new ();
+  g_byte_array_set_size (buffer, sizeof header);
+
+  ret = snapshot_writer_add_song (&writer, &header, song, cancellable, error) &&
+        snapshot_append_section (buffer, &header.strings, writer.strings->str, writer.strings->len, 1, error) &&
+        snapshot_append_section (buffer, &header.ports, writer.ports->data, writer.ports->len, sizeof (MusicianGptMidiPort), error) &&
+        snapshot_append_section (buffer, &header.lyrics, writer.lyrics->data, writer.lyrics->len, sizeof (SnapshotLyrics), error) &&
+        snapshot_append_section (buffer, &header.tracks, writer.tracks->data, writer.tracks->len, sizeof (SnapshotTrack), error) &&
+        snapshot_append_section (buffer, &header.tunings, writer.tunings->data, writer.tunings->len, sizeof (MusicianGptTuning), error) &&
+        snapshot_append_section (buffer, &header.measures, writer.measures->data, writer.measures->len, sizeof (SnapshotMeasure), error) &&
+        snapshot_append_section (buffer, &header.blocks, writer.blocks->data, writer.blocks->len, sizeof (SnapshotBlock), error) &&
+        snapshot_append_section (buffer, &header.beats, writer.beats->data, writer.beats->len, sizeof (SnapshotBeat), error) &&
+        snapshot_append_section (buffer, &header.bends, writer.bends->data, writer.bends->len, sizeof (SnapshotBend), error) &&
+        snapshot_append_section (buffer, &header.bend_points, writer.bend_points->data, writer.bend_points->len, sizeof (MusicianGptBendPoint), error);
+
+  snapshot_writer_clear (&writer);
+
+  if (!ret)
+    return NULL;
+
+  header.len = buffer->len;
+  memcpy (buffer->data, &header, sizeof header);
+
+  return g_byte_array_free_to_bytes (g_steal_pointer (&buffer));
+}
+
+/**
+ * musician_gpt_snapshot_save_to_file:
+ * @song: A #MusicianGptSong
+ * @file: A #GFile
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @error: A location for a #GError or %NULL
+ *
+ * Writes a snapshot of @song to @file. An existing @file is replaced
+ * rather than overwritten, so songs that were loaded from it are not
+ * affected.
+ *
+ * Returns: %TRUE if successful; otherwise %FALSE and @error is set.
+ */
+gboolean
+musician_gpt_snapshot_save_to_file (MusicianGptSong  *song,
+                                    GFile            *file,
+                                    GCancellable     *cancellable,
+                                    GError          **error)
+{
+  g_autoptr(GBytes) bytes = NULL;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (song), FALSE);
+  g_return_val_if_fail (G_IS_FILE (file), FALSE);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), FALSE);
+
+  if (NULL == (bytes = musician_gpt_snapshot_serialize (song, cancellable, error)))
+    return FALSE;
+
+  return g_file_replace_contents (file,
+                                  g_bytes_get_data (bytes, NULL),
+                                  g_bytes_get_size (bytes),
+                                  NULL,
+                                  FALSE,
+                                  G_FILE_CREATE_REPLACE_DESTINATION,
+                                  NULL,
+                                  cancellable,
+                                  error);
+}
+
+static void
+snapshot_free (gpointer data)
+{
+  Snapshot *snapshot = data;
+
+  g_clear_pointer (&snapshot->bytes, g_bytes_unref);
+  g_slice_free (Snapshot, snapshot);
+}
+
+static gboolean
+snapshot_section_is_valid (const SnapshotSection *section,
+                           gsize                  item_size,
+                           gsize                  len)
+{
+  return section->offset >= sizeof (SnapshotHeader) &&
+         section->offset % SNAPSHOT_ALIGN == 0 &&
+         section->offset <= len &&
+         section->n_items <= (len - section->offset) / item_size;
+}
+
+/*
+ * Checks that every section of the snapshot lies within its bytes, so
+ * that records can be read without further bounds checks. The block
+ * layout is checked against the measures and tracks actually stored, as
+ * a beat store is created for each of its tracks.
+ */
+static gboolean
+snapshot_init (Snapshot  *snapshot,
+               GBytes    *bytes,
+               GError   **error)
+{
+  const SnapshotHeader *header;
+  const guint8 *data;
+  gsize len;
+
+  data = g_bytes_get_data (bytes, &len);
+  header = (const SnapshotHeader *)(gconstpointer)data;
+
+  if (len < sizeof *header || memcmp (header->magic, SNAPSHOT_MAGIC, sizeof header->magic) != 0)
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_INVALID_DATA,
+                           "Not a song snapshot");
+      return FALSE;
+    }
+
+  if (header->version != SNAPSHOT_VERSION || header->byte_order != G_BYTE_ORDER)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_NOT_SUPPORTED,
+                   "Snapshot version %u is not supported",
+                   header->version);
+      return FALSE;
+    }
+
+  if (header->len != len ||
+      !snapshot_section_is_valid (&header->strings, 1, len) ||
+      !snapshot_section_is_valid (&header->ports, sizeof (MusicianGptMidiPort), len) ||
+      !snapshot_section_is_valid (&header->lyrics, sizeof (SnapshotLyrics), len) ||
+      !snapshot_section_is_valid (&header->tracks, sizeof (SnapshotTrack), len) ||
+      !snapshot_section_is_valid (&header->tunings, sizeof (MusicianGptTuning), len) ||
+      !snapshot_section_is_valid (&header->measures, sizeof (SnapshotMeasure), len) ||
+      !snapshot_section_is_valid (&header->blocks, sizeof (SnapshotBlock), len) ||
+      !snapshot_section_is_valid (&header->beats, sizeof (SnapshotBeat), len) ||
+      !snapshot_section_is_valid (&header->bends, sizeof (SnapshotBend), len) ||
+      !snapshot_section_is_valid (&header->bend_points, sizeof (MusicianGptBendPoint), len) ||
+      header->strings.n_items == 0 ||
+      data[header->strings.offset + header->strings.n_items - 1] != '\0' ||
+      header->n_block_measures > header->measures.n_items ||
+      header->n_block_tracks > header->tracks.n_items ||
+      header->blocks.n_items != (guint64)header->n_block_measures * header->n_block_tracks)
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_INVALID_DATA,
+                           "The snapshot is truncated or corrupt");
+      return FALSE;
+    }
+
+  snapshot->bytes = g_bytes_ref (bytes);
+  snapshot->data = data;
+  snapshot->header = header;
+
+  return TRUE;
+}
+
+#define snapshot_records(snapshot, section, Type) \
+  ((const Type *)(gconstpointer)&(snapshot)->data[(snapshot)->header->section.offset])
+
+static const gchar *
+snapshot_string (Snapshot *snapshot,
+                 guint32   offset)
+{
+  if (offset == 0)
+    return NULL;
+
+  if (offset >= snapshot->header->strings.n_items)
+    {
+      snapshot->failed = TRUE;
+      return NULL;
+    }
+
+  return (const gchar *)&snapshot->data[snapshot->header->strings.offset + offset];
+}
+
+static gboolean
+snapshot_load_block (guint                  measure,
+                     guint                  track,
+                     MusicianGptBeatStore  *store,
+                     gpointer               user_data,
+                     GCancellable          *cancellable,
+                     GError               **error)
+{
+  Snapshot *snapshot = user_data;
+  const MusicianGptBendPoint *points;
+  const SnapshotBlock *block;
+  const SnapshotBeat *beats;
+  const SnapshotBend *bends;
+  guint32 next_bend = 0;
+
+  g_assert (snapshot != NULL);
+
+  /* The song has checked @measure and @track against the block layout */
+  block = &snapshot_records (snapshot, blocks, SnapshotBlock)[(measure - 1) * snapshot->header->n_block_tracks + (track - 1)];
+  beats = snapshot_records (snapshot, beats, SnapshotBeat);
+  bends = snapshot_records (snapshot, bends, SnapshotBend);
+  points = snapshot_records (snapshot, bend_points, MusicianGptBendPoint);
+
+  snapshot->failed = block->first_beat > snapshot->header->beats.n_items ||
+                     block->n_beats > snapshot->header->beats.n_items - block->first_beat ||
+                     block->first_bend > snapshot->header->bends.n_items ||
+                     block->n_bends > snapshot->header->bends.n_items - block->first_bend;
+
+  for (guint32 i = 0; i < block->n_beats && !snapshot->failed; i++)
+    {
+      const SnapshotBeat *record = &beats[block->first_beat + i];
+      MusicianGptBeatEvent event = { 0 };
+
+      if (record->duration > G_MAXINT8)
+        {
+          snapshot->failed = TRUE;
+          break;
+        }
+
+      event.measure = measure;
+      event.track = track;
+      event.index = i;
+      event.flags = record->flags;
+      event.mode = record->mode;
+      event.duration = record->duration;
+      event.n_tuplet = record->n_tuplet;
+      event.dynamics = record->dynamics;
+      event.text = snapshot_string (snapshot, record->text);
+
+      _musician_gpt_beat_store_append (store, &event);
+
+      if (record->has_chord)
+        {
+          g_autoptr(MusicianGptChord) chord = NULL;
+
+          chord = musician_gpt_intern_table_get_chord (_musician_gpt_beat_store_get_intern_table (store),
+                                                       snapshot_string (snapshot, record->chord_name));
+          _musician_gpt_beat_store_set_chord (store, chord);
+        }
+
+      for (; next_bend < block->n_bends && bends[block->first_bend + next_bend].beat == i; next_bend++)
+        {
+          const SnapshotBend *bend_record = &bends[block->first_bend + next_bend];
+          g_autoptr(MusicianGptBend) bend = NULL;
+
+          if (bend_record->first_point > snapshot->header->bend_points.n_items ||
+              bend_record->n_points > snapshot->header->bend_points.n_items - bend_record->first_point)
+            {
+              snapshot->failed = TRUE;
+              break;
+            }
+
+          bend = musician_gpt_intern_table_get_bend (_musician_gpt_beat_store_get_intern_table (store),
+                                                     bend_record->bend_type,
+                                                     &points[bend_record->first_point],
+                                                     bend_record->n_points);
+          _musician_gpt_beat_store_add_bend (store, bend_record->string, bend);
+        }
+    }
+
+  /* Bends that do not belong to any of the beats, or are out of order */
+  if (next_bend != block->n_bends)
+    snapshot->failed = TRUE;
+
+  if (snapshot->failed)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVALID_DATA,
+                   "The snapshot is corrupt at measure %u, track %u",
+                   measure, track);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * musician_gpt_snapshot_load_from_bytes:
+ * @bytes: A #GBytes containing a snapshot
+ * @error: A location for a #GError or %NULL
+ *
+ * Loads a song from a snapshot created with musician_gpt_snapshot_serialize().
+ *
+ * The song keeps a reference to @bytes and reads its strings and beats
+ * from there, so @bytes must not be modified afterwards.
+ *
+ * Returns: (transfer full): A #MusicianGptSong, or %NULL and @error is set.
+ */
+MusicianGptSong *
+musician_gpt_snapshot_load_from_bytes (GBytes  *bytes,
+                                       GError **error)
+{
+  g_autoptr(MusicianGptArena) arena = NULL;
+  g_autoptr(MusicianGptSong) song = NULL;
+  g_autoptr(GBytes) aligned = NULL;
+  const SnapshotHeader *header;
+  const SnapshotMeasure *measures;
+  const SnapshotLyrics *lyrics;
+  const SnapshotTrack *tracks;
+  const MusicianGptTuning *tunings;
+  MusicianGptSongInfo song_info;
+  Snapshot *snapshot;
+
+  g_return_val_if_fail (bytes != NULL, NULL);
+
+  /* Records are read in place, which needs them to be aligned in memory */
+  if (GPOINTER_TO_SIZE (g_bytes_get_data (bytes, NULL)) % SNAPSHOT_ALIGN != 0)
+    bytes = aligned = g_bytes_new (g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes));
+
+  snapshot = g_slice_new0 (Snapshot);
+
+  if (!snapshot_init (snapshot, bytes, error))
+    {
+      snapshot_free (snapshot);
+      return NULL;
+    }
+
+  header = snapshot->header;
+
+  /* Strings within @bytes are stored by the song without a copy */
+  arena = musician_gpt_arena_new_for_bytes (bytes);
+
+  song = musician_gpt_song_new ();
+  _musician_gpt_song_set_arena (song, arena);
+  _musician_gpt_song_set_block_func (song, snapshot_load_block, snapshot, snapshot_free);
+
+  song_info.album = snapshot_string (snapshot, header->album);
+  song_info.artist = snapshot_string (snapshot, header->artist);
+  song_info.copyright = snapshot_string (snapshot, header->copyright);
+  song_info.interpretation = snapshot_string (snapshot, header->interpretation);
+  song_info.instructions = snapshot_string (snapshot, header->instructions);
+  song_info.subtitle = snapshot_string (snapshot, header->subtitle);
+  song_info.title = snapshot_string (snapshot, header->title);
+  song_info.writer = snapshot_string (snapshot, header->writer);
+  song_info.key = header->key;
+  song_info.octave = header->octave;
+  song_info.triplet_feel = header->triplet_feel;
+  song_info.tempo = header->tempo;
+
+  _musician_gpt_song_set_info (song, &song_info);
+  _musician_gpt_song_set_version (song, snapshot_string (snapshot, header->song_version));
+
+  _musician_gpt_song_set_midi_ports (song,
+                                     snapshot_records (snapshot, ports, MusicianGptMidiPort),
+                                     header->ports.n_items);
+
+  lyrics = snapshot_records (snapshot, lyrics, SnapshotLyrics);
+  for (guint32 i = 0; i < header->lyrics.n_items; i++)
+    _musician_gpt_song_add_lyrics (song, lyrics[i].position, snapshot_string (snapshot, lyrics[i].text));
+
+  tracks = snapshot_records (snapshot, tracks, SnapshotTrack);
+  tunings = snapshot_records (snapshot, tunings, MusicianGptTuning);
+  for (guint32 i = 0; i < header->tracks.n_items && !snapshot->failed; i++)
+    {
+      const SnapshotTrack *record = &tracks[i];
+      g_autoptr(MusicianGptTrack) track = NULL;
+      MusicianGptTrackInfo info;
+
+      if (record->first_tuning > header->tunings.n_items ||
+          record->n_tunings > header->tunings.n_items - record->first_tuning)
+        {
+          snapshot->failed = TRUE;
+          break;
+        }
+
+      info.id = record->id;
+      info.title = snapshot_string (snapshot, record->title);
+      info.tunings = &tunings[record->first_tuning];
+      info.n_tunings = record->n_tunings;
+      info.port = record->port;
+      info.channel = record->channel;
+      info.effects_channel = record->effects_channel;
+      info.n_frets = record->n_frets;
+      info.capo_at = record->capo_at;
+      info.color = record->color;
+
+      track = _musician_gpt_track_new_from_info (&info, arena);
+
+      musician_gpt_song_add_track (song, track);
+    }
+
+  measures = snapshot_records (snapshot, measures, SnapshotMeasure);
+  for (guint32 i = 0; i < header->measures.n_items; i++)
+    {
+      const SnapshotMeasure *record = &measures[i];
+      g_autoptr(MusicianGptMeasure) measure = NULL;
+      MusicianGptMeasureInfo info;
+
+      info.id = record->id;
+      info.numerator = record->numerator;
+      info.denominator = record->denominator;
+      info.n_repeats = record->n_repeats;
+      info.nth_ending = record->nth_ending;
+      info.key = record->key;
+      info.marker_name = snapshot_string (snapshot, record->marker_name);
+      info.marker_color = record->marker_color;
+
+      measure = _musician_gpt_measure_new_from_info (&info, arena);
+
+      musician_gpt_song_add_measure (song, measure);
+    }
+
+  _musician_gpt_song_set_block_layout (song, header->n_block_measures, header->n_block_tracks);
+
+  if (snapshot->failed)
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_INVALID_DATA,
+                           "The snapshot is truncated or corrupt");
+      return NULL;
+    }
+
+  return g_steal_pointer (&song);
+}
+
+/**
+ * musician_gpt_snapshot_load_from_file:
+ * @file: A #GFile
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @error: A location for a #GError or %NULL
+ *
+ * Loads a song from a snapshot written with
+ * musician_gpt_snapshot_save_to_file(). Local files are mapped into
+ * memory and stay mapped for as long as the song is alive.
+ *
+ * Returns: (transfer full): A #MusicianGptSong, or %NULL and @error is set.
+ */
+MusicianGptSong *
+musician_gpt_snapshot_load_from_file (GFile         *file,
+                                      GCancellable  *cancellable,
+                                      GError       **error)
+{
+  g_autoptr(GBytes) bytes = NULL;
+  g_autofree gchar *path = NULL;
+
+  g_return_val_if_fail (G_IS_FILE (file), NULL);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), NULL);
+
+  if (NULL != (path = g_file_get_path (file)))
+    {
+      g_autoptr(GMappedFile) mapped = NULL;
+
+      if (NULL == (mapped = g_mapped_file_new (path, FALSE, error)))
+        return NULL;
+
+      bytes = g_mapped_file_get_bytes (mapped);
+    }
+  else
+    {
+      gchar *contents = NULL;
+      gsize len = 0;
+
+      if (!g_file_load_contents (file, cancellable, &contents, &len, NULL, error))
+        return NULL;
+
+      bytes = g_bytes_new_take (contents, len);
+    }
+
+  return musician_gpt_snapshot_load_from_bytes (bytes, error);
+}
@@ -0,0 +1,44 @@
+/* musician-gpt-snapshot.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_SNAPSHOT_H
+#define MUSICIAN_GPT_SNAPSHOT_H
+
+#include <gio/gio.h>
+
+#include "musician-gpt-song.h"
+#include "musician-gpt-types.h"
+
+G_BEGIN_DECLS
+
+GBytes          *musician_gpt_snapshot_serialize       (MusicianGptSong  *song,
+                                                        GCancellable     *cancellable,
+                                                        GError          **error);
+gboolean         musician_gpt_snapshot_save_to_file    (MusicianGptSong  *song,
+                                                        GFile            *file,
+                                                        GCancellable     *cancellable,
+                                                        GError          **error);
+MusicianGptSong *musician_gpt_snapshot_load_from_bytes (GBytes           *bytes,
+                                                        GError          **error);
+MusicianGptSong *musician_gpt_snapshot_load_from_file  (GFile            *file,
+                                                        GCancellable     *cancellable,
+                                                        GError          **error);
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_SNAPSHOT_H */
@@ -0,0 +1,473 @@
+/* musician-gpt-song-cache.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "musician-gpt-song-cache"
+
+#include "musician-gpt-song-cache.h"
+#include "musician-gpt-song-cache-private.h"
+#include "musician-gpt-song-private.h"
+
+/**
+ * SECTION:musician-gpt-song-cache:
+ * @title: #MusicianGptSongCache
+ * @short_description: Share songs between loads of the same file
+ *
+ * #MusicianGptSongCache keeps the songs that were recently loaded by the
+ * parsers it has been given to with musician_gpt_parser_set_cache(). Songs
+ * are looked up by a SHA-256 digest of the file contents, so loading the
+ * same file again, from any path or stream, returns the song that was
+ * loaded the first time instead of decoding it again.
+ *
+ * Songs from a cache are shared by everyone who loaded them and are
+ * read-only, see musician_gpt_song_get_read_only(). Reading from them,
+ * including creating their list models and timelines, is safe from any
+ * thread.
+ *
+ * The cache holds on to songs until the memory they use passes
+ * #MusicianGptSongCache:max-size, and then drops those that were least
+ * recently loaded. A cache may be used from multiple threads at once.
+ */
+
+#define DEFAULT_MAX_SIZE (64 * 1024 * 1024)
+
+typedef struct
+{
+  /* Our link in the LRU queue, with ourselves as the data */
+  GList            link;
+  gchar           *key;
+  MusicianGptSong *song;
+  guint64          cost;
+} CacheEntry;
+
+struct _MusicianGptSongCache
+{
+  GObject     parent_instance;
+
+  /* Protects everything below */
+  GMutex      mutex;
+
+  /* Digest to CacheEntry, and the entries from most to least recently used */
+  GHashTable *entries;
+  GQueue      lru;
+
+  guint64     max_size;
+  guint64     size;
+
+  guint64     n_hits;
+  guint64     n_misses;
+  guint64     n_evictions;
+};
+
+enum {
+  PROP_0,
+  PROP_MAX_SIZE,
+  N_PROPS
+};
+
+G_DEFINE_TYPE (MusicianGptSongCache, musician_gpt_song_cache, G_TYPE_OBJECT)
+
+static GParamSpec *properties [N_PROPS];
+
+MusicianGptSongCache *
+musician_gpt_song_cache_new (void)
+{
+  return g_object_new (MUSICIAN_TYPE_GPT_SONG_CACHE, NULL);
+}
+
+static void
+cache_entry_free (gpointer data)
+{
+  CacheEntry *entry = data;
+
+  g_clear_pointer (&entry->key, g_free);
+  g_clear_object (&entry->song);
+  g_slice_free (CacheEntry, entry);
+}
+
+/*
+ * Removes entries, least recently used first, until @max_size leaves room
+ * for @cost more bytes. The evicted songs are added to @evicted so that
+ * they can be released once the lock has been dropped.
+ */
+static void
+musician_gpt_song_cache_evict_locked (MusicianGptSongCache *self,
+                                      guint64               cost,
+                                      GPtrArray            *evicted)
+{
+  g_assert (MUSICIAN_IS_GPT_SONG_CACHE (self));
+  g_assert (evicted != NULL);
+
+  while (self->lru.tail != NULL && self->size + cost > self->max_size)
+    {
+      CacheEntry *entry = self->lru.tail->data;
+
+      g_queue_unlink (&self->lru, &entry->link);
+      self->size -= entry->cost;
+      self->n_evictions++;
+
+      g_ptr_array_add (evicted, g_steal_pointer (&entry->song));
+      g_hash_table_remove (self->entries, entry->key);
+    }
+}
+
+static void
+musician_gpt_song_cache_finalize (GObject *object)
+{
+  MusicianGptSongCache *self = (MusicianGptSongCache *)object;
+
+  g_clear_pointer (&self->entries, g_hash_table_unref);
+  g_mutex_clear (&self->mutex);
+
+  G_OBJECT_CLASS (musician_gpt_song_cache_parent_class)->finalize (object);
+}
+
+static void
+musician_gpt_song_cache_get_property (GObject    *object,
+                                      guint       prop_id,
+                                      GValue     *value,
+                                      GParamSpec *pspec)
+{
+  MusicianGptSongCache *self = MUSICIAN_GPT_SONG_CACHE (object);
+
+  switch (prop_id)
+    {
+    case PROP_MAX_SIZE:
+      g_value_set_uint64 (value, musician_gpt_song_cache_get_max_size (self));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+musician_gpt_song_cache_set_property (GObject      *object,
+                                      guint         prop_id,
+                                      const GValue *value,
+                                      GParamSpec   *pspec)
+{
+  MusicianGptSongCache *self = MUSICIAN_GPT_SONG_CACHE (object);
+
+  switch (prop_id)
+    {
+    case PROP_MAX_SIZE:
+      musician_gpt_song_cache_set_max_size (self, g_value_get_uint64 (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+musician_gpt_song_cache_class_init (MusicianGptSongCacheClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = musician_gpt_song_cache_finalize;
+  object_class->get_property = musician_gpt_song_cache_get_property;
+  object_class->set_property = musician_gpt_song_cache_set_property;
+
+  properties [PROP_MAX_SIZE] =
+    g_param_spec_uint64 ("max-size",
+                         "Max Size",
+                         "The most memory the songs in the cache may use, or 0 to keep none",
+                         0,
+                         G_MAXUINT64,
+                         DEFAULT_MAX_SIZE,
+                         (G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_properties (object_class, N_PROPS, properties);
+}
+
+static void
+musician_gpt_song_cache_init (MusicianGptSongCache *self)
+{
+  g_mutex_init (&self->mutex);
+  g_queue_init (&self->lru);
+
+  self->entries = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, cache_entry_free);
+  self->max_size = DEFAULT_MAX_SIZE;
+}
+
+guint64
+musician_gpt_song_cache_get_max_size (MusicianGptSongCache *self)
+{
+  guint64 ret;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG_CACHE (self), 0);
+
+  g_mutex_lock (&self->mutex);
+  ret = self->max_size;
+  g_mutex_unlock (&self->mutex);
+
+  return ret;
+}
+
+/**
+ * musician_gpt_song_cache_set_max_size:
+ * @self: A #MusicianGptSongCache
+ * @max_size: A number of bytes, or 0
+ *
+ * Sets the most memory that the songs in @self may use, in total. The
+ * memory of a song is counted as the size of its file plus what was
+ * allocated while decoding it. Songs are dropped, least recently loaded
+ * first, to stay below @max_size.
+ *
+ * If @max_size is 0, no songs are kept.
+ */
+void
+musician_gpt_song_cache_set_max_size (MusicianGptSongCache *self,
+                                      guint64               max_size)
+{
+  g_autoptr(GPtrArray) evicted = NULL;
+  gboolean changed;
+
+  g_return_if_fail (MUSICIAN_IS_GPT_SONG_CACHE (self));
+
+  evicted = g_ptr_array_new_with_free_func (g_object_unref);
+
+  g_mutex_lock (&self->mutex);
+  changed = self->max_size != max_size;
+  self->max_size = max_size;
+  musician_gpt_song_cache_evict_locked (self, 0, evicted);
+  g_mutex_unlock (&self->mutex);
+
+  if (changed)
+    g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_MAX_SIZE]);
+}
+
+/**
+ * musician_gpt_song_cache_get_size:
+ * @self: A #MusicianGptSongCache
+ *
+ * Returns: The memory used by the songs in @self, in bytes.
+ */
+guint64
+musician_gpt_song_cache_get_size (MusicianGptSongCache *self)
+{
+  guint64 ret;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG_CACHE (self), 0);
+
+  g_mutex_lock (&self->mutex);
+  ret = self->size;
+  g_mutex_unlock (&self->mutex);
+
+  return ret;
+}
+
+guint
+musician_gpt_song_cache_get_n_songs (MusicianGptSongCache *self)
+{
+  guint ret;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG_CACHE (self), 0);
+
+  g_mutex_lock (&self->mutex);
+  ret = self->lru.length;
+  g_mutex_unlock (&self->mutex);
+
+  return ret;
+}
+
+/**
+ * musician_gpt_song_cache_get_n_hits:
+ * @self: A #MusicianGptSongCache
+ *
+ * Returns: The number of loads that were served from @self.
+ */
+guint64
+musician_gpt_song_cache_get_n_hits (MusicianGptSongCache *self)
+{
+  guint64 ret;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG_CACHE (self), 0);
+
+  g_mutex_lock (&self->mutex);
+  ret = self->n_hits;
+  g_mutex_unlock (&self->mutex);
+
+  return ret;
+}
+
+/**
+ * musician_gpt_song_cache_get_n_misses:
+ * @self: A #MusicianGptSongCache
+ *
+ * Returns: The number of loads that had to decode their file.
+ */
+guint64
+musician_gpt_song_cache_get_n_misses (MusicianGptSongCache *self)
+{
+  guint64 ret;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG_CACHE (self), 0);
+
+  g_mutex_lock (&self->mutex);
+  ret = self->n_misses;
+  g_mutex_unlock (&self->mutex);
+
+  return ret;
+}
+
+/**
+ * musician_gpt_song_cache_get_n_evictions:
+ * @self: A #MusicianGptSongCache
+ *
+ * Returns: The number of songs that were dropped to stay within
+ *   #MusicianGptSongCache:max-size.
+ */
+guint64
+musician_gpt_song_cache_get_n_evictions (MusicianGptSongCache *self)
+{
+  guint64 ret;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG_CACHE (self), 0);
+
+  g_mutex_lock (&self->mutex);
+  ret = self->n_evictions;
+  g_mutex_unlock (&self->mutex);
+
+  return ret;
+}
+
+/**
+ * musician_gpt_song_cache_clear:
+ * @self: A #MusicianGptSongCache
+ *
+ * Drops every song from @self. This does not count as evictions, and the
+ * counters are left as they are.
+ */
+void
+musician_gpt_song_cache_clear (MusicianGptSongCache *self)
+{
+  g_autoptr(GHashTable) entries = NULL;
+
+  g_return_if_fail (MUSICIAN_IS_GPT_SONG_CACHE (self));
+
+  g_mutex_lock (&self->mutex);
+  entries = g_steal_pointer (&self->entries);
+  self->entries = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, cache_entry_free);
+  g_queue_init (&self->lru);
+  self->size = 0;
+  g_mutex_unlock (&self->mutex);
+}
+
+/*
+ * Computes the key that the song decoded from @bytes is stored under.
+ * This is a cryptographic digest since the files may come from anyone,
+ * and a collision would hand out somebody else's song.
+ */
+gchar *
+_musician_gpt_song_cache_compute_key (GBytes *bytes)
+{
+  g_assert (bytes != NULL);
+
+  return g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, bytes);
+}
+
+/*
+ * Looks up the song stored under @key, counting a hit or a miss.
+ *
+ * Returns: (transfer full) (nullable): A #MusicianGptSong or %NULL.
+ */
+MusicianGptSong *
+_musician_gpt_song_cache_lookup (MusicianGptSongCache *self,
+                                 const gchar          *key)
+{
+  MusicianGptSong *ret = NULL;
+  CacheEntry *entry;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG_CACHE (self), NULL);
+  g_return_val_if_fail (key != NULL, NULL);
+
+  g_mutex_lock (&self->mutex);
+
+  if (NULL != (entry = g_hash_table_lookup (self->entries, key)))
+    {
+      g_queue_unlink (&self->lru, &entry->link);
+      g_queue_push_head_link (&self->lru, &entry->link);
+      ret = g_object_ref (entry->song);
+      self->n_hits++;
+    }
+  else
+    self->n_misses++;
+
+  g_mutex_unlock (&self->mutex);
+
+  return ret;
+}
+
+/*
+ * Stores @song under @key, charging @cost bytes for it. If another thread
+ * got there first, the song it stored is returned instead of @song, so
+ * that everyone ends up sharing a single song.
+ *
+ * Returns: (transfer full): A #MusicianGptSong.
+ */
+MusicianGptSong *
+_musician_gpt_song_cache_insert (MusicianGptSongCache *self,
+                                 const gchar          *key,
+                                 MusicianGptSong      *song,
+                                 guint64               cost)
+{
+  g_autoptr(GPtrArray) evicted = NULL;
+  MusicianGptSong *ret;
+  CacheEntry *entry;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG_CACHE (self), NULL);
+  g_return_val_if_fail (key != NULL, NULL);
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (song), NULL);
+
+  evicted = g_ptr_array_new_with_free_func (g_object_unref);
+
+  g_mutex_lock (&self->mutex);
+
+  if (NULL != (entry = g_hash_table_lookup (self->entries, key)))
+    {
+      ret = g_object_ref (entry->song);
+    }
+  else
+    {
+      ret = g_object_ref (song);
+
+      /* Songs larger than the whole cache are not worth evicting everything for */
+      if (cost <= self->max_size)
+        {
+          musician_gpt_song_cache_evict_locked (self, cost, evicted);
+
+          /* Other threads may get hold of @song as soon as it is in the table */
+          _musician_gpt_song_set_read_only (song);
+
+          entry = g_slice_new0 (CacheEntry);
+          entry->link.data = entry;
+          entry->key = g_strdup (key);
+          entry->song = g_object_ref (song);
+          entry->cost = cost;
+
+          g_hash_table_insert (self->entries, entry->key, entry);
+          g_queue_push_head_link (&self->lru, &entry->link);
+          self->size += cost;
+        }
+    }
+
+  g_mutex_unlock (&self->mutex);
+
+  return ret;
+}
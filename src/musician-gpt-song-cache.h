@@ -0,0 +1,45 @@
+/* musician-gpt-song-cache.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_SONG_CACHE_H
+#define MUSICIAN_GPT_SONG_CACHE_H
+
+#include <gio/gio.h>
+
+#include "musician-gpt-types.h"
+
+G_BEGIN_DECLS
+
+#define MUSICIAN_TYPE_GPT_SONG_CACHE (musician_gpt_song_cache_get_type())
+
+G_DECLARE_FINAL_TYPE (MusicianGptSongCache, musician_gpt_song_cache, MUSICIAN, GPT_SONG_CACHE, GObject)
+
+MusicianGptSongCache *musician_gpt_song_cache_new             (void);
+guint64               musician_gpt_song_cache_get_max_size    (MusicianGptSongCache *self);
+void                  musician_gpt_song_cache_set_max_size    (MusicianGptSongCache *self,
+                                                               guint64               max_size);
+guint64               musician_gpt_song_cache_get_size        (MusicianGptSongCache *self);
+guint                 musician_gpt_song_cache_get_n_songs     (MusicianGptSongCache *self);
+guint64               musician_gpt_song_cache_get_n_hits      (MusicianGptSongCache *self);
+guint64               musician_gpt_song_cache_get_n_misses    (MusicianGptSongCache *self);
+guint64               musician_gpt_song_cache_get_n_evictions (MusicianGptSongCache *self);
+void                  musician_gpt_song_cache_clear           (MusicianGptSongCache *self);
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_SONG_CACHE_H */
@@ -0,0 +1,37 @@
+/* musician-gpt-song-list-private.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_SONG_LIST_PRIVATE_H
+#define MUSICIAN_GPT_SONG_LIST_PRIVATE_H
+
+#include "musician-gpt-song.h"
+#include "musician-gpt-song-list.h"
+
+G_BEGIN_DECLS
+
+MusicianGptSongList *_musician_gpt_song_list_new           (MusicianGptSong     *song,
+                                                            GType                item_type,
+                                                            GPtrArray           *items);
+void                 _musician_gpt_song_list_items_changed (MusicianGptSongList *self,
+                                                            guint                position,
+                                                            guint                removed,
+                                                            guint                added);
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_SONG_LIST_PRIVATE_H */
@@ -0,0 +1,141 @@
+/* musician-gpt-song-list.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "musician-gpt-song-list"
+
+#include "musician-gpt-song-list.h"
+#include "musician-gpt-song-list-private.h"
+
+/**
+ * SECTION:musician-gpt-song-list
+ * @title: #MusicianGptSongList
+ * @short_description: A #GListModel of the measures, tracks or lyrics of a song
+ *
+ * #MusicianGptSongList is what musician_gpt_song_list_measures(),
+ * musician_gpt_song_list_tracks() and musician_gpt_song_list_lyrics()
+ * return. It reads straight from the song, so nothing is copied when it
+ * is created and each item is only touched when it is asked for, which
+ * suits widgets that only look at the rows they show.
+ *
+ * Adding or removing a measure or a track emits #GListModel::items-changed
+ * for just the position that changed.
+ */
+
+struct _MusicianGptSongList
+{
+  GObject          parent_instance;
+
+  /* We keep the song, and with it @items, alive */
+  MusicianGptSong *song;
+  GPtrArray       *items;
+  GType            item_type;
+};
+
+static GType
+musician_gpt_song_list_get_item_type (GListModel *model)
+{
+  return MUSICIAN_GPT_SONG_LIST (model)->item_type;
+}
+
+static guint
+musician_gpt_song_list_get_n_items (GListModel *model)
+{
+  return MUSICIAN_GPT_SONG_LIST (model)->items->len;
+}
+
+static gpointer
+musician_gpt_song_list_get_item (GListModel *model,
+                                 guint       position)
+{
+  MusicianGptSongList *self = MUSICIAN_GPT_SONG_LIST (model);
+
+  if (position >= self->items->len)
+    return NULL;
+
+  return g_object_ref (g_ptr_array_index (self->items, position));
+}
+
+static void
+list_model_iface_init (GListModelInterface *iface)
+{
+  iface->get_item_type = musician_gpt_song_list_get_item_type;
+  iface->get_n_items = musician_gpt_song_list_get_n_items;
+  iface->get_item = musician_gpt_song_list_get_item;
+}
+
+G_DEFINE_TYPE_WITH_CODE (MusicianGptSongList, musician_gpt_song_list, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, list_model_iface_init))
+
+static void
+musician_gpt_song_list_finalize (GObject *object)
+{
+  MusicianGptSongList *self = (MusicianGptSongList *)object;
+
+  self->items = NULL;
+  g_clear_object (&self->song);
+
+  G_OBJECT_CLASS (musician_gpt_song_list_parent_class)->finalize (object);
+}
+
+static void
+musician_gpt_song_list_class_init (MusicianGptSongListClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = musician_gpt_song_list_finalize;
+}
+
+static void
+musician_gpt_song_list_init (MusicianGptSongList *self)
+{
+}
+
+/*
+ * Creates a list of the @item_type objects in @items, which is owned by
+ * @song. The song must call _musician_gpt_song_list_items_changed()
+ * whenever it changes @items.
+ */
+MusicianGptSongList *
+_musician_gpt_song_list_new (MusicianGptSong *song,
+                             GType            item_type,
+                             GPtrArray       *items)
+{
+  MusicianGptSongList *self;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (song), NULL);
+  g_return_val_if_fail (g_type_is_a (item_type, G_TYPE_OBJECT), NULL);
+  g_return_val_if_fail (items != NULL, NULL);
+
+  self = g_object_new (MUSICIAN_TYPE_GPT_SONG_LIST, NULL);
+  self->song = g_object_ref (song);
+  self->item_type = item_type;
+  self->items = items;
+
+  return self;
+}
+
+void
+_musician_gpt_song_list_items_changed (MusicianGptSongList *self,
+                                       guint                position,
+                                       guint                removed,
+                                       guint                added)
+{
+  g_return_if_fail (MUSICIAN_IS_GPT_SONG_LIST (self));
+
+  g_list_model_items_changed (G_LIST_MODEL (self), position, removed, added);
+}
@@ -19,18 +19,78 @@
 #ifndef MUSICIAN_GPT_SONG_PRIVATE_H
 #define MUSICIAN_GPT_SONG_PRIVATE_H
 
+#include "musician-gpt-arena.h"
+#include "musician-gpt-beat-store.h"
+#include "musician-gpt-intern-table.h"
+#include "musician-gpt-pool.h"
 #include "musician-gpt-song.h"
 
 G_BEGIN_DECLS
 
-void _musician_gpt_song_set_midi_ports (MusicianGptSong           *self,
-                                        const MusicianGptMidiPort *ports,
-                                        gsize                      n_ports);
-void _musician_gpt_song_add_lyrics     (MusicianGptSong           *self,
-                                        guint                      position,
-                                        const gchar               *lyrics);
-void _musician_gpt_song_set_version    (MusicianGptSong           *self,
-                                        const gchar               *version);
+/*
+ * The song header, so that parsers can fill it in with one call to
+ * _musician_gpt_song_set_info() rather than setting (and notifying) each
+ * property in turn.
+ */
+typedef struct
+{
+  const gchar            *title;
+  const gchar            *subtitle;
+  const gchar            *interpretation;
+  const gchar            *album;
+  const gchar            *artist;
+  const gchar            *copyright;
+  const gchar            *writer;
+  const gchar            *instructions;
+  MusicianGptTripletFeel  triplet_feel;
+  guint                   tempo;
+  MusicianGptKey          key;
+  MusicianGptOctave       octave;
+} MusicianGptSongInfo;
+
+/*
+ * Decodes the beats of the @measure/@track block on demand for songs that
+ * were loaded lazily, appending them to @store. The song has already begun
+ * @measure in @store, and drops whatever was appended if this fails.
+ */
+typedef gboolean (*MusicianGptSongBlockFunc) (guint                  measure,
+                                              guint                  track,
+                                              MusicianGptBeatStore  *store,
+                                              gpointer               user_data,
+                                              GCancellable          *cancellable,
+                                              GError               **error);
+
+void                       _musician_gpt_song_set_info         (MusicianGptSong           *self,
+                                                                const MusicianGptSongInfo *info);
+void                       _musician_gpt_song_set_midi_ports   (MusicianGptSong           *self,
+                                                                const MusicianGptMidiPort *ports,
+                                                                gsize                      n_ports);
+const MusicianGptMidiPort *_musician_gpt_song_get_midi_ports   (MusicianGptSong           *self,
+                                                                gsize                     *n_ports);
+void                       _musician_gpt_song_add_lyrics       (MusicianGptSong           *self,
+                                                                guint                      position,
+                                                                const gchar               *lyrics);
+GPtrArray                 *_musician_gpt_song_get_lyrics       (MusicianGptSong           *self);
+GPtrArray                 *_musician_gpt_song_get_tracks       (MusicianGptSong           *self);
+void                       _musician_gpt_song_set_version      (MusicianGptSong           *self,
+                                                                const gchar               *version);
+void                       _musician_gpt_song_set_arena        (MusicianGptSong           *self,
+                                                                MusicianGptArena          *arena);
+void                       _musician_gpt_song_set_block_layout (MusicianGptSong           *self,
+                                                                guint                      n_measures,
+                                                                guint                      n_tracks);
+MusicianGptPool           *_musician_gpt_song_get_pool         (MusicianGptSong           *self);
+MusicianGptInternTable    *_musician_gpt_song_get_intern_table (MusicianGptSong           *self);
+void                       _musician_gpt_song_get_block_layout (MusicianGptSong           *self,
+                                                                guint                     *n_measures,
+                                                                guint                     *n_tracks);
+MusicianGptBeatStore      *_musician_gpt_song_get_store        (MusicianGptSong           *self,
+                                                                guint                      track);
+void                       _musician_gpt_song_set_block_func   (MusicianGptSong           *self,
+                                                                MusicianGptSongBlockFunc   func,
+                                                                gpointer                   user_data,
+                                                                GDestroyNotify             destroy);
+void                       _musician_gpt_song_set_read_only    (MusicianGptSong           *self);
 
 G_END_DECLS
 
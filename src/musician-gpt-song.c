@@ -18,13 +18,33 @@
 
 #define G_LOG_DOMAIN "musician-gpt-song"
 
+#include "musician-gpt-beat.h"
+#include "musician-gpt-beat-private.h"
+#include "musician-gpt-beat-store.h"
+#include "musician-gpt-beat-store-private.h"
+#include "musician-gpt-frozen-song-private.h"
 #include "musician-gpt-lyrics.h"
+#include "musician-gpt-lyrics-private.h"
 #include "musician-gpt-measure.h"
+#include "musician-gpt-snapshot.h"
 #include "musician-gpt-song.h"
+#include "musician-gpt-song-private.h"
+#include "musician-gpt-song-list.h"
+#include "musician-gpt-song-list-private.h"
+#include "musician-gpt-timeline.h"
+#include "musician-gpt-timeline-private.h"
 #include "musician-gpt-track.h"
 
 typedef struct
 {
+  MusicianGptArena *arena;
+
+  /* Beats, bends and chords of the song are allocated from here */
+  MusicianGptPool *pool;
+
+  /* The chords and bends of every track, shared by each beat using them */
+  MusicianGptInternTable *intern_table;
+
   gchar *album;
   gchar *artist;
   gchar *copyright;
@@ -37,10 +57,25 @@ typedef struct
 
   gchar **comments;
 
-  GSequence *measures;
+  /*
+   * Sorted by id. Measures are normally numbered from 1 without gaps, in
+   * which case measure N is found at index N - 1.
+   */
+  GPtrArray *measures;
   GPtrArray *tracks;
   GPtrArray *lyrics;
 
+  /*
+   * Weak references to the lists handed out for the arrays above, which
+   * are told about every change so they can emit items-changed. Songs from
+   * a #MusicianGptSongCache are shared between threads, so the lists are
+   * created with @mutex held and only ever looked at through a strong
+   * reference.
+   */
+  GWeakRef measures_list;
+  GWeakRef tracks_list;
+  GWeakRef lyrics_list;
+
   MusicianGptTripletFeel triplet_feel;
   MusicianGptKey key;
   MusicianGptOctave octave;
@@ -48,6 +83,30 @@ typedef struct
 
   GArray *ports;
 
+  /*
+   * The #MusicianGptBeatStore of each track of the block layout, in order.
+   * Lazily loaded songs fill these in from @block_func as measures are
+   * requested.
+   */
+  GPtrArray                *stores;
+  guint                     n_block_measures;
+  guint                     n_block_tracks;
+  MusicianGptSongBlockFunc  block_func;
+  gpointer                  block_data;
+  GDestroyNotify            block_data_destroy;
+
+  /*
+   * The #MusicianGptTimeline of each track, built when first requested.
+   * Once any is, the time signatures of the measures are watched so the
+   * timelines can be told about changes.
+   */
+  GPtrArray                *timelines;
+
+  /* Protects creating the lists and @timelines above */
+  GMutex                    mutex;
+
+  /* Set for songs shared through a #MusicianGptSongCache */
+  guint                     read_only : 1;
 } MusicianGptSongPrivate;
 
 enum {
@@ -72,26 +131,53 @@ G_DEFINE_TYPE_WITH_PRIVATE (MusicianGptSong, musician_gpt_song, G_TYPE_OBJECT)
 
 static GParamSpec *properties [N_PROPS];
 
+static void musician_gpt_song_measure_notify (MusicianGptMeasure *measure,
+                                              GParamSpec         *pspec,
+                                              MusicianGptSong    *self);
+
 static void
 musician_gpt_song_finalize (GObject *object)
 {
   MusicianGptSong *self = (MusicianGptSong *)object;
   MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
 
-  g_clear_pointer (&priv->album, g_free);
-  g_clear_pointer (&priv->artist, g_free);
-  g_clear_pointer (&priv->copyright, g_free);
-  g_clear_pointer (&priv->interpretation, g_free);
-  g_clear_pointer (&priv->instructions, g_free);
+  /* Measures may outlive us, so stop watching them */
+  if (priv->timelines != NULL)
+    {
+      for (guint i = 0; i < priv->measures->len; i++)
+        g_signal_handlers_disconnect_by_func (g_ptr_array_index (priv->measures, i),
+                                              musician_gpt_song_measure_notify,
+                                              self);
+    }
+
+  musician_gpt_arena_free_string (priv->arena, priv->album);
+  musician_gpt_arena_free_string (priv->arena, priv->artist);
+  musician_gpt_arena_free_string (priv->arena, priv->copyright);
+  musician_gpt_arena_free_string (priv->arena, priv->interpretation);
+  musician_gpt_arena_free_string (priv->arena, priv->instructions);
   g_clear_pointer (&priv->ports, g_array_unref);
-  g_clear_pointer (&priv->subtitle, g_free);
-  g_clear_pointer (&priv->title, g_free);
-  g_clear_pointer (&priv->version, g_free);
-  g_clear_pointer (&priv->writer, g_free);
+  musician_gpt_arena_free_string (priv->arena, priv->subtitle);
+  musician_gpt_arena_free_string (priv->arena, priv->title);
+  musician_gpt_arena_free_string (priv->arena, priv->version);
+  musician_gpt_arena_free_string (priv->arena, priv->writer);
 
   g_clear_pointer (&priv->lyrics, g_ptr_array_free);
-  g_clear_pointer (&priv->measures, g_sequence_free);
+  g_clear_pointer (&priv->measures, g_ptr_array_unref);
   g_clear_pointer (&priv->tracks, g_ptr_array_unref);
+  g_clear_pointer (&priv->stores, g_ptr_array_unref);
+  g_clear_pointer (&priv->timelines, g_ptr_array_unref);
+
+  if (priv->block_data_destroy != NULL)
+    g_clear_pointer (&priv->block_data, priv->block_data_destroy);
+
+  g_clear_pointer (&priv->arena, musician_gpt_arena_unref);
+  g_clear_pointer (&priv->intern_table, musician_gpt_intern_table_unref);
+  g_clear_pointer (&priv->pool, musician_gpt_pool_unref);
+
+  g_weak_ref_clear (&priv->measures_list);
+  g_weak_ref_clear (&priv->tracks_list);
+  g_weak_ref_clear (&priv->lyrics_list);
+  g_mutex_clear (&priv->mutex);
 
   G_OBJECT_CLASS (musician_gpt_song_parent_class)->finalize (object);
 }
@@ -340,10 +426,18 @@ musician_gpt_song_init (MusicianGptSong *self)
 {
   MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
 
-  priv->measures = g_sequence_new (g_object_unref);
+  priv->measures = g_ptr_array_new_with_free_func (g_object_unref);
   priv->ports = g_array_new (FALSE, FALSE, sizeof (MusicianGptMidiPort));
   priv->tracks = g_ptr_array_new_with_free_func (g_object_unref);
   priv->lyrics = g_ptr_array_new_with_free_func (g_object_unref);
+  priv->stores = g_ptr_array_new_with_free_func ((GDestroyNotify)musician_gpt_beat_store_unref);
+  priv->pool = musician_gpt_pool_new ();
+  priv->intern_table = musician_gpt_intern_table_new (priv->pool);
+
+  g_mutex_init (&priv->mutex);
+  g_weak_ref_init (&priv->measures_list, NULL);
+  g_weak_ref_init (&priv->tracks_list, NULL);
+  g_weak_ref_init (&priv->lyrics_list, NULL);
 }
 
 MusicianGptSong *
@@ -362,8 +456,8 @@ _musician_gpt_song_set_version (MusicianGptSong *self,
 
   if (version != priv->version)
     {
-      g_free (priv->version);
-      priv->version = g_strdup (version);
+      musician_gpt_arena_free_string (priv->arena, priv->version);
+      priv->version = musician_gpt_arena_dup_string (priv->arena, version);
       g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_VERSION]);
     }
 }
@@ -475,11 +569,12 @@ musician_gpt_song_set_album (MusicianGptSong *self,
   MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
 
   g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (!priv->read_only);
 
   if (album != priv->album)
     {
-      g_free (priv->album);
-      priv->album = g_strdup (album);
+      musician_gpt_arena_free_string (priv->arena, priv->album);
+      priv->album = musician_gpt_arena_dup_string (priv->arena, album);
       g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_ALBUM]);
     }
 }
@@ -491,11 +586,12 @@ musician_gpt_song_set_artist (MusicianGptSong *self,
   MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
 
   g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (!priv->read_only);
 
   if (artist != priv->artist)
     {
-      g_free (priv->artist);
-      priv->artist = g_strdup (artist);
+      musician_gpt_arena_free_string (priv->arena, priv->artist);
+      priv->artist = musician_gpt_arena_dup_string (priv->arena, artist);
       g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_ARTIST]);
     }
 }
@@ -507,11 +603,12 @@ musician_gpt_song_set_copyright (MusicianGptSong *self,
   MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
 
   g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (!priv->read_only);
 
   if (copyright != priv->copyright)
     {
-      g_free (priv->copyright);
-      priv->copyright = g_strdup (copyright);
+      musician_gpt_arena_free_string (priv->arena, priv->copyright);
+      priv->copyright = musician_gpt_arena_dup_string (priv->arena, copyright);
       g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_COPYRIGHT]);
     }
 }
@@ -523,11 +620,12 @@ musician_gpt_song_set_instructions (MusicianGptSong *self,
   MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
 
   g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (!priv->read_only);
 
   if (instructions != priv->instructions)
     {
-      g_free (priv->instructions);
-      priv->instructions = g_strdup (instructions);
+      musician_gpt_arena_free_string (priv->arena, priv->instructions);
+      priv->instructions = musician_gpt_arena_dup_string (priv->arena, instructions);
       g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_INSTRUCTIONS]);
     }
 }
@@ -539,11 +637,12 @@ musician_gpt_song_set_interpretation (MusicianGptSong *self,
   MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
 
   g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (!priv->read_only);
 
   if (interpretation != priv->interpretation)
     {
-      g_free (priv->interpretation);
-      priv->interpretation = g_strdup (interpretation);
+      musician_gpt_arena_free_string (priv->arena, priv->interpretation);
+      priv->interpretation = musician_gpt_arena_dup_string (priv->arena, interpretation);
       g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_INTERPRETATION]);
     }
 }
@@ -555,11 +654,12 @@ musician_gpt_song_set_subtitle (MusicianGptSong *self,
   MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
 
   g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (!priv->read_only);
 
   if (subtitle != priv->subtitle)
     {
-      g_free (priv->subtitle);
-      priv->subtitle = g_strdup (subtitle);
+      musician_gpt_arena_free_string (priv->arena, priv->subtitle);
+      priv->subtitle = musician_gpt_arena_dup_string (priv->arena, subtitle);
       g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_SUBTITLE]);
     }
 }
@@ -571,11 +671,12 @@ musician_gpt_song_set_title (MusicianGptSong *self,
   MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
 
   g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (!priv->read_only);
 
   if (title != priv->title)
     {
-      g_free (priv->title);
-      priv->title = g_strdup (title);
+      musician_gpt_arena_free_string (priv->arena, priv->title);
+      priv->title = musician_gpt_arena_dup_string (priv->arena, title);
       g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_TITLE]);
     }
 }
@@ -587,6 +688,7 @@ musician_gpt_song_set_triplet_feel (MusicianGptSong        *self,
   MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
 
   g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (!priv->read_only);
 
   if (triplet_feel != priv->triplet_feel)
     {
@@ -602,15 +704,29 @@ musician_gpt_song_set_writer (MusicianGptSong *self,
   MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
 
   g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (!priv->read_only);
 
   if (writer != priv->writer)
     {
-      g_free (priv->writer);
-      priv->writer = g_strdup (writer);
+      musician_gpt_arena_free_string (priv->arena, priv->writer);
+      priv->writer = musician_gpt_arena_dup_string (priv->arena, writer);
       g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_WRITER]);
     }
 }
 
+/* Tells @list, if anyone is holding on to it, about a change to its items */
+static void
+musician_gpt_song_items_changed (GWeakRef *list_ref,
+                                 guint     position,
+                                 guint     removed,
+                                 guint     added)
+{
+  g_autoptr(MusicianGptSongList) list = g_weak_ref_get (list_ref);
+
+  if (list != NULL)
+    _musician_gpt_song_list_items_changed (list, position, removed, added);
+}
+
 void
 _musician_gpt_song_add_lyrics (MusicianGptSong *self,
                                guint            position,
@@ -618,13 +734,17 @@ _musician_gpt_song_add_lyrics (MusicianGptSong *self,
 {
   MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
 
+  MusicianGptLyrics *item;
+
   g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
 
-  g_ptr_array_add (priv->lyrics,
-                   g_object_new (MUSICIAN_TYPE_GPT_LYRICS,
-                                 "text", lyrics,
-                                 "position", position,
-                                 NULL));
+  item = musician_gpt_lyrics_new ();
+  _musician_gpt_lyrics_set_arena (item, priv->arena);
+  musician_gpt_lyrics_set_position (item, position);
+  musician_gpt_lyrics_set_text (item, lyrics);
+
+  g_ptr_array_add (priv->lyrics, item);
+  musician_gpt_song_items_changed (&priv->lyrics_list, priv->lyrics->len - 1, 0, 1);
 }
 
 guint
@@ -644,10 +764,23 @@ musician_gpt_song_set_tempo (MusicianGptSong *self,
   MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
 
   g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (!priv->read_only);
 
   if (tempo != priv->tempo)
     {
       priv->tempo = tempo;
+
+      if (priv->timelines != NULL)
+        {
+          for (guint i = 0; i < priv->timelines->len; i++)
+            {
+              MusicianGptTimeline *timeline = g_ptr_array_index (priv->timelines, i);
+
+              if (timeline != NULL)
+                _musician_gpt_timeline_set_tempo (timeline, tempo);
+            }
+        }
+
       g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_TEMPO]);
     }
 }
@@ -669,6 +802,7 @@ musician_gpt_song_set_key (MusicianGptSong *self,
   MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
 
   g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (!priv->read_only);
 
   if (priv->key != key)
     {
@@ -684,7 +818,7 @@ musician_gpt_song_get_octave (MusicianGptSong *self)
 
   g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (self), 0);
 
-  return priv->key;
+  return priv->octave;
 }
 
 void
@@ -694,6 +828,7 @@ musician_gpt_song_set_octave (MusicianGptSong   *self,
   MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
 
   g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (!priv->read_only);
 
   if (priv->octave != octave)
     {
@@ -702,6 +837,43 @@ musician_gpt_song_set_octave (MusicianGptSong   *self,
     }
 }
 
+/*
+ * Sets every field of the song header from @info at once, without emitting
+ * any notifications. This is meant for parsers filling in a song that
+ * nobody has seen yet.
+ */
+void
+_musician_gpt_song_set_info (MusicianGptSong           *self,
+                             const MusicianGptSongInfo *info)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (info != NULL);
+
+#define SET_STRING(field)                                                   \
+  G_STMT_START {                                                            \
+    musician_gpt_arena_free_string (priv->arena, priv->field);              \
+    priv->field = musician_gpt_arena_dup_string (priv->arena, info->field); \
+  } G_STMT_END
+
+  SET_STRING (title);
+  SET_STRING (subtitle);
+  SET_STRING (interpretation);
+  SET_STRING (album);
+  SET_STRING (artist);
+  SET_STRING (copyright);
+  SET_STRING (writer);
+  SET_STRING (instructions);
+
+#undef SET_STRING
+
+  priv->triplet_feel = info->triplet_feel;
+  priv->tempo = info->tempo;
+  priv->key = info->key;
+  priv->octave = info->octave;
+}
+
 void
 _musician_gpt_song_set_midi_ports (MusicianGptSong           *self,
                                    const MusicianGptMidiPort *ports,
@@ -723,9 +895,11 @@ musician_gpt_song_add_track (MusicianGptSong  *self,
   MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
 
   g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (!priv->read_only);
   g_return_if_fail (MUSICIAN_IS_GPT_TRACK (track));
 
   g_ptr_array_add (priv->tracks, g_object_ref (track));
+  musician_gpt_song_items_changed (&priv->tracks_list, priv->tracks->len - 1, 0, 1);
 }
 
 void
@@ -735,9 +909,116 @@ musician_gpt_song_remove_track (MusicianGptSong  *self,
   MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
 
   g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (!priv->read_only);
   g_return_if_fail (MUSICIAN_IS_GPT_TRACK (track));
 
-  g_ptr_array_remove (priv->tracks, track);
+  for (guint i = 0; i < priv->tracks->len; i++)
+    {
+      if (g_ptr_array_index (priv->tracks, i) == (gpointer)track)
+        {
+          g_ptr_array_remove_index (priv->tracks, i);
+          musician_gpt_song_items_changed (&priv->tracks_list, i, 1, 0);
+          break;
+        }
+    }
+}
+
+/*
+ * Finds the index of the first measure whose id is not less than @id, which
+ * is where a measure numbered @id belongs.
+ */
+static guint
+musician_gpt_song_find_measure (MusicianGptSong *self,
+                                guint            id)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+  guint lo = 0;
+  guint hi = priv->measures->len;
+
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (musician_gpt_measure_get_id (g_ptr_array_index (priv->measures, mid)) < id)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+/*
+ * Gets the length of the measure numbered @id from its time signature, in
+ * ticks, or 0 if there is no such measure or it has no time signature.
+ */
+static guint
+musician_gpt_song_get_measure_length (MusicianGptSong *self,
+                                      guint            id)
+{
+  MusicianGptMeasure *measure;
+  guint numerator;
+  guint denominator;
+
+  g_assert (MUSICIAN_IS_GPT_SONG (self));
+
+  if (NULL == (measure = musician_gpt_song_get_measure (self, id)))
+    return 0;
+
+  numerator = musician_gpt_measure_get_numerator (measure);
+  denominator = musician_gpt_measure_get_denominator (measure);
+
+  if (numerator == 0 || denominator == 0)
+    return 0;
+
+  return numerator * MUSICIAN_GPT_TICKS_PER_QUARTER * 4 / denominator;
+}
+
+/* Tells the timelines of @self that the measure numbered @id has changed */
+static void
+musician_gpt_song_measure_changed (MusicianGptSong *self,
+                                   guint            id)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+  guint length;
+
+  g_assert (MUSICIAN_IS_GPT_SONG (self));
+
+  if (priv->timelines == NULL || id == 0 || id > priv->n_block_measures)
+    return;
+
+  length = musician_gpt_song_get_measure_length (self, id);
+
+  for (guint i = 0; i < priv->timelines->len; i++)
+    {
+      MusicianGptTimeline *timeline = g_ptr_array_index (priv->timelines, i);
+
+      if (timeline != NULL)
+        _musician_gpt_timeline_set_measure_length (timeline, id, length);
+    }
+}
+
+static void
+musician_gpt_song_measure_notify (MusicianGptMeasure *measure,
+                                  GParamSpec         *pspec,
+                                  MusicianGptSong    *self)
+{
+  g_assert (MUSICIAN_IS_GPT_MEASURE (measure));
+  g_assert (MUSICIAN_IS_GPT_SONG (self));
+
+  if (g_strcmp0 (pspec->name, "numerator") == 0 ||
+      g_strcmp0 (pspec->name, "denominator") == 0)
+    musician_gpt_song_measure_changed (self, musician_gpt_measure_get_id (measure));
+}
+
+static void
+musician_gpt_song_watch_measure (MusicianGptSong    *self,
+                                 MusicianGptMeasure *measure)
+{
+  g_signal_connect (measure,
+                    "notify",
+                    G_CALLBACK (musician_gpt_song_measure_notify),
+                    self);
 }
 
 void
@@ -745,14 +1026,34 @@ musician_gpt_song_add_measure (MusicianGptSong    *self,
                                MusicianGptMeasure *measure)
 {
   MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+  guint id;
+  guint index;
 
   g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (!priv->read_only);
   g_return_if_fail (MUSICIAN_IS_GPT_MEASURE (measure));
 
-  g_sequence_insert_sorted (priv->measures,
-                            g_object_ref (measure),
-                            (GCompareDataFunc)musician_gpt_measure_compare,
-                            NULL);
+  id = musician_gpt_measure_get_id (measure);
+
+  /* Nothing is watched until someone asks for a timeline */
+  if (priv->timelines != NULL)
+    musician_gpt_song_watch_measure (self, measure);
+
+  /* Parsers add measures in order, so this is almost always an append */
+  if (priv->measures->len == 0 ||
+      musician_gpt_measure_get_id (g_ptr_array_index (priv->measures, priv->measures->len - 1)) <= id)
+    {
+      g_ptr_array_add (priv->measures, g_object_ref (measure));
+      musician_gpt_song_items_changed (&priv->measures_list, priv->measures->len - 1, 0, 1);
+      musician_gpt_song_measure_changed (self, id);
+      return;
+    }
+
+  /* Measures with the same id keep the order they were added in */
+  index = musician_gpt_song_find_measure (self, id + 1);
+  g_ptr_array_insert (priv->measures, index, g_object_ref (measure));
+  musician_gpt_song_items_changed (&priv->measures_list, index, 0, 1);
+  musician_gpt_song_measure_changed (self, id);
 }
 
 void
@@ -760,17 +1061,129 @@ musician_gpt_song_remove_measure (MusicianGptSong    *self,
                                   MusicianGptMeasure *measure)
 {
   MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
-  GSequenceIter *iter;
+  guint id;
+  guint index;
 
   g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (!priv->read_only);
   g_return_if_fail (MUSICIAN_IS_GPT_MEASURE (measure));
 
-  iter = g_sequence_lookup (priv->measures,
-                            measure,
-                            (GCompareDataFunc)musician_gpt_measure_compare,
-                            NULL);
-  if (iter != NULL)
-    g_sequence_remove (iter);
+  id = musician_gpt_measure_get_id (measure);
+  index = musician_gpt_song_find_measure (self, id);
+
+  if (index < priv->measures->len &&
+      musician_gpt_measure_get_id (g_ptr_array_index (priv->measures, index)) == id)
+    {
+      if (priv->timelines != NULL)
+        g_signal_handlers_disconnect_by_func (g_ptr_array_index (priv->measures, index),
+                                              musician_gpt_song_measure_notify,
+                                              self);
+
+      g_ptr_array_remove_index (priv->measures, index);
+      musician_gpt_song_items_changed (&priv->measures_list, index, 1, 0);
+      musician_gpt_song_measure_changed (self, id);
+    }
+}
+
+/**
+ * musician_gpt_song_get_measure:
+ * @self: A #MusicianGptSong
+ * @id: The id of the measure, starting from 1
+ *
+ * Gets the measure numbered @id.
+ *
+ * Returns: (transfer none) (nullable): A #MusicianGptMeasure or %NULL.
+ */
+MusicianGptMeasure *
+musician_gpt_song_get_measure (MusicianGptSong *self,
+                               guint            id)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+  MusicianGptMeasure *measure;
+  guint index;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (self), NULL);
+
+  if (id > 0 && id <= priv->measures->len)
+    {
+      measure = g_ptr_array_index (priv->measures, id - 1);
+      if (musician_gpt_measure_get_id (measure) == id)
+        return measure;
+    }
+
+  index = musician_gpt_song_find_measure (self, id);
+
+  if (index < priv->measures->len)
+    {
+      measure = g_ptr_array_index (priv->measures, index);
+      if (musician_gpt_measure_get_id (measure) == id)
+        return measure;
+    }
+
+  return NULL;
+}
+
+/**
+ * musician_gpt_song_get_measures:
+ * @self: A #MusicianGptSong
+ * @n_measures: (out): A location for the number of measures
+ *
+ * Gets the measures of @self, sorted by id. The array is owned by @self
+ * and must not be modified. It is only valid until measures are added or
+ * removed.
+ *
+ * Returns: (transfer none) (array length=n_measures): The measures.
+ */
+MusicianGptMeasure **
+musician_gpt_song_get_measures (MusicianGptSong *self,
+                                guint           *n_measures)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (self), NULL);
+  g_return_val_if_fail (n_measures != NULL, NULL);
+
+  *n_measures = priv->measures->len;
+
+  return (MusicianGptMeasure **)priv->measures->pdata;
+}
+
+/*
+ * The following give the snapshot writer access to the song's contents,
+ * which are not otherwise exposed. The results are owned by @self.
+ */
+GPtrArray *
+_musician_gpt_song_get_tracks (MusicianGptSong *self)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (self), NULL);
+
+  return priv->tracks;
+}
+
+GPtrArray *
+_musician_gpt_song_get_lyrics (MusicianGptSong *self)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (self), NULL);
+
+  return priv->lyrics;
+}
+
+const MusicianGptMidiPort *
+_musician_gpt_song_get_midi_ports (MusicianGptSong *self,
+                                   gsize           *n_ports)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (self), NULL);
+  g_return_val_if_fail (n_ports != NULL, NULL);
+
+  *n_ports = priv->ports->len;
+
+  return (const MusicianGptMidiPort *)(gpointer)priv->ports->data;
 }
 
 guint
@@ -780,7 +1193,7 @@ musician_gpt_song_get_n_measures (MusicianGptSong *self)
 
   g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (self), 0);
 
-  return g_sequence_get_length (priv->measures);
+  return priv->measures->len;
 }
 
 guint
@@ -792,3 +1205,500 @@ musician_gpt_song_get_n_tracks (MusicianGptSong *self)
 
   return priv->tracks->len;
 }
+
+/**
+ * musician_gpt_song_get_read_only:
+ * @self: A #MusicianGptSong
+ *
+ * Checks whether @self may be modified. Songs loaded through a
+ * #MusicianGptSongCache are shared by everyone who loaded the same file,
+ * possibly on other threads, and are read-only along with their tracks and
+ * measures. Use musician_gpt_song_freeze() or load without a cache to get
+ * a song of your own.
+ *
+ * Returns: %TRUE if @self must not be modified.
+ */
+gboolean
+musician_gpt_song_get_read_only (MusicianGptSong *self)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (self), FALSE);
+
+  return priv->read_only;
+}
+
+/*
+ * Marks @self as shared, after which the setters refuse to change it. This
+ * must happen before @self is handed to another thread.
+ */
+void
+_musician_gpt_song_set_read_only (MusicianGptSong *self)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+
+  priv->read_only = TRUE;
+}
+
+static GListModel *
+musician_gpt_song_get_list (MusicianGptSong *self,
+                            GWeakRef        *list_ref,
+                            GType            item_type,
+                            GPtrArray       *items)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+  MusicianGptSongList *list;
+
+  g_mutex_lock (&priv->mutex);
+
+  /* The list keeps us alive, and we only keep a weak reference to it */
+  if (NULL == (list = g_weak_ref_get (list_ref)))
+    {
+      list = _musician_gpt_song_list_new (self, item_type, items);
+      g_weak_ref_set (list_ref, list);
+    }
+
+  g_mutex_unlock (&priv->mutex);
+
+  return G_LIST_MODEL (list);
+}
+
+/**
+ * musician_gpt_song_list_measures:
+ * @self: A #MusicianGptSong
+ *
+ * Gets a #GListModel of the #MusicianGptMeasure of @self, ordered by id.
+ * The list follows changes made with musician_gpt_song_add_measure() and
+ * musician_gpt_song_remove_measure().
+ *
+ * Returns: (transfer full): A #GListModel.
+ */
+GListModel *
+musician_gpt_song_list_measures (MusicianGptSong *self)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (self), NULL);
+
+  return musician_gpt_song_get_list (self, &priv->measures_list, MUSICIAN_TYPE_GPT_MEASURE, priv->measures);
+}
+
+/**
+ * musician_gpt_song_list_tracks:
+ * @self: A #MusicianGptSong
+ *
+ * Gets a #GListModel of the #MusicianGptTrack of @self. The list follows
+ * changes made with musician_gpt_song_add_track() and
+ * musician_gpt_song_remove_track().
+ *
+ * Returns: (transfer full): A #GListModel.
+ */
+GListModel *
+musician_gpt_song_list_tracks (MusicianGptSong *self)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (self), NULL);
+
+  return musician_gpt_song_get_list (self, &priv->tracks_list, MUSICIAN_TYPE_GPT_TRACK, priv->tracks);
+}
+
+/**
+ * musician_gpt_song_list_lyrics:
+ * @self: A #MusicianGptSong
+ *
+ * Gets a #GListModel of the #MusicianGptLyrics of @self.
+ *
+ * Returns: (transfer full): A #GListModel.
+ */
+GListModel *
+musician_gpt_song_list_lyrics (MusicianGptSong *self)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (self), NULL);
+
+  return musician_gpt_song_get_list (self, &priv->lyrics_list, MUSICIAN_TYPE_GPT_LYRICS, priv->lyrics);
+}
+
+/**
+ * musician_gpt_song_freeze:
+ * @self: A #MusicianGptSong
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @error: A location for a #GError or %NULL
+ *
+ * Creates a #MusicianGptFrozenSong from @self. The frozen song is a
+ * read-only copy that does not follow later changes to @self and can be
+ * read from any number of threads without locking.
+ *
+ * If @self was loaded lazily, all of its beats are decoded first.
+ *
+ * Returns: (transfer full): A #MusicianGptFrozenSong, or %NULL and @error
+ *   is set.
+ */
+MusicianGptFrozenSong *
+musician_gpt_song_freeze (MusicianGptSong  *self,
+                          GCancellable     *cancellable,
+                          GError          **error)
+{
+  g_autoptr(GBytes) bytes = NULL;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (self), NULL);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), NULL);
+
+  /* The frozen song reads the snapshot records in place */
+  if (NULL == (bytes = musician_gpt_snapshot_serialize (self, cancellable, error)))
+    return NULL;
+
+  return _musician_gpt_frozen_song_new (bytes);
+}
+
+void
+_musician_gpt_song_set_arena (MusicianGptSong  *self,
+                              MusicianGptArena *arena)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (priv->arena == NULL);
+
+  /*
+   * Strings that live in @arena are stored without a copy from now on, so
+   * the arena can only be set once, before the parser fills in the object.
+   */
+  if (arena != NULL)
+    priv->arena = musician_gpt_arena_ref (arena);
+}
+
+/*
+ * Sets the number of measures and tracks that beats are stored for, which
+ * must happen before any beats are added. Measures and tracks are numbered
+ * from 1.
+ */
+void
+_musician_gpt_song_set_block_layout (MusicianGptSong *self,
+                                     guint            n_measures,
+                                     guint            n_tracks)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (priv->stores->len == 0);
+
+  priv->n_block_measures = n_measures;
+  priv->n_block_tracks = n_tracks;
+
+  for (guint i = 0; i < n_tracks; i++)
+    g_ptr_array_add (priv->stores, _musician_gpt_beat_store_new (n_measures, priv->intern_table));
+}
+
+/*
+ * Gets the pool the beats, bends and chords of @self are allocated from.
+ * Objects hold a reference to the pool, so they may outlive @self.
+ *
+ * Returns: (transfer none): A #MusicianGptPool.
+ */
+MusicianGptPool *
+_musician_gpt_song_get_pool (MusicianGptSong *self)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (self), NULL);
+
+  return priv->pool;
+}
+
+/*
+ * Gets the table the chords and bends of @self are interned in.
+ *
+ * Returns: (transfer none): A #MusicianGptInternTable.
+ */
+MusicianGptInternTable *
+_musician_gpt_song_get_intern_table (MusicianGptSong *self)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (self), NULL);
+
+  return priv->intern_table;
+}
+
+void
+_musician_gpt_song_get_block_layout (MusicianGptSong *self,
+                                     guint           *n_measures,
+                                     guint           *n_tracks)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (n_measures != NULL);
+  g_return_if_fail (n_tracks != NULL);
+
+  *n_measures = priv->n_block_measures;
+  *n_tracks = priv->n_block_tracks;
+}
+
+/*
+ * Gets the beats of @track, without loading anything, so the parser can
+ * append beats to it.
+ *
+ * Returns: (transfer none): A #MusicianGptBeatStore.
+ */
+MusicianGptBeatStore *
+_musician_gpt_song_get_store (MusicianGptSong *self,
+                              guint            track)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (self), NULL);
+  g_return_val_if_fail (track > 0 && track <= priv->stores->len, NULL);
+
+  return g_ptr_array_index (priv->stores, track - 1);
+}
+
+/*
+ * Makes @self decode blocks on demand with @func, rather than having the
+ * parser fill in every block up front.
+ */
+void
+_musician_gpt_song_set_block_func (MusicianGptSong          *self,
+                                   MusicianGptSongBlockFunc  func,
+                                   gpointer                  user_data,
+                                   GDestroyNotify            destroy)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_SONG (self));
+  g_return_if_fail (priv->block_func == NULL);
+
+  priv->block_func = func;
+  priv->block_data = user_data;
+  priv->block_data_destroy = destroy;
+}
+
+static gboolean
+musician_gpt_song_load_block (MusicianGptSong  *self,
+                              guint             measure,
+                              guint             track,
+                              GCancellable     *cancellable,
+                              GError          **error)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+  MusicianGptBeatStore *store;
+
+  g_assert (MUSICIAN_IS_GPT_SONG (self));
+  g_assert (measure > 0 && measure <= priv->n_block_measures);
+  g_assert (track > 0 && track <= priv->n_block_tracks);
+
+  store = g_ptr_array_index (priv->stores, track - 1);
+
+  /* Blocks without beats are not stored unless loading lazily */
+  if (priv->block_func == NULL || _musician_gpt_beat_store_is_loaded (store, measure))
+    return TRUE;
+
+  _musician_gpt_beat_store_begin_measure (store, measure);
+
+  if (!priv->block_func (measure, track, store, priv->block_data, cancellable, error))
+    {
+      _musician_gpt_beat_store_abort_measure (store);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * musician_gpt_song_get_beat_store:
+ * @self: A #MusicianGptSong
+ * @track: The track, starting from 1
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @error: A location for a #GError or %NULL
+ *
+ * Gets every beat of @track. This is the cheapest way to look at many
+ * beats, as nothing is allocated for each of them.
+ *
+ * If the song was loaded lazily (see musician_gpt_parser_set_lazy()), every
+ * measure of @track is decoded first.
+ *
+ * Returns: (transfer none): A #MusicianGptBeatStore owned by @self, or
+ *   %NULL and @error is set.
+ */
+MusicianGptBeatStore *
+musician_gpt_song_get_beat_store (MusicianGptSong  *self,
+                                  guint             track,
+                                  GCancellable     *cancellable,
+                                  GError          **error)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (self), NULL);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), NULL);
+
+  if (track == 0 || track > priv->n_block_tracks)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVALID_ARGUMENT,
+                   "No such track: %u",
+                   track);
+      return NULL;
+    }
+
+  for (guint measure = 1; measure <= priv->n_block_measures; measure++)
+    {
+      if (!musician_gpt_song_load_block (self, measure, track, cancellable, error))
+        return NULL;
+    }
+
+  return g_ptr_array_index (priv->stores, track - 1);
+}
+
+/**
+ * musician_gpt_song_get_beats:
+ * @self: A #MusicianGptSong
+ * @measure: The measure, starting from 1
+ * @track: The track, starting from 1
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @error: A location for a #GError or %NULL
+ *
+ * Gets the beats that @track plays in @measure.
+ *
+ * If the song was loaded lazily (see musician_gpt_parser_set_lazy()), the
+ * beats are decoded from the file the first time they are requested and
+ * kept for later calls.
+ *
+ * A new #MusicianGptBeat is created for each beat every time this is
+ * called. Use musician_gpt_song_get_beat_store() to look at many beats.
+ *
+ * Returns: (transfer container) (element-type MusicianGptBeat): The beats
+ *   of the block, or %NULL and @error is set.
+ */
+GPtrArray *
+musician_gpt_song_get_beats (MusicianGptSong  *self,
+                             guint             measure,
+                             guint             track,
+                             GCancellable     *cancellable,
+                             GError          **error)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+  MusicianGptBeatStore *store;
+  GPtrArray *beats;
+  guint first_beat;
+  guint n_beats;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (self), NULL);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), NULL);
+
+  if (measure == 0 || measure > priv->n_block_measures ||
+      track == 0 || track > priv->n_block_tracks)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVALID_ARGUMENT,
+                   "No such measure/track block: %u/%u",
+                   measure, track);
+      return NULL;
+    }
+
+  if (!musician_gpt_song_load_block (self, measure, track, cancellable, error))
+    return NULL;
+
+  store = g_ptr_array_index (priv->stores, track - 1);
+  musician_gpt_beat_store_get_measure (store, measure, &first_beat, &n_beats);
+
+  beats = g_ptr_array_new_full (n_beats, (GDestroyNotify)musician_gpt_beat_unref);
+
+  for (guint i = first_beat; i < first_beat + n_beats; i++)
+    {
+      MusicianGptBeatView view;
+      MusicianGptBeat *beat;
+
+      musician_gpt_beat_store_get_view (store, i, &view);
+
+      beat = _musician_gpt_beat_new_from_pool (priv->pool);
+      musician_gpt_beat_set_mode (beat, view.mode);
+      musician_gpt_beat_set_duration (beat, view.duration);
+      if (view.n_tuplet != 0)
+        musician_gpt_beat_set_n_tuplet (beat, view.n_tuplet);
+      musician_gpt_beat_set_dynamics (beat, view.dynamics);
+      musician_gpt_beat_set_text (beat, view.text);
+      musician_gpt_beat_set_chord (beat, view.chord);
+
+      g_ptr_array_add (beats, beat);
+    }
+
+  return beats;
+}
+
+/**
+ * musician_gpt_song_get_timeline:
+ * @self: A #MusicianGptSong
+ * @track: The track, starting from 1
+ * @cancellable: (nullable): A #GCancellable or %NULL
+ * @error: A location for a #GError or %NULL
+ *
+ * Gets the #MusicianGptTimeline of @track, to find where its measures and
+ * beats are in time, or what is playing at a given time.
+ *
+ * The timeline is built the first time it is requested, which decodes every
+ * measure of @track if the song was loaded lazily. It follows changes to
+ * the time signatures and tempo of @self from then on.
+ *
+ * The timelines of a read-only song may be requested and read from any
+ * thread, see musician_gpt_song_get_read_only().
+ *
+ * Returns: (transfer none): A #MusicianGptTimeline owned by @self, or
+ *   %NULL and @error is set.
+ */
+MusicianGptTimeline *
+musician_gpt_song_get_timeline (MusicianGptSong  *self,
+                                guint             track,
+                                GCancellable     *cancellable,
+                                GError          **error)
+{
+  MusicianGptSongPrivate *priv = musician_gpt_song_get_instance_private (self);
+  MusicianGptTimeline *timeline;
+  MusicianGptBeatStore *store;
+
+  g_return_val_if_fail (MUSICIAN_IS_GPT_SONG (self), NULL);
+  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), NULL);
+
+  if (NULL == (store = musician_gpt_song_get_beat_store (self, track, cancellable, error)))
+    return NULL;
+
+  g_mutex_lock (&priv->mutex);
+
+  if (priv->timelines == NULL)
+    {
+      priv->timelines = g_ptr_array_new_with_free_func ((GDestroyNotify)musician_gpt_timeline_unref);
+      g_ptr_array_set_size (priv->timelines, priv->n_block_tracks);
+
+      for (guint i = 0; i < priv->measures->len; i++)
+        musician_gpt_song_watch_measure (self, g_ptr_array_index (priv->measures, i));
+    }
+
+  if (NULL == (timeline = g_ptr_array_index (priv->timelines, track - 1)))
+    {
+      timeline = _musician_gpt_timeline_new (store, priv->tempo);
+
+      for (guint measure = 1; measure <= priv->n_block_measures; measure++)
+        _musician_gpt_timeline_set_measure_length (timeline,
+                                                   measure,
+                                                   musician_gpt_song_get_measure_length (self, measure));
+
+      /*
+       * Sum up the starts of the measures now, so that reading the timeline
+       * does not write to it unless a measure changes. Read-only songs are
+       * read from several threads at once.
+       */
+      musician_gpt_timeline_get_length (timeline);
+
+      g_ptr_array_index (priv->timelines, track - 1) = timeline;
+    }
+
+  g_mutex_unlock (&priv->mutex);
+
+  return timeline;
+}
@@ -56,8 +56,32 @@ void                    musician_gpt_song_add_measure        (MusicianGptSong
                                                               MusicianGptMeasure     *measure);
 void                    musician_gpt_song_remove_measure     (MusicianGptSong        *self,
                                                               MusicianGptMeasure     *measure);
+MusicianGptMeasure     *musician_gpt_song_get_measure        (MusicianGptSong        *self,
+                                                              guint                   id);
+MusicianGptMeasure    **musician_gpt_song_get_measures       (MusicianGptSong        *self,
+                                                              guint                  *n_measures);
 guint                   musician_gpt_song_get_n_measures     (MusicianGptSong        *self);
 guint                   musician_gpt_song_get_n_tracks       (MusicianGptSong        *self);
+gboolean                musician_gpt_song_get_read_only      (MusicianGptSong        *self);
+GListModel             *musician_gpt_song_list_measures      (MusicianGptSong        *self);
+GListModel             *musician_gpt_song_list_tracks        (MusicianGptSong        *self);
+GListModel             *musician_gpt_song_list_lyrics        (MusicianGptSong        *self);
+GPtrArray              *musician_gpt_song_get_beats          (MusicianGptSong        *self,
+                                                              guint                   measure,
+                                                              guint                   track,
+                                                              GCancellable           *cancellable,
+                                                              GError                **error);
+MusicianGptBeatStore   *musician_gpt_song_get_beat_store     (MusicianGptSong        *self,
+                                                              guint                   track,
+                                                              GCancellable           *cancellable,
+                                                              GError                **error);
+MusicianGptFrozenSong  *musician_gpt_song_freeze             (MusicianGptSong        *self,
+                                                              GCancellable           *cancellable,
+                                                              GError                **error);
+MusicianGptTimeline    *musician_gpt_song_get_timeline       (MusicianGptSong        *self,
+                                                              guint                   track,
+                                                              GCancellable           *cancellable,
+                                                              GError                **error);
 const gchar            *musician_gpt_song_get_album          (MusicianGptSong        *self);
 const gchar            *musician_gpt_song_get_artist         (MusicianGptSong        *self);
 const gchar            *musician_gpt_song_get_copyright      (MusicianGptSong        *self);
@@ -0,0 +1,437 @@
+/* musician-gpt-timeline.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "musician-gpt-timeline"
+
+#include "musician-gpt-timeline.h"
+#include "musician-gpt-timeline-private.h"
+
+/**
+ * SECTION:musician-gpt-timeline
+ * @title: MusicianGptTimeline
+ * @short_description: Where each beat of a track falls in time
+ *
+ * A #MusicianGptTimeline places every measure and beat of a track at an
+ * absolute position in ticks, of which there are
+ * %MUSICIAN_GPT_TICKS_PER_QUARTER in a quarter note, so that what is
+ * playing at any point of the song can be found without walking every
+ * measure before it.
+ *
+ * Measures are as long as their time signature, or as long as their beats
+ * for measures that have none. Beats are placed from the start of their
+ * measure by their duration, dots and tuplets. As each measure starts on
+ * its own, rounding of odd tuplets never adds up past the end of a measure.
+ *
+ * Get the timeline of a track with musician_gpt_song_get_timeline(). It
+ * follows changes to the measures of the song, only going over the
+ * measures after the first one that changed when it is next used.
+ *
+ * Reading a timeline only writes to it after such a change, so the
+ * timelines of a read-only song can be read from several threads at once.
+ */
+
+struct _MusicianGptTimeline
+{
+  volatile gint         ref_count;
+
+  /* Where the beats of each measure are, and their durations */
+  MusicianGptBeatStore *store;
+
+  /* In quarter notes per minute */
+  guint                 tempo;
+
+  guint                 n_measures;
+
+  /*
+   * The length of each measure from its time signature, or 0 to use the
+   * length of its beats in @beat_lengths instead.
+   */
+  guint                *lengths;
+  guint                *beat_lengths;
+
+  /*
+   * Where each measure starts, followed by the end of the song. Only the
+   * first @n_valid + 1 entries are up to date, as a change to a measure
+   * drops the ones after it until they are needed again.
+   */
+  guint64              *starts;
+  guint                 n_valid;
+
+  /* The measure of each beat of @store, and where it starts in it */
+  guint                *beat_measures;
+  guint                *beat_offsets;
+  guint                 n_beats;
+};
+
+G_DEFINE_BOXED_TYPE (MusicianGptTimeline,
+                     musician_gpt_timeline,
+                     musician_gpt_timeline_ref,
+                     musician_gpt_timeline_unref)
+
+/*
+ * Gets the length of a beat in ticks. An n-tuplet fits its notes in the
+ * time of the next lower power of two, such as 3 in the time of 2.
+ */
+static guint
+get_beat_ticks (guint8 duration,
+                guint8 n_tuplet,
+                guint8 flags)
+{
+  guint ticks;
+
+  if (duration == 0)
+    return 0;
+
+  ticks = MUSICIAN_GPT_TICKS_PER_QUARTER * 4 / duration;
+
+  if (flags & MUSICIAN_GPT_BEAT_FLAGS_DOTTED)
+    ticks += ticks / 2;
+
+  if (n_tuplet > 1)
+    ticks = ticks * (1 << g_bit_nth_msf (n_tuplet - 1, -1)) / n_tuplet;
+
+  return ticks;
+}
+
+static void
+musician_gpt_timeline_destroy (MusicianGptTimeline *self)
+{
+  g_clear_pointer (&self->store, musician_gpt_beat_store_unref);
+  g_clear_pointer (&self->lengths, g_free);
+  g_clear_pointer (&self->beat_lengths, g_free);
+  g_clear_pointer (&self->starts, g_free);
+  g_clear_pointer (&self->beat_measures, g_free);
+  g_clear_pointer (&self->beat_offsets, g_free);
+
+  g_slice_free (MusicianGptTimeline, self);
+}
+
+/*
+ * Creates the timeline of the beats in @store, which must not change
+ * afterwards. Every measure is as long as its beats until it is given a
+ * length with _musician_gpt_timeline_set_measure_length().
+ */
+MusicianGptTimeline *
+_musician_gpt_timeline_new (MusicianGptBeatStore *store,
+                            guint                 tempo)
+{
+  MusicianGptTimeline *self;
+  const guint8 *durations;
+  const guint8 *n_tuplets;
+  const guint8 *flags;
+
+  g_return_val_if_fail (store != NULL, NULL);
+
+  self = g_slice_new0 (MusicianGptTimeline);
+  self->ref_count = 1;
+  self->store = musician_gpt_beat_store_ref (store);
+  self->tempo = tempo;
+  self->n_measures = musician_gpt_beat_store_get_n_measures (store);
+  self->n_beats = musician_gpt_beat_store_get_n_beats (store);
+  self->lengths = g_new0 (guint, self->n_measures);
+  self->beat_lengths = g_new0 (guint, self->n_measures);
+  self->starts = g_new0 (guint64, self->n_measures + 1);
+  self->beat_measures = g_new0 (guint, self->n_beats);
+  self->beat_offsets = g_new0 (guint, self->n_beats);
+
+  durations = musician_gpt_beat_store_get_durations (store);
+  n_tuplets = musician_gpt_beat_store_get_n_tuplets (store);
+  flags = musician_gpt_beat_store_get_flags (store);
+
+  for (guint measure = 1; measure <= self->n_measures; measure++)
+    {
+      guint first_beat;
+      guint n_beats;
+      guint offset = 0;
+
+      musician_gpt_beat_store_get_measure (store, measure, &first_beat, &n_beats);
+
+      for (guint i = first_beat; i < first_beat + n_beats; i++)
+        {
+          self->beat_measures[i] = measure;
+          self->beat_offsets[i] = offset;
+          offset += get_beat_ticks (durations[i], n_tuplets[i], flags[i]);
+        }
+
+      self->beat_lengths[measure - 1] = offset;
+    }
+
+  return self;
+}
+
+MusicianGptTimeline *
+musician_gpt_timeline_ref (MusicianGptTimeline *self)
+{
+  g_return_val_if_fail (self, NULL);
+  g_return_val_if_fail (self->ref_count, NULL);
+
+  g_atomic_int_inc (&self->ref_count);
+
+  return self;
+}
+
+void
+musician_gpt_timeline_unref (MusicianGptTimeline *self)
+{
+  g_return_if_fail (self);
+  g_return_if_fail (self->ref_count);
+
+  if (g_atomic_int_dec_and_test (&self->ref_count))
+    musician_gpt_timeline_destroy (self);
+}
+
+/*
+ * Sets @length, in ticks, as the length of @measure, or 0 to use the length
+ * of its beats. Nothing is summed again until the starts of the measures
+ * after @measure are needed.
+ */
+void
+_musician_gpt_timeline_set_measure_length (MusicianGptTimeline *self,
+                                           guint                measure,
+                                           guint                length)
+{
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (measure > 0 && measure <= self->n_measures);
+
+  if (self->lengths[measure - 1] != length)
+    {
+      self->lengths[measure - 1] = length;
+      self->n_valid = MIN (self->n_valid, measure - 1);
+    }
+}
+
+void
+_musician_gpt_timeline_set_tempo (MusicianGptTimeline *self,
+                                  guint                tempo)
+{
+  g_return_if_fail (self != NULL);
+
+  self->tempo = tempo;
+}
+
+/* Brings the starts of the first @n_measures measures, and their ends, up to date */
+static void
+musician_gpt_timeline_update (MusicianGptTimeline *self,
+                              guint                n_measures)
+{
+  g_assert (self != NULL);
+  g_assert (n_measures <= self->n_measures);
+
+  for (guint i = self->n_valid; i < n_measures; i++)
+    {
+      guint length = self->lengths[i] ? self->lengths[i] : self->beat_lengths[i];
+
+      self->starts[i + 1] = self->starts[i] + length;
+    }
+
+  self->n_valid = MAX (self->n_valid, n_measures);
+}
+
+guint
+musician_gpt_timeline_get_n_measures (MusicianGptTimeline *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->n_measures;
+}
+
+/**
+ * musician_gpt_timeline_get_length:
+ * @self: A #MusicianGptTimeline
+ *
+ * Returns: The length of the song, in ticks.
+ */
+guint64
+musician_gpt_timeline_get_length (MusicianGptTimeline *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  musician_gpt_timeline_update (self, self->n_measures);
+
+  return self->starts[self->n_measures];
+}
+
+/**
+ * musician_gpt_timeline_get_measure_tick:
+ * @self: A #MusicianGptTimeline
+ * @measure: The measure, starting from 1
+ *
+ * Returns: Where @measure starts, in ticks.
+ */
+guint64
+musician_gpt_timeline_get_measure_tick (MusicianGptTimeline *self,
+                                        guint                measure)
+{
+  g_return_val_if_fail (self != NULL, 0);
+  g_return_val_if_fail (measure > 0 && measure <= self->n_measures, 0);
+
+  musician_gpt_timeline_update (self, measure - 1);
+
+  return self->starts[measure - 1];
+}
+
+/**
+ * musician_gpt_timeline_get_beat_tick:
+ * @self: A #MusicianGptTimeline
+ * @beat: The index of a beat in the #MusicianGptBeatStore of the track
+ *
+ * Returns: Where @beat starts, in ticks.
+ */
+guint64
+musician_gpt_timeline_get_beat_tick (MusicianGptTimeline *self,
+                                     guint                beat)
+{
+  g_return_val_if_fail (self != NULL, 0);
+  g_return_val_if_fail (beat < self->n_beats, 0);
+
+  return musician_gpt_timeline_get_measure_tick (self, self->beat_measures[beat]) +
+         self->beat_offsets[beat];
+}
+
+/**
+ * musician_gpt_timeline_lookup:
+ * @self: A #MusicianGptTimeline
+ * @tick: A position in the song, in ticks
+ * @measure: (out) (optional): Location for the measure playing at @tick
+ * @beat: (out) (optional): Location for the beat playing at @tick
+ *
+ * Finds what is playing at @tick, in time logarithmic in the number of
+ * measures and beats.
+ *
+ * @beat is set to the index of the beat in the #MusicianGptBeatStore of
+ * the track, or %G_MAXUINT when no beat is playing because the beats of
+ * the measure end before @tick.
+ *
+ * Returns: %TRUE if @tick is before the end of the song.
+ */
+gboolean
+musician_gpt_timeline_lookup (MusicianGptTimeline *self,
+                              guint64              tick,
+                              guint               *measure,
+                              guint               *beat)
+{
+  const guint8 *durations;
+  const guint8 *n_tuplets;
+  const guint8 *flags;
+  guint64 offset;
+  guint first_beat;
+  guint n_beats;
+  guint lo;
+  guint hi;
+
+  g_return_val_if_fail (self != NULL, FALSE);
+
+  musician_gpt_timeline_update (self, self->n_measures);
+
+  if (tick >= self->starts[self->n_measures])
+    return FALSE;
+
+  /* The first measure ending after @tick, which skips empty measures */
+  lo = 1;
+  hi = self->n_measures;
+
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (self->starts[mid] <= tick)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  if (measure != NULL)
+    *measure = lo;
+
+  if (beat == NULL)
+    return TRUE;
+
+  *beat = G_MAXUINT;
+
+  offset = tick - self->starts[lo - 1];
+  musician_gpt_beat_store_get_measure (self->store, lo, &first_beat, &n_beats);
+
+  /* The first beat of the measure starting after @tick */
+  lo = first_beat;
+  hi = first_beat + n_beats;
+
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (self->beat_offsets[mid] <= offset)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  if (lo == first_beat)
+    return TRUE;
+
+  durations = musician_gpt_beat_store_get_durations (self->store);
+  n_tuplets = musician_gpt_beat_store_get_n_tuplets (self->store);
+  flags = musician_gpt_beat_store_get_flags (self->store);
+
+  if (offset < self->beat_offsets[lo - 1] + get_beat_ticks (durations[lo - 1], n_tuplets[lo - 1], flags[lo - 1]))
+    *beat = lo - 1;
+
+  return TRUE;
+}
+
+/**
+ * musician_gpt_timeline_usec_to_tick:
+ * @self: A #MusicianGptTimeline
+ * @usec: A time from the start of the song, in microseconds
+ *
+ * Converts @usec to a position in the song at the tempo of the song.
+ *
+ * Returns: The position, in ticks.
+ */
+guint64
+musician_gpt_timeline_usec_to_tick (MusicianGptTimeline *self,
+                                    gint64               usec)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  if (usec <= 0)
+    return 0;
+
+  return (guint64)usec * self->tempo * MUSICIAN_GPT_TICKS_PER_QUARTER / (60 * G_USEC_PER_SEC);
+}
+
+/**
+ * musician_gpt_timeline_tick_to_usec:
+ * @self: A #MusicianGptTimeline
+ * @tick: A position in the song, in ticks
+ *
+ * Converts @tick to the time it is played at, at the tempo of the song.
+ *
+ * Returns: The time from the start of the song, in microseconds, or 0 if
+ *   the song has no tempo.
+ */
+gint64
+musician_gpt_timeline_tick_to_usec (MusicianGptTimeline *self,
+                                    guint64              tick)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  if (self->tempo == 0)
+    return 0;
+
+  return tick * 60 * G_USEC_PER_SEC / ((guint64)self->tempo * MUSICIAN_GPT_TICKS_PER_QUARTER);
+}
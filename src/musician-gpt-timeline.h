@@ -0,0 +1,59 @@
+/* musician-gpt-timeline.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_TIMELINE_H
+#define MUSICIAN_GPT_TIMELINE_H
+
+#include <glib-object.h>
+
+#include "musician-gpt-types.h"
+
+G_BEGIN_DECLS
+
+#define MUSICIAN_TYPE_GPT_TIMELINE (musician_gpt_timeline_get_type())
+
+/**
+ * MUSICIAN_GPT_TICKS_PER_QUARTER:
+ *
+ * The number of ticks in a quarter note, as used by #MusicianGptTimeline.
+ */
+#define MUSICIAN_GPT_TICKS_PER_QUARTER 960
+
+GType                musician_gpt_timeline_get_type         (void);
+MusicianGptTimeline *musician_gpt_timeline_ref              (MusicianGptTimeline *self);
+void                 musician_gpt_timeline_unref            (MusicianGptTimeline *self);
+guint                musician_gpt_timeline_get_n_measures   (MusicianGptTimeline *self);
+guint64              musician_gpt_timeline_get_length       (MusicianGptTimeline *self);
+guint64              musician_gpt_timeline_get_measure_tick (MusicianGptTimeline *self,
+                                                             guint                measure);
+guint64              musician_gpt_timeline_get_beat_tick    (MusicianGptTimeline *self,
+                                                             guint                beat);
+gboolean             musician_gpt_timeline_lookup           (MusicianGptTimeline *self,
+                                                             guint64              tick,
+                                                             guint               *measure,
+                                                             guint               *beat);
+guint64              musician_gpt_timeline_usec_to_tick     (MusicianGptTimeline *self,
+                                                             gint64               usec);
+gint64               musician_gpt_timeline_tick_to_usec     (MusicianGptTimeline *self,
+                                                             guint64              tick);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MusicianGptTimeline, musician_gpt_timeline_unref)
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_TIMELINE_H */
@@ -0,0 +1,60 @@
+/* musician-gpt-trace-private.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_TRACE_PRIVATE_H
+#define MUSICIAN_GPT_TRACE_PRIVATE_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Where trace marks go. These are set from the MUSICIAN_TRACE environment
+ * variable, as in MUSICIAN_TRACE=sysprof,stderr, when the first parser
+ * class is initialized, or with _musician_gpt_trace_set_flags().
+ */
+typedef enum
+{
+  MUSICIAN_GPT_TRACE_NONE    = 0,
+  MUSICIAN_GPT_TRACE_SYSPROF = 1 << 0,
+  MUSICIAN_GPT_TRACE_STDERR  = 1 << 1,
+} MusicianGptTraceFlags;
+
+extern MusicianGptTraceFlags _musician_gpt_trace_flags;
+
+void   _musician_gpt_trace_init      (void);
+void   _musician_gpt_trace_set_flags (MusicianGptTraceFlags  flags);
+gint64 _musician_gpt_trace_get_time  (void);
+void   _musician_gpt_trace_mark      (gint64                 begin_time,
+                                      const gchar           *name,
+                                      const gchar           *format,
+                                      ...) G_GNUC_PRINTF (3, 4);
+
+/*
+ * Everything that traces checks this first, so that nothing more than a
+ * load and a branch is paid when tracing is off.
+ */
+static inline gboolean
+_musician_gpt_trace_is_enabled (void)
+{
+  return G_UNLIKELY (_musician_gpt_trace_flags != MUSICIAN_GPT_TRACE_NONE);
+}
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_TRACE_PRIVATE_H */
@@ -0,0 +1,119 @@
+/* musician-gpt-trace.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "musician-gpt-trace"
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef HAVE_SYSPROF
+# include <sysprof-capture.h>
+#endif
+
+#include "musician-gpt-trace-private.h"
+
+MusicianGptTraceFlags _musician_gpt_trace_flags;
+
+static const GDebugKey trace_keys[] = {
+  { "sysprof", MUSICIAN_GPT_TRACE_SYSPROF },
+  { "stderr", MUSICIAN_GPT_TRACE_STDERR },
+};
+
+void
+_musician_gpt_trace_init (void)
+{
+  static gsize initialized;
+
+  if (g_once_init_enter (&initialized))
+    {
+      const gchar *value = g_getenv ("MUSICIAN_TRACE");
+      guint flags = 0;
+
+      if (value != NULL)
+        flags = g_parse_debug_string (value, trace_keys, G_N_ELEMENTS (trace_keys));
+
+#ifndef HAVE_SYSPROF
+      /* Rather than dropping the marks, send them somewhere they can be seen */
+      if (flags & MUSICIAN_GPT_TRACE_SYSPROF)
+        {
+          g_message ("Built without sysprof, tracing to stderr instead");
+          flags = (flags & ~MUSICIAN_GPT_TRACE_SYSPROF) | MUSICIAN_GPT_TRACE_STDERR;
+        }
+#endif
+
+      _musician_gpt_trace_set_flags (flags);
+
+      g_once_init_leave (&initialized, TRUE);
+    }
+}
+
+void
+_musician_gpt_trace_set_flags (MusicianGptTraceFlags flags)
+{
+  _musician_gpt_trace_flags = flags;
+}
+
+/*
+ * Returns the monotonic time in nanoseconds, which is the clock sysprof
+ * records its own samples with.
+ */
+gint64
+_musician_gpt_trace_get_time (void)
+{
+#ifdef HAVE_SYSPROF
+  return SYSPROF_CAPTURE_CURRENT_TIME;
+#else
+  return g_get_monotonic_time () * 1000;
+#endif
+}
+
+/*
+ * Records a mark named @name that started at @begin_time, as returned by
+ * _musician_gpt_trace_get_time(), and ends now.
+ */
+void
+_musician_gpt_trace_mark (gint64       begin_time,
+                          const gchar *name,
+                          const gchar *format,
+                          ...)
+{
+  g_autofree gchar *message = NULL;
+  gint64 duration;
+  va_list args;
+
+  g_return_if_fail (name != NULL);
+  g_return_if_fail (format != NULL);
+
+  if (!_musician_gpt_trace_is_enabled ())
+    return;
+
+  duration = _musician_gpt_trace_get_time () - begin_time;
+
+  va_start (args, format);
+  message = g_strdup_vprintf (format, args);
+  va_end (args);
+
+#ifdef HAVE_SYSPROF
+  if (_musician_gpt_trace_flags & MUSICIAN_GPT_TRACE_SYSPROF)
+    sysprof_collector_mark (begin_time, duration, "Musician", name, "%s", message);
+#endif
+
+  if (_musician_gpt_trace_flags & MUSICIAN_GPT_TRACE_STDERR)
+    g_printerr ("musician-trace: %-24s %10.3f ms  %s\n", name, duration / 1000000.0, message);
+}
@@ -0,0 +1,53 @@
+/* musician-gpt-track-private.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUSICIAN_GPT_TRACK_PRIVATE_H
+#define MUSICIAN_GPT_TRACK_PRIVATE_H
+
+#include "musician-gpt-arena.h"
+#include "musician-gpt-track.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Everything a track is made of, so that parsers can create a track in one
+ * go with _musician_gpt_track_new_from_info() rather than setting (and
+ * notifying) each property in turn.
+ */
+typedef struct
+{
+  guint                    id;
+  const gchar             *title;
+  const MusicianGptTuning *tunings;
+  gsize                    n_tunings;
+  guint                    port;
+  guint                    channel;
+  guint                    effects_channel;
+  guint                    n_frets;
+  guint                    capo_at;
+  GdkRGBA                  color;
+} MusicianGptTrackInfo;
+
+void              _musician_gpt_track_set_arena     (MusicianGptTrack           *self,
+                                                     MusicianGptArena           *arena);
+MusicianGptTrack *_musician_gpt_track_new_from_info (const MusicianGptTrackInfo *info,
+                                                     MusicianGptArena           *arena);
+
+G_END_DECLS
+
+#endif /* MUSICIAN_GPT_TRACK_PRIVATE_H */
@@ -19,9 +19,12 @@
 #define G_LOG_DOMAIN "musician-gpt-track"
 
 #include "musician-gpt-track.h"
+#include "musician-gpt-track-private.h"
 
 typedef struct
 {
+  MusicianGptArena *arena;
+
   gchar *title;
   GArray *tunings;
   GdkRGBA color;
@@ -62,9 +65,11 @@ musician_gpt_track_finalize (GObject *object)
   MusicianGptTrack *self = (MusicianGptTrack *)object;
   MusicianGptTrackPrivate *priv = musician_gpt_track_get_instance_private (self);
 
-  g_clear_pointer (&priv->title, g_free);
+  musician_gpt_arena_free_string (priv->arena, priv->title);
   g_clear_pointer (&priv->tunings, g_array_unref);
 
+  g_clear_pointer (&priv->arena, musician_gpt_arena_unref);
+
   G_OBJECT_CLASS (musician_gpt_track_parent_class)->finalize (object);
 }
 
@@ -324,8 +329,8 @@ musician_gpt_track_set_title (MusicianGptTrack *self,
 
   if (g_strcmp0 (priv->title, title) != 0)
     {
-      g_free (priv->title);
-      priv->title = g_strdup (title);
+      musician_gpt_arena_free_string (priv->arena, priv->title);
+      priv->title = musician_gpt_arena_dup_string (priv->arena, title);
       g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_TITLE]);
     }
 }
@@ -495,3 +500,55 @@ musician_gpt_track_get_n_strings (MusicianGptTrack *self)
 
   return priv->tunings->len;
 }
+
+void
+_musician_gpt_track_set_arena (MusicianGptTrack *self,
+                               MusicianGptArena *arena)
+{
+  MusicianGptTrackPrivate *priv = musician_gpt_track_get_instance_private (self);
+
+  g_return_if_fail (MUSICIAN_IS_GPT_TRACK (self));
+  g_return_if_fail (priv->arena == NULL);
+
+  /*
+   * Strings that live in @arena are stored without a copy from now on, so
+   * the arena can only be set once, before the parser fills in the object.
+   */
+  if (arena != NULL)
+    priv->arena = musician_gpt_arena_ref (arena);
+}
+
+/*
+ * Creates a track from @info without emitting any notifications. Strings
+ * that live in @arena are kept without a copy.
+ */
+MusicianGptTrack *
+_musician_gpt_track_new_from_info (const MusicianGptTrackInfo *info,
+                                   MusicianGptArena           *arena)
+{
+  MusicianGptTrackPrivate *priv;
+  MusicianGptTrack *self;
+
+  g_return_val_if_fail (info != NULL, NULL);
+  g_return_val_if_fail (info->tunings != NULL || info->n_tunings == 0, NULL);
+
+  self = g_object_new (MUSICIAN_TYPE_GPT_TRACK, NULL);
+  priv = musician_gpt_track_get_instance_private (self);
+
+  if (arena != NULL)
+    priv->arena = musician_gpt_arena_ref (arena);
+
+  priv->id = info->id;
+  priv->title = musician_gpt_arena_dup_string (priv->arena, info->title);
+  priv->port = info->port;
+  priv->channel = info->channel;
+  priv->effects_channel = info->effects_channel;
+  priv->n_frets = info->n_frets;
+  priv->capo_at = info->capo_at;
+  priv->color = info->color;
+
+  if (info->n_tunings > 0)
+    g_array_append_vals (priv->tunings, info->tunings, info->n_tunings);
+
+  return self;
+}
@@ -25,14 +25,18 @@
 
 G_BEGIN_DECLS
 
-typedef struct _MusicianGptSong    MusicianGptSong;
-typedef struct _MusicianGptTrack   MusicianGptTrack;
-typedef struct _MusicianGptMeasure MusicianGptMeasure;
-typedef struct _MusicianGptBeat    MusicianGptBeat;
-typedef struct _MusicianGptBend    MusicianGptBend;
-typedef struct _MusicianGptChord   MusicianGptChord;
-typedef struct _MusicianGptEffect  MusicianGptEffect;
-typedef struct _MusicianGptLyrics  MusicianGptLyrics;
+typedef struct _MusicianGptSong       MusicianGptSong;
+typedef struct _MusicianGptTrack      MusicianGptTrack;
+typedef struct _MusicianGptMeasure    MusicianGptMeasure;
+typedef struct _MusicianGptBeat       MusicianGptBeat;
+typedef struct _MusicianGptBeatStore  MusicianGptBeatStore;
+typedef struct _MusicianGptBend       MusicianGptBend;
+typedef struct _MusicianGptChord      MusicianGptChord;
+typedef struct _MusicianGptEffect     MusicianGptEffect;
+typedef struct _MusicianGptFrozenSong MusicianGptFrozenSong;
+typedef struct _MusicianGptLyrics     MusicianGptLyrics;
+typedef struct _MusicianGptMetadata   MusicianGptMetadata;
+typedef struct _MusicianGptTimeline   MusicianGptTimeline;
 
 typedef gint32 MusicianGptNote;
 typedef gint32 MusicianGptTuning;
@@ -149,6 +153,13 @@ typedef enum
   MUSICIAN_GPT_TRIPLET_FEEL_EIGHTH,
 } MusicianGptTripletFeel;
 
+typedef enum
+{
+  MUSICIAN_GPT_PUSH_STATUS_ERROR          = -1,
+  MUSICIAN_GPT_PUSH_STATUS_NEED_MORE_DATA = 0,
+  MUSICIAN_GPT_PUSH_STATUS_DONE           = 1,
+} MusicianGptPushStatus;
+
 typedef struct
 {
   guint32 port_id;
@@ -25,14 +25,25 @@ G_BEGIN_DECLS
 
 # include "musician-enums.h"
 # include "musician-gp4-parser.h"
+# include "musician-gpt-batch-loader.h"
 # include "musician-gpt-beat.h"
+# include "musician-gpt-beat-store.h"
 # include "musician-gpt-bend.h"
 # include "musician-gpt-chord.h"
+# include "musician-gpt-events.h"
+# include "musician-gpt-frozen-song.h"
 # include "musician-gpt-input-stream.h"
 # include "musician-gpt-lyrics.h"
 # include "musician-gpt-measure.h"
+# include "musician-gpt-metadata.h"
+# include "musician-gpt-parse-stats.h"
 # include "musician-gpt-parser.h"
+# include "musician-gpt-push-parser.h"
+# include "musician-gpt-snapshot.h"
 # include "musician-gpt-song.h"
+# include "musician-gpt-song-cache.h"
+# include "musician-gpt-song-list.h"
+# include "musician-gpt-timeline.h"
 # include "musician-gpt-track.h"
 # include "musician-gpt-types.h"
 
@@ -0,0 +1,1392 @@
+/* bench-gpt-parser.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib/gstdio.h>
+#include <musician.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "musician-gp4-parser-private.h"
+#include "musician-gpt-input-stream-private.h"
+#include "musician-gpt-measure-private.h"
+#include "musician-gpt-parser-private.h"
+#include "musician-gpt-pool.h"
+#include "musician-gpt-song-private.h"
+
+#include "gp4-generator.h"
+
+/*
+ * This is not run as part of "make check". Run it by hand as:
+ *
+ *   ./bench-gpt-parser [--scale=N] [--iterations=N] [--corpus=PATH...] [--json] [CASE...]
+ *
+ * The input is tests/data/test1.gp4 concatenated --scale times, so that
+ * we are measuring decode throughput rather than open()/mmap() overhead.
+ *
+ * The corpus-* cases load the files given with --corpus instead, each of
+ * which may be a .gp4 file or a directory of them. Without --corpus they
+ * load the copies of test1.gp4. gen-gp4-corpus writes such a directory.
+ *
+ * generated-scaling loads songs from gp4-generator.c that grow by a factor
+ * of ten, so that the time per measure shows whether loading stays linear.
+ *
+ * Each case reports the best of --iterations runs, along with the number
+ * of allocations and frees made by that run, the bytes it allocated, and
+ * the peak RSS of the process so far. The allocations are only counted
+ * with glibc, and left out of the results elsewhere.
+ * --json prints the same as a single JSON object, so that results can be
+ * compared from one build to the next.
+ */
+
+#ifdef __GLIBC__
+# include <errno.h>
+# include <malloc.h>
+
+/*
+ * Count the allocations by wrapping malloc(), free() and the aligned
+ * allocators around the ones from glibc, which is what g_malloc() and
+ * GSlice end up calling. Bytes are what malloc_usable_size() reports, so
+ * they include the rounding done by the allocator, and a realloc() counts
+ * as much as it grew the block.
+ */
+extern void *__libc_malloc   (size_t size);
+extern void *__libc_calloc   (size_t n_members, size_t size);
+extern void *__libc_realloc  (void *mem, size_t size);
+extern void *__libc_memalign (size_t alignment, size_t size);
+extern void *__libc_valloc   (size_t size);
+extern void *__libc_pvalloc  (size_t size);
+extern void  __libc_free     (void *mem);
+
+static volatile gint  n_allocations;
+static volatile gint  n_frees;
+static volatile gsize n_allocated_bytes;
+
+static inline void *
+count_allocation (void *mem)
+{
+  if (mem != NULL)
+    {
+      g_atomic_int_inc (&n_allocations);
+      g_atomic_pointer_add (&n_allocated_bytes, malloc_usable_size (mem));
+    }
+
+  return mem;
+}
+
+void *
+malloc (size_t size)
+{
+  return count_allocation (__libc_malloc (size));
+}
+
+void *
+calloc (size_t n_members,
+        size_t size)
+{
+  return count_allocation (__libc_calloc (n_members, size));
+}
+
+void *
+realloc (void   *mem,
+         size_t  size)
+{
+  gsize old_size;
+  gsize new_size;
+  void *ret;
+
+  if (mem == NULL)
+    return count_allocation (__libc_realloc (NULL, size));
+
+  old_size = malloc_usable_size (mem);
+
+  /* A size of 0 frees @mem and returns %NULL */
+  if (NULL == (ret = __libc_realloc (mem, size)))
+    {
+      if (size == 0)
+        g_atomic_int_inc (&n_frees);
+      return NULL;
+    }
+
+  new_size = malloc_usable_size (ret);
+  if (new_size > old_size)
+    g_atomic_pointer_add (&n_allocated_bytes, new_size - old_size);
+
+  return ret;
+}
+
+void *
+memalign (size_t alignment,
+          size_t size)
+{
+  return count_allocation (__libc_memalign (alignment, size));
+}
+
+void *
+aligned_alloc (size_t alignment,
+               size_t size)
+{
+  if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+    {
+      errno = EINVAL;
+      return NULL;
+    }
+
+  return count_allocation (__libc_memalign (alignment, size));
+}
+
+int
+posix_memalign (void   **memptr,
+                size_t   alignment,
+                size_t   size)
+{
+  void *mem;
+
+  if (alignment % sizeof (void *) != 0 || (alignment & (alignment - 1)) != 0)
+    return EINVAL;
+
+  if (NULL == (mem = count_allocation (__libc_memalign (alignment, size))))
+    return ENOMEM;
+
+  *memptr = mem;
+
+  return 0;
+}
+
+void *
+valloc (size_t size)
+{
+  return count_allocation (__libc_valloc (size));
+}
+
+void *
+pvalloc (size_t size)
+{
+  return count_allocation (__libc_pvalloc (size));
+}
+
+void
+free (void *mem)
+{
+  if (mem != NULL)
+    g_atomic_int_inc (&n_frees);
+  __libc_free (mem);
+}
+
+# define HAVE_ALLOCATION_COUNT 1
+#endif
+
+typedef struct
+{
+  gint  n_allocations;
+  gint  n_frees;
+  gsize n_bytes;
+} AllocationCount;
+
+static void
+get_allocation_count (AllocationCount *count)
+{
+#ifdef HAVE_ALLOCATION_COUNT
+  count->n_allocations = g_atomic_int_get (&n_allocations);
+  count->n_frees = g_atomic_int_get (&n_frees);
+  count->n_bytes = (gsize)g_atomic_pointer_get (&n_allocated_bytes);
+#else
+  memset (count, 0, sizeof *count);
+#endif
+}
+
+typedef struct
+{
+  /* test1.gp4, repeated scale times */
+  GBytes *input;
+  gchar  *path;
+
+  /* Size of a single copy of test1.gp4 */
+  gsize   unit_len;
+
+  /* Size of the song header (everything up to the measure headers) */
+  gsize   header_len;
+
+  /* The song in test1.gp4, and a snapshot of it */
+  MusicianGptSong *song;
+  GBytes *snapshot;
+
+  /* A song with N_BENCH_MEASURES empty measures */
+  MusicianGptSong *long_song;
+
+  /* The files given with --corpus, or the copies of test1.gp4 */
+  GPtrArray *corpus;
+  gsize      corpus_len;
+
+  /* Set by cases that load whole songs, for the songs/s column */
+  guint   n_songs;
+
+  /* Generated songs of N_BENCH_GENERATED_MEASURES measures, 10x and 100x */
+  GBytes *generated[3];
+
+  /* Time spent in each section of the GP4 decoder by corpus-stages */
+  gint64  stage_usec[MUSICIAN_GP4_SECTION_DONE];
+
+  guint   scale;
+} Bench;
+
+typedef struct
+{
+  const gchar *name;
+  const gchar *description;
+  gboolean   (*run) (Bench   *bench,
+                     gsize   *n_bytes,
+                     GError **error);
+} BenchCase;
+
+#define N_BENCH_MEASURES 10000
+#define N_BENCH_GENERATED_MEASURES 20
+#define N_BENCH_GENERATED_TRACKS 8
+
+static gint scale = 512;
+static gint iterations = 5;
+static gchar **corpus;
+static gboolean json;
+
+static const GOptionEntry entries[] = {
+  { "scale", 's', 0, G_OPTION_ARG_INT, &scale, "Number of copies of test1.gp4 to decode", "N" },
+  { "iterations", 'i', 0, G_OPTION_ARG_INT, &iterations, "Number of times to run each case", "N" },
+  { "corpus", 'c', 0, G_OPTION_ARG_FILENAME_ARRAY, &corpus, "A .gp4 file or a directory of them for the corpus-* cases", "PATH" },
+  { "json", 'j', 0, G_OPTION_ARG_NONE, &json, "Print the results as JSON", NULL },
+  { NULL }
+};
+
+static const gchar *stage_names[MUSICIAN_GP4_SECTION_DONE] = {
+  "attributes",
+  "lyrics",
+  "midi-ports",
+  "measures",
+  "tracks",
+  "measure-pairs",
+};
+
+/* Remarks about a case go to stderr when stdout is for JSON */
+static void G_GNUC_PRINTF (1, 2)
+bench_note (const gchar *format,
+            ...)
+{
+  g_autofree gchar *message = NULL;
+  va_list args;
+
+  va_start (args, format);
+  message = g_strdup_vprintf (format, args);
+  va_end (args);
+
+  if (json)
+    g_printerr ("# %s\n", message);
+  else
+    g_print ("# %s\n", message);
+}
+
+/*
+ * Decodes the song header (everything up to the measure count) using the
+ * public reader API. This touches every kind of primitive we have.
+ */
+static gboolean
+decode_header (MusicianGptInputStream  *stream,
+               GError                 **error)
+{
+  const gchar * const *comments;
+  const gchar *version;
+  MusicianGptTripletFeel triplet_feel;
+  MusicianGptOctave octave;
+  MusicianGptKey key;
+  guint32 tempo;
+  guint32 track_num;
+  guint32 n_measures;
+  guint32 n_tracks;
+
+  if (NULL == (version = musician_gpt_input_stream_read_fixed_string_borrowed (stream, 30, NULL, error)))
+    return FALSE;
+
+  for (guint i = 0; i < 8; i++)
+    {
+      const gchar *str;
+
+      if (NULL == (str = musician_gpt_input_stream_read_string_borrowed (stream, NULL, error)))
+        return FALSE;
+    }
+
+  if (NULL == (comments = musician_gpt_input_stream_read_string_array_borrowed (stream, NULL, error)))
+    return FALSE;
+
+  if (!musician_gpt_input_stream_read_triplet_feel (stream, NULL, &triplet_feel, error) ||
+      !musician_gpt_input_stream_read_uint32 (stream, NULL, &track_num, error))
+    return FALSE;
+
+  for (guint i = 0; i < 5; i++)
+    {
+      const gchar *lyric;
+
+      if (NULL == (lyric = musician_gpt_input_stream_read_lyric_borrowed (stream, NULL, NULL, error)))
+        return FALSE;
+    }
+
+  if (!musician_gpt_input_stream_read_tempo (stream, NULL, &tempo, error) ||
+      !musician_gpt_input_stream_read_key (stream, NULL, &key, error) ||
+      !musician_gpt_input_stream_read_octave (stream, NULL, &octave, error))
+    return FALSE;
+
+  for (guint i = 0; i < 4; i++)
+    {
+      if (!musician_gpt_input_stream_read_midi_port (stream, i + 1, NULL, NULL, error))
+        return FALSE;
+    }
+
+  return musician_gpt_input_stream_read_uint32 (stream, NULL, &n_measures, error) &&
+         musician_gpt_input_stream_read_uint32 (stream, NULL, &n_tracks, error);
+}
+
+/*
+ * Decodes every copy of test1.gp4 in @stream. The header is decoded field
+ * by field, and the remainder of each copy is read one byte at a time, which
+ * is the access pattern of the measure and beat decoders.
+ */
+static gboolean
+decode_all (Bench                   *bench,
+            MusicianGptInputStream  *stream,
+            gsize                   *n_bytes,
+            GError                 **error)
+{
+  for (guint i = 0; i < bench->scale; i++)
+    {
+      if (!decode_header (stream, error))
+        return FALSE;
+
+      for (gsize j = bench->header_len; j < bench->unit_len; j++)
+        {
+          if (!musician_gpt_input_stream_read_byte (stream, NULL, NULL, error))
+            return FALSE;
+        }
+    }
+
+  *n_bytes = bench->unit_len * bench->scale;
+
+  return TRUE;
+}
+
+static gboolean
+bench_reader_stream (Bench   *bench,
+                     gsize   *n_bytes,
+                     GError **error)
+{
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+  g_autoptr(GFileInputStream) base_stream = NULL;
+  g_autoptr(GFile) file = g_file_new_for_path (bench->path);
+
+  if (NULL == (base_stream = g_file_read (file, NULL, error)))
+    return FALSE;
+
+  stream = musician_gpt_input_stream_new (G_INPUT_STREAM (base_stream));
+
+  return decode_all (bench, stream, n_bytes, error);
+}
+
+static gboolean
+bench_reader_mapped (Bench   *bench,
+                     gsize   *n_bytes,
+                     GError **error)
+{
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+  g_autoptr(GMappedFile) mapped = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+
+  if (NULL == (mapped = g_mapped_file_new (bench->path, FALSE, error)))
+    return FALSE;
+
+  bytes = g_mapped_file_get_bytes (mapped);
+  stream = musician_gpt_input_stream_new_for_bytes (bytes);
+
+  return decode_all (bench, stream, n_bytes, error);
+}
+
+/*
+ * The load-* and scan-* cases treat each copy of test1.gp4 as its own file,
+ * which is what a library indexer sees.
+ */
+static gboolean
+bench_load_bytes (Bench   *bench,
+                  gsize   *n_bytes,
+                  GError **error)
+{
+  for (guint i = 0; i < bench->scale; i++)
+    {
+      g_autoptr(MusicianGptParser) parser = musician_gpt_parser_new ();
+      g_autoptr(GBytes) unit = g_bytes_new_from_bytes (bench->input, i * bench->unit_len, bench->unit_len);
+
+      if (!musician_gpt_parser_load_from_bytes (parser, unit, NULL, error))
+        return FALSE;
+    }
+
+  bench->n_songs = bench->scale;
+  *n_bytes = bench->unit_len * bench->scale;
+
+  return TRUE;
+}
+
+/*
+ * Like load-bytes, but only records where each measure/track pair starts
+ * and then decodes the first measure, as a viewer opening the file would.
+ */
+static gboolean
+bench_load_lazy (Bench   *bench,
+                 gsize   *n_bytes,
+                 GError **error)
+{
+  for (guint i = 0; i < bench->scale; i++)
+    {
+      g_autoptr(MusicianGptParser) parser = musician_gpt_parser_new ();
+      g_autoptr(GBytes) unit = g_bytes_new_from_bytes (bench->input, i * bench->unit_len, bench->unit_len);
+      MusicianGptSong *song;
+      guint n_tracks;
+
+      musician_gpt_parser_set_lazy (parser, TRUE);
+
+      if (!musician_gpt_parser_load_from_bytes (parser, unit, NULL, error))
+        return FALSE;
+
+      song = musician_gpt_parser_get_song (parser);
+      n_tracks = musician_gpt_song_get_n_tracks (song);
+
+      for (guint track = 1; track <= n_tracks; track++)
+        {
+          g_autoptr(GPtrArray) beats = NULL;
+
+          if (NULL == (beats = musician_gpt_song_get_beats (song, 1, track, NULL, error)))
+            return FALSE;
+        }
+    }
+
+  bench->n_songs = bench->scale;
+  *n_bytes = bench->unit_len * bench->scale;
+
+  return TRUE;
+}
+
+/*
+ * Like load-bytes, but decodes the measure/track pairs of each copy on the
+ * shared decode pool. test1.gp4 only has one track, so this mostly shows
+ * the cost of the extra pass; multi-track files are where it pays off.
+ */
+static gboolean
+bench_load_parallel (Bench   *bench,
+                     gsize   *n_bytes,
+                     GError **error)
+{
+  for (guint i = 0; i < bench->scale; i++)
+    {
+      g_autoptr(MusicianGptParser) parser = musician_gpt_parser_new ();
+      g_autoptr(GBytes) unit = g_bytes_new_from_bytes (bench->input, i * bench->unit_len, bench->unit_len);
+
+      musician_gpt_parser_set_parallel (parser, TRUE);
+
+      if (!musician_gpt_parser_load_from_bytes (parser, unit, NULL, error))
+        return FALSE;
+    }
+
+  bench->n_songs = bench->scale;
+  *n_bytes = bench->unit_len * bench->scale;
+
+  return TRUE;
+}
+
+/*
+ * Loads each copy from a snapshot rather than from test1.gp4, and then
+ * asks for every block of beats so that as much is decoded as load-bytes
+ * does. The throughput is given in terms of the GP4 input so the two can
+ * be compared.
+ */
+static gboolean
+bench_snapshot_load (Bench   *bench,
+                     gsize   *n_bytes,
+                     GError **error)
+{
+  for (guint i = 0; i < bench->scale; i++)
+    {
+      g_autoptr(MusicianGptSong) song = NULL;
+      guint n_measures;
+      guint n_tracks;
+
+      if (NULL == (song = musician_gpt_snapshot_load_from_bytes (bench->snapshot, error)))
+        return FALSE;
+
+      n_measures = musician_gpt_song_get_n_measures (song);
+      n_tracks = musician_gpt_song_get_n_tracks (song);
+
+      for (guint measure = 1; measure <= n_measures; measure++)
+        {
+          for (guint track = 1; track <= n_tracks; track++)
+            {
+              g_autoptr(GPtrArray) beats = NULL;
+
+              if (NULL == (beats = musician_gpt_song_get_beats (song, measure, track, NULL, error)))
+                return FALSE;
+            }
+        }
+    }
+
+  bench->n_songs = bench->scale;
+  *n_bytes = bench->unit_len * bench->scale;
+
+  return TRUE;
+}
+
+/*
+ * Adds up the durations and counts the rests of every beat in the song,
+ * scale times, straight from the columns of its beat store. This is what
+ * gathering statistics about a track looks like.
+ */
+static gboolean
+bench_beat_scan (Bench   *bench,
+                 gsize   *n_bytes,
+                 GError **error)
+{
+  MusicianGptBeatStore *store;
+  const guint8 *durations;
+  const guint8 *modes;
+  guint64 total = 0;
+  guint n_rests = 0;
+  guint n_beats;
+
+  if (NULL == (store = musician_gpt_song_get_beat_store (bench->song, 1, NULL, error)))
+    return FALSE;
+
+  n_beats = musician_gpt_beat_store_get_n_beats (store);
+  durations = musician_gpt_beat_store_get_durations (store);
+  modes = musician_gpt_beat_store_get_modes (store);
+
+  for (guint i = 0; i < bench->scale; i++)
+    {
+      for (guint j = 0; j < n_beats; j++)
+        {
+          total += durations[j];
+          n_rests += modes[j] == MUSICIAN_GPT_BEAT_MODE_REST;
+        }
+    }
+
+  if (total == 0 && n_rests == 0)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED, "No beats were visited");
+      return FALSE;
+    }
+
+  *n_bytes = (gsize)n_beats * 2 * bench->scale;
+
+  return TRUE;
+}
+
+/*
+ * Walks the measures of a song with N_BENCH_MEASURES measures scale times,
+ * once through the measure array and once by id. The throughput is given
+ * in terms of the measure pointers visited.
+ */
+static gboolean
+bench_measure_iterate (Bench   *bench,
+                       gsize   *n_bytes,
+                       GError **error)
+{
+  MusicianGptMeasure **measures;
+  guint n_measures;
+  guint total = 0;
+
+  measures = musician_gpt_song_get_measures (bench->long_song, &n_measures);
+
+  for (guint i = 0; i < bench->scale; i++)
+    {
+      for (guint j = 0; j < n_measures; j++)
+        total += musician_gpt_measure_get_numerator (measures[j]);
+
+      for (guint id = 1; id <= n_measures; id++)
+        total += musician_gpt_measure_get_denominator (musician_gpt_song_get_measure (bench->long_song, id));
+    }
+
+  if (total == 0)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED, "No measures were visited");
+      return FALSE;
+    }
+
+  *n_bytes = sizeof (MusicianGptMeasure *) * n_measures * 2 * bench->scale;
+
+  return TRUE;
+}
+
+/*
+ * Creates the beats of every measure and track of the song, scale times,
+ * and keeps them all alive as a large song would. The first run reports
+ * how many chunks the song's pool needed for them, where each beat used
+ * to be an allocation of its own.
+ */
+static gboolean
+bench_beat_objects (Bench   *bench,
+                    gsize   *n_bytes,
+                    GError **error)
+{
+  static gboolean reported;
+  g_autoptr(GPtrArray) all = g_ptr_array_new_with_free_func ((GDestroyNotify)g_ptr_array_unref);
+  MusicianGptPool *pool = _musician_gpt_song_get_pool (bench->song);
+  guint n_measures = musician_gpt_song_get_n_measures (bench->song);
+  guint n_tracks = musician_gpt_song_get_n_tracks (bench->song);
+  guint n_objects = musician_gpt_pool_get_n_objects (pool);
+  guint n_chunks = musician_gpt_pool_get_n_chunks (pool);
+  guint n_beats = 0;
+
+  for (guint i = 0; i < bench->scale; i++)
+    {
+      for (guint measure = 1; measure <= n_measures; measure++)
+        {
+          for (guint track = 1; track <= n_tracks; track++)
+            {
+              GPtrArray *beats;
+
+              if (NULL == (beats = musician_gpt_song_get_beats (bench->song, measure, track, NULL, error)))
+                return FALSE;
+
+              n_beats += beats->len;
+              g_ptr_array_add (all, beats);
+            }
+        }
+    }
+
+  if (!reported)
+    {
+      bench_note ("beat-objects: %u beats from %u new pool chunks (%u allocations without the pool)",
+               musician_gpt_pool_get_n_objects (pool) - n_objects,
+               musician_gpt_pool_get_n_chunks (pool) - n_chunks,
+               n_beats);
+      reported = TRUE;
+    }
+
+  *n_bytes = (gsize)n_beats * sizeof (MusicianGptBeat *);
+
+  return TRUE;
+}
+
+/*
+ * The measure-setters and measure-info cases build N_BENCH_MEASURES
+ * measures the way the parser used to, one notifying setter per field, and
+ * the way it does now, in one go from a MusicianGptMeasureInfo.
+ */
+static gboolean
+bench_measure_setters (Bench   *bench,
+                       gsize   *n_bytes,
+                       GError **error)
+{
+  g_autoptr(GPtrArray) measures = g_ptr_array_new_with_free_func (g_object_unref);
+
+  for (guint id = 1; id <= N_BENCH_MEASURES; id++)
+    {
+      MusicianGptMeasure *measure = musician_gpt_measure_new ();
+
+      musician_gpt_measure_set_id (measure, id);
+      musician_gpt_measure_set_numerator (measure, 3);
+      musician_gpt_measure_set_denominator (measure, 8);
+      musician_gpt_measure_set_n_repeats (measure, 2);
+      musician_gpt_measure_set_nth_ending (measure, 1);
+      musician_gpt_measure_set_key (measure, MUSICIAN_GPT_KEY_G);
+
+      g_ptr_array_add (measures, measure);
+    }
+
+  *n_bytes = sizeof (MusicianGptMeasureInfo) * N_BENCH_MEASURES;
+
+  return TRUE;
+}
+
+static gboolean
+bench_measure_info (Bench   *bench,
+                    gsize   *n_bytes,
+                    GError **error)
+{
+  g_autoptr(GPtrArray) measures = g_ptr_array_new_with_free_func (g_object_unref);
+  MusicianGptMeasureInfo info = { 0 };
+
+  info.numerator = 3;
+  info.denominator = 8;
+  info.n_repeats = 2;
+  info.nth_ending = 1;
+  info.key = MUSICIAN_GPT_KEY_G;
+
+  for (guint id = 1; id <= N_BENCH_MEASURES; id++)
+    {
+      info.id = id;
+      g_ptr_array_add (measures, _musician_gpt_measure_new_from_info (&info, NULL));
+    }
+
+  *n_bytes = sizeof (MusicianGptMeasureInfo) * N_BENCH_MEASURES;
+
+  return TRUE;
+}
+
+static gboolean
+bench_scan_bytes (Bench   *bench,
+                  gsize   *n_bytes,
+                  GError **error)
+{
+  g_autoptr(MusicianGptParser) parser = musician_gpt_parser_new ();
+
+  for (guint i = 0; i < bench->scale; i++)
+    {
+      g_autoptr(GBytes) unit = g_bytes_new_from_bytes (bench->input, i * bench->unit_len, bench->unit_len);
+      g_autoptr(MusicianGptMetadata) metadata = NULL;
+
+      if (NULL == (metadata = musician_gpt_parser_scan_from_bytes (parser, unit, NULL, error)))
+        return FALSE;
+    }
+
+  *n_bytes = bench->unit_len * bench->scale;
+
+  return TRUE;
+}
+
+/*
+ * The stall-* cases load every copy while a 1 msec timeout ticks on the
+ * main loop, and report the longest gap between ticks. This is how long a
+ * UI would have been frozen.
+ */
+typedef struct
+{
+  GMainLoop *main_loop;
+  Bench     *bench;
+  GError    *error;
+  gint64     last_tick;
+  gint64     max_stall;
+  guint      n_pending;
+} Stall;
+
+static gboolean
+stall_tick (gpointer user_data)
+{
+  Stall *stall = user_data;
+  gint64 now = g_get_monotonic_time ();
+
+  stall->max_stall = MAX (stall->max_stall, now - stall->last_tick);
+  stall->last_tick = now;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+stall_run (Stall       *stall,
+           const gchar *name)
+{
+  guint tick;
+
+  stall->main_loop = g_main_loop_new (NULL, FALSE);
+  stall->last_tick = g_get_monotonic_time ();
+  tick = g_timeout_add (1, stall_tick, stall);
+
+  g_main_loop_run (stall->main_loop);
+
+  g_source_remove (tick);
+  g_clear_pointer (&stall->main_loop, g_main_loop_unref);
+
+  bench_note ("%s: longest main loop stall %.3f ms", name, stall->max_stall / 1000.0);
+}
+
+static gboolean
+stall_sync_idle (gpointer user_data)
+{
+  Stall *stall = user_data;
+  Bench *bench = stall->bench;
+
+  for (guint i = 0; i < bench->scale; i++)
+    {
+      g_autoptr(MusicianGptParser) parser = musician_gpt_parser_new ();
+      g_autoptr(GBytes) unit = g_bytes_new_from_bytes (bench->input, i * bench->unit_len, bench->unit_len);
+      g_autoptr(GInputStream) stream = g_memory_input_stream_new_from_bytes (unit);
+
+      if (!musician_gpt_parser_load_from_stream (parser, stream, NULL, &stall->error))
+        break;
+    }
+
+  g_main_loop_quit (stall->main_loop);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+bench_stall_sync (Bench   *bench,
+                  gsize   *n_bytes,
+                  GError **error)
+{
+  Stall stall = { 0 };
+
+  stall.bench = bench;
+  g_idle_add (stall_sync_idle, &stall);
+  stall_run (&stall, "stall-sync");
+
+  if (stall.error != NULL)
+    {
+      g_propagate_error (error, stall.error);
+      return FALSE;
+    }
+
+  *n_bytes = bench->unit_len * bench->scale;
+
+  return TRUE;
+}
+
+static void
+stall_async_cb (GObject      *object,
+                GAsyncResult *result,
+                gpointer      user_data)
+{
+  MusicianGptParser *parser = (MusicianGptParser *)object;
+  Stall *stall = user_data;
+  GError *error = NULL;
+
+  if (!musician_gpt_parser_load_from_stream_finish (parser, result, &error))
+    {
+      if (stall->error == NULL)
+        stall->error = error;
+      else
+        g_error_free (error);
+    }
+
+  if (--stall->n_pending == 0)
+    g_main_loop_quit (stall->main_loop);
+}
+
+static gboolean
+bench_stall_async (Bench   *bench,
+                   gsize   *n_bytes,
+                   GError **error)
+{
+  Stall stall = { 0 };
+
+  stall.bench = bench;
+  stall.n_pending = bench->scale;
+
+  for (guint i = 0; i < bench->scale; i++)
+    {
+      g_autoptr(MusicianGptParser) parser = musician_gpt_parser_new ();
+      g_autoptr(GBytes) unit = g_bytes_new_from_bytes (bench->input, i * bench->unit_len, bench->unit_len);
+      g_autoptr(GInputStream) stream = g_memory_input_stream_new_from_bytes (unit);
+
+      musician_gpt_parser_load_from_stream_async (parser, stream, NULL, stall_async_cb, &stall);
+    }
+
+  stall_run (&stall, "stall-async");
+
+  if (stall.error != NULL)
+    {
+      g_propagate_error (error, stall.error);
+      return FALSE;
+    }
+
+  *n_bytes = bench->unit_len * bench->scale;
+
+  return TRUE;
+}
+
+/*
+ * Full parse of every file of the corpus, as the ingestion of a library
+ * would do it.
+ */
+static gboolean
+bench_corpus_load (Bench   *bench,
+                   gsize   *n_bytes,
+                   GError **error)
+{
+  for (guint i = 0; i < bench->corpus->len; i++)
+    {
+      g_autoptr(MusicianGptParser) parser = musician_gpt_parser_new ();
+
+      if (!musician_gpt_parser_load_from_bytes (parser, g_ptr_array_index (bench->corpus, i), NULL, error))
+        return FALSE;
+    }
+
+  bench->n_songs = bench->corpus->len;
+  *n_bytes = bench->corpus_len;
+
+  return TRUE;
+}
+
+/*
+ * Like corpus-load, but steps the GP4 decoder by hand so that the time of
+ * each record can be charged to the section it belongs to. Reading the
+ * clock around every record costs a little, so the total is somewhat
+ * slower than corpus-load. Files in other formats are skipped.
+ */
+static gboolean
+bench_corpus_stages (Bench   *bench,
+                     gsize   *n_bytes,
+                     GError **error)
+{
+  *n_bytes = 0;
+
+  for (guint i = 0; i < bench->corpus->len; i++)
+    {
+      GBytes *bytes = g_ptr_array_index (bench->corpus, i);
+      g_autoptr(MusicianGptInputStream) stream = musician_gpt_input_stream_new_for_bytes (bytes);
+      g_autoptr(MusicianGptParser) subparser = NULL;
+      MusicianGp4Decoder decoder;
+      const gchar *version;
+      gboolean ret = TRUE;
+
+      if (NULL == (version = musician_gpt_input_stream_read_fixed_string_borrowed (stream, 30, NULL, error)))
+        return FALSE;
+
+      subparser = _musician_gpt_parser_create_subparser (version, NULL);
+      if (!MUSICIAN_IS_GP4_PARSER (subparser))
+        continue;
+
+      _musician_gp4_decoder_init (&decoder, version, _musician_gpt_input_stream_get_arena (stream), NULL, NULL);
+
+      while (ret && decoder.section != MUSICIAN_GP4_SECTION_DONE)
+        {
+          MusicianGp4Section section = decoder.section;
+          gint64 begin = g_get_monotonic_time ();
+
+          ret = _musician_gp4_parser_step (MUSICIAN_GP4_PARSER (subparser), &decoder, stream, NULL, error);
+          bench->stage_usec[section] += g_get_monotonic_time () - begin;
+        }
+
+      _musician_gp4_decoder_clear (&decoder);
+
+      if (!ret)
+        return FALSE;
+
+      bench->n_songs++;
+      *n_bytes += g_bytes_get_size (bytes);
+    }
+
+  return TRUE;
+}
+
+/*
+ * Full parse of each generated song. The time per measure is printed for
+ * each size, and should stay about the same from one size to the next.
+ */
+static gboolean
+bench_generated_scaling (Bench   *bench,
+                         gsize   *n_bytes,
+                         GError **error)
+{
+  *n_bytes = 0;
+
+  for (guint i = 0; i < G_N_ELEMENTS (bench->generated); i++)
+    {
+      g_autoptr(MusicianGptParser) parser = musician_gpt_parser_new ();
+      MusicianGptSong *song;
+      gint64 begin = g_get_monotonic_time ();
+      gint64 elapsed;
+      guint n_measures;
+
+      if (!musician_gpt_parser_load_from_bytes (parser, bench->generated[i], NULL, error))
+        return FALSE;
+
+      elapsed = g_get_monotonic_time () - begin;
+      song = musician_gpt_parser_get_song (parser);
+      n_measures = musician_gpt_song_get_n_measures (song);
+
+      bench_note ("generated-scaling: %u measures x %u tracks, %.3f usec/measure",
+                  n_measures, musician_gpt_song_get_n_tracks (song),
+                  (gdouble)elapsed / n_measures);
+
+      *n_bytes += g_bytes_get_size (bench->generated[i]);
+    }
+
+  bench->n_songs = G_N_ELEMENTS (bench->generated);
+
+  return TRUE;
+}
+
+static const BenchCase cases[] = {
+  { "reader-stream", "GDataInputStream over a GFileInputStream", bench_reader_stream },
+  { "reader-mapped", "Cursor over a GMappedFile", bench_reader_mapped },
+  { "load-bytes", "Full parse of each copy", bench_load_bytes },
+  { "load-lazy", "Lazy parse of each copy, then its first measure", bench_load_lazy },
+  { "load-parallel", "Full parse of each copy, decoding beats on all cores", bench_load_parallel },
+  { "snapshot-load", "Load of each copy from a snapshot, with all of its beats", bench_snapshot_load },
+  { "beat-scan", "Scan of the duration and mode columns of a track", bench_beat_scan },
+  { "beat-objects", "Creation of every beat of the song, kept alive", bench_beat_objects },
+  { "measure-iterate", "Walk of 10000 measures, in order and by id", bench_measure_iterate },
+  { "measure-setters", "Creation of 10000 measures, one setter per field", bench_measure_setters },
+  { "measure-info", "Creation of 10000 measures from a MusicianGptMeasureInfo", bench_measure_info },
+  { "scan-bytes", "Metadata scan of each copy", bench_scan_bytes },
+  { "stall-sync", "Blocking load of each copy from the main loop", bench_stall_sync },
+  { "stall-async", "Asynchronous load of each copy on the worker pool", bench_stall_async },
+  { "corpus-load", "Full parse of each file of the corpus", bench_corpus_load },
+  { "corpus-stages", "Parse of each GP4 file of the corpus, timing each section", bench_corpus_stages },
+  { "generated-scaling", "Full parse of generated songs 10x and 100x larger", bench_generated_scaling },
+};
+
+static gboolean
+bench_add_corpus_file (Bench        *bench,
+                       const gchar  *path,
+                       GError      **error)
+{
+  gchar *contents = NULL;
+  gsize len = 0;
+
+  if (!g_file_get_contents (path, &contents, &len, error))
+    return FALSE;
+
+  g_ptr_array_add (bench->corpus, g_bytes_new_take (contents, len));
+  bench->corpus_len += len;
+
+  return TRUE;
+}
+
+static gint
+compare_paths (gconstpointer a,
+               gconstpointer b)
+{
+  return g_strcmp0 (*(const gchar * const *)a, *(const gchar * const *)b);
+}
+
+/* Directories contribute their .gp4 files, in a stable order */
+static gboolean
+bench_add_corpus (Bench        *bench,
+                  const gchar  *path,
+                  GError      **error)
+{
+  g_autoptr(GPtrArray) paths = NULL;
+  g_autoptr(GDir) dir = NULL;
+  const gchar *name;
+
+  if (!g_file_test (path, G_FILE_TEST_IS_DIR))
+    return bench_add_corpus_file (bench, path, error);
+
+  if (NULL == (dir = g_dir_open (path, 0, error)))
+    return FALSE;
+
+  paths = g_ptr_array_new_with_free_func (g_free);
+
+  while (NULL != (name = g_dir_read_name (dir)))
+    {
+      g_autofree gchar *lower = g_ascii_strdown (name, -1);
+
+      if (g_str_has_suffix (lower, ".gp4"))
+        g_ptr_array_add (paths, g_build_filename (path, name, NULL));
+    }
+
+  g_ptr_array_sort (paths, compare_paths);
+
+  for (guint i = 0; i < paths->len; i++)
+    {
+      if (!bench_add_corpus_file (bench, g_ptr_array_index (paths, i), error))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+bench_init (Bench   *bench,
+            GError **error)
+{
+  g_autofree gchar *unit_path = g_build_filename (TESTS_SRCDIR, "data", "test1.gp4", NULL);
+  g_autoptr(MusicianGptParser) parser = musician_gpt_parser_new ();
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+  g_autoptr(GByteArray) buffer = NULL;
+  g_autoptr(GBytes) unit = NULL;
+  g_autofree gchar *contents = NULL;
+  gsize len;
+  gint fd;
+
+  if (!g_file_get_contents (unit_path, &contents, &len, error))
+    return FALSE;
+
+  /* Find out where the header ends so decode_all() knows how much to drain */
+  unit = g_bytes_new_static (contents, len);
+  stream = musician_gpt_input_stream_new_for_bytes (unit);
+
+  if (!decode_header (stream, error))
+    return FALSE;
+
+  bench->header_len = len;
+  while (musician_gpt_input_stream_read_byte (stream, NULL, NULL, NULL))
+    bench->header_len--;
+
+  if (!musician_gpt_parser_load_from_bytes (parser, unit, NULL, error))
+    return FALSE;
+
+  bench->song = g_object_ref (musician_gpt_parser_get_song (parser));
+
+  if (NULL == (bench->snapshot = musician_gpt_snapshot_serialize (bench->song, NULL, error)))
+    return FALSE;
+
+  bench->long_song = musician_gpt_song_new ();
+  for (guint id = 1; id <= N_BENCH_MEASURES; id++)
+    {
+      g_autoptr(MusicianGptMeasure) measure = musician_gpt_measure_new ();
+
+      musician_gpt_measure_set_id (measure, id);
+      musician_gpt_song_add_measure (bench->long_song, measure);
+    }
+
+  buffer = g_byte_array_sized_new (len * bench->scale);
+  for (guint i = 0; i < bench->scale; i++)
+    g_byte_array_append (buffer, (const guint8 *)contents, len);
+
+  bench->unit_len = len;
+  bench->input = g_byte_array_free_to_bytes (g_steal_pointer (&buffer));
+
+  bench->corpus = g_ptr_array_new_with_free_func ((GDestroyNotify)g_bytes_unref);
+
+  if (corpus != NULL)
+    {
+      for (guint i = 0; corpus[i]; i++)
+        {
+          if (!bench_add_corpus (bench, corpus[i], error))
+            return FALSE;
+        }
+    }
+  else
+    {
+      for (guint i = 0; i < bench->scale; i++)
+        g_ptr_array_add (bench->corpus, g_bytes_new_from_bytes (bench->input, i * len, len));
+      bench->corpus_len = len * bench->scale;
+    }
+
+  for (guint i = 0, n_measures = N_BENCH_GENERATED_MEASURES; i < G_N_ELEMENTS (bench->generated); i++, n_measures *= 10)
+    {
+      Gp4GeneratorOptions options;
+
+      gp4_generator_options_init (&options);
+      options.n_measures = n_measures;
+      options.n_tracks = N_BENCH_GENERATED_TRACKS;
+
+      bench->generated[i] = gp4_generator_generate (&options, NULL);
+    }
+
+  if (-1 == (fd = g_file_open_tmp ("bench-gpt-parser-XXXXXX.gp4", &bench->path, error)))
+    return FALSE;
+  close (fd);
+
+  return g_file_set_contents (bench->path,
+                              g_bytes_get_data (bench->input, NULL),
+                              g_bytes_get_size (bench->input),
+                              error);
+}
+
+static void
+bench_clear (Bench *bench)
+{
+  if (bench->path != NULL)
+    g_unlink (bench->path);
+
+  g_clear_pointer (&bench->path, g_free);
+  g_clear_pointer (&bench->input, g_bytes_unref);
+  g_clear_pointer (&bench->snapshot, g_bytes_unref);
+  g_clear_pointer (&bench->corpus, g_ptr_array_unref);
+
+  for (guint i = 0; i < G_N_ELEMENTS (bench->generated); i++)
+    g_clear_pointer (&bench->generated[i], g_bytes_unref);
+  g_clear_object (&bench->song);
+  g_clear_object (&bench->long_song);
+}
+
+/* The best run of a case */
+typedef struct
+{
+  gdouble seconds;
+  gsize   n_bytes;
+  guint   n_songs;
+  gint    n_allocations;
+  gint    n_frees;
+  gsize   n_allocated_bytes;
+  gint64  stage_usec[MUSICIAN_GP4_SECTION_DONE];
+} BenchResult;
+
+/* In KiB, which is what Linux reports */
+static glong
+get_peak_rss (void)
+{
+  struct rusage usage;
+
+  if (getrusage (RUSAGE_SELF, &usage) != 0)
+    return -1;
+
+  return usage.ru_maxrss;
+}
+
+static void
+print_result (const BenchCase   *bench_case,
+              const BenchResult *result,
+              gboolean           first)
+{
+  gdouble mb_per_sec = result->n_bytes / result->seconds / (1024.0 * 1024.0);
+  gdouble songs_per_sec = result->n_songs / result->seconds;
+  gboolean has_stages = FALSE;
+
+  for (guint i = 0; i < G_N_ELEMENTS (result->stage_usec); i++)
+    has_stages |= result->stage_usec[i] != 0;
+
+  if (!json)
+    {
+      g_print ("%-24s %10.2f MB/s  %8.3f ms  (%s)\n",
+               bench_case->name,
+               mb_per_sec,
+               result->seconds * 1000.0,
+               bench_case->description);
+
+      if (result->n_songs > 0)
+        g_print ("%-24s %10.2f songs/s\n", "", songs_per_sec);
+
+#ifdef HAVE_ALLOCATION_COUNT
+      g_print ("%-24s %10d allocations, %"G_GSIZE_FORMAT" bytes, %d frees\n",
+               "", result->n_allocations, result->n_allocated_bytes, result->n_frees);
+#endif
+      g_print ("%-24s peak RSS %ld KiB\n", "", get_peak_rss ());
+
+      for (guint i = 0; has_stages && i < G_N_ELEMENTS (result->stage_usec); i++)
+        g_print ("%-24s %10.3f ms  %s\n", "", result->stage_usec[i] / 1000.0, stage_names[i]);
+
+      return;
+    }
+
+  /* Names and descriptions are ours, and need no escaping */
+  g_print ("%s\n    { \"name\": \"%s\", \"description\": \"%s\",\n",
+           first ? "" : ",", bench_case->name, bench_case->description);
+  g_print ("      \"seconds\": %.6f, \"bytes\": %"G_GSIZE_FORMAT", \"mb_per_sec\": %.3f,\n",
+           result->seconds, result->n_bytes, mb_per_sec);
+
+  if (result->n_songs > 0)
+    g_print ("      \"songs\": %u, \"songs_per_sec\": %.3f,\n", result->n_songs, songs_per_sec);
+
+#ifdef HAVE_ALLOCATION_COUNT
+  g_print ("      \"allocations\": %d, \"allocated_bytes\": %"G_GSIZE_FORMAT", \"frees\": %d,\n",
+           result->n_allocations, result->n_allocated_bytes, result->n_frees);
+#endif
+
+  if (has_stages)
+    {
+      g_print ("      \"stages\": {");
+      for (guint i = 0; i < G_N_ELEMENTS (result->stage_usec); i++)
+        g_print ("%s \"%s\": %.6f", i ? "," : "", stage_names[i], result->stage_usec[i] / (gdouble)G_USEC_PER_SEC);
+      g_print (" },\n");
+    }
+
+  g_print ("      \"peak_rss_kib\": %ld }", get_peak_rss ());
+}
+
+static gboolean
+should_run (const BenchCase  *bench_case,
+            gchar           **filter)
+{
+  if (filter == NULL || filter[0] == NULL)
+    return TRUE;
+
+  for (guint i = 0; filter[i]; i++)
+    {
+      if (g_str_equal (filter[i], bench_case->name))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+gint
+main (gint   argc,
+      gchar *argv[])
+{
+  g_autoptr(GOptionContext) context = NULL;
+  g_autoptr(GError) error = NULL;
+  Bench bench = { 0 };
+  gboolean first = TRUE;
+
+  context = g_option_context_new ("[CASE...] - benchmark the Guitar Pro parser");
+  g_option_context_add_main_entries (context, entries, NULL);
+
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      return EXIT_FAILURE;
+    }
+
+  bench.scale = MAX (1, scale);
+
+  if (!bench_init (&bench, &error))
+    {
+      g_printerr ("Failed to prepare input: %s\n", error->message);
+      bench_clear (&bench);
+      return EXIT_FAILURE;
+    }
+
+  if (json)
+    g_print ("{\n  \"input\": { \"bytes\": %"G_GSIZE_FORMAT", \"scale\": %u, \"corpus_files\": %u, \"corpus_bytes\": %"G_GSIZE_FORMAT" },\n  \"cases\": [",
+             g_bytes_get_size (bench.input), bench.scale, bench.corpus->len, bench.corpus_len);
+  else
+    g_print ("# input: %"G_GSIZE_FORMAT" bytes (test1.gp4 x %u), corpus: %u files, %"G_GSIZE_FORMAT" bytes\n",
+             g_bytes_get_size (bench.input), bench.scale, bench.corpus->len, bench.corpus_len);
+
+  for (guint i = 0; i < G_N_ELEMENTS (cases); i++)
+    {
+      const BenchCase *bench_case = &cases[i];
+      BenchResult best = { G_MAXDOUBLE };
+
+      if (!should_run (bench_case, &argv[1]))
+        continue;
+
+      for (gint j = 0; j < MAX (1, iterations); j++)
+        {
+          gint64 begin;
+          AllocationCount before;
+          AllocationCount after;
+          gdouble elapsed;
+          gsize n_bytes = 0;
+
+          bench.n_songs = 0;
+          memset (bench.stage_usec, 0, sizeof bench.stage_usec);
+
+          get_allocation_count (&before);
+          begin = g_get_monotonic_time ();
+
+          if (!bench_case->run (&bench, &n_bytes, &error))
+            {
+              g_printerr ("%s: %s\n", bench_case->name, error->message);
+              bench_clear (&bench);
+              return EXIT_FAILURE;
+            }
+
+          elapsed = (g_get_monotonic_time () - begin) / (gdouble)G_USEC_PER_SEC;
+          get_allocation_count (&after);
+
+          if (elapsed < best.seconds)
+            {
+              best.seconds = elapsed;
+              best.n_bytes = n_bytes;
+              best.n_songs = bench.n_songs;
+              best.n_allocations = after.n_allocations - before.n_allocations;
+              best.n_frees = after.n_frees - before.n_frees;
+              best.n_allocated_bytes = after.n_bytes - before.n_bytes;
+              memcpy (best.stage_usec, bench.stage_usec, sizeof best.stage_usec);
+            }
+        }
+
+      print_result (bench_case, &best, first);
+      first = FALSE;
+    }
+
+  if (json)
+    g_print ("\n  ]\n}\n");
+
+  bench_clear (&bench);
+
+  return EXIT_SUCCESS;
+}
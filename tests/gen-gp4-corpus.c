@@ -0,0 +1,133 @@
+/* gen-gp4-corpus.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+
+#include "gp4-generator.h"
+
+/*
+ * Writes a directory of generated .gp4 files, for bench-gpt-parser:
+ *
+ *   ./gen-gp4-corpus --measures=1000 --tracks=8 --count=50 DIR
+ *   ./bench-gpt-parser --corpus=DIR corpus-load corpus-stages
+ *
+ * File N is generated with --seed + N, so the same command line always
+ * writes the same files.
+ */
+
+static gint n_measures = 100;
+static gint n_tracks = 4;
+static gint n_beats = 4;
+static gdouble chord_rate = 0.05;
+static gdouble bend_rate = 0.05;
+static gdouble text_rate = 0.02;
+static gint n_chord_names = 24;
+static gint lyrics_len = 256;
+static gint seed = 1;
+static gint count = 1;
+
+static const GOptionEntry entries[] = {
+  { "measures", 'm', 0, G_OPTION_ARG_INT, &n_measures, "Number of measures in each file", "N" },
+  { "tracks", 't', 0, G_OPTION_ARG_INT, &n_tracks, "Number of tracks in each file", "N" },
+  { "beats", 'b', 0, G_OPTION_ARG_INT, &n_beats, "Number of beats in each measure of a track", "N" },
+  { "chords", 0, 0, G_OPTION_ARG_DOUBLE, &chord_rate, "Fraction of beats with a chord diagram", "RATE" },
+  { "bends", 0, 0, G_OPTION_ARG_DOUBLE, &bend_rate, "Fraction of beats with a bend", "RATE" },
+  { "texts", 0, 0, G_OPTION_ARG_DOUBLE, &text_rate, "Fraction of beats with a text", "RATE" },
+  { "chord-names", 0, 0, G_OPTION_ARG_INT, &n_chord_names, "Number of distinct chord names", "N" },
+  { "lyrics", 'l', 0, G_OPTION_ARG_INT, &lyrics_len, "Length of the lyrics in bytes", "N" },
+  { "seed", 's', 0, G_OPTION_ARG_INT, &seed, "Seed of the first file", "N" },
+  { "count", 'n', 0, G_OPTION_ARG_INT, &count, "Number of files to write", "N" },
+  { NULL }
+};
+
+gint
+main (gint   argc,
+      gchar *argv[])
+{
+  g_autoptr(GOptionContext) context = NULL;
+  g_autoptr(GError) error = NULL;
+  Gp4GeneratorOptions options;
+  gsize total = 0;
+
+  context = g_option_context_new ("DIRECTORY - write generated Guitar Pro 4 files");
+  g_option_context_add_main_entries (context, entries, NULL);
+
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      return EXIT_FAILURE;
+    }
+
+  if (argc != 2)
+    {
+      g_printerr ("usage: %s [OPTION...] DIRECTORY\n", g_get_prgname ());
+      return EXIT_FAILURE;
+    }
+
+  if (n_measures < 1 || n_tracks < 1 || n_beats < 0 || lyrics_len < 0 || count < 0)
+    {
+      g_printerr ("--measures and --tracks must be positive, the others may not be negative\n");
+      return EXIT_FAILURE;
+    }
+
+  if (g_mkdir_with_parents (argv[1], 0750) != 0)
+    {
+      g_printerr ("Failed to create %s: %s\n", argv[1], g_strerror (errno));
+      return EXIT_FAILURE;
+    }
+
+  gp4_generator_options_init (&options);
+  options.n_measures = n_measures;
+  options.n_tracks = n_tracks;
+  options.n_beats = n_beats;
+  options.chord_rate = chord_rate;
+  options.bend_rate = bend_rate;
+  options.text_rate = text_rate;
+  options.n_chord_names = MAX (1, n_chord_names);
+  options.lyrics_len = lyrics_len;
+
+  for (gint i = 0; i < count; i++)
+    {
+      g_autoptr(GBytes) bytes = NULL;
+      g_autofree gchar *name = NULL;
+      g_autofree gchar *path = NULL;
+
+      options.seed = seed + i;
+
+      bytes = gp4_generator_generate (&options, NULL);
+      name = g_strdup_printf ("generated-%04d.gp4", i);
+      path = g_build_filename (argv[1], name, NULL);
+
+      if (!g_file_set_contents (path,
+                                g_bytes_get_data (bytes, NULL),
+                                g_bytes_get_size (bytes),
+                                &error))
+        {
+          g_printerr ("%s\n", error->message);
+          return EXIT_FAILURE;
+        }
+
+      total += g_bytes_get_size (bytes);
+    }
+
+  g_print ("Wrote %d files, %"G_GSIZE_FORMAT" bytes, to %s\n", count, total, argv[1]);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,448 @@
+/* gp4-generator.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <musician.h>
+#include <string.h>
+
+#include "gp4-generator.h"
+
+/*
+ * This writes the records in the order and layout that MusicianGp4Parser
+ * reads them, with everything the parser skips over zeroed. Each note is
+ * a plain fretted note, with a bend or a grace note when the beat is given
+ * one.
+ */
+
+#define N_STRINGS 6
+
+static const gchar *chord_roots[] = {
+  "C", "C#", "D", "Eb", "E", "F", "F#", "G", "Ab", "A", "Bb", "B",
+};
+
+static const gchar *chord_kinds[] = {
+  "", "m", "7", "m7", "maj7", "sus2", "sus4", "dim", "aug", "6", "9", "add9",
+};
+
+static void
+put_byte (GByteArray *buffer,
+          guint8      value)
+{
+  g_byte_array_append (buffer, &value, 1);
+}
+
+static void
+put_zeroes (GByteArray *buffer,
+            gsize       n_bytes)
+{
+  static const guint8 zeroes[64] = { 0 };
+
+  while (n_bytes > 0)
+    {
+      gsize n = MIN (n_bytes, sizeof zeroes);
+
+      g_byte_array_append (buffer, zeroes, n);
+      n_bytes -= n;
+    }
+}
+
+static void
+put_uint32 (GByteArray *buffer,
+            guint32     value)
+{
+  value = GUINT32_TO_LE (value);
+  g_byte_array_append (buffer, (const guint8 *)&value, sizeof value);
+}
+
+/* A 32-bit length, then a 1-byte length and the string */
+static void
+put_string (GByteArray  *buffer,
+            const gchar *str)
+{
+  gsize len = MIN (strlen (str), G_MAXUINT8);
+
+  put_uint32 (buffer, len + 1);
+  put_byte (buffer, len);
+  g_byte_array_append (buffer, (const guint8 *)str, len);
+}
+
+/* A 1-byte length, then the string padded out to @max_length */
+static void
+put_fixed_string (GByteArray  *buffer,
+                  const gchar *str,
+                  guint8       max_length)
+{
+  gsize len = MIN (strlen (str), max_length);
+
+  put_byte (buffer, len);
+  g_byte_array_append (buffer, (const guint8 *)str, len);
+  put_zeroes (buffer, max_length - len);
+}
+
+static void
+put_color (GByteArray *buffer,
+           guint8      red,
+           guint8      green,
+           guint8      blue)
+{
+  put_byte (buffer, red);
+  put_byte (buffer, green);
+  put_byte (buffer, blue);
+  put_byte (buffer, 0);
+}
+
+static void
+put_header (GByteArray                *buffer,
+            const Gp4GeneratorOptions *options)
+{
+  g_autofree gchar *title = NULL;
+  g_autoptr(GString) lyrics = g_string_new (NULL);
+
+  put_fixed_string (buffer, "FICHIER GUITAR PRO v4.06", 30);
+
+  /* Title, subtitle, interpretation, album, artist, copyright, writer and instructions */
+  title = g_strdup_printf ("Generated %u", options->seed);
+  put_string (buffer, title);
+  put_string (buffer, "");
+  put_string (buffer, "");
+  put_string (buffer, "Synthetic");
+  put_string (buffer, "gnome-musician");
+  put_string (buffer, "");
+  put_string (buffer, "");
+  put_string (buffer, "");
+
+  put_uint32 (buffer, options->n_comments);
+  for (guint i = 0; i < options->n_comments; i++)
+    {
+      g_autofree gchar *comment = g_strdup_printf ("Comment %u", i + 1);
+
+      put_string (buffer, comment);
+    }
+
+  /* No triplet feel */
+  put_byte (buffer, 0);
+
+  /* The lyrics track, then the first line of lyrics and four empty ones */
+  while (lyrics->len < options->lyrics_len)
+    g_string_append (lyrics, "la ");
+  g_string_truncate (lyrics, options->lyrics_len);
+
+  put_uint32 (buffer, 1);
+  for (guint i = 0; i < 5; i++)
+    {
+      gsize len = i == 0 ? lyrics->len : 0;
+
+      put_uint32 (buffer, 1);
+      put_uint32 (buffer, len);
+      g_byte_array_append (buffer, (const guint8 *)lyrics->str, len);
+    }
+
+  /* Tempo, key and octave */
+  put_uint32 (buffer, 120);
+  put_uint32 (buffer, 0);
+  put_byte (buffer, 0);
+
+  /* Instrument, volume, balance, chorus, reverb, phaser, tremolo and padding */
+  for (guint port = 0; port < 4; port++)
+    {
+      for (guint channel = 0; channel < 16; channel++)
+        {
+          put_uint32 (buffer, 25);
+          put_byte (buffer, 13);
+          put_byte (buffer, 8);
+          put_zeroes (buffer, 4 + 2);
+        }
+    }
+
+  put_uint32 (buffer, options->n_measures);
+  put_uint32 (buffer, options->n_tracks);
+}
+
+static void
+put_measures (GByteArray                *buffer,
+              const Gp4GeneratorOptions *options)
+{
+  for (guint i = 0; i < options->n_measures; i++)
+    {
+      MusicianGptMeasureFlags flags = MUSICIAN_GPT_MEASURE_FLAGS_NONE;
+
+      if (i == 0)
+        flags |= MUSICIAN_GPT_MEASURE_FLAGS_KEY_NUMERATOR | MUSICIAN_GPT_MEASURE_FLAGS_KEY_DENOMINATOR;
+
+      /* A marker at the start of every section of 16 measures */
+      if (i % 16 == 0)
+        flags |= MUSICIAN_GPT_MEASURE_FLAGS_MARKER;
+
+      /*
+       * Each section is repeated 3 times, with a second ending just before
+       * the repeat. The values differ so that mixing them up shows.
+       */
+      if (i % 16 == 14)
+        flags |= MUSICIAN_GPT_MEASURE_FLAGS_ALTERNATE_ENDING;
+
+      if (i % 16 == 15)
+        flags |= MUSICIAN_GPT_MEASURE_FLAGS_REPEAT_END;
+
+      put_byte (buffer, flags);
+
+      if (flags & MUSICIAN_GPT_MEASURE_FLAGS_KEY_NUMERATOR)
+        put_byte (buffer, 4);
+
+      if (flags & MUSICIAN_GPT_MEASURE_FLAGS_KEY_DENOMINATOR)
+        put_byte (buffer, 4);
+
+      if (flags & MUSICIAN_GPT_MEASURE_FLAGS_REPEAT_END)
+        put_byte (buffer, 3);
+
+      if (flags & MUSICIAN_GPT_MEASURE_FLAGS_ALTERNATE_ENDING)
+        put_byte (buffer, 2);
+
+      if (flags & MUSICIAN_GPT_MEASURE_FLAGS_MARKER)
+        {
+          g_autofree gchar *name = g_strdup_printf ("Section %u", i / 16 + 1);
+
+          put_string (buffer, name);
+          put_color (buffer, 255, 0, 0);
+        }
+    }
+}
+
+static void
+put_tracks (GByteArray                *buffer,
+            const Gp4GeneratorOptions *options)
+{
+  static const gint32 tunings[7] = { 64, 59, 55, 50, 45, 40, 0 };
+
+  for (guint i = 0; i < options->n_tracks; i++)
+    {
+      g_autofree gchar *title = g_strdup_printf ("Track %u", i + 1);
+
+      put_byte (buffer, MUSICIAN_GPT_TRACK_FLAGS_NONE);
+      put_fixed_string (buffer, title, 40);
+      put_uint32 (buffer, N_STRINGS);
+
+      for (guint j = 0; j < G_N_ELEMENTS (tunings); j++)
+        put_uint32 (buffer, tunings[j]);
+
+      /* Port, channel, effects channel, frets and capo */
+      put_uint32 (buffer, 1);
+      put_uint32 (buffer, i % 16 + 1);
+      put_uint32 (buffer, i % 16 + 1);
+      put_uint32 (buffer, 24);
+      put_uint32 (buffer, 0);
+
+      put_color (buffer, 0, 0, 255);
+    }
+}
+
+static void
+put_chord (GByteArray  *buffer,
+           const gchar *name)
+{
+  /* The Guitar Pro 4 diagram, see musician_gp4_parser_load_chord() */
+  put_byte (buffer, 1);
+  put_zeroes (buffer, 1 + 3 + 3 + 4 + 4 + 1);
+  put_fixed_string (buffer, name, 22);
+  put_zeroes (buffer, 3 + 4 + (7 * 4) + 1 + (3 * 5) + 7 + 1 + 7 + 1);
+}
+
+static void
+put_bend (GByteArray *buffer)
+{
+  put_byte (buffer, MUSICIAN_GPT_BEND_BEND_AND_RELEASE);
+  put_uint32 (buffer, 100);
+
+  /* Position, height and vibrato of each point */
+  put_uint32 (buffer, 3);
+  put_uint32 (buffer, 0);
+  put_uint32 (buffer, 0);
+  put_byte (buffer, MUSICIAN_GPT_VIBRATO_NONE);
+  put_uint32 (buffer, 6);
+  put_uint32 (buffer, 4);
+  put_byte (buffer, MUSICIAN_GPT_VIBRATO_NONE);
+  put_uint32 (buffer, 12);
+  put_uint32 (buffer, 0);
+  put_byte (buffer, MUSICIAN_GPT_VIBRATO_NONE);
+}
+
+/* Instrument, then -1 for each value and the tempo, which leaves them be */
+static void
+put_mix_table (GByteArray *buffer)
+{
+  put_byte (buffer, 0);
+  for (guint i = 0; i < 6; i++)
+    put_byte (buffer, 0xff);
+  put_uint32 (buffer, G_MAXUINT32);
+
+  /* Which of the changes apply to all tracks */
+  put_byte (buffer, 0);
+}
+
+static void
+put_beat (GByteArray                *buffer,
+          const Gp4GeneratorOptions *options,
+          GRand                     *rand,
+          Gp4GeneratorStats         *stats)
+{
+  MusicianGptBeatFlags flags = MUSICIAN_GPT_BEAT_FLAGS_NONE;
+  gboolean has_bend;
+  gboolean has_grace = FALSE;
+  guint string;
+
+  if (g_rand_double (rand) < options->chord_rate)
+    flags |= MUSICIAN_GPT_BEAT_FLAGS_CHORD_DIAGRAM;
+
+  if (g_rand_double (rand) < options->text_rate)
+    flags |= MUSICIAN_GPT_BEAT_FLAGS_TEXT;
+
+  has_bend = g_rand_double (rand) < options->bend_rate;
+
+  /* Only drawn when asked for, to keep the default files the same */
+  if (options->mix_table_rate > 0 && g_rand_double (rand) < options->mix_table_rate)
+    flags |= MUSICIAN_GPT_BEAT_FLAGS_MIX_TABLE;
+
+  if (options->grace_rate > 0 && g_rand_double (rand) < options->grace_rate)
+    has_grace = TRUE;
+
+  put_byte (buffer, flags);
+
+  /* Half, quarter or eighth note */
+  put_byte (buffer, g_rand_int_range (rand, -1, 2));
+
+  if (flags & MUSICIAN_GPT_BEAT_FLAGS_CHORD_DIAGRAM)
+    {
+      guint n = g_rand_int_range (rand, 0, MAX (1, options->n_chord_names));
+      guint n_names = G_N_ELEMENTS (chord_roots) * G_N_ELEMENTS (chord_kinds);
+      const gchar *root = chord_roots[n % G_N_ELEMENTS (chord_roots)];
+      const gchar *kind = chord_kinds[n / G_N_ELEMENTS (chord_roots) % G_N_ELEMENTS (chord_kinds)];
+      g_autofree gchar *name = NULL;
+
+      /* Past the plain names, add a bass to keep them distinct */
+      if (n < n_names)
+        name = g_strconcat (root, kind, NULL);
+      else
+        name = g_strdup_printf ("%s%s/%u", root, kind, n / n_names);
+
+      put_chord (buffer, name);
+      stats->n_chords++;
+    }
+
+  if (flags & MUSICIAN_GPT_BEAT_FLAGS_TEXT)
+    {
+      g_autofree gchar *text = g_strdup_printf ("Text %u", stats->n_beats);
+
+      put_string (buffer, text);
+      stats->n_texts++;
+    }
+
+  if (flags & MUSICIAN_GPT_BEAT_FLAGS_MIX_TABLE)
+    {
+      put_mix_table (buffer);
+      stats->n_mix_tables++;
+    }
+
+  /* One string played, from the highest bit (string 1) down */
+  string = g_rand_int_range (rand, 0, N_STRINGS);
+  put_byte (buffer, 1 << (6 - string));
+
+  /* Note type and fret, then the effects if there is a bend or grace note */
+  put_byte (buffer, (1 << 5) | (has_bend || has_grace ? (1 << 3) : 0));
+  put_byte (buffer, 1);
+  put_byte (buffer, g_rand_int_range (rand, 0, 13));
+
+  if (has_bend || has_grace)
+    {
+      put_byte (buffer, (has_bend ? (1 << 0) : 0) | (has_grace ? (1 << 4) : 0));
+      put_byte (buffer, 0);
+    }
+
+  if (has_bend)
+    {
+      put_bend (buffer);
+      stats->n_bends++;
+    }
+
+  /* Fret, dynamics, transition and duration of the grace note */
+  if (has_grace)
+    {
+      put_zeroes (buffer, 4);
+      stats->n_grace_notes++;
+    }
+
+  stats->n_beats++;
+}
+
+void
+gp4_generator_options_init (Gp4GeneratorOptions *options)
+{
+  g_return_if_fail (options != NULL);
+
+  options->seed = 1;
+  options->n_measures = 100;
+  options->n_tracks = 4;
+  options->n_beats = 4;
+  options->chord_rate = 0.05;
+  options->bend_rate = 0.05;
+  options->text_rate = 0.02;
+  options->mix_table_rate = 0.0;
+  options->grace_rate = 0.0;
+  options->n_chord_names = 24;
+  options->n_comments = 0;
+  options->lyrics_len = 256;
+}
+
+/**
+ * gp4_generator_generate:
+ * @options: The shape of the file
+ * @stats: (out) (optional): What went into the file
+ *
+ * Returns: (transfer full): The contents of a Guitar Pro 4 file.
+ */
+GBytes *
+gp4_generator_generate (const Gp4GeneratorOptions *options,
+                        Gp4GeneratorStats         *stats)
+{
+  g_autoptr(GByteArray) buffer = g_byte_array_new ();
+  Gp4GeneratorStats real_stats = { 0 };
+  GRand *rand;
+
+  g_return_val_if_fail (options != NULL, NULL);
+
+  rand = g_rand_new_with_seed (options->seed);
+
+  put_header (buffer, options);
+  put_measures (buffer, options);
+  put_tracks (buffer, options);
+
+  for (guint measure = 0; measure < options->n_measures; measure++)
+    {
+      for (guint track = 0; track < options->n_tracks; track++)
+        {
+          put_uint32 (buffer, options->n_beats);
+
+          for (guint beat = 0; beat < options->n_beats; beat++)
+            put_beat (buffer, options, rand, &real_stats);
+        }
+    }
+
+  g_rand_free (rand);
+
+  if (stats != NULL)
+    *stats = real_stats;
+
+  return g_byte_array_free_to_bytes (g_steal_pointer (&buffer));
+}
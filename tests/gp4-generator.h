@@ -0,0 +1,70 @@
+/* gp4-generator.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GP4_GENERATOR_H
+#define GP4_GENERATOR_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Writes synthetic Guitar Pro 4 files for tests and benchmarks that need
+ * larger inputs than tests/data has. The same options always give the
+ * same bytes, and @seed picks one of many files with the same shape.
+ *
+ * The rates are the fraction of beats, from 0.0 to 1.0, that get a chord
+ * diagram, a bend, a text, a mix table change or a grace note. Chord names
+ * are picked from @n_chord_names distinct names, so that repeated chords
+ * can be told from unique ones. Mix table changes and grace notes are off
+ * by default, so that the files benchmarks load stay the same.
+ */
+typedef struct
+{
+  guint32 seed;
+  guint   n_measures;
+  guint   n_tracks;
+  guint   n_beats;
+  gdouble chord_rate;
+  gdouble bend_rate;
+  gdouble text_rate;
+  gdouble mix_table_rate;
+  gdouble grace_rate;
+  guint   n_chord_names;
+  guint   n_comments;
+  gsize   lyrics_len;
+} Gp4GeneratorOptions;
+
+/* What went into a generated file, to check a parse against */
+typedef struct
+{
+  guint n_beats;
+  guint n_chords;
+  guint n_bends;
+  guint n_texts;
+  guint n_mix_tables;
+  guint n_grace_notes;
+} Gp4GeneratorStats;
+
+void    gp4_generator_options_init (Gp4GeneratorOptions       *options);
+GBytes *gp4_generator_generate     (const Gp4GeneratorOptions *options,
+                                    Gp4GeneratorStats         *stats);
+
+G_END_DECLS
+
+#endif /* GP4_GENERATOR_H */
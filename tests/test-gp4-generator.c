@@ -0,0 +1,380 @@
+/* test-gp4-generator.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <musician.h>
+#include <string.h>
+
+#include "gp4-generator.h"
+
+static MusicianGptParser *
+load_generated (const Gp4GeneratorOptions *options,
+                Gp4GeneratorStats         *stats)
+{
+  g_autoptr(MusicianGptParser) parser = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+  gboolean r;
+
+  bytes = gp4_generator_generate (options, stats);
+  g_assert (bytes != NULL);
+
+  parser = musician_gpt_parser_new ();
+  r = musician_gpt_parser_load_from_bytes (parser, bytes, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (r);
+
+  return g_steal_pointer (&parser);
+}
+
+static void
+test_generator_deterministic (void)
+{
+  Gp4GeneratorOptions options;
+  g_autoptr(GBytes) a = NULL;
+  g_autoptr(GBytes) b = NULL;
+  g_autoptr(GBytes) c = NULL;
+
+  gp4_generator_options_init (&options);
+
+  a = gp4_generator_generate (&options, NULL);
+  b = gp4_generator_generate (&options, NULL);
+  g_assert (g_bytes_equal (a, b));
+
+  options.seed++;
+  c = gp4_generator_generate (&options, NULL);
+  g_assert (!g_bytes_equal (a, c));
+}
+
+static void
+test_generator_contents (void)
+{
+  g_autoptr(MusicianGptParser) parser = NULL;
+  g_autoptr(GHashTable) chords = g_hash_table_new (NULL, NULL);
+  g_autoptr(GListModel) lyrics = NULL;
+  g_autoptr(MusicianGptLyrics) first_lyrics = NULL;
+  g_autoptr(GError) error = NULL;
+  Gp4GeneratorOptions options;
+  Gp4GeneratorStats stats;
+  MusicianGptSong *song;
+  guint n_beats = 0;
+  guint n_chords = 0;
+  guint n_texts = 0;
+  guint n_bends = 0;
+
+  gp4_generator_options_init (&options);
+  options.n_measures = 40;
+  options.n_tracks = 3;
+  options.n_beats = 6;
+  options.chord_rate = 0.25;
+  options.bend_rate = 0.2;
+  options.text_rate = 0.1;
+  options.n_chord_names = 5;
+  options.lyrics_len = 1000;
+
+  parser = load_generated (&options, &stats);
+  song = musician_gpt_parser_get_song (parser);
+
+  g_assert_cmpint (musician_gpt_song_get_n_measures (song), ==, 40);
+  g_assert_cmpint (musician_gpt_song_get_n_tracks (song), ==, 3);
+  g_assert_cmpstr (musician_gpt_song_get_title (song), ==, "Generated 1");
+  g_assert_cmpstr (musician_gpt_measure_get_marker_name (musician_gpt_song_get_measure (song, 17)), ==, "Section 2");
+  g_assert_null (musician_gpt_measure_get_marker_name (musician_gpt_song_get_measure (song, 18)));
+
+  lyrics = musician_gpt_song_list_lyrics (song);
+  first_lyrics = g_list_model_get_item (lyrics, 0);
+  g_assert_cmpint (strlen (musician_gpt_lyrics_get_text (first_lyrics)), ==, 1000);
+
+  for (guint track = 1; track <= 3; track++)
+    {
+      MusicianGptBeatStore *store;
+      guint n_store_beats;
+
+      store = musician_gpt_song_get_beat_store (song, track, NULL, &error);
+      g_assert_no_error (error);
+
+      n_store_beats = musician_gpt_beat_store_get_n_beats (store);
+      g_assert_cmpint (n_store_beats, ==, 40 * 6);
+
+      for (guint i = 0; i < n_store_beats; i++)
+        {
+          MusicianGptBeatView view;
+
+          musician_gpt_beat_store_get_view (store, i, &view);
+
+          if (view.chord != NULL)
+            {
+              g_hash_table_add (chords, view.chord);
+              n_chords++;
+            }
+
+          if (view.text != NULL)
+            n_texts++;
+
+          n_bends += view.n_bends;
+        }
+
+      n_beats += n_store_beats;
+    }
+
+  g_assert_cmpint (n_beats, ==, stats.n_beats);
+  g_assert_cmpint (n_chords, ==, stats.n_chords);
+  g_assert_cmpint (n_texts, ==, stats.n_texts);
+  g_assert_cmpint (n_bends, ==, stats.n_bends);
+
+  /* The rates are far enough from 0 that each shows up in 720 beats */
+  g_assert_cmpint (stats.n_chords, >, 0);
+  g_assert_cmpint (stats.n_texts, >, 0);
+  g_assert_cmpint (stats.n_bends, >, 0);
+
+  /* Identical chords are interned, so there are no more than the names */
+  g_assert_cmpint (g_hash_table_size (chords), <=, 5);
+}
+
+/*
+ * The /Musician/Gp4Parser tests patch test1.gp4 to check the repeat count
+ * and alternate ending, the tunings and the durations. This checks them on
+ * a generated file, whose beats can be read back from the beat store.
+ */
+static void
+test_generator_decoding (void)
+{
+  g_autoptr(MusicianGptParser) parser = NULL;
+  g_autoptr(MusicianGptTrack) track = NULL;
+  g_autoptr(GListModel) tracks = NULL;
+  g_autoptr(GError) error = NULL;
+  Gp4GeneratorOptions options;
+  MusicianGptMeasure *measure;
+  MusicianGptBeatStore *store;
+  const MusicianGptTuning *tunings;
+  const guint8 *durations;
+  gsize n_tunings = 0;
+  guint seen = 0;
+
+  gp4_generator_options_init (&options);
+  options.n_measures = 32;
+  options.n_tracks = 2;
+  options.n_beats = 8;
+
+  parser = load_generated (&options, NULL);
+
+  measure = musician_gpt_song_get_measure (musician_gpt_parser_get_song (parser), 15);
+  g_assert_cmpint (musician_gpt_measure_get_nth_ending (measure), ==, 2);
+  g_assert_cmpint (musician_gpt_measure_get_n_repeats (measure), ==, 0);
+
+  measure = musician_gpt_song_get_measure (musician_gpt_parser_get_song (parser), 32);
+  g_assert_cmpint (musician_gpt_measure_get_nth_ending (measure), ==, 0);
+  g_assert_cmpint (musician_gpt_measure_get_n_repeats (measure), ==, 3);
+
+  tracks = musician_gpt_song_list_tracks (musician_gpt_parser_get_song (parser));
+  track = g_list_model_get_item (tracks, 1);
+  tunings = musician_gpt_track_get_tunings (track, &n_tunings);
+  g_assert_cmpint (musician_gpt_track_get_n_strings (track), ==, 6);
+  g_assert_cmpint (n_tunings, ==, 6);
+  g_assert_cmpint (tunings[0], ==, 64);
+  g_assert_cmpint (tunings[5], ==, 40);
+
+  /* The generator writes half, quarter and eighth notes */
+  store = musician_gpt_song_get_beat_store (musician_gpt_parser_get_song (parser), 1, NULL, &error);
+  g_assert_no_error (error);
+
+  durations = musician_gpt_beat_store_get_durations (store);
+
+  for (guint i = 0; i < musician_gpt_beat_store_get_n_beats (store); i++)
+    {
+      g_assert (durations[i] == 2 || durations[i] == 4 || durations[i] == 8);
+      seen |= durations[i];
+    }
+
+  g_assert_cmpint (seen, ==, 2 | 4 | 8);
+}
+
+/*
+ * Mix table changes, grace notes and comments are read past, and the
+ * stats count each of them, whether the beats are decoded now or later.
+ */
+static void
+test_generator_unsupported (void)
+{
+  g_autoptr(MusicianGptParser) parser = NULL;
+  g_autoptr(MusicianGptParser) lazy = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+  Gp4GeneratorOptions options;
+  Gp4GeneratorStats stats;
+  MusicianGptParseStats parse_stats;
+  MusicianGptParseStats lazy_stats;
+  gboolean r;
+
+  gp4_generator_options_init (&options);
+  options.n_measures = 40;
+  options.n_tracks = 3;
+  options.n_beats = 6;
+  options.mix_table_rate = 0.1;
+  options.grace_rate = 0.1;
+  options.n_comments = 3;
+
+  parser = load_generated (&options, &stats);
+
+  /* The rates are far enough from 0 that each shows up in 720 beats */
+  g_assert_cmpint (stats.n_mix_tables, >, 0);
+  g_assert_cmpint (stats.n_grace_notes, >, 0);
+
+  g_assert_true (musician_gpt_parser_get_stats (parser, &parse_stats));
+  g_assert_cmpuint (parse_stats.n_beats, ==, stats.n_beats);
+  g_assert_cmpuint (parse_stats.n_unsupported, ==, stats.n_mix_tables + stats.n_grace_notes + 3);
+  g_assert_cmpuint (parse_stats.n_deferred, ==, 0);
+
+  bytes = gp4_generator_generate (&options, NULL);
+  lazy = musician_gpt_parser_new ();
+  musician_gpt_parser_set_lazy (lazy, TRUE);
+  r = musician_gpt_parser_load_from_bytes (lazy, bytes, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (r);
+
+  g_assert_true (musician_gpt_parser_get_stats (lazy, &lazy_stats));
+  g_assert_cmpuint (lazy_stats.n_unsupported, ==, parse_stats.n_unsupported);
+  g_assert_cmpuint (lazy_stats.n_deferred, ==, 40 * 3);
+}
+
+static void
+test_generator_scale (void)
+{
+  g_autoptr(MusicianGptParser) parser = NULL;
+  Gp4GeneratorOptions options;
+  Gp4GeneratorStats stats;
+  MusicianGptSong *song;
+
+  if (!g_test_slow ())
+    {
+      g_test_skip ("Only run with -m slow");
+      return;
+    }
+
+  gp4_generator_options_init (&options);
+  options.n_measures = 2000;
+  options.n_tracks = 16;
+  options.n_beats = 8;
+
+  parser = load_generated (&options, &stats);
+  song = musician_gpt_parser_get_song (parser);
+
+  g_assert_cmpint (musician_gpt_song_get_n_measures (song), ==, 2000);
+  g_assert_cmpint (musician_gpt_song_get_n_tracks (song), ==, 16);
+  g_assert_cmpint (stats.n_beats, ==, 2000 * 16 * 8);
+}
+
+/*
+ * Patches the measure and track counts of a generated file, which are the
+ * last thing in the header.
+ */
+static GBytes *
+generate_with_counts (const Gp4GeneratorOptions *options,
+                      guint32                    n_measures,
+                      guint32                    n_tracks)
+{
+  Gp4GeneratorOptions header_options = *options;
+  g_autoptr(GBytes) header = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+  guint8 *data;
+  gsize header_len;
+  gsize len;
+
+  header_options.n_measures = 0;
+  header_options.n_tracks = 0;
+  header = gp4_generator_generate (&header_options, NULL);
+  header_len = g_bytes_get_size (header);
+
+  bytes = gp4_generator_generate (options, NULL);
+  data = g_bytes_unref_to_data (g_steal_pointer (&bytes), &len);
+  g_assert_cmpint (len, >=, header_len);
+
+  n_measures = GUINT32_TO_LE (n_measures);
+  n_tracks = GUINT32_TO_LE (n_tracks);
+  memcpy (data + header_len - 8, &n_measures, 4);
+  memcpy (data + header_len - 4, &n_tracks, 4);
+
+  return g_bytes_new_take (data, len);
+}
+
+static void
+test_generator_hostile_header (void)
+{
+  static const guint32 counts[][2] = {
+    { 0x7fffffff, 2 },
+    { 4, 0x7fffffff },
+    { 0x7fffffff, 0 },
+    { 0x10000, 0x10000 },
+  };
+  Gp4GeneratorOptions options;
+
+  gp4_generator_options_init (&options);
+  options.n_measures = 4;
+  options.n_tracks = 2;
+  options.n_beats = 2;
+
+  for (guint i = 0; i < G_N_ELEMENTS (counts); i++)
+    {
+      g_autoptr(MusicianGptParser) parser = musician_gpt_parser_new ();
+      g_autoptr(MusicianGptPushParser) push_parser = musician_gpt_push_parser_new ();
+      g_autoptr(GInputStream) stream = NULL;
+      g_autoptr(GBytes) bytes = NULL;
+      g_autoptr(GError) error = NULL;
+      MusicianGptPushStatus status;
+      gboolean r;
+
+      bytes = generate_with_counts (&options, counts[i][0], counts[i][1]);
+
+      /* The whole file is known, so the counts are rejected up front */
+      r = musician_gpt_parser_load_from_bytes (parser, bytes, NULL, &error);
+      g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+      g_assert_false (r);
+      g_clear_error (&error);
+
+      /* Otherwise the file runs out long before the counts are reached */
+      stream = g_memory_input_stream_new_from_bytes (bytes);
+      r = musician_gpt_parser_load_from_stream (parser, stream, NULL, &error);
+      g_assert_nonnull (error);
+      g_assert_false (r);
+      g_clear_error (&error);
+
+      status = musician_gpt_push_parser_feed (push_parser,
+                                              g_bytes_get_data (bytes, NULL),
+                                              g_bytes_get_size (bytes),
+                                              NULL,
+                                              &error);
+      if (status == MUSICIAN_GPT_PUSH_STATUS_NEED_MORE_DATA)
+        musician_gpt_push_parser_close (push_parser, &error);
+      else
+        g_assert_cmpint (status, ==, MUSICIAN_GPT_PUSH_STATUS_ERROR);
+      g_assert_nonnull (error);
+    }
+}
+
+gint
+main (gint argc,
+      gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  g_test_add_func ("/Musician/Gp4Generator/deterministic", test_generator_deterministic);
+  g_test_add_func ("/Musician/Gp4Generator/contents", test_generator_contents);
+  g_test_add_func ("/Musician/Gp4Generator/decoding", test_generator_decoding);
+  g_test_add_func ("/Musician/Gp4Generator/unsupported", test_generator_unsupported);
+  g_test_add_func ("/Musician/Gp4Generator/scale", test_generator_scale);
+  g_test_add_func ("/Musician/Gp4Generator/hostile-header", test_generator_hostile_header);
+  return g_test_run ();
+}
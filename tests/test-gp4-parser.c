@@ -0,0 +1,188 @@
+/* test-gp4-parser.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <musician.h>
+
+#include "musician-gpt-song-private.h"
+
+/* Offsets of a few fields in tests/data/test1.gp4 */
+#define MEASURE_1_KEY     956
+#define MEASURE_2_HEADER  958
+#define TRACK_1_N_STRINGS 1051
+#define BEAT_1_DURATION   1113
+
+/*
+ * Loads test1.gp4 with the @n_replaced bytes at @offset replaced by @data,
+ * so a test can change a single field of an otherwise valid file.
+ */
+static MusicianGptSong *
+load_patched (gsize          offset,
+              gsize          n_replaced,
+              const guint8  *data,
+              gsize          len,
+              GError       **error)
+{
+  g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", "test1.gp4", NULL);
+  g_autoptr(MusicianGptParser) parser = NULL;
+  g_autoptr(GByteArray) buffer = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+  g_autofree gchar *contents = NULL;
+  gsize length = 0;
+
+  g_file_get_contents (path, &contents, &length, NULL);
+  g_assert_cmpint (offset + n_replaced, <=, length);
+
+  buffer = g_byte_array_new ();
+  g_byte_array_append (buffer, (const guint8 *)contents, offset);
+  g_byte_array_append (buffer, data, len);
+  g_byte_array_append (buffer,
+                       (const guint8 *)contents + offset + n_replaced,
+                       length - offset - n_replaced);
+  bytes = g_byte_array_free_to_bytes (g_steal_pointer (&buffer));
+
+  parser = musician_gpt_parser_new ();
+
+  if (!musician_gpt_parser_load_from_bytes (parser, bytes, NULL, error))
+    return NULL;
+
+  return g_object_ref (musician_gpt_parser_get_song (parser));
+}
+
+static void
+test_gp4_parser_durations (void)
+{
+  static const guint8 whole[] = { 0xfe };
+  static const guint8 sixty_fourth[] = { 4 };
+  static const guint8 invalid[] = { 5 };
+  g_autoptr(MusicianGptSong) song = NULL;
+  g_autoptr(GError) error = NULL;
+
+  /* Durations go from -2 (whole note) to 4 (sixty-fourth note) */
+  song = load_patched (BEAT_1_DURATION, 1, whole, sizeof whole, &error);
+  g_assert_no_error (error);
+  g_assert (song != NULL);
+  g_clear_object (&song);
+
+  song = load_patched (BEAT_1_DURATION, 1, sixty_fourth, sizeof sixty_fourth, &error);
+  g_assert_no_error (error);
+  g_assert (song != NULL);
+  g_clear_object (&song);
+
+  song = load_patched (BEAT_1_DURATION, 1, invalid, sizeof invalid, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+  g_assert (song == NULL);
+}
+
+static void
+test_gp4_parser_measure_headers (void)
+{
+  static const guint8 b_flat[] = { 0xfe };
+  g_autoptr(MusicianGptSong) song = NULL;
+  g_autoptr(GError) error = NULL;
+  MusicianGptMeasure *measure;
+
+  /* Keys with flats are negative */
+  song = load_patched (MEASURE_1_KEY, 1, b_flat, sizeof b_flat, &error);
+  g_assert_no_error (error);
+
+  measure = musician_gpt_song_get_measure (song, 1);
+  g_assert_cmpint (musician_gpt_measure_get_numerator (measure), ==, 4);
+  g_assert_cmpint (musician_gpt_measure_get_denominator (measure), ==, 4);
+  g_assert_cmpint (musician_gpt_measure_get_key (measure), ==, MUSICIAN_GPT_KEY_B_FLAT);
+
+  /* Measure 2 has no time signature of its own */
+  measure = musician_gpt_song_get_measure (song, 2);
+  g_assert_cmpint (musician_gpt_measure_get_numerator (measure), ==, 4);
+  g_assert_cmpint (musician_gpt_measure_get_denominator (measure), ==, 4);
+
+  measure = musician_gpt_song_get_measure (song, 4);
+  g_assert_cmpint (musician_gpt_measure_get_numerator (measure), ==, 7);
+  g_assert_cmpint (musician_gpt_measure_get_denominator (measure), ==, 8);
+
+  /* Measure 29 only changes the numerator of the 4/4 before it */
+  measure = musician_gpt_song_get_measure (song, 29);
+  g_assert_cmpint (musician_gpt_measure_get_numerator (measure), ==, 2);
+  g_assert_cmpint (musician_gpt_measure_get_denominator (measure), ==, 4);
+}
+
+static void
+test_gp4_parser_repeats (void)
+{
+  /*
+   * Measure 2 closes a repeat played 3 times, and measure 3 is the second
+   * ending. Neither has any other field in test1.gp4.
+   */
+  static const guint8 headers[] = {
+    MUSICIAN_GPT_MEASURE_FLAGS_REPEAT_END, 3,
+    MUSICIAN_GPT_MEASURE_FLAGS_ALTERNATE_ENDING, 2,
+  };
+  g_autoptr(MusicianGptSong) song = NULL;
+  g_autoptr(GError) error = NULL;
+  MusicianGptMeasure *measure;
+
+  song = load_patched (MEASURE_2_HEADER, 2, headers, sizeof headers, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (musician_gpt_song_get_n_measures (song), ==, 42);
+
+  measure = musician_gpt_song_get_measure (song, 2);
+  g_assert_cmpint (musician_gpt_measure_get_n_repeats (measure), ==, 3);
+  g_assert_cmpint (musician_gpt_measure_get_nth_ending (measure), ==, 0);
+
+  measure = musician_gpt_song_get_measure (song, 3);
+  g_assert_cmpint (musician_gpt_measure_get_n_repeats (measure), ==, 0);
+  g_assert_cmpint (musician_gpt_measure_get_nth_ending (measure), ==, 2);
+}
+
+static void
+test_gp4_parser_tunings (void)
+{
+  static const guint8 n_strings[] = { 8, 0, 0, 0 };
+  g_autoptr(MusicianGptSong) song = NULL;
+  g_autoptr(GError) error = NULL;
+  const MusicianGptTuning *tunings;
+  MusicianGptTrack *track;
+  gsize n_tunings = 0;
+
+  /* The file has room for 7 tunings, but the track only has 6 strings */
+  song = load_patched (0, 0, NULL, 0, &error);
+  g_assert_no_error (error);
+
+  track = g_ptr_array_index (_musician_gpt_song_get_tracks (song), 0);
+  tunings = musician_gpt_track_get_tunings (track, &n_tunings);
+  g_assert_cmpint (musician_gpt_track_get_n_strings (track), ==, 6);
+  g_assert_cmpint (n_tunings, ==, 6);
+  g_assert_cmpint (tunings[0], ==, 63);
+  g_assert_cmpint (tunings[5], ==, 39);
+  g_clear_object (&song);
+
+  song = load_patched (TRACK_1_N_STRINGS, sizeof n_strings, n_strings, sizeof n_strings, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+  g_assert (song == NULL);
+}
+
+gint
+main (gint argc,
+      gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  g_test_add_func ("/Musician/Gp4Parser/durations", test_gp4_parser_durations);
+  g_test_add_func ("/Musician/Gp4Parser/measure-headers", test_gp4_parser_measure_headers);
+  g_test_add_func ("/Musician/Gp4Parser/repeats", test_gp4_parser_repeats);
+  g_test_add_func ("/Musician/Gp4Parser/tunings", test_gp4_parser_tunings);
+  return g_test_run ();
+}
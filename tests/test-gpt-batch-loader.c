@@ -0,0 +1,146 @@
+/* test-gpt-batch-loader.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <musician.h>
+
+typedef struct
+{
+  GThread *thread;
+  guint    n_songs;
+  guint    n_errors;
+  GError  *last_error;
+} BatchCounts;
+
+static void
+count_result (GFile           *file,
+              MusicianGptSong *song,
+              const GError    *error,
+              gpointer         user_data)
+{
+  BatchCounts *counts = user_data;
+
+  /* Results are always handed over on the thread that started the run */
+  g_assert (counts->thread == g_thread_self ());
+  g_assert (G_IS_FILE (file));
+
+  if (song != NULL)
+    {
+      g_assert (error == NULL);
+      g_assert_cmpint (musician_gpt_song_get_n_measures (song), ==, 42);
+      counts->n_songs++;
+    }
+  else
+    {
+      g_assert (error != NULL);
+      g_clear_error (&counts->last_error);
+      counts->last_error = g_error_copy (error);
+      counts->n_errors++;
+    }
+}
+
+static void
+test_batch_loader_files (void)
+{
+  g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", "test1.gp4", NULL);
+  g_autoptr(MusicianGptBatchLoader) loader = NULL;
+  g_autoptr(GFile) file = g_file_new_for_path (path);
+  g_autoptr(GError) error = NULL;
+  BatchCounts counts = { g_thread_self () };
+  gboolean r;
+
+  loader = musician_gpt_batch_loader_new ();
+
+  for (guint i = 0; i < 32; i++)
+    musician_gpt_batch_loader_add_file (loader, file);
+
+  g_assert_cmpint (musician_gpt_batch_loader_get_n_files (loader), ==, 32);
+
+  r = musician_gpt_batch_loader_run (loader, count_result, &counts, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (r);
+
+  g_assert_cmpint (counts.n_songs, ==, 32);
+  g_assert_cmpint (counts.n_errors, ==, 0);
+  g_assert_cmpint (musician_gpt_batch_loader_get_n_files (loader), ==, 0);
+}
+
+static void
+test_batch_loader_directory (void)
+{
+  g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", NULL);
+  g_autoptr(MusicianGptBatchLoader) loader = NULL;
+  g_autoptr(GFile) directory = g_file_new_for_path (path);
+  g_autoptr(GError) error = NULL;
+  BatchCounts counts = { g_thread_self () };
+  gboolean r;
+
+  loader = musician_gpt_batch_loader_new ();
+
+  /* Only test1.gp4, test1.gp5 is skipped */
+  r = musician_gpt_batch_loader_add_directory (loader, directory, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (r);
+  g_assert_cmpint (musician_gpt_batch_loader_get_n_files (loader), ==, 1);
+
+  r = musician_gpt_batch_loader_run (loader, count_result, &counts, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (r);
+
+  g_assert_cmpint (counts.n_songs, ==, 1);
+  g_assert_cmpint (counts.n_errors, ==, 0);
+}
+
+static void
+test_batch_loader_max_memory (void)
+{
+  g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", "test1.gp4", NULL);
+  g_autoptr(MusicianGptBatchLoader) loader = NULL;
+  g_autoptr(GFile) file = g_file_new_for_path (path);
+  g_autoptr(GError) error = NULL;
+  BatchCounts counts = { g_thread_self () };
+  gboolean r;
+
+  loader = musician_gpt_batch_loader_new ();
+
+  /* Not even enough for the title of a single file */
+  musician_gpt_batch_loader_set_max_memory (loader, 4);
+
+  for (guint i = 0; i < 8; i++)
+    musician_gpt_batch_loader_add_file (loader, file);
+
+  r = musician_gpt_batch_loader_run (loader, count_result, &counts, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (r);
+
+  g_assert_cmpint (counts.n_songs, ==, 0);
+  g_assert_cmpint (counts.n_errors, ==, 8);
+  g_assert_error (counts.last_error, G_IO_ERROR, G_IO_ERROR_NO_SPACE);
+
+  g_clear_error (&counts.last_error);
+}
+
+gint
+main (gint argc,
+      gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  g_test_add_func ("/Musician/GptBatchLoader/files", test_batch_loader_files);
+  g_test_add_func ("/Musician/GptBatchLoader/directory", test_batch_loader_directory);
+  g_test_add_func ("/Musician/GptBatchLoader/max-memory", test_batch_loader_max_memory);
+  return g_test_run ();
+}
@@ -0,0 +1,46 @@
+/* test-gpt-beat.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <musician.h>
+
+static void
+test_beat_text (void)
+{
+  g_autoptr(MusicianGptBeat) beat = musician_gpt_beat_new ();
+
+  g_assert_null (musician_gpt_beat_get_text (beat));
+
+  /* Setting a different text used to be ignored */
+  musician_gpt_beat_set_text (beat, "a tempo");
+  g_assert_cmpstr (musician_gpt_beat_get_text (beat), ==, "a tempo");
+
+  musician_gpt_beat_set_text (beat, "rit.");
+  g_assert_cmpstr (musician_gpt_beat_get_text (beat), ==, "rit.");
+
+  musician_gpt_beat_set_text (beat, NULL);
+  g_assert_null (musician_gpt_beat_get_text (beat));
+}
+
+gint
+main (gint argc,
+      gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  g_test_add_func ("/Musician/GptBeat/text", test_beat_text);
+  return g_test_run ();
+}
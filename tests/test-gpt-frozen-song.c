@@ -0,0 +1,217 @@
+/* test-gpt-frozen-song.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <musician.h>
+
+#define N_THREADS 4
+
+static MusicianGptSong *
+load_test_song (const gchar *name)
+{
+  g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", name, NULL);
+  g_autoptr(MusicianGptParser) parser = musician_gpt_parser_new ();
+  g_autoptr(GFile) file = g_file_new_for_path (path);
+  g_autoptr(GError) error = NULL;
+
+  musician_gpt_parser_load_from_file (parser, file, NULL, &error);
+  g_assert_no_error (error);
+
+  return g_object_ref (musician_gpt_parser_get_song (parser));
+}
+
+/* Sums up everything within the beats, to compare songs and threads */
+static guint64
+checksum_beats (MusicianGptFrozenSong *frozen)
+{
+  guint n_measures = musician_gpt_frozen_song_get_n_measures (frozen);
+  guint n_tracks = musician_gpt_frozen_song_get_n_tracks (frozen);
+  guint64 sum = 0;
+
+  for (guint measure = 1; measure <= n_measures; measure++)
+    {
+      for (guint track = 1; track <= n_tracks; track++)
+        {
+          guint n_beats = musician_gpt_frozen_song_get_n_beats (frozen, measure, track);
+
+          for (guint i = 0; i < n_beats; i++)
+            {
+              MusicianGptFrozenBeat view;
+
+              g_assert_true (musician_gpt_frozen_song_get_beat (frozen, measure, track, i, &view));
+
+              sum = sum * 31 + view.mode + view.duration + view.n_tuplet + view.dynamics + view.n_bends;
+              if (view.text != NULL)
+                sum += g_str_hash (view.text);
+            }
+        }
+    }
+
+  return sum;
+}
+
+static void
+test_frozen_song_contents (void)
+{
+  g_autoptr(MusicianGptSong) song = load_test_song ("test1.gp4");
+  g_autoptr(MusicianGptFrozenSong) frozen = NULL;
+  g_autoptr(GError) error = NULL;
+  MusicianGptMeasure **measures;
+  MusicianGptFrozenMeasure frozen_measure;
+  MusicianGptFrozenTrack frozen_track;
+  guint n_measures;
+  guint n_tracks;
+
+  frozen = musician_gpt_song_freeze (song, NULL, &error);
+  g_assert_no_error (error);
+  g_assert (frozen != NULL);
+
+  g_assert_cmpstr (musician_gpt_frozen_song_get_title (frozen), ==, musician_gpt_song_get_title (song));
+  g_assert_cmpstr (musician_gpt_frozen_song_get_artist (frozen), ==, musician_gpt_song_get_artist (song));
+  g_assert_cmpstr (musician_gpt_frozen_song_get_album (frozen), ==, musician_gpt_song_get_album (song));
+  g_assert_cmpstr (musician_gpt_frozen_song_get_version (frozen), ==, musician_gpt_song_get_version (song));
+  g_assert_cmpint (musician_gpt_frozen_song_get_tempo (frozen), ==, musician_gpt_song_get_tempo (song));
+  g_assert_cmpint (musician_gpt_frozen_song_get_key (frozen), ==, musician_gpt_song_get_key (song));
+
+  measures = musician_gpt_song_get_measures (song, &n_measures);
+  n_tracks = musician_gpt_song_get_n_tracks (song);
+
+  g_assert_cmpint (musician_gpt_frozen_song_get_n_measures (frozen), ==, n_measures);
+  g_assert_cmpint (musician_gpt_frozen_song_get_n_tracks (frozen), ==, n_tracks);
+
+  for (guint i = 0; i < n_measures; i++)
+    {
+      g_assert_true (musician_gpt_frozen_song_get_measure (frozen, i, &frozen_measure));
+      g_assert_cmpint (frozen_measure.id, ==, musician_gpt_measure_get_id (measures[i]));
+      g_assert_cmpint (frozen_measure.numerator, ==, musician_gpt_measure_get_numerator (measures[i]));
+      g_assert_cmpint (frozen_measure.denominator, ==, musician_gpt_measure_get_denominator (measures[i]));
+      g_assert_cmpstr (frozen_measure.marker_name, ==, musician_gpt_measure_get_marker_name (measures[i]));
+    }
+
+  g_assert_false (musician_gpt_frozen_song_get_measure (frozen, n_measures, &frozen_measure));
+  g_assert_false (musician_gpt_frozen_song_get_track (frozen, n_tracks, &frozen_track));
+
+  for (guint measure = 1; measure <= n_measures; measure++)
+    {
+      for (guint track = 1; track <= n_tracks; track++)
+        {
+          g_autoptr(GPtrArray) beats = NULL;
+          MusicianGptFrozenBeat view;
+
+          beats = musician_gpt_song_get_beats (song, measure, track, NULL, &error);
+          g_assert_no_error (error);
+
+          g_assert_cmpint (musician_gpt_frozen_song_get_n_beats (frozen, measure, track), ==, beats->len);
+
+          for (guint i = 0; i < beats->len; i++)
+            {
+              MusicianGptBeat *beat = g_ptr_array_index (beats, i);
+              MusicianGptChord *chord = musician_gpt_beat_get_chord (beat);
+
+              g_assert_true (musician_gpt_frozen_song_get_beat (frozen, measure, track, i, &view));
+              g_assert_cmpint (view.mode, ==, musician_gpt_beat_get_mode (beat));
+              g_assert_cmpint (view.duration, ==, musician_gpt_beat_get_duration (beat));
+              g_assert_cmpint (view.n_tuplet, ==, musician_gpt_beat_get_n_tuplet (beat));
+              g_assert_cmpint (view.dynamics, ==, musician_gpt_beat_get_dynamics (beat));
+              g_assert_cmpstr (view.text, ==, musician_gpt_beat_get_text (beat));
+              g_assert_cmpint (view.has_chord, ==, chord != NULL);
+              if (chord != NULL)
+                g_assert_cmpstr (view.chord_name, ==, musician_gpt_chord_get_name (chord));
+            }
+
+          g_assert_false (musician_gpt_frozen_song_get_beat (frozen, measure, track, beats->len, &view));
+        }
+    }
+
+  g_assert_cmpint (musician_gpt_frozen_song_get_n_beats (frozen, 0, 1), ==, 0);
+  g_assert_cmpint (musician_gpt_frozen_song_get_n_beats (frozen, 1, n_tracks + 1), ==, 0);
+}
+
+static void
+test_frozen_song_detached (void)
+{
+  g_autoptr(MusicianGptSong) song = load_test_song ("test1.gp4");
+  g_autoptr(MusicianGptTrack) track = musician_gpt_track_new ();
+  g_autoptr(MusicianGptFrozenSong) frozen = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree gchar *title = NULL;
+  guint n_tracks;
+
+  frozen = musician_gpt_song_freeze (song, NULL, &error);
+  g_assert_no_error (error);
+
+  title = g_strdup (musician_gpt_frozen_song_get_title (frozen));
+  n_tracks = musician_gpt_frozen_song_get_n_tracks (frozen);
+
+  /* Later changes to the song are not seen, and the song may go away */
+  musician_gpt_song_set_title (song, "Something else");
+  musician_gpt_song_add_track (song, track);
+  g_clear_object (&song);
+
+  g_assert_cmpstr (musician_gpt_frozen_song_get_title (frozen), ==, title);
+  g_assert_cmpint (musician_gpt_frozen_song_get_n_tracks (frozen), ==, n_tracks);
+}
+
+static gpointer
+read_frozen_song (gpointer data)
+{
+  MusicianGptFrozenSong *frozen = data;
+  guint64 sum = 0;
+
+  for (guint i = 0; i < 100; i++)
+    sum = checksum_beats (frozen);
+
+  musician_gpt_frozen_song_unref (frozen);
+
+  return g_memdup (&sum, sizeof sum);
+}
+
+static void
+test_frozen_song_threads (void)
+{
+  g_autoptr(MusicianGptSong) song = load_test_song ("test1.gp4");
+  g_autoptr(MusicianGptFrozenSong) frozen = NULL;
+  g_autoptr(GError) error = NULL;
+  GThread *threads[N_THREADS];
+  guint64 expected;
+
+  frozen = musician_gpt_song_freeze (song, NULL, &error);
+  g_assert_no_error (error);
+
+  expected = checksum_beats (frozen);
+
+  for (guint i = 0; i < N_THREADS; i++)
+    threads[i] = g_thread_new ("reader", read_frozen_song, musician_gpt_frozen_song_ref (frozen));
+
+  for (guint i = 0; i < N_THREADS; i++)
+    {
+      g_autofree guint64 *sum = g_thread_join (threads[i]);
+
+      g_assert_cmpuint (*sum, ==, expected);
+    }
+}
+
+gint
+main (gint argc,
+      gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  g_test_add_func ("/Musician/GptFrozenSong/contents", test_frozen_song_contents);
+  g_test_add_func ("/Musician/GptFrozenSong/detached", test_frozen_song_detached);
+  g_test_add_func ("/Musician/GptFrozenSong/threads", test_frozen_song_threads);
+  return g_test_run ();
+}
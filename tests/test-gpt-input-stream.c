@@ -0,0 +1,304 @@
+/* test-gpt-input-stream.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <musician.h>
+
+#include "musician-gpt-input-stream-private.h"
+
+static GBytes *
+get_test_bytes (const gchar *name)
+{
+  g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", name, NULL);
+  g_autoptr(GError) error = NULL;
+  gchar *contents = NULL;
+  gsize len = 0;
+
+  g_file_get_contents (path, &contents, &len, &error);
+  g_assert_no_error (error);
+
+  return g_bytes_new_take (contents, len);
+}
+
+static void
+test_input_stream_bytes (void)
+{
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+  g_autoptr(MusicianGptInputStream) mapped = NULL;
+  g_autoptr(GInputStream) base_stream = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+  g_autoptr(GError) error = NULL;
+
+  bytes = get_test_bytes ("test1.gp4");
+  base_stream = g_memory_input_stream_new_from_bytes (bytes);
+  stream = musician_gpt_input_stream_new (base_stream);
+  mapped = musician_gpt_input_stream_new_for_bytes (bytes);
+
+  /*
+   * Both backends must decode the same values from the same data, and the
+   * borrowed readers must give the same strings as the owned ones.
+   */
+  {
+    g_autofree gchar *a = musician_gpt_input_stream_read_fixed_string (stream, 30, NULL, &error);
+    const gchar *b = musician_gpt_input_stream_read_fixed_string_borrowed (mapped, 30, NULL, &error);
+
+    g_assert_no_error (error);
+    g_assert_cmpstr (a, ==, "FICHIER GUITAR PRO v4.00");
+    g_assert_cmpstr (a, ==, b);
+  }
+
+  for (guint i = 0; i < 8; i++)
+    {
+      g_autofree gchar *a = musician_gpt_input_stream_read_string (stream, NULL, &error);
+      const gchar *b = musician_gpt_input_stream_read_string_borrowed (mapped, NULL, &error);
+
+      g_assert_no_error (error);
+      g_assert_cmpstr (a, ==, b);
+    }
+
+  {
+    g_auto(GStrv) a = musician_gpt_input_stream_read_string_array (stream, NULL, &error);
+    const gchar * const *b = musician_gpt_input_stream_read_string_array_borrowed (mapped, NULL, &error);
+
+    g_assert_no_error (error);
+    g_assert_cmpint (g_strv_length (a), ==, g_strv_length ((gchar **)b));
+    for (guint i = 0; a[i] != NULL; i++)
+      g_assert_cmpstr (a[i], ==, b[i]);
+  }
+
+  /* g_input_stream_skip() must move the cursor of the mapped stream too */
+  g_assert_cmpint (g_input_stream_skip (G_INPUT_STREAM (stream), 5, NULL, &error), ==, 5);
+  g_assert_cmpint (g_input_stream_skip (G_INPUT_STREAM (mapped), 5, NULL, &error), ==, 5);
+  g_assert_no_error (error);
+
+  for (guint i = 0; i < 5; i++)
+    {
+      guint32 pos_a = 0;
+      guint32 pos_b = 0;
+      g_autofree gchar *a = musician_gpt_input_stream_read_lyric (stream, NULL, &pos_a, &error);
+      const gchar *b = musician_gpt_input_stream_read_lyric_borrowed (mapped, NULL, &pos_b, &error);
+
+      g_assert_no_error (error);
+      g_assert_cmpstr (a, ==, b);
+      g_assert_cmpint (pos_a, ==, pos_b);
+    }
+
+  {
+    guint32 tempo_a = 0;
+    guint32 tempo_b = 0;
+
+    musician_gpt_input_stream_read_tempo (stream, NULL, &tempo_a, &error);
+    g_assert_no_error (error);
+    musician_gpt_input_stream_read_tempo (mapped, NULL, &tempo_b, &error);
+    g_assert_no_error (error);
+    g_assert_cmpint (tempo_a, ==, tempo_b);
+    g_assert_cmpint (tempo_a, >, 0);
+  }
+
+  /* Only what was decoded counts, not what the buffered stream read ahead */
+  g_assert_cmpuint (_musician_gpt_input_stream_get_offset (stream), ==,
+                    _musician_gpt_input_stream_get_offset (mapped));
+
+  /* Drain the mapped stream and make sure we fail cleanly at the end */
+  while (musician_gpt_input_stream_read_byte (mapped, NULL, NULL, &error))
+    g_assert_no_error (error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+}
+
+static void
+test_input_stream_sticky (void)
+{
+  static const guint8 data[] = { 0x01, 0x02, 0x03 };
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+  g_autoptr(GError) error = NULL;
+
+  bytes = g_bytes_new_static (data, sizeof data);
+  stream = musician_gpt_input_stream_new_for_bytes (bytes);
+
+  g_assert_cmpint (_musician_gpt_input_stream_pull_byte (stream, NULL), ==, 0x01);
+  g_assert (_musician_gpt_input_stream_check (stream, NULL, &error));
+  g_assert_no_error (error);
+
+  /* Not enough data, and everything after the failure reads as zero */
+  g_assert_cmpint (_musician_gpt_input_stream_pull_uint32 (stream, NULL), ==, 0);
+  g_assert (_musician_gpt_input_stream_failed (stream));
+  g_assert_cmpint (_musician_gpt_input_stream_pull_byte (stream, NULL), ==, 0);
+  g_assert (_musician_gpt_input_stream_pull_string (stream, NULL) == NULL);
+
+  /* Only the first error is kept */
+  _musician_gpt_input_stream_set_error (stream, G_IO_ERROR, G_IO_ERROR_FAILED, "ignored");
+
+  g_assert (!_musician_gpt_input_stream_check (stream, NULL, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+  g_clear_error (&error);
+
+  /* Checking hands the error over, so the stream is usable again */
+  g_assert (!_musician_gpt_input_stream_failed (stream));
+  g_assert_cmpint (_musician_gpt_input_stream_pull_byte (stream, NULL), ==, 0x02);
+  g_assert (_musician_gpt_input_stream_check (stream, NULL, &error));
+  g_assert_no_error (error);
+}
+
+static void
+test_input_stream_midi_port (void)
+{
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+  g_autoptr(MusicianGptInputStream) pulled = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+  g_autoptr(GError) error = NULL;
+  MusicianGptMidiPort port;
+  MusicianGptMidiPort pulled_port;
+  guint8 data[16 * 12];
+
+  /* Instrument, volume, balance, chorus, reverb, phaser, tremolo, padding */
+  for (guint i = 0; i < 16; i++)
+    {
+      guint8 *channel = &data[i * 12];
+
+      channel[0] = i + 1;
+      channel[1] = channel[2] = channel[3] = 0;
+      for (guint j = 4; j < 10; j++)
+        channel[j] = i * 6 + j;
+      channel[10] = channel[11] = 0xff;
+    }
+
+  bytes = g_bytes_new (data, sizeof data);
+  stream = musician_gpt_input_stream_new_for_bytes (bytes);
+  pulled = musician_gpt_input_stream_new_for_bytes (bytes);
+
+  g_assert (musician_gpt_input_stream_read_midi_port (stream, 2, NULL, &port, &error));
+  g_assert_no_error (error);
+
+  _musician_gpt_input_stream_pull_midi_port (pulled, 2, NULL, &pulled_port);
+  g_assert (_musician_gpt_input_stream_check (pulled, NULL, &error));
+  g_assert_no_error (error);
+
+  g_assert_cmpint (pulled_port.port_id, ==, 2);
+  g_assert_cmpmem (&port, sizeof port, &pulled_port, sizeof pulled_port);
+  g_assert_cmpint (pulled_port.channels[15].instrument, ==, 16);
+  g_assert_cmpint (pulled_port.channels[15].tremelo, ==, 15 * 6 + 9);
+
+  /* A port that is cut short fails on the next check */
+  _musician_gpt_input_stream_seek (pulled, 1);
+  _musician_gpt_input_stream_pull_midi_port (pulled, 1, NULL, &pulled_port);
+  g_assert (!_musician_gpt_input_stream_check (pulled, NULL, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+}
+
+static void
+test_input_stream_reset_arena (void)
+{
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+  g_autoptr(GByteArray) data = g_byte_array_new ();
+  g_autoptr(GBytes) bytes = NULL;
+  g_autoptr(GError) error = NULL;
+  MusicianGptBudget budget;
+  guint n_read = 0;
+
+  /* 100 strings of 10 characters, 11 bytes each once decoded */
+  for (guint i = 0; i < 100; i++)
+    {
+      static const guint8 len[] = { 11, 0, 0, 0, 10 };
+
+      g_byte_array_append (data, len, sizeof len);
+      g_byte_array_append (data, (const guint8 *)"0123456789", 10);
+    }
+
+  bytes = g_byte_array_free_to_bytes (g_steal_pointer (&data));
+
+  /* Far less than the strings take all together */
+  _musician_gpt_budget_init (&budget, 64);
+
+  stream = musician_gpt_input_stream_new_for_bytes (bytes);
+  _musician_gpt_input_stream_set_budget (stream, &budget);
+
+  /* Releasing the strings after each one gives the memory back */
+  for (guint i = 0; i < 50; i++)
+    {
+      g_assert_cmpstr (musician_gpt_input_stream_read_string_borrowed (stream, NULL, &error), ==, "0123456789");
+      g_assert_no_error (error);
+
+      _musician_gpt_input_stream_reset_arena (stream);
+      g_assert_cmpuint (budget.used, ==, 0);
+    }
+
+  /* Keeping them runs into the budget */
+  while (musician_gpt_input_stream_read_string_borrowed (stream, NULL, &error) != NULL)
+    n_read++;
+
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE);
+  g_assert_cmpuint (n_read, ==, 64 / 11);
+  g_assert_cmpuint (budget.used, ==, n_read * 11);
+
+  g_clear_object (&stream);
+  g_assert_cmpuint (budget.used, ==, 0);
+  _musician_gpt_budget_clear (&budget);
+}
+
+static void
+test_input_stream_owned_strings (void)
+{
+  g_autoptr(MusicianGptInputStream) stream = NULL;
+  g_autoptr(GByteArray) data = g_byte_array_new ();
+  g_autoptr(GBytes) bytes = NULL;
+  g_autoptr(GError) error = NULL;
+  MusicianGptBudget budget;
+
+  /* 100 strings of 10 characters, 11 bytes each once decoded */
+  for (guint i = 0; i < 100; i++)
+    {
+      static const guint8 len[] = { 11, 0, 0, 0, 10 };
+
+      g_byte_array_append (data, len, sizeof len);
+      g_byte_array_append (data, (const guint8 *)"0123456789", 10);
+    }
+
+  bytes = g_byte_array_free_to_bytes (g_steal_pointer (&data));
+
+  /* Far less than the strings take all together */
+  _musician_gpt_budget_init (&budget, 64);
+
+  stream = musician_gpt_input_stream_new_for_bytes (bytes);
+  _musician_gpt_input_stream_set_budget (stream, &budget);
+
+  /* The caller owns what the public readers return, so nothing stays charged */
+  for (guint i = 0; i < 100; i++)
+    {
+      g_autofree gchar *str = musician_gpt_input_stream_read_string (stream, NULL, &error);
+
+      g_assert_no_error (error);
+      g_assert_cmpstr (str, ==, "0123456789");
+      g_assert_cmpuint (budget.used, ==, 0);
+    }
+
+  g_clear_object (&stream);
+  _musician_gpt_budget_clear (&budget);
+}
+
+gint
+main (gint argc,
+      gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  g_test_add_func ("/Musician/GptInputStream/bytes", test_input_stream_bytes);
+  g_test_add_func ("/Musician/GptInputStream/sticky", test_input_stream_sticky);
+  g_test_add_func ("/Musician/GptInputStream/midi-port", test_input_stream_midi_port);
+  g_test_add_func ("/Musician/GptInputStream/reset-arena", test_input_stream_reset_arena);
+  g_test_add_func ("/Musician/GptInputStream/owned-strings", test_input_stream_owned_strings);
+  return g_test_run ();
+}
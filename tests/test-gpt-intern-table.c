@@ -0,0 +1,102 @@
+/* test-gpt-intern-table.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <musician.h>
+
+#include "musician-gpt-intern-table.h"
+
+static void
+test_intern_table_chords (void)
+{
+  g_autoptr(MusicianGptPool) pool = musician_gpt_pool_new ();
+  g_autoptr(MusicianGptInternTable) table = musician_gpt_intern_table_new (pool);
+  g_autoptr(MusicianGptChord) am = NULL;
+  g_autoptr(MusicianGptChord) am_again = NULL;
+  g_autoptr(MusicianGptChord) g = NULL;
+  g_autoptr(MusicianGptChord) unnamed = NULL;
+  g_autoptr(MusicianGptChord) unnamed_again = NULL;
+
+  am = musician_gpt_intern_table_get_chord (table, "Am");
+  am_again = musician_gpt_intern_table_get_chord (table, "Am");
+  g = musician_gpt_intern_table_get_chord (table, "G");
+  unnamed = musician_gpt_intern_table_get_chord (table, NULL);
+  unnamed_again = musician_gpt_intern_table_get_chord (table, NULL);
+
+  g_assert (am == am_again);
+  g_assert (am != g);
+  g_assert (unnamed == unnamed_again);
+  g_assert (unnamed != am);
+  g_assert_cmpstr (musician_gpt_chord_get_name (am), ==, "Am");
+  g_assert_cmpstr (musician_gpt_chord_get_name (unnamed), ==, NULL);
+  g_assert_cmpint (musician_gpt_intern_table_get_n_items (table), ==, 3);
+
+  /* The duplicates went straight back to the pool */
+  g_assert_cmpint (musician_gpt_pool_get_n_objects (pool), ==, 3);
+}
+
+static void
+test_intern_table_bends (void)
+{
+  g_autoptr(MusicianGptPool) pool = musician_gpt_pool_new ();
+  g_autoptr(MusicianGptInternTable) table = musician_gpt_intern_table_new (pool);
+  g_autoptr(MusicianGptBend) full = NULL;
+  g_autoptr(MusicianGptBend) full_again = NULL;
+  g_autoptr(MusicianGptBend) half = NULL;
+  g_autoptr(MusicianGptBend) release = NULL;
+  MusicianGptBendPoint points[3] = { { 0 } };
+  MusicianGptBendPoint point = { 0 };
+  guint n_points;
+
+  points[1].absolute_position = 30;
+  points[1].vertical_position = 4;
+  points[2].absolute_position = 60;
+  points[2].vertical_position = 4;
+
+  full = musician_gpt_intern_table_get_bend (table, MUSICIAN_GPT_BEND_BEND, points, 3);
+  full_again = musician_gpt_intern_table_get_bend (table, MUSICIAN_GPT_BEND_BEND, points, 3);
+  release = musician_gpt_intern_table_get_bend (table, MUSICIAN_GPT_BEND_BEND_AND_RELEASE, points, 3);
+
+  points[2].vertical_position = 2;
+  half = musician_gpt_intern_table_get_bend (table, MUSICIAN_GPT_BEND_BEND, points, 3);
+
+  g_assert (full == full_again);
+  g_assert (full != release);
+  g_assert (full != half);
+  g_assert_cmpint (musician_gpt_intern_table_get_n_items (table), ==, 3);
+
+  g_assert (musician_gpt_bend_get_points (full, &n_points) != NULL);
+  g_assert_cmpint (n_points, ==, 3);
+
+  /* Shared bends cannot be changed behind the back of other beats */
+  g_test_expect_message ("musician-gpt-bend", G_LOG_LEVEL_CRITICAL, "*frozen*");
+  musician_gpt_bend_add_point (full, &point);
+  g_test_assert_expected_messages ();
+
+  musician_gpt_bend_get_points (full, &n_points);
+  g_assert_cmpint (n_points, ==, 3);
+}
+
+gint
+main (gint argc,
+      gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  g_test_add_func ("/Musician/GptInternTable/chords", test_intern_table_chords);
+  g_test_add_func ("/Musician/GptInternTable/bends", test_intern_table_bends);
+  return g_test_run ();
+}
@@ -18,6 +18,8 @@
 
 #include <musician.h>
 
+#include "musician-gpt-trace-private.h"
+
 static GInputStream *
 get_test_file (const gchar   *name,
                GCancellable  *cancellable,
@@ -51,11 +53,637 @@ test_parser_basic (void)
   g_assert (parser == NULL);
 }
 
+static void
+test_parser_bytes (void)
+{
+  g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", "test1.gp4", NULL);
+  g_autoptr(MusicianGptParser) parser = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+  MusicianGptSong *song;
+  gchar *contents = NULL;
+  gsize len = 0;
+  gint r;
+
+  g_file_get_contents (path, &contents, &len, &error);
+  g_assert_no_error (error);
+  bytes = g_bytes_new_take (contents, len);
+
+  parser = musician_gpt_parser_new ();
+  r = musician_gpt_parser_load_from_bytes (parser, bytes, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (r, ==, 1);
+
+  song = musician_gpt_parser_get_song (parser);
+  g_assert (song != NULL);
+  g_assert_cmpstr (musician_gpt_song_get_title (song), ==, "Eruption");
+  g_assert_cmpint (musician_gpt_song_get_n_measures (song), ==, 42);
+  g_assert_cmpint (musician_gpt_song_get_n_tracks (song), ==, 1);
+}
+
+static void
+test_parser_scan (void)
+{
+  g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", "test1.gp4", NULL);
+  g_autoptr(GFile) file = g_file_new_for_path (path);
+  g_autoptr(MusicianGptParser) parser = NULL;
+  g_autoptr(GError) error = NULL;
+
+  parser = musician_gpt_parser_new ();
+
+  /* Scanning never creates a song, so the parser can be reused */
+  for (guint i = 0; i < 2; i++)
+    {
+      g_autoptr(MusicianGptMetadata) metadata = NULL;
+      g_autoptr(GInputStream) stream = NULL;
+
+      if (i == 0)
+        {
+          metadata = musician_gpt_parser_scan_from_file (parser, file, NULL, &error);
+        }
+      else
+        {
+          stream = get_test_file ("test1.gp4", NULL, &error);
+          g_assert_no_error (error);
+          metadata = musician_gpt_parser_scan_from_stream (parser, stream, NULL, &error);
+        }
+
+      g_assert_no_error (error);
+      g_assert (metadata != NULL);
+      g_assert_cmpstr (musician_gpt_metadata_get_version (metadata), ==, "FICHIER GUITAR PRO v4.00");
+      g_assert_cmpstr (musician_gpt_metadata_get_title (metadata), ==, "Eruption");
+      g_assert_cmpstr (musician_gpt_metadata_get_artist (metadata), ==, "eddie van halen");
+      g_assert_cmpint (musician_gpt_metadata_get_tempo (metadata), ==, 92);
+      g_assert_cmpint (musician_gpt_metadata_get_n_measures (metadata), ==, 42);
+      g_assert_cmpint (musician_gpt_metadata_get_n_tracks (metadata), ==, 1);
+    }
+
+  g_assert (musician_gpt_parser_get_song (parser) == NULL);
+}
+
+static void
+test_parser_async_cb (GObject      *object,
+                      GAsyncResult *result,
+                      gpointer      user_data)
+{
+  MusicianGptParser *parser = (MusicianGptParser *)object;
+  GMainLoop *main_loop = user_data;
+  g_autoptr(GError) error = NULL;
+  MusicianGptSong *song;
+  gboolean r;
+
+  r = musician_gpt_parser_load_from_file_finish (parser, result, &error);
+  g_assert_no_error (error);
+  g_assert_true (r);
+
+  song = musician_gpt_parser_get_song (parser);
+  g_assert (song != NULL);
+  g_assert_cmpstr (musician_gpt_song_get_title (song), ==, "Eruption");
+  g_assert_cmpint (musician_gpt_song_get_n_measures (song), ==, 42);
+
+  g_main_loop_quit (main_loop);
+}
+
+static void
+test_parser_async (void)
+{
+  g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", "test1.gp4", NULL);
+  g_autoptr(GFile) file = g_file_new_for_path (path);
+  g_autoptr(MusicianGptParser) parser = NULL;
+  g_autoptr(GMainLoop) main_loop = NULL;
+  g_autoptr(GError) error = NULL;
+
+  main_loop = g_main_loop_new (NULL, FALSE);
+  parser = musician_gpt_parser_new ();
+
+  musician_gpt_parser_load_from_file_async (parser, file, NULL, test_parser_async_cb, main_loop);
+  g_main_loop_run (main_loop);
+
+  /* The parser has a song now, so it cannot be used again */
+  g_assert_false (musician_gpt_parser_load_from_file (parser, file, NULL, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVAL);
+}
+
+static void
+test_parser_async_options_cb (GObject      *object,
+                              GAsyncResult *result,
+                              gpointer      user_data)
+{
+  MusicianGptParser *parser = (MusicianGptParser *)object;
+  GMainLoop *main_loop = user_data;
+  g_autoptr(GError) error = NULL;
+  gboolean r;
+
+  r = musician_gpt_parser_load_from_file_finish (parser, result, &error);
+  g_assert_no_error (error);
+  g_assert_true (r);
+
+  g_main_loop_quit (main_loop);
+}
+
+static void
+test_parser_async_options (void)
+{
+  g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", "test1.gp4", NULL);
+  g_autoptr(GFile) file = g_file_new_for_path (path);
+  g_autoptr(MusicianGptParser) eager = NULL;
+  g_autoptr(MusicianGptParser) parser = NULL;
+  g_autoptr(GMainLoop) main_loop = NULL;
+  g_autoptr(GError) error = NULL;
+  MusicianGptParseStats eager_stats;
+  MusicianGptParseStats stats;
+  gboolean r;
+
+  eager = musician_gpt_parser_new ();
+  r = musician_gpt_parser_load_from_file (eager, file, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (r);
+  g_assert_true (musician_gpt_parser_get_stats (eager, &eager_stats));
+
+  main_loop = g_main_loop_new (NULL, FALSE);
+  parser = musician_gpt_parser_new ();
+  musician_gpt_parser_set_lazy (parser, TRUE);
+
+  /* The load goes by the options the parser had when it was started */
+  musician_gpt_parser_load_from_file_async (parser, file, NULL, test_parser_async_options_cb, main_loop);
+  musician_gpt_parser_set_lazy (parser, FALSE);
+  musician_gpt_parser_set_parallel (parser, TRUE);
+  g_main_loop_run (main_loop);
+
+  g_assert_true (musician_gpt_parser_get_stats (parser, &stats));
+  g_assert_cmpint (stats.n_deferred, >, eager_stats.n_deferred);
+}
+
+typedef struct
+{
+  gchar *title;
+  guint  n_measures;
+  guint  n_tracks;
+  guint  n_measure_headers;
+  guint  n_track_events;
+  guint  n_beats;
+} EventCounts;
+
+static void
+test_parser_events_header (const MusicianGptHeaderEvent  *event,
+                           gpointer                       user_data,
+                           GError                       **error)
+{
+  EventCounts *counts = user_data;
+
+  /* Strings are only valid for the duration of the callback */
+  counts->title = g_strdup (event->title);
+  counts->n_measures = event->n_measures;
+  counts->n_tracks = event->n_tracks;
+}
+
+static void
+test_parser_events_measure_header (const MusicianGptMeasureHeaderEvent  *event,
+                                   gpointer                              user_data,
+                                   GError                              **error)
+{
+  EventCounts *counts = user_data;
+
+  /* Measures are numbered from 1 */
+  counts->n_measure_headers++;
+  g_assert_cmpint (event->id, ==, counts->n_measure_headers);
+}
+
+static void
+test_parser_events_track (const MusicianGptTrackEvent  *event,
+                          gpointer                      user_data,
+                          GError                      **error)
+{
+  EventCounts *counts = user_data;
+
+  counts->n_track_events++;
+}
+
+static void
+test_parser_events_beat (const MusicianGptBeatEvent  *event,
+                         gpointer                     user_data,
+                         GError                     **error)
+{
+  EventCounts *counts = user_data;
+
+  g_assert_cmpint (event->measure, >=, 1);
+  g_assert_cmpint (event->measure, <=, counts->n_measures);
+  g_assert_cmpint (event->track, >=, 1);
+  g_assert_cmpint (event->track, <=, counts->n_tracks);
+  counts->n_beats++;
+}
+
+static void
+test_parser_events (void)
+{
+  static const MusicianGptEvents events = {
+    .on_header = test_parser_events_header,
+    .on_measure_header = test_parser_events_measure_header,
+    .on_track = test_parser_events_track,
+    .on_beat = test_parser_events_beat,
+  };
+  g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", "test1.gp4", NULL);
+  g_autoptr(GFile) file = g_file_new_for_path (path);
+  g_autoptr(MusicianGptParser) parser = NULL;
+  g_autoptr(GError) error = NULL;
+  EventCounts counts = { 0 };
+  gboolean r;
+
+  parser = musician_gpt_parser_new ();
+
+  r = musician_gpt_parser_parse_from_file (parser, file, &events, &counts, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (r);
+
+  g_assert_cmpstr (counts.title, ==, "Eruption");
+  g_assert_cmpint (counts.n_measures, ==, 42);
+  g_assert_cmpint (counts.n_tracks, ==, 1);
+  g_assert_cmpint (counts.n_measure_headers, ==, 42);
+  g_assert_cmpint (counts.n_track_events, ==, 1);
+  g_assert_cmpint (counts.n_beats, >, 0);
+
+  /* No song is built in this mode */
+  g_assert (musician_gpt_parser_get_song (parser) == NULL);
+
+  g_free (counts.title);
+}
+
+static void
+assert_beats_equal (GPtrArray *expected,
+                    GPtrArray *beats)
+{
+  g_assert_cmpint (beats->len, ==, expected->len);
+
+  for (guint i = 0; i < beats->len; i++)
+    {
+      MusicianGptBeat *a = g_ptr_array_index (expected, i);
+      MusicianGptBeat *b = g_ptr_array_index (beats, i);
+
+      g_assert_cmpint (musician_gpt_beat_get_mode (a), ==, musician_gpt_beat_get_mode (b));
+      g_assert_cmpint (musician_gpt_beat_get_duration (a), ==, musician_gpt_beat_get_duration (b));
+      g_assert_cmpint (musician_gpt_beat_get_n_tuplet (a), ==, musician_gpt_beat_get_n_tuplet (b));
+      g_assert_cmpstr (musician_gpt_beat_get_text (a), ==, musician_gpt_beat_get_text (b));
+      g_assert ((musician_gpt_beat_get_chord (a) == NULL) == (musician_gpt_beat_get_chord (b) == NULL));
+    }
+}
+
+static void
+test_parser_lazy (void)
+{
+  g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", "test1.gp4", NULL);
+  g_autoptr(GFile) file = g_file_new_for_path (path);
+  g_autoptr(MusicianGptParser) eager = NULL;
+  g_autoptr(MusicianGptParser) lazy = NULL;
+  g_autoptr(GError) error = NULL;
+  MusicianGptBeatStore *store;
+  MusicianGptSong *eager_song;
+  MusicianGptSong *lazy_song;
+  guint n_beats = 0;
+  gboolean r;
+
+  eager = musician_gpt_parser_new ();
+  r = musician_gpt_parser_load_from_file (eager, file, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (r);
+
+  lazy = musician_gpt_parser_new ();
+  musician_gpt_parser_set_lazy (lazy, TRUE);
+  r = musician_gpt_parser_load_from_file (lazy, file, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (r);
+
+  eager_song = musician_gpt_parser_get_song (eager);
+  lazy_song = musician_gpt_parser_get_song (lazy);
+
+  g_assert_cmpint (musician_gpt_song_get_n_measures (lazy_song), ==, 42);
+  g_assert_cmpint (musician_gpt_song_get_n_tracks (lazy_song), ==, 1);
+
+  /* Go backwards so blocks are not decoded in file order */
+  for (guint measure = 42; measure >= 1; measure--)
+    {
+      g_autoptr(GPtrArray) expected = NULL;
+      g_autoptr(GPtrArray) beats = NULL;
+      g_autoptr(GPtrArray) cached = NULL;
+
+      expected = musician_gpt_song_get_beats (eager_song, measure, 1, NULL, &error);
+      g_assert_no_error (error);
+      beats = musician_gpt_song_get_beats (lazy_song, measure, 1, NULL, &error);
+      g_assert_no_error (error);
+
+      assert_beats_equal (expected, beats);
+
+      /* The second request does not decode the measure again */
+      cached = musician_gpt_song_get_beats (lazy_song, measure, 1, NULL, &error);
+      g_assert_no_error (error);
+      assert_beats_equal (beats, cached);
+
+      n_beats += beats->len;
+    }
+
+  g_assert_cmpint (n_beats, >, 0);
+
+  store = musician_gpt_song_get_beat_store (lazy_song, 1, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (musician_gpt_beat_store_get_n_beats (store), ==, n_beats);
+
+  g_assert_null (musician_gpt_song_get_beats (lazy_song, 43, 1, NULL, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
+}
+
+static void
+test_parser_parallel (void)
+{
+  g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", "test1.gp4", NULL);
+  g_autoptr(GFile) file = g_file_new_for_path (path);
+  g_autoptr(MusicianGptParser) serial = NULL;
+  g_autoptr(MusicianGptParser) parallel = NULL;
+  g_autoptr(GError) error = NULL;
+  MusicianGptSong *serial_song;
+  MusicianGptSong *parallel_song;
+  gboolean r;
+
+  serial = musician_gpt_parser_new ();
+  r = musician_gpt_parser_load_from_file (serial, file, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (r);
+
+  parallel = musician_gpt_parser_new ();
+  musician_gpt_parser_set_parallel (parallel, TRUE);
+  r = musician_gpt_parser_load_from_file (parallel, file, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (r);
+
+  serial_song = musician_gpt_parser_get_song (serial);
+  parallel_song = musician_gpt_parser_get_song (parallel);
+
+  g_assert_cmpint (musician_gpt_song_get_n_measures (parallel_song), ==, 42);
+  g_assert_cmpint (musician_gpt_song_get_n_tracks (parallel_song), ==, 1);
+
+  for (guint measure = 1; measure <= 42; measure++)
+    {
+      g_autoptr(GPtrArray) expected = NULL;
+      g_autoptr(GPtrArray) beats = NULL;
+
+      expected = musician_gpt_song_get_beats (serial_song, measure, 1, NULL, &error);
+      g_assert_no_error (error);
+      beats = musician_gpt_song_get_beats (parallel_song, measure, 1, NULL, &error);
+      g_assert_no_error (error);
+
+      assert_beats_equal (expected, beats);
+    }
+}
+
+static void
+test_parser_beat_store (void)
+{
+  g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", "test1.gp4", NULL);
+  g_autoptr(GFile) file = g_file_new_for_path (path);
+  g_autoptr(MusicianGptParser) parser = NULL;
+  g_autoptr(MusicianGptParser) parallel = NULL;
+  g_autoptr(GError) error = NULL;
+  MusicianGptBeatStore *parallel_store;
+  MusicianGptBeatStore *store;
+  MusicianGptSong *song;
+  const guint8 *durations;
+  guint next_beat = 0;
+  guint n_beats;
+  gboolean r;
+
+  parser = musician_gpt_parser_new ();
+  r = musician_gpt_parser_load_from_file (parser, file, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (r);
+
+  song = musician_gpt_parser_get_song (parser);
+  store = musician_gpt_song_get_beat_store (song, 1, NULL, &error);
+  g_assert_no_error (error);
+  g_assert (store != NULL);
+
+  n_beats = musician_gpt_beat_store_get_n_beats (store);
+  durations = musician_gpt_beat_store_get_durations (store);
+  g_assert_cmpint (n_beats, >, 0);
+  g_assert_cmpint (musician_gpt_beat_store_get_n_measures (store), ==, 42);
+
+  /* Measures of an eagerly loaded song follow each other in the columns */
+  for (guint measure = 1; measure <= 42; measure++)
+    {
+      g_autoptr(GPtrArray) beats = NULL;
+      guint first_beat;
+      guint n_measure_beats;
+
+      r = musician_gpt_beat_store_get_measure (store, measure, &first_beat, &n_measure_beats);
+      g_assert_true (r);
+
+      beats = musician_gpt_song_get_beats (song, measure, 1, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_cmpint (beats->len, ==, n_measure_beats);
+
+      if (n_measure_beats > 0)
+        g_assert_cmpint (first_beat, ==, next_beat);
+
+      for (guint i = 0; i < n_measure_beats; i++)
+        {
+          MusicianGptBeat *beat = g_ptr_array_index (beats, i);
+          MusicianGptBeatView view;
+
+          musician_gpt_beat_store_get_view (store, first_beat + i, &view);
+
+          g_assert_cmpint (view.duration, ==, durations[first_beat + i]);
+          g_assert_cmpint (view.mode, ==, musician_gpt_beat_get_mode (beat));
+          g_assert_cmpint (view.duration, ==, musician_gpt_beat_get_duration (beat));
+          g_assert_cmpint (view.dynamics, ==, musician_gpt_beat_get_dynamics (beat));
+          g_assert_cmpstr (view.text, ==, musician_gpt_beat_get_text (beat));
+          g_assert (view.chord == musician_gpt_beat_get_chord (beat));
+
+          for (guint j = 0; j < view.n_bends; j++)
+            g_assert (musician_gpt_beat_store_get_bend (store, first_beat + i, j, NULL) != NULL);
+          g_assert (musician_gpt_beat_store_get_bend (store, first_beat + i, view.n_bends, NULL) == NULL);
+        }
+
+      next_beat += n_measure_beats;
+    }
+
+  g_assert_cmpint (next_beat, ==, n_beats);
+  g_assert_false (musician_gpt_beat_store_get_measure (store, 43, &next_beat, &n_beats));
+
+  g_assert_null (musician_gpt_song_get_beat_store (song, 2, NULL, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
+  g_clear_error (&error);
+
+  /* Gathering the measures decoded on other threads gives the same columns */
+  parallel = musician_gpt_parser_new ();
+  musician_gpt_parser_set_parallel (parallel, TRUE);
+  r = musician_gpt_parser_load_from_file (parallel, file, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (r);
+
+  parallel_store = musician_gpt_song_get_beat_store (musician_gpt_parser_get_song (parallel), 1, NULL, &error);
+  g_assert_no_error (error);
+
+  n_beats = musician_gpt_beat_store_get_n_beats (store);
+  g_assert_cmpint (musician_gpt_beat_store_get_n_beats (parallel_store), ==, n_beats);
+  g_assert_cmpmem (musician_gpt_beat_store_get_modes (store), n_beats,
+                   musician_gpt_beat_store_get_modes (parallel_store), n_beats);
+  g_assert_cmpmem (musician_gpt_beat_store_get_durations (store), n_beats,
+                   musician_gpt_beat_store_get_durations (parallel_store), n_beats);
+  g_assert_cmpmem (musician_gpt_beat_store_get_flags (store), n_beats,
+                   musician_gpt_beat_store_get_flags (parallel_store), n_beats);
+
+  /* As do the chords, texts and bends moved over from each slice */
+  for (guint i = 0; i < n_beats; i++)
+    {
+      MusicianGptBeatView view;
+      MusicianGptBeatView parallel_view;
+
+      musician_gpt_beat_store_get_view (store, i, &view);
+      musician_gpt_beat_store_get_view (parallel_store, i, &parallel_view);
+
+      g_assert_cmpstr (view.text, ==, parallel_view.text);
+      g_assert_cmpint (view.chord != NULL, ==, parallel_view.chord != NULL);
+      g_assert_cmpint (view.n_bends, ==, parallel_view.n_bends);
+    }
+
+  for (guint measure = 1; measure <= 42; measure++)
+    {
+      guint first_beat;
+      guint n_measure_beats;
+      guint parallel_first_beat;
+      guint parallel_n_measure_beats;
+
+      musician_gpt_beat_store_get_measure (store, measure, &first_beat, &n_measure_beats);
+      musician_gpt_beat_store_get_measure (parallel_store, measure, &parallel_first_beat, &parallel_n_measure_beats);
+
+      g_assert_cmpint (parallel_n_measure_beats, ==, n_measure_beats);
+      if (n_measure_beats > 0)
+        g_assert_cmpint (parallel_first_beat, ==, first_beat);
+    }
+}
+
+static void
+test_parser_stats (void)
+{
+  g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", "test1.gp4", NULL);
+  g_autoptr(MusicianGptParseStats) copy = NULL;
+  g_autoptr(MusicianGptParser) parser = NULL;
+  g_autoptr(MusicianGptParser) parallel = NULL;
+  g_autoptr(MusicianGptParser) lazy = NULL;
+  g_autoptr(GInputStream) base_stream = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+  MusicianGptParseStats stats;
+  MusicianGptParseStats parallel_stats;
+  MusicianGptParseStats lazy_stats;
+  gchar *contents = NULL;
+  gsize len = 0;
+  gboolean r;
+
+  parser = musician_gpt_parser_new ();
+  g_assert_false (musician_gpt_parser_get_stats (parser, &stats));
+  g_object_get (parser, "stats", &copy, NULL);
+  g_assert (copy == NULL);
+
+  /* Not decoded from memory, so the offset is what was read from the base stream */
+  base_stream = get_test_file ("test1.gp4", NULL, &error);
+  g_assert_no_error (error);
+  r = musician_gpt_parser_load_from_stream (parser, base_stream, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (r);
+
+  g_file_get_contents (path, &contents, &len, &error);
+  g_assert_no_error (error);
+  bytes = g_bytes_new_take (contents, len);
+
+  g_assert_true (musician_gpt_parser_get_stats (parser, &stats));
+  g_assert_cmpuint (stats.n_bytes, >, 0);
+  g_assert_cmpuint (stats.n_bytes, <=, len);
+  g_assert_cmpint (stats.header_usec, >=, 0);
+  g_assert_cmpint (stats.beats_usec, >=, 0);
+  g_assert_cmpuint (stats.n_measures, ==, 42);
+  g_assert_cmpuint (stats.n_tracks, ==, 1);
+  g_assert_cmpuint (stats.n_beats, >, 0);
+  g_assert_cmpuint (stats.n_deferred, ==, 0);
+  g_assert_cmpuint (stats.allocated, >, 0);
+  g_assert_cmpuint (stats.peak_arena_size, >, 0);
+
+  g_object_get (parser, "stats", &copy, NULL);
+  g_assert (copy != NULL);
+  g_assert_cmpuint (copy->n_beats, ==, stats.n_beats);
+
+  /* The first pass of a parallel load sees every beat as well */
+  parallel = musician_gpt_parser_new ();
+  musician_gpt_parser_set_parallel (parallel, TRUE);
+  r = musician_gpt_parser_load_from_bytes (parallel, bytes, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (r);
+
+  g_assert_true (musician_gpt_parser_get_stats (parallel, &parallel_stats));
+  g_assert_cmpuint (parallel_stats.n_bytes, ==, stats.n_bytes);
+  g_assert_cmpuint (parallel_stats.n_beats, ==, stats.n_beats);
+  g_assert_cmpuint (parallel_stats.n_chords, ==, stats.n_chords);
+  g_assert_cmpuint (parallel_stats.n_bends, ==, stats.n_bends);
+  g_assert_cmpuint (parallel_stats.n_unsupported, ==, stats.n_unsupported);
+  g_assert_cmpuint (parallel_stats.n_deferred, ==, 0);
+
+  /* What the workers allocate is counted along with the first pass */
+  g_assert_cmpuint (parallel_stats.allocated, >=, stats.allocated);
+  g_assert_cmpuint (parallel_stats.peak_arena_size, >, 0);
+
+  /* A lazy load leaves every measure/track pair for later */
+  lazy = musician_gpt_parser_new ();
+  musician_gpt_parser_set_lazy (lazy, TRUE);
+  r = musician_gpt_parser_load_from_bytes (lazy, bytes, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (r);
+
+  g_assert_true (musician_gpt_parser_get_stats (lazy, &lazy_stats));
+  g_assert_cmpuint (lazy_stats.n_bytes, ==, stats.n_bytes);
+  g_assert_cmpuint (lazy_stats.n_unsupported, ==, stats.n_unsupported);
+  g_assert_cmpuint (lazy_stats.n_deferred, ==, lazy_stats.n_measures * lazy_stats.n_tracks);
+}
+
+static void
+test_parser_trace (void)
+{
+  if (g_test_subprocess ())
+    {
+      g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", "test1.gp4", NULL);
+      g_autoptr(GFile) file = g_file_new_for_path (path);
+      g_autoptr(MusicianGptParser) parser = musician_gpt_parser_new ();
+      g_autoptr(GError) error = NULL;
+      gboolean r;
+
+      /* After the parser class has looked at MUSICIAN_TRACE */
+      _musician_gpt_trace_set_flags (MUSICIAN_GPT_TRACE_STDERR);
+
+      r = musician_gpt_parser_load_from_file (parser, file, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_true (r);
+
+      return;
+    }
+
+  g_test_trap_subprocess (NULL, 0, 0);
+  g_test_trap_assert_passed ();
+  g_test_trap_assert_stderr ("*gp4:attributes*gp4:midi-ports*gp4:measures*42 records*"
+                             "gp4:tracks*1 records*gp4:measure-pairs*42 measures, 1 tracks*"
+                             "parser:load*MusicianGp4Parser for \"FICHIER GUITAR PRO v4.00\"*");
+}
+
 gint
 main (gint argc,
       gchar *argv[])
 {
   g_test_init (&argc, &argv, NULL);
   g_test_add_func ("/Musician/GptParser/basic", test_parser_basic);
+  g_test_add_func ("/Musician/GptParser/bytes", test_parser_bytes);
+  g_test_add_func ("/Musician/GptParser/scan", test_parser_scan);
+  g_test_add_func ("/Musician/GptParser/async", test_parser_async);
+  g_test_add_func ("/Musician/GptParser/async-options", test_parser_async_options);
+  g_test_add_func ("/Musician/GptParser/events", test_parser_events);
+  g_test_add_func ("/Musician/GptParser/lazy", test_parser_lazy);
+  g_test_add_func ("/Musician/GptParser/parallel", test_parser_parallel);
+  g_test_add_func ("/Musician/GptParser/beat-store", test_parser_beat_store);
+  g_test_add_func ("/Musician/GptParser/stats", test_parser_stats);
+  g_test_add_func ("/Musician/GptParser/trace", test_parser_trace);
   return g_test_run ();
 }
@@ -0,0 +1,138 @@
+/* test-gpt-pool.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <musician.h>
+#include <string.h>
+
+#include "musician-gpt-pool.h"
+#include "musician-gpt-song-private.h"
+
+static void
+test_pool_alloc (void)
+{
+  g_autoptr(MusicianGptPool) pool = musician_gpt_pool_new ();
+  g_autoptr(GPtrArray) slots = g_ptr_array_new ();
+  gpointer slot;
+  guint n_chunks;
+
+  for (guint i = 0; i < 10000; i++)
+    {
+      guint8 *mem = musician_gpt_pool_alloc0 (pool, MUSICIAN_GPT_POOL_BEAT, 24);
+
+      for (guint j = 0; j < 24; j++)
+        g_assert_cmpint (mem[j], ==, 0);
+
+      memset (mem, 0xff, 24);
+      g_ptr_array_add (slots, mem);
+    }
+
+  g_assert_cmpint (musician_gpt_pool_get_n_objects (pool), ==, 10000);
+
+  /* Ten thousand objects, only a few chunks */
+  n_chunks = musician_gpt_pool_get_n_chunks (pool);
+  g_assert_cmpint (n_chunks, >, 0);
+  g_assert_cmpint (n_chunks, <=, 10);
+
+  for (guint i = 0; i < slots->len; i++)
+    musician_gpt_pool_free (pool, MUSICIAN_GPT_POOL_BEAT, g_ptr_array_index (slots, i));
+
+  g_assert_cmpint (musician_gpt_pool_get_n_objects (pool), ==, 0);
+
+  /* Freed slots are handed out again, zeroed */
+  slot = musician_gpt_pool_alloc0 (pool, MUSICIAN_GPT_POOL_BEAT, 24);
+  g_assert (slot == g_ptr_array_index (slots, slots->len - 1));
+  g_assert_cmpint (((guint8 *)slot)[0], ==, 0);
+  g_assert_cmpint (musician_gpt_pool_get_n_chunks (pool), ==, n_chunks);
+
+  musician_gpt_pool_free (pool, MUSICIAN_GPT_POOL_BEAT, slot);
+}
+
+static void
+test_pool_song (void)
+{
+  g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", "test1.gp4", NULL);
+  g_autoptr(MusicianGptParser) parser = musician_gpt_parser_new ();
+  g_autoptr(GFile) file = g_file_new_for_path (path);
+  g_autoptr(GPtrArray) beats = NULL;
+  g_autoptr(MusicianGptPool) pool = NULL;
+  g_autoptr(GError) error = NULL;
+  MusicianGptSong *song;
+  guint n_objects;
+
+  musician_gpt_parser_load_from_file (parser, file, NULL, &error);
+  g_assert_no_error (error);
+
+  song = musician_gpt_parser_get_song (parser);
+  g_object_add_weak_pointer (G_OBJECT (song), (gpointer *)&song);
+  pool = musician_gpt_pool_ref (_musician_gpt_song_get_pool (song));
+  n_objects = musician_gpt_pool_get_n_objects (pool);
+
+  beats = musician_gpt_song_get_beats (song, 1, 1, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (beats->len, >, 0);
+  g_assert_cmpint (musician_gpt_pool_get_n_objects (pool), ==, n_objects + beats->len);
+
+  /* Beats keep working after the song is gone */
+  g_clear_object (&parser);
+  g_assert (song == NULL);
+  g_assert_cmpint (musician_gpt_beat_get_duration (g_ptr_array_index (beats, 0)), <=, G_MAXINT8);
+
+  g_clear_pointer (&beats, g_ptr_array_unref);
+  g_assert_cmpint (musician_gpt_pool_get_n_objects (pool), ==, 0);
+}
+
+static void
+test_pool_bend_points (void)
+{
+  g_autoptr(MusicianGptBend) bend = musician_gpt_bend_new ();
+  const MusicianGptBendPoint *points;
+  guint n_points;
+
+  points = musician_gpt_bend_get_points (bend, &n_points);
+  g_assert_cmpint (n_points, ==, 0);
+
+  /* Past the inline points, everything moves to the heap in order */
+  for (guint i = 0; i < 20; i++)
+    {
+      MusicianGptBendPoint point = { 0 };
+
+      point.absolute_position = i;
+      point.vertical_position = i * 25;
+      musician_gpt_bend_add_point (bend, &point);
+
+      points = musician_gpt_bend_get_points (bend, &n_points);
+      g_assert_cmpint (n_points, ==, i + 1);
+
+      for (guint j = 0; j < n_points; j++)
+        {
+          g_assert_cmpint (points[j].absolute_position, ==, j);
+          g_assert_cmpint (points[j].vertical_position, ==, j * 25);
+        }
+    }
+}
+
+gint
+main (gint argc,
+      gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  g_test_add_func ("/Musician/GptPool/alloc", test_pool_alloc);
+  g_test_add_func ("/Musician/GptPool/song", test_pool_song);
+  g_test_add_func ("/Musician/GptPool/bend-points", test_pool_bend_points);
+  return g_test_run ();
+}
@@ -0,0 +1,166 @@
+/* test-gpt-push-parser.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <musician.h>
+#include <string.h>
+
+static GBytes *
+get_test_bytes (const gchar *name)
+{
+  g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", name, NULL);
+  g_autoptr(GError) error = NULL;
+  gchar *contents = NULL;
+  gsize len = 0;
+
+  g_file_get_contents (path, &contents, &len, &error);
+  g_assert_no_error (error);
+
+  return g_bytes_new_take (contents, len);
+}
+
+static void
+test_push_parser_chunks (void)
+{
+  static const gsize chunk_sizes[] = { 1, 3, 7, 64, 4096, G_MAXSIZE };
+  g_autoptr(GBytes) bytes = get_test_bytes ("test1.gp4");
+  const guint8 *data;
+  gsize len;
+
+  data = g_bytes_get_data (bytes, &len);
+
+  for (guint i = 0; i < G_N_ELEMENTS (chunk_sizes); i++)
+    {
+      g_autoptr(MusicianGptPushParser) parser = musician_gpt_push_parser_new ();
+      g_autoptr(GError) error = NULL;
+      MusicianGptPushStatus status = MUSICIAN_GPT_PUSH_STATUS_NEED_MORE_DATA;
+      MusicianGptSong *song;
+      gsize max_buffered = 0;
+      gsize pos = 0;
+
+      while (pos < len)
+        {
+          gsize n = MIN (chunk_sizes[i], len - pos);
+
+          status = musician_gpt_push_parser_feed (parser, &data[pos], n, NULL, &error);
+          g_assert_no_error (error);
+          g_assert_cmpint (status, !=, MUSICIAN_GPT_PUSH_STATUS_ERROR);
+
+          max_buffered = MAX (max_buffered, musician_gpt_push_parser_get_n_buffered (parser));
+          pos += n;
+        }
+
+      g_assert_cmpint (status, ==, MUSICIAN_GPT_PUSH_STATUS_DONE);
+      g_assert_true (musician_gpt_push_parser_close (parser, &error));
+      g_assert_no_error (error);
+
+      /*
+       * Only an incomplete record is ever held back. The largest one is the
+       * block of MIDI ports (768 bytes) along with the counts after it.
+       */
+      if (chunk_sizes[i] < 256)
+        g_assert_cmpuint (max_buffered, <, 1024);
+
+      song = musician_gpt_push_parser_get_song (parser);
+      g_assert (song != NULL);
+      g_assert_cmpstr (musician_gpt_song_get_title (song), ==, "Eruption");
+      g_assert_cmpint (musician_gpt_song_get_tempo (song), ==, 92);
+      g_assert_cmpint (musician_gpt_song_get_n_measures (song), ==, 42);
+      g_assert_cmpint (musician_gpt_song_get_n_tracks (song), ==, 1);
+    }
+}
+
+static void
+test_push_parser_bytewise (void)
+{
+  g_autoptr(MusicianGptPushParser) whole = musician_gpt_push_parser_new ();
+  g_autoptr(MusicianGptPushParser) parser = musician_gpt_push_parser_new ();
+  g_autoptr(GBytes) bytes = get_test_bytes ("test1.gp4");
+  g_autoptr(GError) error = NULL;
+  MusicianGptPushStatus status = MUSICIAN_GPT_PUSH_STATUS_NEED_MORE_DATA;
+  const guint8 *data;
+  gsize n_allocated;
+  gsize len;
+
+  data = g_bytes_get_data (bytes, &len);
+
+  status = musician_gpt_push_parser_feed (whole, data, len, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (status, ==, MUSICIAN_GPT_PUSH_STATUS_DONE);
+  n_allocated = musician_gpt_push_parser_get_n_allocated (whole);
+
+  /* Records decoded again as their bytes trickle in do not leave anything behind */
+  for (gsize pos = 0; pos < len && status != MUSICIAN_GPT_PUSH_STATUS_DONE; pos++)
+    {
+      status = musician_gpt_push_parser_feed (parser, &data[pos], 1, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_cmpint (status, !=, MUSICIAN_GPT_PUSH_STATUS_ERROR);
+      g_assert_cmpuint (musician_gpt_push_parser_get_n_allocated (parser), <=, n_allocated);
+    }
+
+  g_assert_cmpint (status, ==, MUSICIAN_GPT_PUSH_STATUS_DONE);
+  g_assert_cmpuint (musician_gpt_push_parser_get_n_allocated (parser), ==, n_allocated);
+}
+
+static void
+test_push_parser_truncated (void)
+{
+  g_autoptr(MusicianGptPushParser) parser = musician_gpt_push_parser_new ();
+  g_autoptr(GBytes) bytes = get_test_bytes ("test1.gp4");
+  g_autoptr(GError) error = NULL;
+  MusicianGptPushStatus status;
+  const guint8 *data;
+  gsize len;
+
+  data = g_bytes_get_data (bytes, &len);
+
+  status = musician_gpt_push_parser_feed (parser, data, len / 2, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (status, ==, MUSICIAN_GPT_PUSH_STATUS_NEED_MORE_DATA);
+  g_assert (musician_gpt_push_parser_get_song (parser) == NULL);
+
+  g_assert_false (musician_gpt_push_parser_close (parser, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+}
+
+static void
+test_push_parser_invalid (void)
+{
+  g_autoptr(MusicianGptPushParser) parser = musician_gpt_push_parser_new ();
+  g_autoptr(GError) error = NULL;
+  guint8 data[64] = { 0 };
+  MusicianGptPushStatus status;
+
+  data[0] = 11;
+  memcpy (&data[1], "not a file!", 11);
+
+  status = musician_gpt_push_parser_feed (parser, data, sizeof data, NULL, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED);
+  g_assert_cmpint (status, ==, MUSICIAN_GPT_PUSH_STATUS_ERROR);
+}
+
+gint
+main (gint argc,
+      gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  g_test_add_func ("/Musician/GptPushParser/chunks", test_push_parser_chunks);
+  g_test_add_func ("/Musician/GptPushParser/bytewise", test_push_parser_bytewise);
+  g_test_add_func ("/Musician/GptPushParser/truncated", test_push_parser_truncated);
+  g_test_add_func ("/Musician/GptPushParser/invalid", test_push_parser_invalid);
+  return g_test_run ();
+}
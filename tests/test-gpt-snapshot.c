@@ -0,0 +1,268 @@
+/* test-gpt-snapshot.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib/gstdio.h>
+#include <musician.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "musician-gpt-snapshot-private.h"
+
+static MusicianGptSong *
+load_test_song (const gchar *name)
+{
+  g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", name, NULL);
+  g_autoptr(MusicianGptParser) parser = musician_gpt_parser_new ();
+  g_autoptr(GFile) file = g_file_new_for_path (path);
+  g_autoptr(GError) error = NULL;
+
+  musician_gpt_parser_load_from_file (parser, file, NULL, &error);
+  g_assert_no_error (error);
+
+  return g_object_ref (musician_gpt_parser_get_song (parser));
+}
+
+static void
+assert_songs_equal (MusicianGptSong *a,
+                    MusicianGptSong *b)
+{
+  guint n_measures;
+  guint n_tracks;
+
+  g_assert_cmpstr (musician_gpt_song_get_title (a), ==, musician_gpt_song_get_title (b));
+  g_assert_cmpstr (musician_gpt_song_get_artist (a), ==, musician_gpt_song_get_artist (b));
+  g_assert_cmpstr (musician_gpt_song_get_album (a), ==, musician_gpt_song_get_album (b));
+  g_assert_cmpstr (musician_gpt_song_get_writer (a), ==, musician_gpt_song_get_writer (b));
+  g_assert_cmpstr (musician_gpt_song_get_version (a), ==, musician_gpt_song_get_version (b));
+  g_assert_cmpint (musician_gpt_song_get_tempo (a), ==, musician_gpt_song_get_tempo (b));
+  g_assert_cmpint (musician_gpt_song_get_key (a), ==, musician_gpt_song_get_key (b));
+  g_assert_cmpint (musician_gpt_song_get_octave (a), ==, musician_gpt_song_get_octave (b));
+  g_assert_cmpint (musician_gpt_song_get_triplet_feel (a), ==, musician_gpt_song_get_triplet_feel (b));
+
+  n_measures = musician_gpt_song_get_n_measures (a);
+  n_tracks = musician_gpt_song_get_n_tracks (a);
+
+  g_assert_cmpint (musician_gpt_song_get_n_measures (b), ==, n_measures);
+  g_assert_cmpint (musician_gpt_song_get_n_tracks (b), ==, n_tracks);
+
+  for (guint track = 1; track <= n_tracks; track++)
+    {
+      g_autoptr(GError) error = NULL;
+      MusicianGptBeatStore *store_a;
+      MusicianGptBeatStore *store_b;
+      guint n_beats;
+
+      store_a = musician_gpt_song_get_beat_store (a, track, NULL, &error);
+      g_assert_no_error (error);
+      store_b = musician_gpt_song_get_beat_store (b, track, NULL, &error);
+      g_assert_no_error (error);
+
+      n_beats = musician_gpt_beat_store_get_n_beats (store_a);
+      g_assert_cmpint (musician_gpt_beat_store_get_n_beats (store_b), ==, n_beats);
+      g_assert_cmpmem (musician_gpt_beat_store_get_flags (store_a), n_beats,
+                       musician_gpt_beat_store_get_flags (store_b), n_beats);
+
+      for (guint i = 0; i < n_beats; i++)
+        {
+          MusicianGptBeatView view_a;
+          MusicianGptBeatView view_b;
+
+          musician_gpt_beat_store_get_view (store_a, i, &view_a);
+          musician_gpt_beat_store_get_view (store_b, i, &view_b);
+
+          g_assert_cmpint (view_a.n_bends, ==, view_b.n_bends);
+        }
+    }
+
+  for (guint measure = 1; measure <= n_measures; measure++)
+    {
+      for (guint track = 1; track <= n_tracks; track++)
+        {
+          g_autoptr(GPtrArray) beats_a = NULL;
+          g_autoptr(GPtrArray) beats_b = NULL;
+          g_autoptr(GError) error = NULL;
+
+          beats_a = musician_gpt_song_get_beats (a, measure, track, NULL, &error);
+          g_assert_no_error (error);
+          beats_b = musician_gpt_song_get_beats (b, measure, track, NULL, &error);
+          g_assert_no_error (error);
+
+          g_assert_cmpint (beats_a->len, ==, beats_b->len);
+
+          for (guint i = 0; i < beats_a->len; i++)
+            {
+              MusicianGptBeat *beat_a = g_ptr_array_index (beats_a, i);
+              MusicianGptBeat *beat_b = g_ptr_array_index (beats_b, i);
+
+              g_assert_cmpint (musician_gpt_beat_get_mode (beat_a), ==, musician_gpt_beat_get_mode (beat_b));
+              g_assert_cmpint (musician_gpt_beat_get_duration (beat_a), ==, musician_gpt_beat_get_duration (beat_b));
+              g_assert_cmpint (musician_gpt_beat_get_n_tuplet (beat_a), ==, musician_gpt_beat_get_n_tuplet (beat_b));
+              g_assert_cmpint (musician_gpt_beat_get_dynamics (beat_a), ==, musician_gpt_beat_get_dynamics (beat_b));
+              g_assert_cmpstr (musician_gpt_beat_get_text (beat_a), ==, musician_gpt_beat_get_text (beat_b));
+              g_assert_true ((musician_gpt_beat_get_chord (beat_a) == NULL) ==
+                             (musician_gpt_beat_get_chord (beat_b) == NULL));
+              if (musician_gpt_beat_get_chord (beat_a) != NULL)
+                g_assert_cmpstr (musician_gpt_chord_get_name (musician_gpt_beat_get_chord (beat_a)), ==,
+                                 musician_gpt_chord_get_name (musician_gpt_beat_get_chord (beat_b)));
+            }
+        }
+    }
+}
+
+static void
+test_snapshot_bytes (void)
+{
+  g_autoptr(MusicianGptSong) song = load_test_song ("test1.gp4");
+  g_autoptr(MusicianGptSong) loaded = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+  g_autoptr(GError) error = NULL;
+  const gchar *title;
+  const gchar *data;
+  gsize len;
+
+  bytes = musician_gpt_snapshot_serialize (song, NULL, &error);
+  g_assert_no_error (error);
+  g_assert (bytes != NULL);
+
+  loaded = musician_gpt_snapshot_load_from_bytes (bytes, &error);
+  g_assert_no_error (error);
+  g_assert (MUSICIAN_IS_GPT_SONG (loaded));
+
+  assert_songs_equal (song, loaded);
+
+  /* Strings are not copied out of the snapshot */
+  data = g_bytes_get_data (bytes, &len);
+  title = musician_gpt_song_get_title (loaded);
+  g_assert_true (title >= data && title < data + len);
+}
+
+static void
+test_snapshot_file (void)
+{
+  g_autoptr(MusicianGptSong) song = load_test_song ("test1.gp4");
+  g_autoptr(MusicianGptSong) loaded = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GFile) file = NULL;
+  g_autofree gchar *path = NULL;
+  gint fd;
+
+  fd = g_file_open_tmp ("test-gpt-snapshot-XXXXXX", &path, &error);
+  g_assert_no_error (error);
+  close (fd);
+
+  file = g_file_new_for_path (path);
+
+  musician_gpt_snapshot_save_to_file (song, file, NULL, &error);
+  g_assert_no_error (error);
+
+  loaded = musician_gpt_snapshot_load_from_file (file, NULL, &error);
+  g_assert_no_error (error);
+  g_assert (MUSICIAN_IS_GPT_SONG (loaded));
+
+  /* The song keeps the old contents mapped while the file is replaced */
+  musician_gpt_snapshot_save_to_file (song, file, NULL, &error);
+  g_assert_no_error (error);
+
+  assert_songs_equal (song, loaded);
+
+  g_unlink (path);
+}
+
+static void
+test_snapshot_invalid (void)
+{
+  g_autoptr(MusicianGptSong) song = load_test_song ("test1.gp4");
+  g_autoptr(GBytes) bytes = NULL;
+  g_autoptr(GBytes) truncated = NULL;
+  g_autoptr(GBytes) garbage = NULL;
+  g_autoptr(GError) error = NULL;
+  MusicianGptSong *loaded;
+
+  bytes = musician_gpt_snapshot_serialize (song, NULL, &error);
+  g_assert_no_error (error);
+
+  truncated = g_bytes_new_from_bytes (bytes, 0, g_bytes_get_size (bytes) - 1);
+  loaded = musician_gpt_snapshot_load_from_bytes (truncated, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+  g_assert (loaded == NULL);
+  g_clear_error (&error);
+
+  garbage = g_bytes_new_static ("not a snapshot", 14);
+  loaded = musician_gpt_snapshot_load_from_bytes (garbage, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+  g_assert (loaded == NULL);
+}
+
+static GBytes *
+patch_block_layout (GBytes  *bytes,
+                    guint32  n_block_measures,
+                    guint32  n_block_tracks)
+{
+  SnapshotHeader *header;
+  gconstpointer contents;
+  guint8 *data;
+  gsize len;
+
+  contents = g_bytes_get_data (bytes, &len);
+  data = g_malloc (len);
+  memcpy (data, contents, len);
+  header = (SnapshotHeader *)(gpointer)data;
+  header->n_block_measures = n_block_measures;
+  header->n_block_tracks = n_block_tracks;
+  header->blocks.n_items = (guint64)n_block_measures * n_block_tracks;
+
+  return g_bytes_new_take (data, len);
+}
+
+static void
+test_snapshot_block_layout (void)
+{
+  g_autoptr(MusicianGptSong) song = load_test_song ("test1.gp4");
+  g_autoptr(GBytes) bytes = NULL;
+  g_autoptr(GBytes) no_measures = NULL;
+  g_autoptr(GBytes) no_tracks = NULL;
+  g_autoptr(GError) error = NULL;
+  MusicianGptSong *loaded;
+
+  bytes = musician_gpt_snapshot_serialize (song, NULL, &error);
+  g_assert_no_error (error);
+
+  /* No blocks at all, yet a beat store would be created for every track */
+  no_measures = patch_block_layout (bytes, 0, G_MAXUINT32);
+  loaded = musician_gpt_snapshot_load_from_bytes (no_measures, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+  g_assert (loaded == NULL);
+  g_clear_error (&error);
+
+  no_tracks = patch_block_layout (bytes, G_MAXUINT32, 0);
+  loaded = musician_gpt_snapshot_load_from_bytes (no_tracks, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+  g_assert (loaded == NULL);
+}
+
+gint
+main (gint argc,
+      gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  g_test_add_func ("/Musician/GptSnapshot/bytes", test_snapshot_bytes);
+  g_test_add_func ("/Musician/GptSnapshot/file", test_snapshot_file);
+  g_test_add_func ("/Musician/GptSnapshot/invalid", test_snapshot_invalid);
+  g_test_add_func ("/Musician/GptSnapshot/block-layout", test_snapshot_block_layout);
+  return g_test_run ();
+}
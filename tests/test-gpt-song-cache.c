@@ -0,0 +1,208 @@
+/* test-gpt-song-cache.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <musician.h>
+
+#define N_THREADS 8
+
+static GFile *
+get_test_file (const gchar *name)
+{
+  g_autofree gchar *path = g_build_filename (TESTS_SRCDIR, "data", name, NULL);
+
+  return g_file_new_for_path (path);
+}
+
+static MusicianGptSong *
+load_file (MusicianGptSongCache *cache,
+           GFile                *file)
+{
+  g_autoptr(MusicianGptParser) parser = musician_gpt_parser_new ();
+  g_autoptr(GError) error = NULL;
+
+  musician_gpt_parser_set_cache (parser, cache);
+  musician_gpt_parser_load_from_file (parser, file, NULL, &error);
+  g_assert_no_error (error);
+
+  return g_object_ref (musician_gpt_parser_get_song (parser));
+}
+
+static void
+test_song_cache_hit (void)
+{
+  g_autoptr(MusicianGptSongCache) cache = musician_gpt_song_cache_new ();
+  g_autoptr(MusicianGptParser) parser = musician_gpt_parser_new ();
+  g_autoptr(GFile) file = get_test_file ("test1.gp4");
+  g_autoptr(MusicianGptSong) first = NULL;
+  g_autoptr(MusicianGptSong) second = NULL;
+  g_autoptr(GFileInputStream) stream = NULL;
+  g_autoptr(GError) error = NULL;
+
+  first = load_file (cache, file);
+  g_assert_cmpint (musician_gpt_song_cache_get_n_misses (cache), ==, 1);
+  g_assert_cmpint (musician_gpt_song_cache_get_n_hits (cache), ==, 0);
+  g_assert_cmpint (musician_gpt_song_cache_get_n_songs (cache), ==, 1);
+  g_assert_cmpint (musician_gpt_song_cache_get_size (cache), >, 0);
+
+  second = load_file (cache, file);
+  g_assert_true (first == second);
+  g_assert_true (musician_gpt_song_get_read_only (first));
+  g_assert_cmpint (musician_gpt_song_cache_get_n_hits (cache), ==, 1);
+
+  /* Songs are found by their contents, however they are read */
+  stream = g_file_read (file, NULL, &error);
+  g_assert_no_error (error);
+
+  musician_gpt_parser_set_cache (parser, cache);
+  musician_gpt_parser_load_from_stream (parser, G_INPUT_STREAM (stream), NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (musician_gpt_parser_get_song (parser) == first);
+  g_assert_cmpint (musician_gpt_song_cache_get_n_hits (cache), ==, 2);
+  g_assert_cmpint (musician_gpt_song_cache_get_n_misses (cache), ==, 1);
+
+  musician_gpt_song_cache_clear (cache);
+  g_assert_cmpint (musician_gpt_song_cache_get_n_songs (cache), ==, 0);
+  g_assert_cmpint (musician_gpt_song_cache_get_size (cache), ==, 0);
+}
+
+static void
+test_song_cache_evict (void)
+{
+  g_autoptr(MusicianGptSongCache) cache = musician_gpt_song_cache_new ();
+  g_autoptr(GFile) file = get_test_file ("test1.gp4");
+  g_autoptr(MusicianGptSong) first = NULL;
+  g_autoptr(MusicianGptSong) second = NULL;
+  g_autoptr(MusicianGptSong) third = NULL;
+  guint64 size;
+
+  first = load_file (cache, file);
+  size = musician_gpt_song_cache_get_size (cache);
+
+  /* Too small for the song, so it is dropped and decoded again */
+  musician_gpt_song_cache_set_max_size (cache, size - 1);
+  g_assert_cmpint (musician_gpt_song_cache_get_n_evictions (cache), ==, 1);
+  g_assert_cmpint (musician_gpt_song_cache_get_n_songs (cache), ==, 0);
+
+  second = load_file (cache, file);
+  g_assert_true (first != second);
+  g_assert_cmpint (musician_gpt_song_cache_get_n_misses (cache), ==, 2);
+  g_assert_cmpint (musician_gpt_song_cache_get_n_songs (cache), ==, 0);
+
+  musician_gpt_song_cache_set_max_size (cache, size);
+  third = load_file (cache, file);
+  g_assert_cmpint (musician_gpt_song_cache_get_n_songs (cache), ==, 1);
+}
+
+typedef struct
+{
+  MusicianGptSongCache *cache;
+  GFile                *file;
+} ThreadData;
+
+static gpointer
+load_thread (gpointer data)
+{
+  ThreadData *thread_data = data;
+
+  return load_file (thread_data->cache, thread_data->file);
+}
+
+static void
+test_song_cache_threads (void)
+{
+  g_autoptr(MusicianGptSongCache) cache = musician_gpt_song_cache_new ();
+  g_autoptr(GFile) file = get_test_file ("test1.gp4");
+  g_autoptr(MusicianGptSong) cached = NULL;
+  ThreadData thread_data = { cache, file };
+  GThread *threads[N_THREADS];
+
+  for (guint i = 0; i < N_THREADS; i++)
+    threads[i] = g_thread_new ("load", load_thread, &thread_data);
+
+  for (guint i = 0; i < N_THREADS; i++)
+    {
+      g_autoptr(MusicianGptSong) song = g_thread_join (threads[i]);
+
+      g_assert (MUSICIAN_IS_GPT_SONG (song));
+    }
+
+  g_assert_cmpint (musician_gpt_song_cache_get_n_hits (cache) +
+                   musician_gpt_song_cache_get_n_misses (cache), ==, N_THREADS);
+  g_assert_cmpint (musician_gpt_song_cache_get_n_songs (cache), ==, 1);
+
+  /* Everyone who missed at the same time still ends up with the same song */
+  cached = load_file (cache, file);
+  g_assert_cmpint (musician_gpt_song_cache_get_n_hits (cache) +
+                   musician_gpt_song_cache_get_n_misses (cache), ==, N_THREADS + 1);
+}
+
+static gpointer
+list_thread (gpointer data)
+{
+  MusicianGptSong *song = data;
+  g_autoptr(GError) error = NULL;
+  MusicianGptTimeline *timeline;
+  guint64 length;
+
+  timeline = musician_gpt_song_get_timeline (song, 1, NULL, &error);
+  g_assert_no_error (error);
+  length = musician_gpt_timeline_get_length (timeline);
+  g_assert_cmpint (length, >, 0);
+
+  for (guint i = 0; i < 1000; i++)
+    {
+      g_autoptr(GListModel) measures = musician_gpt_song_list_measures (song);
+      g_autoptr(GListModel) tracks = musician_gpt_song_list_tracks (song);
+
+      g_assert_cmpint (g_list_model_get_n_items (measures), ==, musician_gpt_song_get_n_measures (song));
+      g_assert_cmpint (g_list_model_get_n_items (tracks), ==, musician_gpt_song_get_n_tracks (song));
+
+      g_assert_true (musician_gpt_song_get_timeline (song, 1, NULL, &error) == timeline);
+      g_assert_cmpint (musician_gpt_timeline_get_length (timeline), ==, length);
+    }
+
+  return NULL;
+}
+
+static void
+test_song_cache_shared (void)
+{
+  g_autoptr(MusicianGptSongCache) cache = musician_gpt_song_cache_new ();
+  g_autoptr(GFile) file = get_test_file ("test1.gp4");
+  g_autoptr(MusicianGptSong) song = load_file (cache, file);
+  GThread *threads[N_THREADS];
+
+  /* The lists and timelines of a shared song are used on every thread at once */
+  for (guint i = 0; i < N_THREADS; i++)
+    threads[i] = g_thread_new ("list", list_thread, song);
+
+  for (guint i = 0; i < N_THREADS; i++)
+    g_thread_join (threads[i]);
+}
+
+gint
+main (gint argc,
+      gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  g_test_add_func ("/Musician/GptSongCache/hit", test_song_cache_hit);
+  g_test_add_func ("/Musician/GptSongCache/evict", test_song_cache_evict);
+  g_test_add_func ("/Musician/GptSongCache/threads", test_song_cache_threads);
+  g_test_add_func ("/Musician/GptSongCache/shared", test_song_cache_shared);
+  return g_test_run ();
+}
@@ -0,0 +1,409 @@
+/* test-gpt-song.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <musician.h>
+
+#include "musician-gpt-beat-store-private.h"
+#include "musician-gpt-measure-private.h"
+#include "musician-gpt-song-private.h"
+#include "musician-gpt-track-private.h"
+
+static MusicianGptMeasure *
+create_measure (guint id)
+{
+  MusicianGptMeasure *measure = musician_gpt_measure_new ();
+
+  musician_gpt_measure_set_id (measure, id);
+
+  return measure;
+}
+
+static void
+assert_measures_sorted (MusicianGptSong *song)
+{
+  MusicianGptMeasure **measures;
+  guint n_measures;
+
+  measures = musician_gpt_song_get_measures (song, &n_measures);
+  g_assert_cmpint (n_measures, ==, musician_gpt_song_get_n_measures (song));
+
+  for (guint i = 1; i < n_measures; i++)
+    g_assert_cmpint (musician_gpt_measure_get_id (measures[i - 1]), <=, musician_gpt_measure_get_id (measures[i]));
+}
+
+static void
+test_song_measures (void)
+{
+  g_autoptr(MusicianGptSong) song = musician_gpt_song_new ();
+  g_autoptr(MusicianGptMeasure) other = NULL;
+  MusicianGptMeasure **measures;
+  guint n_measures;
+
+  for (guint id = 1; id <= 100; id++)
+    {
+      g_autoptr(MusicianGptMeasure) measure = create_measure (id);
+
+      musician_gpt_song_add_measure (song, measure);
+    }
+
+  measures = musician_gpt_song_get_measures (song, &n_measures);
+  g_assert_cmpint (n_measures, ==, 100);
+
+  for (guint id = 1; id <= 100; id++)
+    {
+      MusicianGptMeasure *measure = musician_gpt_song_get_measure (song, id);
+
+      g_assert (measure == measures[id - 1]);
+      g_assert_cmpint (musician_gpt_measure_get_id (measure), ==, id);
+    }
+
+  g_assert (musician_gpt_song_get_measure (song, 0) == NULL);
+  g_assert (musician_gpt_song_get_measure (song, 101) == NULL);
+
+  /* Removing matches by id, and leaves a gap that lookups still handle */
+  other = create_measure (50);
+  musician_gpt_song_remove_measure (song, other);
+  g_assert_cmpint (musician_gpt_song_get_n_measures (song), ==, 99);
+  g_assert (musician_gpt_song_get_measure (song, 50) == NULL);
+  g_assert_cmpint (musician_gpt_measure_get_id (musician_gpt_song_get_measure (song, 51)), ==, 51);
+  g_assert_cmpint (musician_gpt_measure_get_id (musician_gpt_song_get_measure (song, 100)), ==, 100);
+
+  musician_gpt_song_remove_measure (song, other);
+  g_assert_cmpint (musician_gpt_song_get_n_measures (song), ==, 99);
+
+  /* Adding it back out of order keeps the measures sorted */
+  musician_gpt_song_add_measure (song, other);
+  g_assert_cmpint (musician_gpt_song_get_n_measures (song), ==, 100);
+  g_assert (musician_gpt_song_get_measure (song, 50) == other);
+  assert_measures_sorted (song);
+}
+
+static void
+test_song_measures_unordered (void)
+{
+  g_autoptr(MusicianGptSong) song = musician_gpt_song_new ();
+  static const guint ids[] = { 7, 3, 9, 1, 3, 12 };
+
+  for (guint i = 0; i < G_N_ELEMENTS (ids); i++)
+    {
+      g_autoptr(MusicianGptMeasure) measure = create_measure (ids[i]);
+
+      musician_gpt_song_add_measure (song, measure);
+    }
+
+  g_assert_cmpint (musician_gpt_song_get_n_measures (song), ==, G_N_ELEMENTS (ids));
+  assert_measures_sorted (song);
+
+  for (guint i = 0; i < G_N_ELEMENTS (ids); i++)
+    g_assert_cmpint (musician_gpt_measure_get_id (musician_gpt_song_get_measure (song, ids[i])), ==, ids[i]);
+
+  g_assert (musician_gpt_song_get_measure (song, 2) == NULL);
+  g_assert (musician_gpt_song_get_measure (song, 13) == NULL);
+}
+
+static void
+count_notify (GObject    *object,
+              GParamSpec *pspec,
+              guint      *n_notify)
+{
+  (*n_notify)++;
+}
+
+static void
+test_song_info (void)
+{
+  g_autoptr(MusicianGptSong) song = musician_gpt_song_new ();
+  g_autoptr(MusicianGptMeasure) measure = NULL;
+  g_autoptr(MusicianGptTrack) track = NULL;
+  static const MusicianGptTuning tunings[] = { 64, 59, 55, 50, 45, 40 };
+  MusicianGptMeasureInfo measure_info = { 0 };
+  MusicianGptTrackInfo track_info = { 0 };
+  MusicianGptSongInfo song_info = { 0 };
+  const MusicianGptTuning *track_tunings;
+  gsize n_tunings;
+  guint n_notify = 0;
+
+  g_signal_connect (song, "notify", G_CALLBACK (count_notify), &n_notify);
+
+  song_info.title = "Title";
+  song_info.artist = "Artist";
+  song_info.tempo = 140;
+  song_info.key = MUSICIAN_GPT_KEY_G;
+  _musician_gpt_song_set_info (song, &song_info);
+
+  g_assert_cmpint (n_notify, ==, 0);
+  g_assert_cmpstr (musician_gpt_song_get_title (song), ==, "Title");
+  g_assert_cmpstr (musician_gpt_song_get_artist (song), ==, "Artist");
+  g_assert_cmpstr (musician_gpt_song_get_album (song), ==, NULL);
+  g_assert_cmpint (musician_gpt_song_get_tempo (song), ==, 140);
+  g_assert_cmpint (musician_gpt_song_get_key (song), ==, MUSICIAN_GPT_KEY_G);
+
+  /* The regular setters still notify */
+  musician_gpt_song_set_tempo (song, 120);
+  g_assert_cmpint (n_notify, ==, 1);
+
+  measure_info.id = 3;
+  measure_info.numerator = 6;
+  measure_info.denominator = 8;
+  measure_info.marker_name = "Chorus";
+  measure = _musician_gpt_measure_new_from_info (&measure_info, NULL);
+
+  g_assert_cmpint (musician_gpt_measure_get_id (measure), ==, 3);
+  g_assert_cmpint (musician_gpt_measure_get_numerator (measure), ==, 6);
+  g_assert_cmpint (musician_gpt_measure_get_denominator (measure), ==, 8);
+  g_assert_cmpstr (musician_gpt_measure_get_marker_name (measure), ==, "Chorus");
+
+  track_info.id = 1;
+  track_info.title = "Guitar";
+  track_info.tunings = tunings;
+  track_info.n_tunings = G_N_ELEMENTS (tunings);
+  track_info.n_frets = 24;
+  track = _musician_gpt_track_new_from_info (&track_info, NULL);
+
+  g_assert_cmpint (musician_gpt_track_get_id (track), ==, 1);
+  g_assert_cmpstr (musician_gpt_track_get_title (track), ==, "Guitar");
+  g_assert_cmpint (musician_gpt_track_get_n_frets (track), ==, 24);
+  track_tunings = musician_gpt_track_get_tunings (track, &n_tunings);
+  g_assert_cmpint (n_tunings, ==, G_N_ELEMENTS (tunings));
+  g_assert_cmpmem (track_tunings, n_tunings * sizeof *track_tunings, tunings, sizeof tunings);
+}
+
+typedef struct
+{
+  guint position;
+  guint removed;
+  guint added;
+  guint n_emissions;
+} ItemsChanged;
+
+static void
+record_items_changed (GListModel   *model,
+                      guint         position,
+                      guint         removed,
+                      guint         added,
+                      ItemsChanged *changed)
+{
+  changed->position = position;
+  changed->removed = removed;
+  changed->added = added;
+  changed->n_emissions++;
+}
+
+static void
+test_song_list_models (void)
+{
+  g_autoptr(MusicianGptSong) song = musician_gpt_song_new ();
+  g_autoptr(MusicianGptMeasure) inserted = create_measure (5);
+  g_autoptr(MusicianGptTrack) track = musician_gpt_track_new ();
+  g_autoptr(GListModel) measures = NULL;
+  g_autoptr(GListModel) again = NULL;
+  g_autoptr(GListModel) tracks = NULL;
+  g_autoptr(GObject) item = NULL;
+  ItemsChanged changed = { 0 };
+
+  for (guint id = 1; id <= 10; id++)
+    {
+      g_autoptr(MusicianGptMeasure) measure = create_measure (id * 2);
+
+      musician_gpt_song_add_measure (song, measure);
+    }
+
+  measures = musician_gpt_song_list_measures (song);
+  again = musician_gpt_song_list_measures (song);
+  g_assert (measures == again);
+  g_assert (g_list_model_get_item_type (measures) == MUSICIAN_TYPE_GPT_MEASURE);
+  g_assert_cmpint (g_list_model_get_n_items (measures), ==, 10);
+  g_assert (g_list_model_get_item (measures, 10) == NULL);
+
+  item = g_list_model_get_item (measures, 3);
+  g_assert (item == (GObject *)musician_gpt_song_get_measure (song, 8));
+  g_clear_object (&item);
+
+  g_signal_connect (measures, "items-changed", G_CALLBACK (record_items_changed), &changed);
+
+  /* Only the position that changed is reported */
+  musician_gpt_song_add_measure (song, inserted);
+  g_assert_cmpint (changed.n_emissions, ==, 1);
+  g_assert_cmpint (changed.position, ==, 2);
+  g_assert_cmpint (changed.removed, ==, 0);
+  g_assert_cmpint (changed.added, ==, 1);
+  g_assert_cmpint (g_list_model_get_n_items (measures), ==, 11);
+
+  musician_gpt_song_remove_measure (song, inserted);
+  g_assert_cmpint (changed.n_emissions, ==, 2);
+  g_assert_cmpint (changed.position, ==, 2);
+  g_assert_cmpint (changed.removed, ==, 1);
+  g_assert_cmpint (changed.added, ==, 0);
+
+  tracks = musician_gpt_song_list_tracks (song);
+  g_assert_cmpint (g_list_model_get_n_items (tracks), ==, 0);
+  musician_gpt_song_add_track (song, track);
+  g_assert_cmpint (g_list_model_get_n_items (tracks), ==, 1);
+  item = g_list_model_get_item (tracks, 0);
+  g_assert (item == (GObject *)track);
+  g_clear_object (&item);
+  musician_gpt_song_remove_track (song, track);
+  g_assert_cmpint (g_list_model_get_n_items (tracks), ==, 0);
+
+  /* The lists keep the song alive */
+  g_object_add_weak_pointer (G_OBJECT (song), (gpointer *)&song);
+  g_object_unref (song);
+  g_assert (song != NULL);
+  g_assert_cmpint (g_list_model_get_n_items (measures), ==, 10);
+  g_clear_object (&measures);
+  g_clear_object (&again);
+  g_clear_object (&tracks);
+  g_assert (song == NULL);
+}
+
+static void
+append_beat (MusicianGptBeatStore *store,
+             guint                 duration,
+             guint                 n_tuplet,
+             MusicianGptBeatFlags  flags)
+{
+  MusicianGptBeatEvent event = { 0 };
+
+  event.mode = MUSICIAN_GPT_BEAT_MODE_NORMAL;
+  event.duration = duration;
+  event.n_tuplet = n_tuplet;
+  event.flags = flags;
+
+  _musician_gpt_beat_store_append (store, &event);
+}
+
+static MusicianGptMeasure *
+create_signed_measure (guint id,
+                       guint numerator,
+                       guint denominator)
+{
+  MusicianGptMeasure *measure = create_measure (id);
+
+  musician_gpt_measure_set_numerator (measure, numerator);
+  musician_gpt_measure_set_denominator (measure, denominator);
+
+  return measure;
+}
+
+static void
+assert_lookup (MusicianGptTimeline *timeline,
+               guint64              tick,
+               guint                expected_measure,
+               guint                expected_beat)
+{
+  guint measure = 0;
+  guint beat = 0;
+
+  g_assert_true (musician_gpt_timeline_lookup (timeline, tick, &measure, &beat));
+  g_assert_cmpint (measure, ==, expected_measure);
+  g_assert_cmpint (beat, ==, expected_beat);
+}
+
+static void
+test_song_timeline (void)
+{
+  g_autoptr(MusicianGptSong) song = musician_gpt_song_new ();
+  g_autoptr(MusicianGptMeasure) first = create_signed_measure (1, 4, 4);
+  g_autoptr(MusicianGptMeasure) second = create_signed_measure (2, 3, 4);
+  g_autoptr(MusicianGptMeasure) third = create_signed_measure (3, 4, 4);
+  g_autoptr(GError) error = NULL;
+  MusicianGptTimeline *timeline;
+  MusicianGptBeatStore *store;
+
+  musician_gpt_song_set_tempo (song, 120);
+  musician_gpt_song_add_measure (song, first);
+  musician_gpt_song_add_measure (song, second);
+
+  _musician_gpt_song_set_block_layout (song, 3, 1);
+  store = _musician_gpt_song_get_store (song, 1);
+
+  /* Three quarter notes, leaving the last beat of 4/4 empty */
+  _musician_gpt_beat_store_begin_measure (store, 1);
+  for (guint i = 0; i < 3; i++)
+    append_beat (store, 4, 0, 0);
+
+  /* A dotted half note in 3/4 */
+  _musician_gpt_beat_store_begin_measure (store, 2);
+  append_beat (store, 2, 0, MUSICIAN_GPT_BEAT_FLAGS_DOTTED);
+
+  /* Triplet eighths and a half note, in a measure without a header */
+  _musician_gpt_beat_store_begin_measure (store, 3);
+  for (guint i = 0; i < 3; i++)
+    append_beat (store, 8, 3, MUSICIAN_GPT_BEAT_FLAGS_N_TUPLET);
+  append_beat (store, 2, 0, 0);
+
+  timeline = musician_gpt_song_get_timeline (song, 1, NULL, &error);
+  g_assert_no_error (error);
+  g_assert (timeline != NULL);
+  g_assert (timeline == musician_gpt_song_get_timeline (song, 1, NULL, NULL));
+
+  g_assert_cmpint (musician_gpt_timeline_get_n_measures (timeline), ==, 3);
+  g_assert_cmpint (musician_gpt_timeline_get_measure_tick (timeline, 1), ==, 0);
+  g_assert_cmpint (musician_gpt_timeline_get_measure_tick (timeline, 2), ==, 3840);
+  g_assert_cmpint (musician_gpt_timeline_get_measure_tick (timeline, 3), ==, 6720);
+  g_assert_cmpint (musician_gpt_timeline_get_length (timeline), ==, 9600);
+
+  g_assert_cmpint (musician_gpt_timeline_get_beat_tick (timeline, 2), ==, 1920);
+  g_assert_cmpint (musician_gpt_timeline_get_beat_tick (timeline, 3), ==, 3840);
+  g_assert_cmpint (musician_gpt_timeline_get_beat_tick (timeline, 5), ==, 7040);
+  g_assert_cmpint (musician_gpt_timeline_get_beat_tick (timeline, 7), ==, 7680);
+
+  assert_lookup (timeline, 0, 1, 0);
+  assert_lookup (timeline, 2879, 1, 2);
+  assert_lookup (timeline, 3000, 1, G_MAXUINT);
+  assert_lookup (timeline, 3840, 2, 3);
+  assert_lookup (timeline, 7100, 3, 5);
+  assert_lookup (timeline, 9599, 3, 7);
+  g_assert_false (musician_gpt_timeline_lookup (timeline, 9600, NULL, NULL));
+
+  g_assert_cmpint (musician_gpt_timeline_tick_to_usec (timeline, 3840), ==, 2 * G_USEC_PER_SEC);
+  g_assert_cmpint (musician_gpt_timeline_usec_to_tick (timeline, 2 * G_USEC_PER_SEC), ==, 3840);
+
+  /* Only what comes after a changed measure moves */
+  musician_gpt_measure_set_numerator (first, 2);
+  g_assert_cmpint (musician_gpt_timeline_get_measure_tick (timeline, 2), ==, 1920);
+  g_assert_cmpint (musician_gpt_timeline_get_beat_tick (timeline, 3), ==, 1920);
+  g_assert_cmpint (musician_gpt_timeline_get_length (timeline), ==, 7680);
+  assert_lookup (timeline, 1919, 1, 1);
+
+  musician_gpt_song_add_measure (song, third);
+  g_assert_cmpint (musician_gpt_timeline_get_length (timeline), ==, 8640);
+  assert_lookup (timeline, 8000, 3, G_MAXUINT);
+
+  musician_gpt_song_remove_measure (song, third);
+  g_assert_cmpint (musician_gpt_timeline_get_length (timeline), ==, 7680);
+
+  musician_gpt_song_set_tempo (song, 60);
+  g_assert_cmpint (musician_gpt_timeline_tick_to_usec (timeline, 960), ==, G_USEC_PER_SEC);
+
+  g_assert_null (musician_gpt_song_get_timeline (song, 2, NULL, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
+}
+
+gint
+main (gint argc,
+      gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  g_test_add_func ("/Musician/GptSong/measures", test_song_measures);
+  g_test_add_func ("/Musician/GptSong/measures-unordered", test_song_measures_unordered);
+  g_test_add_func ("/Musician/GptSong/info", test_song_info);
+  g_test_add_func ("/Musician/GptSong/list-models", test_song_list_models);
+  g_test_add_func ("/Musician/GptSong/timeline", test_song_timeline);
+  return g_test_run ();
+}